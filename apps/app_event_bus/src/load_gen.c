@@ -0,0 +1,396 @@
+#include "load_gen.h"
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <string.h>
+
+LOG_MODULE_REGISTER(load_gen, CONFIG_LOG_DEFAULT_LEVEL);
+
+#define PRODUCER_STACK_SIZE 1024
+#define SUBSCRIBER_STACK_SIZE 1024
+// Subscribers preempt the producers, like a consumer thread woken by its queue.
+#define PRODUCER_PRIORITY 8
+#define SUBSCRIBER_PRIORITY 7
+// ISR producers post what is due on every expiry.
+#define ISR_PERIOD K_MSEC(1)
+// Posts per wakeup before a producer gives up on its backlog
+#define MAX_CATCH_UP 256
+// How long the subscribers get to empty their queues after a run
+#define DRAIN_TIMEOUT_MS 1000
+
+static const event_id_t kind_events[LOAD_GEN_KINDS] = {
+    [LOAD_GEN_MOTOR_SPEED] = EVENT_MOTOR_SPEED_REPORT,
+    [LOAD_GEN_HEATER_TEMP] = EVENT_HEATER_TEMP_CHANGED,
+    [LOAD_GEN_WATER_LEVEL] = EVENT_WATER_LEVEL_CHANGED,
+    [LOAD_GEN_WEIGHT] = EVENT_WEIGHT_CALCULATED,
+};
+
+typedef struct {
+    uint64_t next_ns;       // Uptime of the next post
+    uint32_t rng;
+    uint32_t seq;
+    uint32_t posted;
+    uint32_t failed;
+    uint32_t behind;
+    uint8_t index;
+} producer_t;
+
+typedef struct {
+    struct k_msgq msgq;
+    atomic_t received;
+    uint32_t consume_us;
+#if defined(CONFIG_EVENT_BUS_USE_CALLBACK)
+    event_bus_sink_stats_t start;   // Sink counters when the run started
+#endif
+} subscriber_t;
+
+K_THREAD_STACK_ARRAY_DEFINE(producer_stacks, LOAD_GEN_MAX_PRODUCERS, PRODUCER_STACK_SIZE);
+K_THREAD_STACK_ARRAY_DEFINE(subscriber_stacks, LOAD_GEN_MAX_SUBSCRIBERS, SUBSCRIBER_STACK_SIZE);
+static struct k_thread producer_threads[LOAD_GEN_MAX_PRODUCERS];
+static struct k_thread subscriber_threads[LOAD_GEN_MAX_SUBSCRIBERS];
+static struct k_timer isr_timers[LOAD_GEN_MAX_PRODUCERS];
+static char __aligned(4) queue_buffers[LOAD_GEN_MAX_SUBSCRIBERS]
+                                      [LOAD_GEN_QUEUE_DEPTH * sizeof(app_event_t)];
+
+static producer_t producers[LOAD_GEN_MAX_PRODUCERS];
+static subscriber_t subscribers[LOAD_GEN_MAX_SUBSCRIBERS];
+// Set by the first start; subscriptions cannot be taken back in callback mode.
+static uint8_t subscriber_count;
+
+static load_gen_config_t config;
+// Cumulative mix weights, for picking an event kind
+static uint32_t mix_bound[LOAD_GEN_KINDS];
+static uint64_t interval_ns;        // Mean gap between two posts of a producer
+static uint64_t start_ns;
+static atomic_t running;
+
+static uint64_t now_ns(void)
+{
+    return k_ticks_to_ns_floor64(k_uptime_ticks());
+}
+
+static uint32_t next_random(producer_t *p)
+{
+    p->rng = p->rng * 1664525u + 1013904223u;
+    return p->rng;
+}
+
+// -ln(u / 2^32) in Q16, for exponential gaps. log2 from the position of the
+// top bit plus a quadratic fit of the mantissa, within 0.006 of the real
+// thing, which is plenty for load shaping.
+static uint32_t neg_ln_q16(uint32_t u)
+{
+    u = MAX(u, 1);
+
+    const uint32_t msb = 31 - __builtin_clz(u);
+    const uint32_t frac = msb >= 16 ? (u >> (msb - 16)) & 0xffff : (u << (16 - msb)) & 0xffff;
+    const uint32_t log2_q16 = (msb << 16) + frac +
+                              ((((uint64_t)frac * (65536 - frac)) >> 16) * 22713 >> 16);
+
+    // ln(2) in Q16
+    return (uint32_t)(((uint64_t)((32u << 16) - log2_q16) * 45426) >> 16);
+}
+
+static void schedule_next(producer_t *p)
+{
+    if (config.shape == LOAD_GEN_POISSON) {
+        p->next_ns += (interval_ns * neg_ln_q16(next_random(p))) >> 16;
+        return;
+    }
+
+    p->next_ns += interval_ns;
+    if (config.shape == LOAD_GEN_ON_OFF) {
+        const uint64_t on_ns = (uint64_t)config.on_ms * NSEC_PER_MSEC;
+        const uint64_t period_ns = on_ns + (uint64_t)config.off_ms * NSEC_PER_MSEC;
+        const uint64_t phase = (p->next_ns - start_ns) % period_ns;
+
+        if (phase >= on_ns) {
+            p->next_ns += period_ns - phase;
+        }
+    }
+}
+
+static void post_one(producer_t *p)
+{
+    const uint32_t pick = next_random(p) % mix_bound[LOAD_GEN_KINDS - 1];
+    int kind = 0;
+
+    while (pick >= mix_bound[kind]) {
+        kind++;
+    }
+
+    const app_event_t event = {
+        .id = kind_events[kind],
+        .payload.u32 = ((uint32_t)p->index << 24) | (p->seq++ & 0xffffff),
+    };
+
+    if (event_bus_post(&event) != 0) {
+        p->failed++;
+    }
+    p->posted++;
+}
+
+// Posts everything due by now. A producer that cannot keep up drops its
+// backlog instead of posting it in one long burst, so the achieved rate
+// shows the saturation.
+static void producer_run_due(producer_t *p)
+{
+    const uint64_t now = now_ns();
+
+    for (int n = 0; p->next_ns <= now; n++) {
+        if (n == MAX_CATCH_UP) {
+            p->behind++;
+            p->next_ns = now;
+            schedule_next(p);
+            break;
+        }
+        post_one(p);
+        schedule_next(p);
+    }
+}
+
+static void producer_entry(void *p1, void *p2, void *p3)
+{
+    producer_t *p = p1;
+
+    ARG_UNUSED(p2);
+    ARG_UNUSED(p3);
+
+    while (atomic_get(&running)) {
+        producer_run_due(p);
+        k_sleep(K_TIMEOUT_ABS_TICKS(k_ns_to_ticks_ceil64(p->next_ns)));
+    }
+}
+
+static void isr_producer_expiry(struct k_timer *timer)
+{
+    producer_run_due(k_timer_user_data_get(timer));
+}
+
+static void subscriber_entry(void *p1, void *p2, void *p3)
+{
+    subscriber_t *s = p1;
+    app_event_t event;
+
+    ARG_UNUSED(p2);
+    ARG_UNUSED(p3);
+
+    while (1) {
+        k_msgq_get(&s->msgq, &event, K_FOREVER);
+        // Counted on the way out of the queue, so an empty queue means
+        // everything delivered has been counted.
+        atomic_inc(&s->received);
+        if (s->consume_us) {
+            k_busy_wait(s->consume_us);
+        }
+    }
+}
+
+static int subscribe(subscriber_t *s)
+{
+#if defined(CONFIG_EVENT_BUS_USE_CALLBACK)
+    return event_bus_register_queue_sink(&s->msgq, kind_events, ARRAY_SIZE(kind_events), NULL);
+#else
+    return event_bus_subscribe(&s->msgq, kind_events, ARRAY_SIZE(kind_events)) ? 0 : -ENOMEM;
+#endif
+}
+
+static int start_subscribers(uint8_t count)
+{
+    for (int i = 0; i < count; i++) {
+        subscriber_t *s = &subscribers[i];
+        int ret;
+
+        k_msgq_init(&s->msgq, queue_buffers[i], sizeof(app_event_t), LOAD_GEN_QUEUE_DEPTH);
+        ret = subscribe(s);
+        if (ret != 0) {
+            LOG_ERR("Failed to subscribe load subscriber %d: %d", i, ret);
+            return ret;
+        }
+        k_thread_create(&subscriber_threads[i], subscriber_stacks[i],
+                        K_THREAD_STACK_SIZEOF(subscriber_stacks[i]), subscriber_entry, s, NULL,
+                        NULL, SUBSCRIBER_PRIORITY, 0, K_NO_WAIT);
+        k_thread_name_set(&subscriber_threads[i], "load_sub");
+        subscriber_count++;
+    }
+    return 0;
+}
+
+static bool config_valid(const load_gen_config_t *c)
+{
+    const int total = c->producers + c->isr_producers;
+
+    if (total == 0 || total > LOAD_GEN_MAX_PRODUCERS || c->rate_hz == 0 ||
+        c->rate_hz > USEC_PER_SEC) {
+        return false;
+    }
+    if (c->shape > LOAD_GEN_ON_OFF || (c->shape == LOAD_GEN_ON_OFF && c->on_ms == 0)) {
+        return false;
+    }
+    if (c->subscribers == 0 || c->subscribers > LOAD_GEN_MAX_SUBSCRIBERS) {
+        return false;
+    }
+    // The subscribers of the first run stay subscribed.
+    return subscriber_count == 0 || c->subscribers == subscriber_count;
+}
+
+int load_gen_start(const load_gen_config_t *cfg)
+{
+    uint32_t total_weight = 0;
+    int ret;
+
+    if (!cfg || !config_valid(cfg)) {
+        return -EINVAL;
+    }
+    if (atomic_get(&running)) {
+        return -EBUSY;
+    }
+    if (subscriber_count == 0) {
+        ret = start_subscribers(cfg->subscribers);
+        if (ret != 0) {
+            return ret;
+        }
+    }
+
+    config = *cfg;
+    for (int k = 0; k < LOAD_GEN_KINDS; k++) {
+        total_weight += config.mix[k];
+    }
+    for (int k = 0; k < LOAD_GEN_KINDS; k++) {
+        // All zero means an equal share each.
+        mix_bound[k] = (k > 0 ? mix_bound[k - 1] : 0) + (total_weight ? config.mix[k] : 1);
+    }
+    interval_ns = NSEC_PER_SEC / config.rate_hz;
+
+    for (int i = 0; i < config.subscribers; i++) {
+        subscriber_t *s = &subscribers[i];
+
+        s->consume_us = config.consume_us[i];
+        atomic_set(&s->received, 0);
+#if defined(CONFIG_EVENT_BUS_USE_CALLBACK)
+        event_bus_get_sink_stats(&s->msgq, &s->start);
+#endif
+    }
+
+    atomic_set(&running, 1);
+    start_ns = now_ns();
+    for (int i = 0; i < config.producers + config.isr_producers; i++) {
+        producer_t *p = &producers[i];
+
+        *p = (producer_t){ .index = i, .rng = 2654435761u * (i + 1), .next_ns = start_ns };
+        if (i < config.producers) {
+            k_thread_create(&producer_threads[i], producer_stacks[i],
+                            K_THREAD_STACK_SIZEOF(producer_stacks[i]), producer_entry, p, NULL,
+                            NULL, PRODUCER_PRIORITY, 0, K_NO_WAIT);
+            k_thread_name_set(&producer_threads[i], "load_prod");
+        } else {
+            k_timer_init(&isr_timers[i], isr_producer_expiry, NULL);
+            k_timer_user_data_set(&isr_timers[i], p);
+            k_timer_start(&isr_timers[i], ISR_PERIOD, ISR_PERIOD);
+        }
+    }
+
+    LOG_INF("Load: %u+%u producers at %u Hz, %u subscribers", config.producers,
+            config.isr_producers, config.rate_hz, config.subscribers);
+    return 0;
+}
+
+// Waits until every subscriber queue is empty and stays empty.
+static void drain_subscribers(void)
+{
+    for (int waited = 0; waited < DRAIN_TIMEOUT_MS; waited++) {
+        uint32_t used = 0;
+
+        for (int i = 0; i < config.subscribers; i++) {
+            used += k_msgq_num_used_get(&subscribers[i].msgq);
+        }
+        if (used == 0 && waited > 0) {
+            return;
+        }
+        k_msleep(1);
+    }
+    LOG_WRN("Load subscribers still busy after %d ms", DRAIN_TIMEOUT_MS);
+}
+
+int load_gen_stop(load_gen_report_t *report)
+{
+    const int total = config.producers + config.isr_producers;
+    uint32_t failed = 0;
+
+    if (!atomic_cas(&running, 1, 0)) {
+        return -EALREADY;
+    }
+
+    const uint64_t elapsed_ns = now_ns() - start_ns;
+
+    for (int i = 0; i < total; i++) {
+        if (i < config.producers) {
+            k_wakeup(&producer_threads[i]);
+            k_thread_join(&producer_threads[i], K_FOREVER);
+        } else {
+            k_timer_stop(&isr_timers[i]);
+        }
+    }
+    drain_subscribers();
+
+    if (!report) {
+        return 0;
+    }
+    memset(report, 0, sizeof(*report));
+    report->elapsed_ms = MAX(elapsed_ns / NSEC_PER_MSEC, 1);
+    report->requested_hz = config.rate_hz * total;
+    if (config.shape == LOAD_GEN_ON_OFF) {
+        report->requested_hz = (uint64_t)report->requested_hz * config.on_ms /
+                               (config.on_ms + config.off_ms);
+    }
+    for (int i = 0; i < total; i++) {
+        report->posted += producers[i].posted;
+        failed += producers[i].failed;
+        report->behind += producers[i].behind;
+    }
+    report->failed = failed;
+    report->achieved_hz = (uint64_t)report->posted * MSEC_PER_SEC / report->elapsed_ms;
+
+    report->subscribers = config.subscribers;
+    for (int i = 0; i < config.subscribers; i++) {
+        subscriber_t *s = &subscribers[i];
+        load_gen_subscriber_report_t *out = &report->subscriber[i];
+
+        out->received = atomic_get(&s->received);
+#if defined(CONFIG_EVENT_BUS_USE_CALLBACK)
+        // The sink counts its own drops.
+        event_bus_sink_stats_t now;
+
+        event_bus_get_sink_stats(&s->msgq, &now);
+        out->dropped = now.dropped - s->start.dropped;
+#elif defined(CONFIG_EVENT_BUS_DIRECT_DISPATCH)
+        // A failed post still reached the subscribers that had room.
+        out->dropped = report->posted - out->received;
+#else
+        // A failed post never left the central queue.
+        out->dropped = report->posted - failed - out->received;
+#endif
+    }
+    return 0;
+}
+
+int load_gen_run(const load_gen_config_t *cfg, uint32_t duration_ms, load_gen_report_t *report)
+{
+    const int ret = load_gen_start(cfg);
+
+    if (ret != 0) {
+        return ret;
+    }
+    k_msleep(duration_ms);
+    return load_gen_stop(report);
+}
+
+void load_gen_log_report(const load_gen_report_t *report)
+{
+    LOG_INF("Load: requested %u/s, achieved %u/s over %u ms (%u posts, %u failed, %u backlogs dropped)",
+            report->requested_hz, report->achieved_hz, report->elapsed_ms, report->posted,
+            report->failed, report->behind);
+    for (int i = 0; i < report->subscribers; i++) {
+        LOG_INF("  subscriber %d: %u received, %u dropped", i, report->subscriber[i].received,
+                report->subscriber[i].dropped);
+    }
+}
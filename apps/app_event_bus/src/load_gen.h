@@ -0,0 +1,93 @@
+#pragma once
+
+#include <zephyr/kernel.h>
+#include <stdint.h>
+#include "event_bus.h"
+
+/**
+ * @file load_gen.h
+ * @brief Synthetic load for finding where the event bus saturates.
+ *
+ * Producer threads, and optionally k_timer expiry functions in ISR
+ * context, post events at a configured rate and burst shape. A fixed set
+ * of subscriber threads, each with its own queue and a configurable cost
+ * per event, receive them. The report compares the rate achieved with
+ * the rate requested and counts what each subscriber lost.
+ */
+
+#define LOAD_GEN_MAX_PRODUCERS 8
+#define LOAD_GEN_MAX_SUBSCRIBERS 4
+// Messages in each subscriber's queue
+#define LOAD_GEN_QUEUE_DEPTH 16
+
+typedef enum {
+    LOAD_GEN_CONSTANT,      // Evenly spaced
+    LOAD_GEN_POISSON,       // Exponential gaps with the same mean
+    LOAD_GEN_ON_OFF,        // Constant during on_ms, silent during off_ms
+} load_gen_shape_t;
+
+/**
+ * @brief The events the generator posts. The subscribers take all of them,
+ * the mix only changes how often each is posted.
+ */
+typedef enum {
+    LOAD_GEN_MOTOR_SPEED,   // EVENT_MOTOR_SPEED_REPORT
+    LOAD_GEN_HEATER_TEMP,   // EVENT_HEATER_TEMP_CHANGED
+    LOAD_GEN_WATER_LEVEL,   // EVENT_WATER_LEVEL_CHANGED
+    LOAD_GEN_WEIGHT,        // EVENT_WEIGHT_CALCULATED
+    LOAD_GEN_KINDS
+} load_gen_kind_t;
+
+typedef struct {
+    uint8_t producers;          // Producer threads
+    uint8_t isr_producers;      // Producers run from a k_timer, in ISR context
+    uint32_t rate_hz;           // Events per second per producer, while on
+    load_gen_shape_t shape;
+    uint16_t on_ms;             // LOAD_GEN_ON_OFF only
+    uint16_t off_ms;
+    uint8_t mix[LOAD_GEN_KINDS];    // Relative weight of each event, all 0 for equal
+    uint8_t subscribers;
+    // Busy time each subscriber spends on one event, to model slow consumers
+    uint16_t consume_us[LOAD_GEN_MAX_SUBSCRIBERS];
+} load_gen_config_t;
+
+typedef struct {
+    uint32_t received;
+    uint32_t dropped;           // Events the bus took that never reached it
+} load_gen_subscriber_report_t;
+
+typedef struct {
+    uint32_t elapsed_ms;
+    uint32_t requested_hz;      // All producers, averaged over the on/off cycle
+    uint32_t achieved_hz;       // Posts made, whatever the bus answered
+    uint32_t posted;
+    uint32_t failed;            // event_bus_post() returned an error
+    uint32_t behind;            // Times a producer gave up catching up
+    uint8_t subscribers;
+    load_gen_subscriber_report_t subscriber[LOAD_GEN_MAX_SUBSCRIBERS];
+} load_gen_report_t;
+
+/**
+ * @brief Starts the producers. The first call also starts and subscribes
+ * the subscriber threads; the bus must be initialized.
+ *
+ * @return 0 on success, -EBUSY if already running, -EINVAL for a bad
+ *         configuration, or the error of the subscription.
+ */
+int load_gen_start(const load_gen_config_t *config);
+
+/**
+ * @brief Stops the producers, lets the subscribers empty their queues and
+ * fills @p report.
+ *
+ * @return 0 on success, -EALREADY if not running.
+ */
+int load_gen_stop(load_gen_report_t *report);
+
+/**
+ * @brief Runs @p config for @p duration_ms and fills @p report.
+ */
+int load_gen_run(const load_gen_config_t *config, uint32_t duration_ms,
+                 load_gen_report_t *report);
+
+void load_gen_log_report(const load_gen_report_t *report);
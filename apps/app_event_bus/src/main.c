@@ -1,9 +1,66 @@
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
 #include "event_bus.h"
+#include "load_gen.h"
 
 LOG_MODULE_REGISTER(main, CONFIG_LOG_DEFAULT_LEVEL);
 
+#if defined(CONFIG_APP_LOAD_GEN)
+// Total rate at which the sweep stops even if the bus keeps up
+#define SWEEP_MAX_HZ 1000000
+
+#if defined(CONFIG_EVENT_BUS_USE_CALLBACK)
+#define BUS_MODE "callback"
+#elif defined(CONFIG_EVENT_BUS_DIRECT_DISPATCH)
+#define BUS_MODE "polling, direct dispatch"
+#else
+#define BUS_MODE "polling"
+#endif
+
+// Doubles the rate until the bus falls behind or a subscriber loses events.
+static void load_sweep(void)
+{
+    load_gen_config_t config = {
+        .producers = 2,
+        .isr_producers = 1,
+        .rate_hz = 500,
+        .shape = LOAD_GEN_POISSON,
+        .mix = {
+            [LOAD_GEN_MOTOR_SPEED] = 4,
+            [LOAD_GEN_HEATER_TEMP] = 2,
+            [LOAD_GEN_WATER_LEVEL] = 1,
+            [LOAD_GEN_WEIGHT] = 1,
+        },
+        .subscribers = 2,
+        // One fast subscriber, one that does a little work per event
+        .consume_us = { 0, 20 },
+    };
+    load_gen_report_t report;
+
+    LOG_INF("Load sweep, %s bus, %u ms per step", BUS_MODE, CONFIG_APP_LOAD_GEN_STEP_MS);
+    while (config.rate_hz * (config.producers + config.isr_producers) <= SWEEP_MAX_HZ) {
+        if (load_gen_run(&config, CONFIG_APP_LOAD_GEN_STEP_MS, &report) != 0) {
+            LOG_ERR("Load generator failed to start");
+            return;
+        }
+        load_gen_log_report(&report);
+
+        bool lost = report.failed > 0;
+
+        for (int i = 0; i < report.subscribers; i++) {
+            lost |= report.subscriber[i].dropped > 0;
+        }
+        if (lost || report.achieved_hz < report.requested_hz * 95 / 100) {
+            LOG_INF("Saturated at %u events/s requested (%s bus)", report.requested_hz,
+                    BUS_MODE);
+            return;
+        }
+        config.rate_hz *= 2;
+    }
+    LOG_INF("No saturation up to %u events/s (%s bus)", SWEEP_MAX_HZ, BUS_MODE);
+}
+#endif // CONFIG_APP_LOAD_GEN
+
 int main(void)
 {
     LOG_INF("--- Event Bus Test Application ---");
@@ -15,5 +72,9 @@ int main(void)
     }
 
     LOG_INF("Event bus initialized. Test is running...");
+
+#if defined(CONFIG_APP_LOAD_GEN)
+    load_sweep();
+#endif
     return 0;
 }
\ No newline at end of file
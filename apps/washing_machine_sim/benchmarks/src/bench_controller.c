@@ -0,0 +1,329 @@
+#include <zephyr/ztest.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include "event_bus.h"
+#include "timer_wheel.h"
+#include "controller_thread.h"
+#include "sim_plant.h"
+
+LOG_MODULE_REGISTER(bench_controller, LOG_LEVEL_INF);
+
+#define BENCH_CYCLES 2000
+#define LATENCY_SAMPLES 1000
+// Simulated seconds each drum phase of the plant run lasts
+#define PLANT_TUMBLE_S 60
+#define PLANT_SPIN_S 60
+
+// Payloads that route a latency sample through the queue sink or, on a
+// callback bus, through a work item as the controller used to.
+#define SINK_PAYLOAD 0
+#define CALLBACK_HOP_PAYLOAD 1
+
+// One Normal cycle from Selection back to Selection, with events the
+// machine ignores mixed in. Fits the controller queue in one burst.
+static const event_id_t cycle_events[] = {
+    EVENT_START_BUTTON_PRESSED,
+    EVENT_POWER_RESTORED,
+    EVENT_WEIGHT_CALCULATED,
+    EVENT_DOSING_COMPLETE,
+    EVENT_TEMP_REACHED,
+    EVENT_WATER_LEVEL_REACHED,
+    EVENT_TIMER_EXPIRED,
+    EVENT_DRUM_EMPTY,
+    EVENT_CYCLE_SELECTED,
+    EVENT_TIMER_EXPIRED,
+    EVENT_DRUM_EMPTY,
+    EVENT_TIMER_EXPIRED,
+    EVENT_ANY_KEY_PRESSED,
+};
+
+BUILD_ASSERT(ARRAY_SIZE(cycle_events) <= 16, "A cycle must fit the controller queue");
+
+#if defined(CONFIG_EVENT_BUS_USE_CALLBACK)
+// The bus callback the controller had before its queue sink
+static void callback_hop(const app_event_t *event)
+{
+    if (k_msgq_put(&fsm_msgq, event, K_NO_WAIT) != 0) {
+        LOG_WRN("Failed to enqueue event for FSM thread, queue may be full.");
+    }
+}
+
+// Both routes into fsm_msgq side by side, told apart by the payload.
+static void bench_subscribe(void)
+{
+    const event_filter_t sink_only = {
+        .type = EVENT_FILTER_RANGE,
+        .range = { .min = SINK_PAYLOAD, .max = SINK_PAYLOAD },
+    };
+    const event_filter_t hop_only = {
+        .type = EVENT_FILTER_RANGE,
+        .range = { .min = CALLBACK_HOP_PAYLOAD, .max = CALLBACK_HOP_PAYLOAD },
+    };
+    const event_id_t *events;
+    const size_t num_events = controller_get_subscribed_events(&events);
+
+    zassert_ok(event_bus_register_queue_sink(&fsm_msgq, events, num_events, &sink_only));
+    zassert_ok(event_bus_register_handler_filtered(callback_hop, events, num_events, &hop_only));
+}
+#else
+static void bench_subscribe(void)
+{
+    zassert_ok(controller_subscribe());
+}
+#endif // CONFIG_EVENT_BUS_USE_CALLBACK
+
+// The plant's samples, for a consumer that sees every one. The threshold
+// events go to the controller.
+static const event_id_t sensor_events[] = {
+    EVENT_WATER_LEVEL_CHANGED,
+    EVENT_HEATER_TEMP_CHANGED,
+    EVENT_MOTOR_SPEED_REPORT,
+};
+
+K_MSGQ_DEFINE(sensor_msgq, sizeof(app_event_t), 2 * SIM_PLANT_MAX_EVENTS, 4);
+
+static void *bench_setup(void)
+{
+    zassert_ok(event_bus_init(), "event_bus_init() failed");
+    bench_subscribe();
+#if defined(CONFIG_EVENT_BUS_USE_CALLBACK)
+    zassert_ok(event_bus_register_queue_sink(&sensor_msgq, sensor_events,
+                                             ARRAY_SIZE(sensor_events), NULL));
+#else
+    zassert_not_null(event_bus_subscribe(&sensor_msgq, sensor_events,
+                                         ARRAY_SIZE(sensor_events)));
+#endif
+    zassert_ok(timer_wheel_init());
+    return NULL;
+}
+
+static void bench_before(void *data)
+{
+    const app_event_t select[] = {
+        { .id = EVENT_POWER_BUTTON_PRESSED },
+        { .id = EVENT_CYCLE_SELECTED, .payload.u32 = 0 },
+    };
+
+    ARG_UNUSED(data);
+
+    controller_start();
+    for (int i = 0; i < ARRAY_SIZE(select); i++) {
+        controller_handle_event(&select[i]);
+    }
+    zassert_equal(controller_fsm_get_handle()->system_state, STATE_L1_SELECTION);
+}
+
+static void post_cycle(bool log_each)
+{
+    for (int i = 0; i < ARRAY_SIZE(cycle_events); i++) {
+        const app_event_t event = { .id = cycle_events[i] };
+
+        if (log_each) {
+            // What the bus callback used to log for every event
+            LOG_INF("FSM Controller thread callback received event ID: %d", event.id);
+        }
+        zassert_ok(event_bus_post(&event));
+    }
+}
+
+static void report(const char *name, uint64_t cycles)
+{
+    const uint32_t events = BENCH_CYCLES * ARRAY_SIZE(cycle_events);
+    const uint64_t ns = k_cyc_to_ns_floor64(cycles);
+
+    TC_PRINT("%s, %u events\n", name, events);
+    TC_PRINT("  ns/event:  %u\n", (uint32_t)(ns / events));
+    TC_PRINT("  events/s:  %u\n", (uint32_t)(ns ? events * 1000000000ULL / ns : 0));
+}
+
+/**
+ * @brief The controller loop as it was: one k_msgq_get() and two log
+ * calls per event.
+ */
+ZTEST(controller_bench_suite, test_one_event_at_a_time)
+{
+    app_event_t event;
+    const uint64_t start = k_cycle_get_64();
+
+    for (int c = 0; c < BENCH_CYCLES; c++) {
+        post_cycle(true);
+        while (k_msgq_get(&fsm_msgq, &event, K_NO_WAIT) == 0) {
+            LOG_INF("Controller thread processing event ID: %d", event.id);
+            controller_handle_event(&event);
+        }
+    }
+    report("one event at a time", k_cycle_get_64() - start);
+    zassert_equal(controller_fsm_get_handle()->system_state, STATE_L1_SELECTION);
+}
+
+/**
+ * @brief controller_drain(): the queue in one pass, one summary per batch.
+ */
+ZTEST(controller_bench_suite, test_batched)
+{
+    controller_stats_t before;
+    controller_stats_t after;
+
+    controller_get_stats(&before);
+
+    const uint64_t start = k_cycle_get_64();
+
+    for (int c = 0; c < BENCH_CYCLES; c++) {
+        post_cycle(false);
+        while (controller_drain(K_NO_WAIT) > 0) {
+        }
+    }
+    report("batched", k_cycle_get_64() - start);
+
+    controller_get_stats(&after);
+    zassert_equal(after.events - before.events, BENCH_CYCLES * ARRAY_SIZE(cycle_events));
+    zassert_equal(controller_fsm_get_handle()->system_state, STATE_L1_SELECTION);
+    TC_PRINT("  batches:   %u, up to %u events\n", after.batches - before.batches,
+             after.max_batch);
+}
+
+// Posts one event at a time and lets controller_drain() wait for it,
+// reporting the mean time from event_bus_post() to the FSM.
+static void measure_latency(const char *name, uint32_t payload)
+{
+    // Ignored outside a brownout, so the machine stays in Selection
+    const app_event_t event = { .id = EVENT_POWER_RESTORED, .payload.u32 = payload };
+    controller_stats_t before;
+    controller_stats_t after;
+
+    controller_get_stats(&before);
+    for (int i = 0; i < LATENCY_SAMPLES; i++) {
+        zassert_ok(event_bus_post(&event));
+        zassert_equal(controller_drain(K_MSEC(100)), 1, "Event did not reach the controller");
+    }
+    controller_get_stats(&after);
+    zassert_equal(after.dropped, before.dropped, "Events dropped");
+
+    const uint64_t cycles = after.latency_total_cycles - before.latency_total_cycles;
+
+    TC_PRINT("%s, %u events\n", name, LATENCY_SAMPLES);
+    TC_PRINT("  post to FSM, mean ns: %u\n",
+             (uint32_t)k_cyc_to_ns_floor64(cycles / LATENCY_SAMPLES));
+}
+
+/**
+ * @brief Latency through the route controller_subscribe() takes: the
+ * queue sink, filled from the post on a callback bus and by the fan-out
+ * on a polling bus.
+ */
+ZTEST(controller_bench_suite, test_latency_direct)
+{
+    measure_latency("bus straight into the controller queue", SINK_PAYLOAD);
+}
+
+/**
+ * @brief Latency through a callback work item that forwards the event
+ * into the controller queue, as before the queue sink.
+ */
+ZTEST(controller_bench_suite, test_latency_callback_hop)
+{
+#if defined(CONFIG_EVENT_BUS_USE_CALLBACK)
+    measure_latency("bus callback forwarding to the controller queue", CALLBACK_HOP_PAYLOAD);
+#else
+    ztest_test_skip();
+#endif
+}
+
+typedef struct {
+    uint64_t steps;
+    uint32_t posted;
+    uint32_t samples;       // Posted events the sensor consumer subscribed to
+    uint32_t received;
+} plant_run_t;
+
+// One plant step with its events through the bus to the sensor consumer
+// and the controller. Returns true once @p until has been posted.
+static bool plant_step(sim_plant_t *plant, plant_run_t *run, event_id_t until)
+{
+    app_event_t events[SIM_PLANT_MAX_EVENTS];
+    app_event_t sample;
+    const size_t count = sim_plant_step(plant, events, ARRAY_SIZE(events));
+    bool done = false;
+
+    for (size_t i = 0; i < count; i++) {
+        event_bus_post(&events[i]);
+        done |= events[i].id == until;
+        run->samples += events[i].id == EVENT_WATER_LEVEL_CHANGED ||
+                        events[i].id == EVENT_HEATER_TEMP_CHANGED ||
+                        events[i].id == EVENT_MOTOR_SPEED_REPORT;
+    }
+    while (k_msgq_get(&sensor_msgq, &sample, K_NO_WAIT) == 0) {
+        run->received++;
+    }
+    controller_drain(K_NO_WAIT);
+    run->posted += count;
+    run->steps++;
+    return done;
+}
+
+static void plant_run_until(sim_plant_t *plant, plant_run_t *run, event_id_t until)
+{
+    while (!plant_step(plant, run, until)) {
+    }
+}
+
+static void plant_run_for(sim_plant_t *plant, plant_run_t *run, uint32_t seconds)
+{
+    for (uint32_t n = 0; n < seconds * plant->params.rate_hz; n++) {
+        plant_step(plant, run, EVENT_ID_COUNT);
+    }
+}
+
+static void plant_command(sim_plant_t *plant, event_id_t id, int32_t value)
+{
+    const app_event_t event = { .id = id, .payload.s32 = value };
+
+    sim_plant_command(plant, &event);
+}
+
+/**
+ * @brief The physics plant at its highest rate through one wash: fill,
+ * heat, tumble, drain and spin, every sensor report posted on the bus.
+ */
+ZTEST(controller_bench_suite, test_plant_sensor_stream)
+{
+    sim_plant_params_t params;
+    sim_plant_t plant;
+    plant_run_t run = { 0 };
+
+    sim_plant_get_default_params(&params);
+    params.rate_hz = SIM_PLANT_MAX_RATE_HZ;
+    // A speed sensor reporting every rpm, for a denser stream
+    params.rpm_report = 1;
+    zassert_ok(sim_plant_init(&plant, &params));
+
+    const uint64_t start = k_cycle_get_64();
+
+    sim_plant_set_water(&plant, SIM_PLANT_WATER_FILL);
+    plant_run_until(&plant, &run, EVENT_WATER_LEVEL_REACHED);
+    sim_plant_set_water(&plant, SIM_PLANT_WATER_HOLD);
+    plant_command(&plant, COMMAND_HEATER_SET_TEMP, 40);
+    plant_run_until(&plant, &run, EVENT_TEMP_REACHED);
+    plant_command(&plant, COMMAND_HEATER_SET_TEMP, 0);
+    plant_command(&plant, COMMAND_MOTOR_SET_SPEED, 50);
+    plant_run_for(&plant, &run, PLANT_TUMBLE_S);
+    plant_command(&plant, COMMAND_MOTOR_SET_SPEED, 0);
+    sim_plant_set_water(&plant, SIM_PLANT_WATER_DRAIN);
+    plant_run_until(&plant, &run, EVENT_DRUM_EMPTY);
+    plant_command(&plant, COMMAND_MOTOR_SET_SPEED, 1200);
+    plant_run_for(&plant, &run, PLANT_SPIN_S);
+    plant_command(&plant, COMMAND_MOTOR_SET_SPEED, 0);
+    plant_run_until(&plant, &run, EVENT_MOTOR_STOPPED);
+
+    const uint64_t ns = k_cyc_to_ns_floor64(k_cycle_get_64() - start);
+
+    zassert_equal(run.received, run.samples, "Sensor samples lost");
+    TC_PRINT("plant at %u Hz, %u simulated s, %u events\n", params.rate_hz,
+             (uint32_t)(run.steps / params.rate_hz), run.posted);
+    TC_PRINT("  ns/step:   %u\n", (uint32_t)(ns / run.steps));
+    TC_PRINT("  events/s:  %u\n", (uint32_t)(ns ? run.posted * 1000000000ULL / ns : 0));
+    TC_PRINT("  simulated s per s: %u\n",
+             (uint32_t)(ns ? run.steps * 1000000000ULL / params.rate_hz / ns : 0));
+}
+
+ZTEST_SUITE(controller_bench_suite, NULL, bench_setup, bench_before, NULL, NULL);
@@ -0,0 +1,48 @@
+#include <zephyr/ztest.h>
+#include <zephyr/kernel.h>
+#include <zephyr/storage/flash_map.h>
+#include "fsm_checkpoint.h"
+
+#define CHECKPOINT_PARTITION FIXED_PARTITION_ID(storage_partition)
+#define BENCH_SAVES 2000
+
+/**
+ * @brief Checkpoint save latency, average and worst case.
+ *
+ * The worst case is what has to fit in the brownout hold-up window. Saves
+ * cross several sector switches, so it includes them.
+ */
+ZTEST(fsm_checkpoint_bench_suite, test_checkpoint_latency)
+{
+    const struct flash_area *fa;
+    fsm_checkpoint_stats_t stats;
+    uint64_t total_us = 0;
+    fsm_snapshot_t snapshot = {
+        .fsm = {
+            .system_state = STATE_L1_BROWNOUT,
+            .wash_cycle_state = STATE_L2_WASHING,
+            .program_has_heating = true,
+        },
+        .timer_remaining_ms = 600000,
+    };
+
+    zassert_ok(flash_area_open(CHECKPOINT_PARTITION, &fa));
+    zassert_ok(flash_area_erase(fa, 0, fa->fa_size));
+    flash_area_close(fa);
+    zassert_ok(fsm_checkpoint_init(CHECKPOINT_PARTITION));
+
+    for (int i = 0; i < BENCH_SAVES; i++) {
+        snapshot.phase_elapsed_ms = i;
+        zassert_ok(fsm_checkpoint_save(&snapshot));
+        fsm_checkpoint_get_stats(&stats);
+        total_us += stats.last_save_us;
+        // Leave the background erase its chance, as real saves are sparse.
+        k_yield();
+    }
+
+    TC_PRINT("Checkpoint save, %u saves, %u sector switches\n", stats.saves, stats.slot_switches);
+    TC_PRINT("  average:     %u us\n", (uint32_t)(total_us / BENCH_SAVES));
+    TC_PRINT("  worst case:  %u us\n", stats.max_save_us);
+}
+
+ZTEST_SUITE(fsm_checkpoint_bench_suite, NULL, NULL, NULL, NULL, NULL);
@@ -0,0 +1,270 @@
+#include <zephyr/ztest.h>
+#include <zephyr/kernel.h>
+#include "fsm.h"
+#include "l1_system_fsm.h"
+#include "l2_wash_cycle_fsm.h"
+
+#define BENCH_CYCLES 10000
+
+// --- Reference implementation ---
+// The nested switch dispatch the table-driven engine replaced, kept as
+// the baseline for both speed and behaviour. It only gained the L2 resets
+// on END -> SELECTION and FAILURE -> STANDBY the model has since.
+
+static bool legacy_l1_override(fsm_handle_t *fsm, event_id_t event)
+{
+    if (fsm->system_state != STATE_L1_RUNNING) {
+        return false;
+    }
+
+    switch (event) {
+        case EVENT_PAUSE_BUTTON_PRESSED:
+            fsm->system_state = STATE_L1_PAUSED;
+            return true;
+        case EVENT_POWER_LOSS_DETECTED:
+            fsm->system_state = STATE_L1_BROWNOUT;
+            return true;
+        case EVENT_FATAL_FAULT_DETECTED:
+            fsm->system_state = STATE_L1_FAILURE;
+            return true;
+        default:
+            return false;
+    }
+}
+
+static void legacy_l1_process_event(fsm_handle_t *fsm, event_id_t event)
+{
+    switch (fsm->system_state) {
+        case STATE_L1_POWER_OFF:
+            if (event == EVENT_POWER_BUTTON_PRESSED) {
+                fsm->system_state = STATE_L1_STANDBY;
+            }
+            break;
+        case STATE_L1_STANDBY:
+            if (event == EVENT_CYCLE_SELECTED) {
+                fsm->system_state = STATE_L1_SELECTION;
+            } else if (event == EVENT_POWER_BUTTON_PRESSED) {
+                fsm->system_state = STATE_L1_POWER_OFF;
+            }
+            break;
+        case STATE_L1_SELECTION:
+            if (event == EVENT_START_BUTTON_PRESSED) {
+                fsm->system_state = STATE_L1_RUNNING;
+                l2_fsm_start(fsm);
+            } else if (event == EVENT_POWER_BUTTON_PRESSED) {
+                fsm->system_state = STATE_L1_POWER_OFF;
+            }
+            break;
+        case STATE_L1_RUNNING:
+            if (event == EVENT_CYCLE_FINISHED) {
+                fsm->system_state = STATE_L1_END;
+            }
+            break;
+        case STATE_L1_PAUSED:
+            if (event == EVENT_START_BUTTON_PRESSED) {
+                fsm->system_state = STATE_L1_RUNNING;
+            } else if (event == EVENT_CANCEL_BUTTON_PRESSED) {
+                fsm->system_state = STATE_L1_SELECTION;
+                l2_fsm_init(fsm);
+            }
+            break;
+        case STATE_L1_END:
+            if (event == EVENT_ANY_KEY_PRESSED) {
+                fsm->system_state = STATE_L1_SELECTION;
+                l2_fsm_init(fsm);
+            }
+            break;
+        case STATE_L1_BROWNOUT:
+            if (event == EVENT_POWER_RESTORED) {
+                fsm->system_state = STATE_L1_RUNNING;
+            }
+            break;
+        case STATE_L1_FAILURE:
+            if (event == EVENT_POWER_BUTTON_PRESSED) {
+                fsm->system_state = STATE_L1_STANDBY;
+                l2_fsm_init(fsm);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+static void legacy_l2_process_event(fsm_handle_t *fsm, event_id_t event)
+{
+    switch (fsm->wash_cycle_state) {
+        case STATE_L2_LOAD_SENSING:
+            if (event == EVENT_WEIGHT_CALCULATED) fsm->wash_cycle_state = STATE_L2_DOSING;
+            break;
+        case STATE_L2_DOSING:
+            if (event == EVENT_DOSING_COMPLETE) fsm->wash_cycle_state = STATE_L2_PREWASH_CHECK;
+            break;
+        case STATE_L2_PREWASH_CHECK:
+            fsm->wash_cycle_state = fsm->program_has_prewash ? STATE_L2_PREWASH : STATE_L2_FILLING;
+            break;
+        case STATE_L2_PREWASH:
+            if (event == EVENT_TIMER_EXPIRED) fsm->wash_cycle_state = STATE_L2_DRAINING_PRE;
+            break;
+        case STATE_L2_DRAINING_PRE:
+            if (event == EVENT_DRUM_EMPTY) fsm->wash_cycle_state = STATE_L2_FILLING;
+            break;
+        case STATE_L2_FILLING:
+            if (event == EVENT_WATER_LEVEL_REACHED) fsm->wash_cycle_state = STATE_L2_HEATING_CHECK;
+            break;
+        case STATE_L2_HEATING_CHECK:
+            fsm->wash_cycle_state = fsm->program_has_heating ? STATE_L2_HEATING : STATE_L2_WASHING;
+            break;
+        case STATE_L2_HEATING:
+            if (event == EVENT_TEMP_REACHED) fsm->wash_cycle_state = STATE_L2_WASHING;
+            break;
+        case STATE_L2_WASHING:
+            if (event == EVENT_TIMER_EXPIRED) fsm->wash_cycle_state = STATE_L2_DRAINING_WASH;
+            break;
+        case STATE_L2_DRAINING_WASH:
+            if (event == EVENT_DRUM_EMPTY) fsm->wash_cycle_state = STATE_L2_RINSING;
+            break;
+        case STATE_L2_RINSING:
+            if (event == EVENT_TIMER_EXPIRED) fsm->wash_cycle_state = STATE_L2_DRAINING_RINSE;
+            break;
+        case STATE_L2_DRAINING_RINSE:
+            if (event == EVENT_DRUM_EMPTY) fsm->wash_cycle_state = STATE_L2_SPINNING;
+            break;
+        case STATE_L2_SPINNING:
+            if (event == EVENT_TIMER_EXPIRED) fsm->wash_cycle_state = STATE_L2_STEAM_CHECK;
+            break;
+        case STATE_L2_STEAM_CHECK:
+            fsm->wash_cycle_state = fsm->program_has_steam ? STATE_L2_STEAMING : STATE_L2_COMPLETE;
+            break;
+        case STATE_L2_STEAMING:
+            if (event == EVENT_TIMER_EXPIRED) fsm->wash_cycle_state = STATE_L2_COMPLETE;
+            break;
+        default:
+            break;
+    }
+}
+
+// --- Dispatch without logging, one implementation at a time ---
+
+typedef struct {
+    bool (*override)(fsm_handle_t *fsm, event_id_t event);
+    void (*l1)(fsm_handle_t *fsm, event_id_t event);
+    void (*l2)(fsm_handle_t *fsm, event_id_t event);
+} fsm_impl_t;
+
+static const fsm_impl_t table_impl = {
+    l1_system_process_override_events, l1_system_process_event, l2_wash_cycle_process_event,
+};
+
+static const fsm_impl_t switch_impl = {
+    legacy_l1_override, legacy_l1_process_event, legacy_l2_process_event,
+};
+
+static inline void dispatch(const fsm_impl_t *impl, fsm_handle_t *fsm, event_id_t event)
+{
+    if (impl->override(fsm, event)) {
+        return;
+    }
+    if (fsm->system_state == STATE_L1_RUNNING) {
+        impl->l2(fsm, event);
+        if (fsm->wash_cycle_state == STATE_L2_COMPLETE) {
+            impl->l1(fsm, EVENT_CYCLE_FINISHED);
+        }
+    } else {
+        impl->l1(fsm, event);
+    }
+}
+
+// One full programme with every option, from SELECTION back to SELECTION,
+// with a few events that the current state ignores mixed in.
+static const event_id_t cycle_events[] = {
+    EVENT_START_BUTTON_PRESSED,
+    EVENT_DOOR_OPENED,
+    EVENT_WEIGHT_CALCULATED,
+    EVENT_DOSING_COMPLETE,
+    EVENT_UNKNOWN,              // Pre-wash check
+    EVENT_TIMER_EXPIRED,
+    EVENT_DRUM_EMPTY,
+    EVENT_WATER_LEVEL_CHANGED,
+    EVENT_WATER_LEVEL_REACHED,
+    EVENT_UNKNOWN,              // Heating check
+    EVENT_HEATER_TEMP_CHANGED,
+    EVENT_TEMP_REACHED,
+    EVENT_TIMER_EXPIRED,
+    EVENT_DRUM_EMPTY,
+    EVENT_TIMER_EXPIRED,
+    EVENT_DRUM_EMPTY,
+    EVENT_MOTOR_SPEED_REPORT,
+    EVENT_TIMER_EXPIRED,
+    EVENT_UNKNOWN,              // Steam check
+    EVENT_TIMER_EXPIRED,
+    EVENT_ANY_KEY_PRESSED,
+};
+
+static void run_cycles(const fsm_impl_t *impl, const char *name)
+{
+    fsm_handle_t fsm;
+    const uint32_t events = BENCH_CYCLES * ARRAY_SIZE(cycle_events);
+
+    fsm_init(&fsm);
+    fsm.system_state = STATE_L1_SELECTION;
+    fsm.program_has_prewash = true;
+    fsm.program_has_heating = true;
+    fsm.program_has_steam = true;
+
+    uint32_t start = k_cycle_get_32();
+    for (int c = 0; c < BENCH_CYCLES; c++) {
+        for (int i = 0; i < ARRAY_SIZE(cycle_events); i++) {
+            dispatch(impl, &fsm, cycle_events[i]);
+        }
+    }
+    uint32_t cycles = k_cycle_get_32() - start;
+    uint64_t ns = k_cyc_to_ns_floor64(cycles);
+
+    zassert_equal(fsm.system_state, STATE_L1_SELECTION, "%s: cycle did not complete", name);
+    TC_PRINT("%s dispatch, %u events\n", name, events);
+    TC_PRINT("  cycles/event:  %u\n", cycles / events);
+    TC_PRINT("  ns/event:      %u\n", (uint32_t)(ns / events));
+    TC_PRINT("  events/s:      %u\n", (uint32_t)(ns ? events * 1000000000ULL / ns : 0));
+}
+
+/**
+ * @brief Transitions per second, table-driven engine against switches.
+ */
+ZTEST(fsm_bench_suite, test_dispatch_throughput)
+{
+    run_cycles(&switch_impl, "switch");
+    run_cycles(&table_impl, "table");
+}
+
+/**
+ * @brief Every state x event x programme combination behaves the same
+ * in both implementations.
+ */
+ZTEST(fsm_bench_suite, test_table_matches_switch)
+{
+    for (int flags = 0; flags < 8; flags++) {
+        for (int l1 = 0; l1 < STATE_L1_COUNT; l1++) {
+            for (int l2 = 0; l2 < STATE_L2_COUNT; l2++) {
+                for (int event = 0; event < EVENT_ID_COUNT; event++) {
+                    fsm_handle_t expected = {
+                        .system_state = l1,
+                        .wash_cycle_state = l2,
+                        .program_has_prewash = flags & 1,
+                        .program_has_heating = flags & 2,
+                        .program_has_steam = flags & 4,
+                    };
+                    fsm_handle_t actual = expected;
+
+                    dispatch(&switch_impl, &expected, event);
+                    dispatch(&table_impl, &actual, event);
+                    zassert_equal(actual.system_state, expected.system_state,
+                                  "L1 mismatch: l1 %d l2 %d event %d", l1, l2, event);
+                    zassert_equal(actual.wash_cycle_state, expected.wash_cycle_state,
+                                  "L2 mismatch: l1 %d l2 %d event %d", l1, l2, event);
+                }
+            }
+        }
+    }
+}
+
+ZTEST_SUITE(fsm_bench_suite, NULL, NULL, NULL, NULL, NULL);
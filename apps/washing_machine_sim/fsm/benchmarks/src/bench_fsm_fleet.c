@@ -0,0 +1,123 @@
+#include <zephyr/ztest.h>
+#include <zephyr/kernel.h>
+#include "fsm.h"
+#include "fsm_fleet.h"
+
+#define BENCH_MAX_MACHINES 10000
+#define BENCH_EVENTS 2000000
+
+FSM_FLEET_DEFINE(bench_fleet, BENCH_MAX_MACHINES);
+
+// Baseline: one fsm_handle_t per machine, driven one event at a time
+static fsm_handle_t handles[BENCH_MAX_MACHINES];
+
+// One full programme per machine from SELECTION back to SELECTION, with
+// a few ignored events mixed in. Machines take turns, one event each.
+static const event_id_t cycle_events[] = {
+    EVENT_START_BUTTON_PRESSED,
+    EVENT_DOOR_OPENED,
+    EVENT_WEIGHT_CALCULATED,
+    EVENT_DOSING_COMPLETE,
+    EVENT_TIMER_EXPIRED,
+    EVENT_DRUM_EMPTY,
+    EVENT_WATER_LEVEL_CHANGED,
+    EVENT_WATER_LEVEL_REACHED,
+    EVENT_HEATER_TEMP_CHANGED,
+    EVENT_TEMP_REACHED,
+    EVENT_TIMER_EXPIRED,
+    EVENT_DRUM_EMPTY,
+    EVENT_TIMER_EXPIRED,
+    EVENT_DRUM_EMPTY,
+    EVENT_MOTOR_SPEED_REPORT,
+    EVENT_TIMER_EXPIRED,
+    EVENT_TIMER_EXPIRED,
+    EVENT_ANY_KEY_PRESSED,
+};
+
+static fsm_fleet_event_t stream[BENCH_MAX_MACHINES * ARRAY_SIZE(cycle_events)];
+
+// Brings every machine to SELECTION with a varied programme, and fills
+// the stream with one cycle of every machine.
+static size_t prepare(int machines)
+{
+    static const event_id_t to_selection[] = {
+        EVENT_POWER_BUTTON_PRESSED, EVENT_CYCLE_SELECTED,
+    };
+    size_t length = 0;
+
+    fsm_fleet_init(&bench_fleet);
+    for (int m = 0; m < machines; m++) {
+        bool prewash = m & 1, heating = m & 2, steam = m & 4;
+
+        fsm_fleet_set_program(&bench_fleet, m, prewash, heating, steam);
+        fsm_init(&handles[m]);
+        handles[m].program_has_prewash = prewash;
+        handles[m].program_has_heating = heating;
+        handles[m].program_has_steam = steam;
+    }
+
+    for (int i = 0; i < ARRAY_SIZE(to_selection); i++) {
+        for (int m = 0; m < machines; m++) {
+            stream[length++] = (fsm_fleet_event_t){ m, to_selection[i] };
+            fsm_apply_event(&handles[m], to_selection[i]);
+        }
+    }
+    fsm_fleet_process_batch(&bench_fleet, stream, length);
+
+    length = 0;
+    for (int i = 0; i < ARRAY_SIZE(cycle_events); i++) {
+        for (int m = 0; m < machines; m++) {
+            stream[length++] = (fsm_fleet_event_t){ m, cycle_events[i] };
+        }
+    }
+    return length;
+}
+
+static void report(const char *name, int machines, uint32_t events, uint32_t cycles)
+{
+    uint64_t ns = k_cyc_to_ns_floor64(cycles);
+
+    TC_PRINT("%-6s %5d machines: %4u ns/event, %9u transitions/s\n", name, machines,
+             (uint32_t)(ns / events), (uint32_t)(ns ? events * 1000000000ULL / ns : 0));
+}
+
+static void run_fleet(int machines)
+{
+    const size_t length = prepare(machines);
+    const int rounds = MAX(1, BENCH_EVENTS / (int)length);
+
+    // Scalar baseline, same stream
+    uint32_t start = k_cycle_get_32();
+    for (int r = 0; r < rounds; r++) {
+        for (size_t i = 0; i < length; i++) {
+            fsm_apply_event(&handles[stream[i].machine], stream[i].event);
+        }
+    }
+    report("scalar", machines, rounds * length, k_cycle_get_32() - start);
+
+    start = k_cycle_get_32();
+    for (int r = 0; r < rounds; r++) {
+        fsm_fleet_process_batch(&bench_fleet, stream, length);
+    }
+    report("fleet", machines, rounds * length, k_cycle_get_32() - start);
+
+    for (int m = 0; m < machines; m++) {
+        zassert_equal(fsm_fleet_get_system_state(&bench_fleet, m), STATE_L1_SELECTION,
+                      "machine %d did not complete its cycle", m);
+        zassert_equal(handles[m].system_state, STATE_L1_SELECTION,
+                      "machine %d did not complete its cycle", m);
+    }
+}
+
+/**
+ * @brief Machine transitions per second for fleets of 1, 100 and 10,000
+ * machines, batched against one scalar handle per machine.
+ */
+ZTEST(fsm_fleet_bench_suite, test_fleet_throughput)
+{
+    run_fleet(1);
+    run_fleet(100);
+    run_fleet(BENCH_MAX_MACHINES);
+}
+
+ZTEST_SUITE(fsm_fleet_bench_suite, NULL, NULL, NULL, NULL, NULL);
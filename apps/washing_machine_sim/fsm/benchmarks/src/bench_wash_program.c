@@ -0,0 +1,63 @@
+#include <zephyr/ztest.h>
+#include <zephyr/kernel.h>
+#include "fsm.h"
+#include "wash_program.h"
+
+#define BENCH_QUERIES 1000000
+
+// Baseline: the plan worked out again on every query.
+static uint32_t recompute_remaining_ms(const fsm_handle_t *fsm, uint32_t phase_done_ms)
+{
+    uint32_t remaining = 0;
+    const uint32_t phase_ms = wash_program_phase_ms(fsm, fsm->wash_cycle_state);
+
+    for (int state = fsm->wash_cycle_state + 1; state < STATE_L2_COUNT; state++) {
+        remaining += wash_program_phase_ms(fsm, state);
+    }
+    return remaining + (phase_done_ms < phase_ms ? phase_ms - phase_done_ms : 0);
+}
+
+/**
+ * @brief Cost of one remaining-time query, incremental estimate against
+ * recomputing the plan, early in an Intensive cycle where the most
+ * phases are left.
+ */
+ZTEST(wash_program_bench_suite, test_remaining_time_query)
+{
+    fsm_handle_t fsm;
+    wash_estimate_t estimate;
+    volatile uint32_t sink;
+
+    fsm_init(&fsm);
+    fsm_process_event(&fsm, EVENT_POWER_BUTTON_PRESSED);
+    fsm_process_event(&fsm, EVENT_CYCLE_SELECTED);
+    zassert_ok(wash_program_select(&fsm, WASH_PROGRAM_INTENSIVE));
+    fsm_process_event(&fsm, EVENT_START_BUTTON_PRESSED);
+    wash_estimate_init(&estimate, &fsm, 0, 0);
+
+    uint64_t start = k_cycle_get_64();
+    for (int i = 0; i < BENCH_QUERIES; i++) {
+        sink = wash_estimate_remaining_ms(&estimate, i);
+    }
+    const uint64_t incremental_ns = k_cyc_to_ns_floor64(k_cycle_get_64() - start);
+
+    start = k_cycle_get_64();
+    for (int i = 0; i < BENCH_QUERIES; i++) {
+        sink = recompute_remaining_ms(&fsm, i);
+    }
+    const uint64_t recompute_ns = k_cyc_to_ns_floor64(k_cycle_get_64() - start);
+
+    zassert_equal(wash_estimate_remaining_ms(&estimate, 1000), recompute_remaining_ms(&fsm, 1000),
+                  "The estimate and the baseline disagree");
+    ARG_UNUSED(sink);
+
+    // Tenths of a nanosecond
+    const uint32_t incremental = incremental_ns * 10 / BENCH_QUERIES;
+    const uint32_t recompute = recompute_ns * 10 / BENCH_QUERIES;
+
+    TC_PRINT("remaining-time query, %d queries\n", BENCH_QUERIES);
+    TC_PRINT("  incremental ns/query: %u.%u\n", incremental / 10, incremental % 10);
+    TC_PRINT("  recompute ns/query:   %u.%u\n", recompute / 10, recompute % 10);
+}
+
+ZTEST_SUITE(wash_program_bench_suite, NULL, NULL, NULL, NULL, NULL);
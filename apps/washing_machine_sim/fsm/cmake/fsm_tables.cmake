@@ -0,0 +1,34 @@
+# Generates the FSM state enums, name tables and transition tables from the
+# PlantUML models in fsm/model. Include this file, then call
+#
+#   fsm_generate_tables(<target>)
+#
+# to make <target> depend on the generated files and see their directory.
+
+set(FSM_DIR ${CMAKE_CURRENT_LIST_DIR}/..)
+set(FSM_EVENT_DEFS ${FSM_DIR}/../../../components/event_bus/include/event_defs.h)
+
+function(fsm_generate_tables target)
+  set(gen_dir ${CMAKE_CURRENT_BINARY_DIR}/fsm_generated)
+  set(generator ${FSM_DIR}/scripts/gen_fsm_tables.py)
+  set(outputs)
+
+  foreach(model l1_system l2_wash_cycle)
+    set(model_file ${FSM_DIR}/model/${model}.puml)
+    set(model_outputs ${gen_dir}/${model}_states.h ${gen_dir}/${model}_tables.inc)
+    add_custom_command(
+      OUTPUT ${model_outputs}
+      COMMAND ${PYTHON_EXECUTABLE} ${generator} ${model_file}
+              --out-dir ${gen_dir} --events ${FSM_EVENT_DEFS}
+      DEPENDS ${generator} ${model_file} ${FSM_EVENT_DEFS}
+      COMMENT "Generating FSM tables from ${model}.puml"
+    )
+    list(APPEND outputs ${model_outputs})
+  endforeach()
+
+  # A custom target lets targets defined in other directories depend on
+  # the generated files too.
+  add_custom_target(${target}_fsm_tables DEPENDS ${outputs})
+  add_dependencies(${target} ${target}_fsm_tables)
+  target_include_directories(${target} PRIVATE ${gen_dir})
+endfunction()
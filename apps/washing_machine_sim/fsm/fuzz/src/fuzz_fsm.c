@@ -0,0 +1,142 @@
+#include <zephyr/kernel.h>
+#include <zephyr/irq.h>
+#include "fsm.h"
+#include "fsm_fleet.h"
+
+/**
+ * @file fuzz_fsm.c
+ * @brief libFuzzer target for fsm_process_event().
+ *
+ * Every input byte is one step for a machine fresh from fsm_init():
+ * bytes from FUZZ_PROGRAM up set the programme flags from their low three
+ * bits, all others are an event ID, EVENT_ID_COUNT standing for any
+ * unknown event. After each step the machine must satisfy the model's
+ * invariants and agree with a one-machine fleet fed the same steps. A
+ * violation is printed and panics, which libFuzzer reports as a crash.
+ */
+
+#define FUZZ_PROGRAM 0xf8
+
+// Set by the libFuzzer glue in arch/posix before FUZZ_IRQ is raised
+extern const uint8_t *posix_fuzz_buf;
+extern size_t posix_fuzz_sz;
+
+FSM_FLEET_DEFINE(fuzz_fleet, 1);
+
+#define FUZZ_CHECK(cond, step, fsm, fmt, ...)                                          \
+    do {                                                                               \
+        if (!(cond)) {                                                                 \
+            printk("Invariant violated at step %u (%s / %s): " fmt "\n", (step),       \
+                   fsm_get_system_state_name((fsm)->system_state),                     \
+                   fsm_get_wash_cycle_state_name((fsm)->wash_cycle_state), ##__VA_ARGS__); \
+            k_panic();                                                                 \
+        }                                                                              \
+    } while (0)
+
+static bool l2_is_check_state(wash_cycle_state_t state)
+{
+    return state == STATE_L2_PREWASH_CHECK || state == STATE_L2_HEATING_CHECK ||
+           state == STATE_L2_STEAM_CHECK;
+}
+
+// The L1 state an override event forces RUNNING into, or RUNNING if
+// @p event is not an override.
+static system_state_t override_target(event_id_t event)
+{
+    switch (event) {
+        case EVENT_PAUSE_BUTTON_PRESSED:
+            return STATE_L1_PAUSED;
+        case EVENT_POWER_LOSS_DETECTED:
+            return STATE_L1_BROWNOUT;
+        case EVENT_FATAL_FAULT_DETECTED:
+            return STATE_L1_FAILURE;
+        default:
+            return STATE_L1_RUNNING;
+    }
+}
+
+static void check_step(uint32_t step, const fsm_handle_t *before, event_id_t event,
+                       const fsm_handle_t *fsm)
+{
+    const system_state_t l1 = fsm->system_state;
+    const wash_cycle_state_t l2 = fsm->wash_cycle_state;
+
+    FUZZ_CHECK((unsigned int)l1 < STATE_L1_COUNT && (unsigned int)l2 < STATE_L2_COUNT, step,
+               fsm, "state out of range");
+
+    // Outside a cycle L2 is at rest, and a finished cycle has completed it.
+    if (l1 == STATE_L1_POWER_OFF || l1 == STATE_L1_STANDBY || l1 == STATE_L1_SELECTION) {
+        FUZZ_CHECK(l2 == STATE_L2_IDLE, step, fsm, "L2 active outside a cycle");
+    }
+    FUZZ_CHECK(l1 != STATE_L1_END || l2 == STATE_L2_COMPLETE, step, fsm,
+               "cycle ended before L2 completed");
+    FUZZ_CHECK(l1 != STATE_L1_RUNNING || (l2 != STATE_L2_IDLE && l2 != STATE_L2_COMPLETE), step,
+               fsm, "running without an active phase");
+    // Check states resolve in the step that enters them.
+    FUZZ_CHECK(!l2_is_check_state(l2), step, fsm, "stopped in a check state");
+
+    // Overrides win over whatever L2 would do with the event.
+    if (before->system_state == STATE_L1_RUNNING &&
+        override_target(event) != STATE_L1_RUNNING) {
+        FUZZ_CHECK(l1 == override_target(event), step, fsm, "override %d lost", event);
+        FUZZ_CHECK(l2 == before->wash_cycle_state, step, fsm, "override %d moved L2", event);
+    }
+    // Only a running machine, or an L1 transition, moves L2.
+    if (before->system_state != STATE_L1_RUNNING && l1 == before->system_state) {
+        FUZZ_CHECK(l2 == before->wash_cycle_state, step, fsm, "L2 moved while L1 idle");
+    }
+    if ((unsigned int)event >= EVENT_ID_COUNT) {
+        FUZZ_CHECK(l1 == before->system_state && l2 == before->wash_cycle_state, step, fsm,
+                   "unknown event %d changed the state", event);
+    }
+
+    FUZZ_CHECK(fsm_fleet_get_system_state(&fuzz_fleet, 0) == l1 &&
+               fsm_fleet_get_wash_cycle_state(&fuzz_fleet, 0) == l2, step, fsm,
+               "fleet disagrees: %s / %s",
+               fsm_get_system_state_name(fsm_fleet_get_system_state(&fuzz_fleet, 0)),
+               fsm_get_wash_cycle_state_name(fsm_fleet_get_wash_cycle_state(&fuzz_fleet, 0)));
+}
+
+static void fuzz_one_input(const uint8_t *data, size_t size)
+{
+    fsm_handle_t fsm;
+
+    fsm_init(&fsm);
+    fsm_fleet_init(&fuzz_fleet);
+
+    for (uint32_t step = 0; step < size; step++) {
+        const uint8_t byte = data[step];
+
+        if (byte >= FUZZ_PROGRAM) {
+            fsm.program_has_prewash = byte & FSM_FLEET_PREWASH;
+            fsm.program_has_heating = byte & FSM_FLEET_HEATING;
+            fsm.program_has_steam = byte & FSM_FLEET_STEAM;
+            fsm_fleet_set_program(&fuzz_fleet, 0, fsm.program_has_prewash,
+                                  fsm.program_has_heating, fsm.program_has_steam);
+            continue;
+        }
+
+        const event_id_t event = byte % (EVENT_ID_COUNT + 1);
+        const fsm_fleet_event_t fleet_event = { .machine = 0, .event = event };
+        const fsm_handle_t before = fsm;
+
+        fsm_process_event(&fsm, event);
+        fsm_fleet_process_batch(&fuzz_fleet, &fleet_event, 1);
+        check_step(step, &before, event, &fsm);
+    }
+}
+
+// Runs the input straight from the interrupt: the FSM needs no thread,
+// and skipping the hand-off to one keeps every execution short.
+static void fuzz_isr(const void *arg)
+{
+    ARG_UNUSED(arg);
+    fuzz_one_input(posix_fuzz_buf, posix_fuzz_sz);
+}
+
+int main(void)
+{
+    IRQ_CONNECT(CONFIG_ARCH_POSIX_FUZZ_IRQ, 0, fuzz_isr, NULL, 0);
+    irq_enable(CONFIG_ARCH_POSIX_FUZZ_IRQ);
+    return 0;
+}
@@ -5,38 +5,11 @@
 #include "event_defs.h" // For event_id_t and event_payload_t
 
 
-// --- Level 1: System Mode States ---
-typedef enum {
-    STATE_L1_POWER_OFF,
-    STATE_L1_STANDBY,
-    STATE_L1_SELECTION,
-    STATE_L1_RUNNING,
-    STATE_L1_PAUSED,
-    STATE_L1_END,
-    STATE_L1_BROWNOUT,
-    STATE_L1_FAILURE,
-} system_state_t;
-
-// --- Level 2: Wash Cycle States ---
-typedef enum {
-    STATE_L2_IDLE,
-    STATE_L2_LOAD_SENSING,
-    STATE_L2_DOSING,
-    STATE_L2_PREWASH_CHECK,
-    STATE_L2_PREWASH,
-    STATE_L2_DRAINING_PRE,
-    STATE_L2_FILLING,
-    STATE_L2_HEATING_CHECK,
-    STATE_L2_HEATING,
-    STATE_L2_WASHING,
-    STATE_L2_DRAINING_WASH,
-    STATE_L2_RINSING,
-    STATE_L2_DRAINING_RINSE,
-    STATE_L2_SPINNING,
-    STATE_L2_STEAM_CHECK,
-    STATE_L2_STEAMING,
-    STATE_L2_COMPLETE,
-} wash_cycle_state_t;
+// --- Level 1 and Level 2 States ---
+// Generated from model/l1_system.puml and model/l2_wash_cycle.puml by
+// scripts/gen_fsm_tables.py. Edit the models, not the generated headers.
+#include "l1_system_states.h"
+#include "l2_wash_cycle_states.h"
 
 // --- System-Wide Events (Triggers) ---
 // typedef enum {
@@ -68,11 +41,24 @@ typedef struct {
     bool program_has_prewash;
     bool program_has_heating;
     bool program_has_steam;
+    uint8_t program_id;         // Selected wash programme, see wash_program.h
 } fsm_handle_t;
 
 // --- Public API Functions ---
 void fsm_init(fsm_handle_t *fsm);
+// Runs an event to completion: the L2 check states it leads to are
+// resolved and L1 hears of a finished cycle before this returns.
 void fsm_process_event(fsm_handle_t *fsm, event_id_t event);
+// Same transitions as fsm_process_event(), without logging them.
+void fsm_apply_event(fsm_handle_t *fsm, event_id_t event);
+// Called by fsm_process_event() after every event that changed a state,
+// with the states before it.
+typedef void (*fsm_transition_listener_t)(const fsm_handle_t *fsm, system_state_t old_l1_state,
+                                          wash_cycle_state_t old_l2_state);
+// Installs the one listener, NULL removes it. fsm_apply_event() never calls it.
+void fsm_set_transition_listener(fsm_transition_listener_t listener);
 const char* fsm_get_system_state_name(system_state_t state);
 const char* fsm_get_wash_cycle_state_name(wash_cycle_state_t state);
+// Phase timeout declared for the state in the model, 0 if it has none.
+uint32_t fsm_get_wash_cycle_state_timeout_ms(wash_cycle_state_t state);
 
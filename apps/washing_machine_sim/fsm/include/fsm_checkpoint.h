@@ -0,0 +1,70 @@
+#pragma once
+
+#include <stdint.h>
+#include "fsm.h"
+
+/**
+ * @file fsm_checkpoint.h
+ * @brief Persists the FSM across a brownout or reset.
+ *
+ * A snapshot is one 32 byte record, versioned and CRC protected. Records
+ * are appended to one of two flash sectors; when it fills up, saving moves
+ * to the other one, which was erased in the background beforehand. A save
+ * is therefore a single small flash write and never waits for an erase,
+ * and the previous snapshot stays valid until the new one is on flash.
+ */
+
+#define FSM_CHECKPOINT_VERSION 1
+
+/**
+ * @brief What is needed to resume a cycle mid-phase.
+ */
+typedef struct {
+    fsm_handle_t fsm;               // States and programme options
+    uint32_t phase_elapsed_ms;      // Time spent in the current L2 phase
+    uint32_t timer_remaining_ms;    // Phase timer still to run, 0 if none
+    uint32_t seq;                   // Set by fsm_checkpoint_save()
+} fsm_snapshot_t;
+
+/**
+ * @brief Checkpoint counters, see fsm_checkpoint_get_stats().
+ */
+typedef struct {
+    uint32_t saves;             // Snapshots written
+    uint32_t failures;          // Saves that returned an error
+    uint32_t slot_switches;     // Moves to the other sector
+    uint32_t last_save_us;      // Duration of the latest save
+    uint32_t max_save_us;       // Worst case since init
+} fsm_checkpoint_stats_t;
+
+/**
+ * @brief Opens the checkpoint area and finds the newest snapshot.
+ *
+ * The first two sectors of the partition are used. If the spare one holds
+ * stale data, its erase is queued on the system work queue.
+ *
+ * @param flash_area_id Partition to use, e.g. FIXED_PARTITION_ID(storage_partition).
+ * @return 0 on success, or a negative error code on failure.
+ */
+int fsm_checkpoint_init(uint8_t flash_area_id);
+
+/**
+ * @brief Writes a snapshot.
+ *
+ * Bounded in time: one flash_area_write() of one record, never an erase.
+ * Fills in @p snapshot->seq.
+ *
+ * @return 0 on success, -ENODEV before init, -EBUSY if both sectors are
+ *         full because the background erase has not run yet, or a flash
+ *         error code.
+ */
+int fsm_checkpoint_save(fsm_snapshot_t *snapshot);
+
+/**
+ * @brief Reads the newest valid snapshot.
+ *
+ * @return 0 on success, -ENOENT if there is none, -ENODEV before init.
+ */
+int fsm_checkpoint_restore(fsm_snapshot_t *snapshot);
+
+void fsm_checkpoint_get_stats(fsm_checkpoint_stats_t *out);
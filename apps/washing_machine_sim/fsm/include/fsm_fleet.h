@@ -0,0 +1,86 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <zephyr/sys/util.h>
+#include "fsm.h"
+
+/**
+ * @file fsm_fleet.h
+ * @brief The L1/L2 state machines for many washing machines at once.
+ *
+ * A fleet keeps the machines in struct-of-arrays form: one byte of
+ * combined L1/L2 state and one byte of programme flags per machine.
+ * fsm_fleet_process_batch() runs a batch of (machine, event) pairs in a
+ * single loop over a precomputed state x event table, with the same
+ * result as calling fsm_apply_event() on one fsm_handle_t per machine.
+ */
+
+// Programme flags, one byte per machine
+#define FSM_FLEET_PREWASH BIT(0)
+#define FSM_FLEET_HEATING BIT(1)
+#define FSM_FLEET_STEAM   BIT(2)
+
+/**
+ * @brief Number of combined states, STATE_L1_COUNT x STATE_L2_COUNT.
+ */
+#define FSM_FLEET_STATE_COUNT (STATE_L1_COUNT * STATE_L2_COUNT)
+
+typedef struct {
+    uint8_t *state;         // L1 state * STATE_L2_COUNT + L2 state
+    uint8_t *flags;         // FSM_FLEET_* programme flags
+    uint16_t num_machines;
+} fsm_fleet_t;
+
+/**
+ * @brief One event for one machine of a fleet.
+ */
+typedef struct {
+    uint16_t machine;
+    uint8_t event;          // event_id_t
+} fsm_fleet_event_t;
+
+/**
+ * @brief Statically defines a fleet of @p n machines named @p name.
+ */
+#define FSM_FLEET_DEFINE(name, n)                                   \
+    BUILD_ASSERT((n) > 0 && (n) <= UINT16_MAX, "bad fleet size");   \
+    static uint8_t name##_state[n];                                 \
+    static uint8_t name##_flags[n];                                 \
+    static fsm_fleet_t name = {                                     \
+        .state = name##_state,                                      \
+        .flags = name##_flags,                                      \
+        .num_machines = (n),                                        \
+    }
+
+/**
+ * @brief Puts every machine in the state fsm_init() gives a handle.
+ *
+ * The first call also builds the shared transition table; make it before
+ * any other thread uses a fleet.
+ *
+ * @return 0 on success, -EINVAL if @p fleet is NULL.
+ */
+int fsm_fleet_init(fsm_fleet_t *fleet);
+
+/**
+ * @brief Sets the programme flags of one machine.
+ *
+ * @return 0 on success, -EINVAL for a bad fleet or machine.
+ */
+int fsm_fleet_set_program(fsm_fleet_t *fleet, uint16_t machine,
+                          bool prewash, bool heating, bool steam);
+
+/**
+ * @brief Runs @p count events through the fleet, in order.
+ *
+ * Events for machines outside the fleet are skipped.
+ *
+ * @return The number of events that changed a machine's state, or
+ *         -EINVAL if @p fleet or @p events is NULL.
+ */
+int fsm_fleet_process_batch(fsm_fleet_t *fleet, const fsm_fleet_event_t *events, size_t count);
+
+system_state_t fsm_fleet_get_system_state(const fsm_fleet_t *fleet, uint16_t machine);
+wash_cycle_state_t fsm_fleet_get_wash_cycle_state(const fsm_fleet_t *fleet, uint16_t machine);
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "fsm.h"
+
+/**
+ * @file fsm_notify.h
+ * @brief Publishes the state changes of one machine on the event bus.
+ *
+ * Every fsm_process_event() that changes a state posts an
+ * EVENT_FSM_STATE_CHANGED carrying the states before and after, so UI,
+ * telemetry and logging can follow the machine without polling it.
+ *
+ * With L2 coalescing, changes of the wash cycle state alone are held back
+ * until fsm_notify_flush() and then posted as one event, from the state
+ * last published to the current one. An L1 change is posted at once and
+ * takes any held L2 change with it, except a change into brownout: that is
+ * held too, so posting it never delays the power-loss checkpoint.
+ */
+
+/**
+ * @brief The payload of EVENT_FSM_STATE_CHANGED, unpacked.
+ */
+typedef struct {
+    uint8_t old_l1;     // system_state_t
+    uint8_t old_l2;     // wash_cycle_state_t
+    uint8_t new_l1;
+    uint8_t new_l2;
+} fsm_state_change_t;
+
+static inline uint32_t fsm_state_change_pack(const fsm_state_change_t *change)
+{
+    return ((uint32_t)change->old_l1 << 24) | ((uint32_t)change->old_l2 << 16) |
+           ((uint32_t)change->new_l1 << 8) | change->new_l2;
+}
+
+static inline fsm_state_change_t fsm_state_change_unpack(uint32_t payload)
+{
+    return (fsm_state_change_t){
+        .old_l1 = payload >> 24,
+        .old_l2 = payload >> 16,
+        .new_l1 = payload >> 8,
+        .new_l2 = payload,
+    };
+}
+
+/**
+ * @brief Notification counters, see fsm_notify_get_stats().
+ */
+typedef struct {
+    uint32_t published;     // EVENT_FSM_STATE_CHANGED posted
+    uint32_t coalesced;     // L2 changes folded into a later event
+    uint32_t failed;        // Posts the bus did not take in full
+} fsm_notify_stats_t;
+
+/**
+ * @brief Starts publishing the changes of @p fsm, replacing any machine
+ * published before, and clears the counters.
+ *
+ * Installs the transition listener of fsm.h.
+ *
+ * @param coalesce_l2 Hold L2-only changes and brownouts until
+ *                    fsm_notify_flush().
+ * @return 0 on success, -EINVAL for a NULL machine.
+ */
+int fsm_notify_attach(const fsm_handle_t *fsm, bool coalesce_l2);
+
+/**
+ * @brief Stops publishing. A held change is dropped.
+ */
+void fsm_notify_detach(void);
+
+/**
+ * @brief Posts the held change, if any. Call it from the thread that
+ * processes the events, once it has run out of them, and right after the
+ * power-loss checkpoint.
+ */
+void fsm_notify_flush(void);
+
+void fsm_notify_get_stats(fsm_notify_stats_t *out);
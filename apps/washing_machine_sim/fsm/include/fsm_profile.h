@@ -0,0 +1,111 @@
+#pragma once
+
+#include <stdint.h>
+#include "fsm.h"
+
+/**
+ * @brief Transition profiler for fsm_process_event().
+ *
+ * A profile attached to a machine records which transitions it takes,
+ * how long it dwells in each state and which events each state ignores.
+ * Machines without a profile cost one branch per event. Each profile has
+ * its own lock, so machines on different threads never wait for each
+ * other.
+ */
+
+// Distinct transitions one profile tracks; more are counted as overflow.
+#define FSM_PROFILE_MAX_EDGES 48
+// Dwell histogram bucket i counts dwells of [2^(i-1), 2^i) ms, bucket 0
+// dwells under 1 ms; the last bucket takes everything longer.
+#define FSM_PROFILE_DWELL_BUCKETS 24
+// Profiles that can be attached at the same time
+#define FSM_PROFILE_MAX_MACHINES 4
+
+typedef enum {
+    FSM_PROFILE_L1,
+    FSM_PROFILE_L2,
+} fsm_profile_level_t;
+
+typedef struct {
+    uint8_t level;          // fsm_profile_level_t
+    uint8_t from;
+    uint8_t event;
+    uint8_t to;
+    uint32_t count;
+} fsm_profile_edge_t;
+
+typedef struct {
+    uint32_t histogram[FSM_PROFILE_DWELL_BUCKETS];
+    uint32_t count;         // Completed visits
+    uint64_t total_ms;
+    uint32_t max_ms;
+} fsm_profile_dwell_t;
+
+typedef struct {
+    fsm_profile_edge_t edges[FSM_PROFILE_MAX_EDGES];
+    uint16_t num_edges;
+    uint32_t edge_overflow;     // Transitions that found the edge table full
+    fsm_profile_dwell_t l1_dwell[STATE_L1_COUNT];
+    fsm_profile_dwell_t l2_dwell[STATE_L2_COUNT];
+    // Events that changed nothing, by the L1 state, or by the L2 state
+    // while L1 is running, and by event ID
+    uint32_t l1_ignored[STATE_L1_COUNT];
+    uint32_t l2_ignored[STATE_L2_COUNT];
+    uint32_t ignored_by_event[EVENT_ID_COUNT];
+    uint32_t events;            // Events applied, internal ones included
+    // Entry times of the current states
+    int64_t l1_entered_ms;
+    int64_t l2_entered_ms;
+} fsm_profile_t;
+
+/**
+ * @brief Starts profiling @p fsm into @p profile, which is cleared.
+ *
+ * @param now_ms Clock for dwell times, NULL for k_uptime_get().
+ * @return 0 on success, -EINVAL for NULL arguments, -ENOMEM when
+ *         FSM_PROFILE_MAX_MACHINES machines are already profiled.
+ */
+int fsm_profile_attach(const fsm_handle_t *fsm, fsm_profile_t *profile, int64_t (*now_ms)(void));
+
+/**
+ * @brief Stops profiling @p fsm.
+ *
+ * @return 0 on success, -ENOENT if it was not profiled.
+ */
+int fsm_profile_detach(const fsm_handle_t *fsm);
+
+/**
+ * @brief Clears the profile of @p fsm, keeping it attached.
+ *
+ * @return 0 on success, -ENOENT if it is not profiled.
+ */
+int fsm_profile_reset(const fsm_handle_t *fsm);
+
+/**
+ * @brief Copies the profile of @p fsm, consistent even while the
+ * machine is processing events on another thread.
+ *
+ * The copy takes no lock. It is retried when an event was recorded
+ * during it, so it never holds off the dispatcher or interrupts.
+ *
+ * @return 0 on success, -ENOENT if it is not profiled.
+ */
+int fsm_profile_snapshot(const fsm_handle_t *fsm, fsm_profile_t *out);
+
+/**
+ * @brief Records one event applied to @p fsm, external or internal,
+ * before its completion transitions. Called by the dispatcher.
+ */
+void fsm_profile_record(const fsm_handle_t *fsm, event_id_t event,
+                        system_state_t original_l1_state, wash_cycle_state_t original_l2_state);
+
+/**
+ * @brief Records one completion transition out of an L2 check state,
+ * credited to the @p event that led into it. Called by the dispatcher.
+ */
+void fsm_profile_record_completion(const fsm_handle_t *fsm, event_id_t event,
+                                   wash_cycle_state_t original_l2_state);
+
+// Number of machines profiled. The dispatcher skips the profiler while
+// it is 0.
+extern uint8_t fsm_profile_attached;
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <stdint.h>
+#include <zephyr/sys/atomic.h>
+#include "fsm.h"
+
+/**
+ * @file fsm_status.h
+ * @brief Consistent FSM status for readers on other threads.
+ *
+ * One writer publishes, any number of readers copy, and neither takes a
+ * lock. The channel holds two copies of the status: the writer fills the
+ * one readers are not using and then bumps the sequence number, which
+ * hands it over. A reader copies the current one and retries only if a
+ * publication completed meanwhile, so it never waits for a writer that
+ * was preempted halfway, and the writer never waits for readers.
+ */
+
+/**
+ * @brief What a UI or test needs to know about the machine.
+ */
+typedef struct {
+    uint32_t seq;               // Publication count, set by fsm_status_publish()
+    uint8_t system_state;       // system_state_t
+    uint8_t wash_cycle_state;   // wash_cycle_state_t
+    uint8_t program_id;
+    uint8_t options;            // WASH_PROGRAM_* options of the cycle
+    uint32_t phase_start_ms;    // Clock when the current L2 phase was entered
+    uint32_t phase_timeout_ms;  // Timeout of the current phase, 0 if untimed
+    uint32_t remaining_ms;      // Cycle time left when published
+    uint32_t published_ms;      // Clock when published
+} fsm_status_t;
+
+typedef struct {
+    atomic_t seq;               // Publications so far; slot[seq & 1] is current
+    fsm_status_t slot[2];
+} fsm_status_channel_t;
+
+/**
+ * @brief Fills the state and programme fields of @p status from @p fsm.
+ */
+void fsm_status_from_fsm(fsm_status_t *status, const fsm_handle_t *fsm);
+
+/**
+ * @brief Makes @p status the current one. Wait-free.
+ *
+ * Only one thread may publish on a channel.
+ */
+void fsm_status_publish(fsm_status_channel_t *channel, const fsm_status_t *status);
+
+/**
+ * @brief Copies the current status. Lock-free, from any thread or ISR.
+ *
+ * @return How often the copy was retried because a publication completed
+ *         during it.
+ */
+uint32_t fsm_status_read(const fsm_status_channel_t *channel, fsm_status_t *out);
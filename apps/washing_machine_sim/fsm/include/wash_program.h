@@ -0,0 +1,110 @@
+#pragma once
+
+#include <stdint.h>
+#include <zephyr/sys/util.h>
+#include "fsm.h"
+
+/**
+ * @file wash_program.h
+ * @brief Wash programme descriptors and the time-remaining estimator.
+ *
+ * A programme is a const descriptor: which optional phases it runs, its
+ * wash parameters and the nominal time of every L2 phase. Selecting one
+ * (EVENT_CYCLE_SELECTED, payload = programme ID) sets the machine's
+ * programme flags; its timed phases then last as long as the descriptor
+ * says.
+ */
+
+// Optional phases, wash_program_t::options
+#define WASH_PROGRAM_PREWASH BIT(0)
+#define WASH_PROGRAM_HEATING BIT(1)
+#define WASH_PROGRAM_STEAM   BIT(2)
+
+typedef enum {
+    WASH_PROGRAM_NORMAL,        // The model's nominal phase times
+    WASH_PROGRAM_COTTON,
+    WASH_PROGRAM_SYNTHETICS,
+    WASH_PROGRAM_QUICK,
+    WASH_PROGRAM_DELICATES,
+    WASH_PROGRAM_INTENSIVE,
+    WASH_PROGRAM_COUNT
+} wash_program_id_t;
+
+typedef struct {
+    const char *name;
+    uint8_t options;            // WASH_PROGRAM_* optional phases
+    uint8_t target_temp_c;      // Heating target, 0 for a cold wash
+    uint8_t rinse_count;        // Rinses run back to back in STATE_L2_RINSING
+    uint8_t water_level_pct;    // Fill level, percent of the drum
+    uint16_t wash_rpm;
+    uint16_t spin_rpm;
+    // Nominal seconds in each L2 phase, one rinse for STATE_L2_RINSING.
+    // Timed phases last exactly this long, the others until their sensor
+    // reports.
+    uint16_t phase_s[STATE_L2_COUNT];
+} wash_program_t;
+
+/**
+ * @brief Looks up a programme descriptor.
+ *
+ * @return The descriptor, or NULL if @p id names no programme.
+ */
+const wash_program_t *wash_program_get(uint32_t id);
+
+/**
+ * @brief Selects programme @p id for @p fsm and sets its programme flags.
+ *
+ * @return 0 on success, -EINVAL if @p id names no programme.
+ */
+int wash_program_select(fsm_handle_t *fsm, uint32_t id);
+
+/**
+ * @brief Nominal time @p fsm spends in @p state with its programme and
+ * flags, 0 if the cycle skips the state.
+ *
+ * A machine with an unknown programme ID runs WASH_PROGRAM_NORMAL.
+ */
+uint32_t wash_program_phase_ms(const fsm_handle_t *fsm, wash_cycle_state_t state);
+
+/**
+ * @brief Phase timeout for @p state: the programme's time for the states
+ * the model times, 0 for the others.
+ */
+uint32_t wash_program_timeout_ms(const fsm_handle_t *fsm, wash_cycle_state_t state);
+
+/**
+ * @brief Remaining cycle time of one machine.
+ *
+ * The plan, the time still to come after each phase, is worked out once
+ * per programme selection. After that every transition is O(1) to record
+ * and the remaining time is O(1) to read. The cycle visits the L2 states
+ * in the order the model declares them, which the plan relies on. Not
+ * thread-safe, like fsm_handle_t.
+ */
+typedef struct {
+    uint32_t after_ms[STATE_L2_COUNT];  // Planned time after leaving each phase
+    uint16_t plan_key;                  // Programme and flags the plan is for
+    wash_cycle_state_t phase;
+    uint32_t phase_ms;                  // Planned time of the current phase
+    uint32_t phase_done_ms;             // Time run in it before running_since_ms
+    int64_t running_since_ms;           // -1 while the cycle is not running
+} wash_estimate_t;
+
+/**
+ * @brief Starts an estimate for @p fsm, @p phase_elapsed_ms into its
+ * current phase.
+ */
+void wash_estimate_init(wash_estimate_t *est, const fsm_handle_t *fsm,
+                        uint32_t phase_elapsed_ms, int64_t now_ms);
+
+/**
+ * @brief Records whatever @p fsm did since the last call. Call after
+ * every event.
+ */
+void wash_estimate_update(wash_estimate_t *est, const fsm_handle_t *fsm, int64_t now_ms);
+
+/**
+ * @brief Time left until the cycle completes, the whole cycle before it
+ * starts. Paused time does not count as progress.
+ */
+uint32_t wash_estimate_remaining_ms(const wash_estimate_t *est, int64_t now_ms);
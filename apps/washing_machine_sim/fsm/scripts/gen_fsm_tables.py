@@ -0,0 +1,371 @@
+#!/usr/bin/env python3
+"""Generate FSM state enums, name tables and transition tables from PlantUML.
+
+The model is a PlantUML state diagram restricted to the subset below:
+
+    ' fsm: machine=l2 type=wash_cycle_state_t count=STATE_L2_COUNT
+    state "Display Name" as STATE_ID
+    [*] --> STATE_ID
+    STATE_A --> STATE_B : EVENT_ID
+    STATE_A --> STATE_B : EVENT_ID [guard] / action
+    STATE_A --> STATE_B : <<override>> EVENT_ID
+    STATE_A --> STATE_B : [guard]
+    STATE_A --> STATE_B : [else]
+    STATE_A --> [*]
+    STATE_ID : timeout 30 s
+
+States are numbered in declaration order. A transition without an event
+is a completion transition, taken on any event. Transitions sharing a
+source state and event form a chain tried in file order; each but the
+last needs a guard, [else] is the same as no guard. Guards and actions
+name C functions the including source file defines.
+
+A state with a timeout (in ms, s or min) must have a transition on the
+timeout event, EVENT_TIMER_EXPIRED unless the directive sets
+timeout_event=. The timeouts go into a <machine>_state_timeouts_ms table;
+the dispatcher arms a timer with it when the state is entered.
+
+Two files are written to the output directory, named after the model:
+    <model>_states.h    the state enum and the name table declaration
+    <model>_tables.inc  the name table and the fsm_engine.h machine(s)
+"""
+
+import argparse
+import os
+import re
+import sys
+
+DIRECTIVE_RE = re.compile(r"^'\s*fsm:\s*(.*)$")
+STATE_RE = re.compile(r'^state\s+"([^"]+)"\s+as\s+(\w+)\s*$')
+TRANSITION_RE = re.compile(r"^(\[\*\]|\w+)\s+-+(?:\w+-+)?>\s+(\[\*\]|\w+)\s*(?::\s*(.*))?$")
+LABEL_RE = re.compile(
+    r"^(?P<override><<override>>\s*)?"
+    r"(?P<event>EVENT_\w+)?\s*"
+    r"(?:\[(?P<guard>[^\]]+)\])?\s*"
+    r"(?:/\s*(?P<action>\w+))?$"
+)
+TIMEOUT_RE = re.compile(r"^(\w+)\s*:\s*timeout\s+(\d+)\s*(ms|s|min)\s*$")
+EVENT_ENUM_RE = re.compile(r"^\s*(EVENT_\w+|COMMAND_\w+)\s*(?:=\s*\d+)?\s*,")
+
+MAX_TRANSITIONS = 255
+TIMEOUT_UNITS_MS = {"ms": 1, "s": 1000, "min": 60000}
+DEFAULT_TIMEOUT_EVENT = "EVENT_TIMER_EXPIRED"
+
+
+class ModelError(Exception):
+    pass
+
+
+class Transition:
+    def __init__(self, line, source, target, event, guard, action, override):
+        self.line = line
+        self.source = source
+        self.target = target
+        self.event = event
+        self.guard = None if guard in (None, "else") else guard
+        self.action = action
+        self.override = override
+        self.index = 0
+        self.alternative = 0
+
+
+class Model:
+    def __init__(self, path):
+        self.path = path
+        self.name = os.path.splitext(os.path.basename(path))[0]
+        self.options = {}
+        self.states = []
+        self.labels = {}
+        self.initial = None
+        self.transitions = []
+        self.timeouts = {}
+        self.timeout_lines = {}
+
+    def error(self, line, msg):
+        raise ModelError(f"{self.path}:{line}: {msg}")
+
+
+def parse_model(path):
+    model = Model(path)
+    in_note = False
+
+    with open(path, encoding="utf-8") as f:
+        for num, raw in enumerate(f, 1):
+            line = raw.strip()
+
+            directive = DIRECTIVE_RE.match(line)
+            if directive:
+                for option in directive.group(1).split():
+                    key, _, value = option.partition("=")
+                    model.options[key] = value
+                continue
+            if in_note:
+                in_note = not line.startswith("end note")
+                continue
+            if line.startswith("note "):
+                in_note = ":" not in line
+                continue
+            if not line or line.startswith("'") or line.startswith("@") or line.startswith("skinparam"):
+                continue
+
+            match = STATE_RE.match(line)
+            if match:
+                label, state = match.groups()
+                if state in model.labels:
+                    model.error(num, f"state {state} declared twice")
+                model.states.append(state)
+                model.labels[state] = label
+                continue
+
+            match = TIMEOUT_RE.match(line)
+            if match:
+                state, value, unit = match.groups()
+                if state in model.timeouts:
+                    model.error(num, f"second timeout for {state}")
+                model.timeouts[state] = int(value) * TIMEOUT_UNITS_MS[unit]
+                model.timeout_lines[state] = num
+                continue
+
+            match = TRANSITION_RE.match(line)
+            if not match:
+                model.error(num, f"cannot parse '{line}'")
+            source, target, label = match.groups()
+
+            if source == "[*]":
+                model.initial = (num, target)
+                continue
+            if target == "[*]":
+                # Final pseudo-state, documentation only.
+                continue
+
+            label_match = LABEL_RE.match((label or "").strip())
+            if not label_match:
+                model.error(num, f"cannot parse transition label '{label}'")
+            model.transitions.append(Transition(
+                num, source, target,
+                label_match.group("event"),
+                label_match.group("guard"),
+                label_match.group("action"),
+                bool(label_match.group("override"))))
+
+    return model
+
+
+def load_events(path):
+    events = set()
+    with open(path, encoding="utf-8") as f:
+        for line in f:
+            match = EVENT_ENUM_RE.match(line)
+            if match:
+                events.add(match.group(1))
+    return events
+
+
+def validate(model, events):
+    for key in ("machine", "type", "count"):
+        if key not in model.options:
+            model.error(1, f"missing '{key}=' in the fsm: directive")
+    if not model.states:
+        model.error(1, "no states declared")
+    if model.initial:
+        num, state = model.initial
+        if state != model.states[0]:
+            model.error(num, f"initial state {state} must be declared first")
+
+    for t in model.transitions:
+        for state in (t.source, t.target):
+            if state not in model.labels:
+                model.error(t.line, f"unknown state {state}")
+        if t.event and events is not None and t.event not in events:
+            model.error(t.line, f"unknown event {t.event}")
+        if t.override and not t.event:
+            model.error(t.line, "override transitions need an event")
+
+    timeout_event = model.options.get("timeout_event", DEFAULT_TIMEOUT_EVENT)
+    for state, ms in model.timeouts.items():
+        num = model.timeout_lines[state]
+        if state not in model.labels:
+            model.error(num, f"timeout for unknown state {state}")
+        if ms == 0 or ms > 0xFFFFFFFF:
+            model.error(num, f"timeout of {state} out of range")
+        if not any(t.source == state and t.event == timeout_event for t in model.transitions):
+            model.error(num, f"{state} has a timeout but no {timeout_event} transition")
+
+    chains = {}
+    for t in model.transitions:
+        chains.setdefault((t.override, t.source, t.event), []).append(t)
+
+    for (override, source, event), chain in chains.items():
+        for t in chain[:-1]:
+            if t.guard is None:
+                model.error(t.line, "unguarded transition hides the ones after it")
+        if event is None and any(e is not None and s == source and not o
+                                 for (o, s, e) in chains):
+            model.error(chain[0].line, f"{source} has both completion and event transitions")
+
+    return chains
+
+
+def number_transitions(model, chains):
+    index = 1
+    for chain in chains.values():
+        for t in chain:
+            t.index = index
+            index += 1
+        for t, nxt in zip(chain, chain[1:]):
+            t.alternative = nxt.index
+    if index - 1 > MAX_TRANSITIONS:
+        model.error(1, f"{index - 1} transitions, at most {MAX_TRANSITIONS} fit the tables")
+
+
+def emit_header(model, out):
+    typ = model.options["type"]
+    count = model.options["count"]
+    machine = model.options["machine"]
+    src = os.path.basename(model.path)
+
+    out.write(f"// Generated by gen_fsm_tables.py from {src}. Do not edit.\n")
+    out.write("#pragma once\n\n")
+    if model.timeouts:
+        out.write("#include <stdint.h>\n\n")
+    out.write("typedef enum {\n")
+    for state in model.states:
+        out.write(f"    {state},\n")
+    out.write("    // --- This must be the last entry ---\n")
+    out.write(f"    {count}\n")
+    out.write(f"}} {typ};\n\n")
+    out.write(f"extern const char *const {machine}_state_names[{count}];\n")
+    if model.timeouts:
+        out.write("// Timeout of each state in ms, 0 for states without one.\n")
+        out.write(f"extern const uint32_t {machine}_state_timeouts_ms[{count}];\n")
+
+
+def emit_table(out, name, count, rows):
+    out.write(f"static const uint8_t {name}[{count}][EVENT_ID_COUNT] = {{\n")
+    for state, cells in rows.items():
+        out.write(f"    [{state}] = {{\n")
+        for event, index in cells:
+            out.write(f"        [{event}] = {index},\n")
+        out.write("    },\n")
+    out.write("};\n\n")
+
+
+def emit_machine(out, name, machine, count, table, completion):
+    out.write(f"static const fsm_machine_t {name} = {{\n")
+    out.write(f"    .transitions = {machine}_transitions,\n")
+    out.write(f"    .table = &{table}[0][0],\n")
+    if completion:
+        out.write(f"    .completion = {completion},\n")
+    out.write(f"    .num_states = {count},\n")
+    out.write("};\n\n")
+
+
+def emit_tables(model, chains, out):
+    machine = model.options["machine"]
+    count = model.options["count"]
+    src = os.path.basename(model.path)
+
+    out.write(f"// Generated by gen_fsm_tables.py from {src}. Do not edit.\n")
+    out.write("// Include once, after the guards and actions it names are declared.\n\n")
+
+    out.write(f"const char *const {machine}_state_names[{count}] = {{\n")
+    for state in model.states:
+        out.write(f"    [{state}] = \"{model.labels[state]}\",\n")
+    out.write("};\n\n")
+
+    if model.timeouts:
+        out.write(f"const uint32_t {machine}_state_timeouts_ms[{count}] = {{\n")
+        for state in model.states:
+            if state in model.timeouts:
+                out.write(f"    [{state}] = {model.timeouts[state]},\n")
+        out.write("};\n\n")
+
+    out.write(f"static const fsm_transition_t {machine}_transitions[] = {{\n")
+    for chain in chains.values():
+        for t in chain:
+            fields = [f".next_state = {t.target}"]
+            if t.guard:
+                fields.append(f".guard = {t.guard}")
+            if t.action:
+                fields.append(f".action = {t.action}")
+            if t.alternative:
+                fields.append(f".alternative = {t.alternative}")
+            trigger = t.event or "*"
+            out.write(f"    // {t.source} --{trigger}--> {t.target}\n")
+            out.write(f"    [{t.index}] = {{ {', '.join(fields)} }},\n")
+    out.write("};\n\n")
+
+    regular, override, completion = {}, {}, {}
+    for (is_override, source, event), chain in chains.items():
+        if event is None:
+            completion[source] = chain[0].index
+        else:
+            rows = override if is_override else regular
+            rows.setdefault(source, []).append((event, chain[0].index))
+
+    emit_table(out, f"{machine}_table", count, regular)
+    completion_name = None
+    if completion:
+        completion_name = f"{machine}_completion"
+        out.write(f"static const uint8_t {completion_name}[{count}] = {{\n")
+        for state, index in completion.items():
+            out.write(f"    [{state}] = {index},\n")
+        out.write("};\n\n")
+    emit_machine(out, f"{machine}_machine", machine, count, f"{machine}_table", completion_name)
+
+    if override:
+        emit_table(out, f"{machine}_override_table", count, override)
+        emit_machine(out, f"{machine}_override_machine", machine, count,
+                     f"{machine}_override_table", None)
+
+
+def write_if_changed(path, text):
+    # Leave unchanged outputs alone so dependents are not rebuilt.
+    if os.path.exists(path):
+        with open(path, encoding="utf-8") as f:
+            if f.read() == text:
+                return
+    with open(path, "w", encoding="utf-8") as f:
+        f.write(text)
+
+
+class Buffer:
+    def __init__(self):
+        self.parts = []
+
+    def write(self, text):
+        self.parts.append(text)
+
+    def text(self):
+        return "".join(self.parts)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("model", help="PlantUML state machine model")
+    parser.add_argument("--out-dir", required=True, help="directory for the generated files")
+    parser.add_argument("--events", help="event_defs.h, to check event names against")
+    args = parser.parse_args()
+
+    try:
+        model = parse_model(args.model)
+        events = load_events(args.events) if args.events else None
+        chains = validate(model, events)
+        number_transitions(model, chains)
+    except (ModelError, OSError) as e:
+        print(f"gen_fsm_tables: {e}", file=sys.stderr)
+        return 1
+
+    header, tables = Buffer(), Buffer()
+    emit_header(model, header)
+    emit_tables(model, chains, tables)
+
+    os.makedirs(args.out_dir, exist_ok=True)
+    write_if_changed(os.path.join(args.out_dir, f"{model.name}_states.h"), header.text())
+    write_if_changed(os.path.join(args.out_dir, f"{model.name}_tables.inc"),
+                     tables.text().rstrip("\n") + "\n")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
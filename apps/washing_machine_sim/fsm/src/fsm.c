@@ -1,4 +1,5 @@
 #include "fsm.h"
+#include "fsm_profile.h"
 #include "l1_system_fsm.h"
 #include "l2_wash_cycle_fsm.h"
 
@@ -14,24 +15,73 @@ void fsm_init(fsm_handle_t *fsm)
         fsm->program_has_prewash = false;
         fsm->program_has_heating = false;
         fsm->program_has_steam = false;
+        fsm->program_id = 0;
     }
 }
 
-void fsm_process_event(fsm_handle_t *fsm, event_id_t event)
+// --- Internal event queue ---
+// Events the L2 machine raises for L1 (EVENT_CYCLE_FINISHED) wait here
+// and run before fsm_apply_event() returns. Each step raises at most one,
+// so the queue only needs a few slots.
+#define FSM_INTERNAL_QUEUE_SIZE 4
+
+typedef struct {
+    event_id_t events[FSM_INTERNAL_QUEUE_SIZE];
+    uint8_t head;
+    uint8_t count;
+} fsm_internal_queue_t;
+
+static bool internal_queue_put(fsm_internal_queue_t *queue, event_id_t event)
 {
-    if (!fsm) {
-        return;
+    if (queue->count == FSM_INTERNAL_QUEUE_SIZE) {
+        return false;
+    }
+    queue->events[(queue->head + queue->count) % FSM_INTERNAL_QUEUE_SIZE] = event;
+    queue->count++;
+    return true;
+}
+
+static bool internal_queue_get(fsm_internal_queue_t *queue, event_id_t *event)
+{
+    if (queue->count == 0) {
+        return false;
     }
+    *event = queue->events[queue->head];
+    queue->head = (queue->head + 1) % FSM_INTERNAL_QUEUE_SIZE;
+    queue->count--;
+    return true;
+}
 
+// Resolves the L2 check states in the same step that entered them, which
+// @p event did. Bounded, so a loop of completion transitions in the model
+// cannot hang the dispatcher.
+static void fsm_run_to_completion(fsm_handle_t *fsm, event_id_t event)
+{
+    for (int step = 0; step < STATE_L2_COUNT; step++) {
+        const wash_cycle_state_t original_l2_state = fsm->wash_cycle_state;
+
+        if (fsm->system_state != STATE_L1_RUNNING || !l2_wash_cycle_run_completion(fsm)) {
+            return;
+        }
+        if (fsm_profile_attached) {
+            fsm_profile_record_completion(fsm, event, original_l2_state);
+        }
+    }
+}
+
+static void fsm_step(fsm_handle_t *fsm, event_id_t event, bool internal,
+                     fsm_internal_queue_t *queue)
+{
     system_state_t original_l1_state = fsm->system_state;
     wash_cycle_state_t original_l2_state = fsm->wash_cycle_state;
 
-    // L1 FSM handles high-priority override events first.
-    // These are events that can interrupt the RUNNING state.
-    bool event_handled_by_l1 = l1_system_process_override_events(fsm, event);
-
-    if (!event_handled_by_l1) {
-        // If not an override, dispatch based on the current L1 state.
+    if (internal) {
+        // Internal events are addressed to L1.
+        l1_system_process_event(fsm, event);
+    } else if (!l1_system_process_override_events(fsm, event)) {
+        // L1 FSM handles high-priority override events first. These are
+        // events that can interrupt the RUNNING state. Anything else is
+        // dispatched based on the current L1 state.
         if (fsm->system_state == STATE_L1_RUNNING) {
             l2_wash_cycle_process_event(fsm, event);
         } else {
@@ -39,61 +89,92 @@ void fsm_process_event(fsm_handle_t *fsm, event_id_t event)
         }
     }
 
-    // A special case: if the L2 machine has just completed,
-    // we need to inject an event into the L1 machine to signal this.
+    if (fsm_profile_attached) {
+        fsm_profile_record(fsm, event, original_l1_state, original_l2_state);
+    }
+    fsm_run_to_completion(fsm, event);
+
+    // When the L2 machine has just completed, L1 is told so with an
+    // internal event.
     if (original_l2_state != STATE_L2_COMPLETE && fsm->wash_cycle_state == STATE_L2_COMPLETE) {
-        l1_system_process_event(fsm, EVENT_CYCLE_FINISHED);
+        if (!internal_queue_put(queue, EVENT_CYCLE_FINISHED)) {
+            LOG_ERR("Internal event queue full, dropping event %d", EVENT_CYCLE_FINISHED);
+        }
     }
-    
+}
+
+void fsm_apply_event(fsm_handle_t *fsm, event_id_t event)
+{
+    fsm_internal_queue_t queue = { 0 };
+
+    if (!fsm) {
+        return;
+    }
+
+    fsm_step(fsm, event, false, &queue);
+    while (internal_queue_get(&queue, &event)) {
+        fsm_step(fsm, event, true, &queue);
+    }
+}
+
+// See fsm_set_transition_listener()
+static fsm_transition_listener_t transition_listener;
+
+void fsm_set_transition_listener(fsm_transition_listener_t listener)
+{
+    transition_listener = listener;
+}
+
+void fsm_process_event(fsm_handle_t *fsm, event_id_t event)
+{
+    if (!fsm) {
+        return;
+    }
+
+    system_state_t original_l1_state = fsm->system_state;
+    wash_cycle_state_t original_l2_state = fsm->wash_cycle_state;
+
+    fsm_apply_event(fsm, event);
+
     if (original_l1_state != fsm->system_state) {
-        LOG_INF("L1 State Change: %s -> %s", 
+        LOG_DBG("L1 State Change: %s -> %s", 
                 fsm_get_system_state_name(original_l1_state), 
                 fsm_get_system_state_name(fsm->system_state));
     }
 
     if (original_l2_state != fsm->wash_cycle_state) {
-        LOG_INF("L2 State Change: %s -> %s", 
+        LOG_DBG("L2 State Change: %s -> %s", 
                 fsm_get_wash_cycle_state_name(original_l2_state), 
                 fsm_get_wash_cycle_state_name(fsm->wash_cycle_state));
     }
+
+    if (transition_listener && (original_l1_state != fsm->system_state ||
+                                original_l2_state != fsm->wash_cycle_state)) {
+        transition_listener(fsm, original_l1_state, original_l2_state);
+    }
 }
 
 
 const char* fsm_get_system_state_name(system_state_t state)
 {
-    switch(state) {
-        case STATE_L1_POWER_OFF: return "Power Off";
-        case STATE_L1_STANDBY: return "Standby";
-        case STATE_L1_SELECTION: return "Selection";
-        case STATE_L1_RUNNING: return "Running";
-        case STATE_L1_PAUSED: return "Paused";
-        case STATE_L1_END: return "End";
-        case STATE_L1_BROWNOUT: return "Brownout";
-        case STATE_L1_FAILURE: return "Failure";
+    if ((unsigned int)state < STATE_L1_COUNT) {
+        return l1_state_names[state];
     }
     return "Unknown L1";
 }
 
 const char* fsm_get_wash_cycle_state_name(wash_cycle_state_t state)
 {
-    switch(state) {
-        case STATE_L2_IDLE: return "Idle";
-        case STATE_L2_LOAD_SENSING: return "Load Sensing";
-        case STATE_L2_DOSING: return "Dosing";
-        case STATE_L2_PREWASH_CHECK: return "Pre-Wash Check";
-        case STATE_L2_PREWASH: return "Pre-Wash";
-        case STATE_L2_DRAINING_PRE: return "Draining (Pre)";
-        case STATE_L2_FILLING: return "Filling";
-        case STATE_L2_HEATING_CHECK: return "Heating Check";
-        case STATE_L2_HEATING: return "Heating";
-        case STATE_L2_WASHING: return "Washing";
-        case STATE_L2_DRAINING_WASH: return "Draining (Wash)";
-        case STATE_L2_RINSING: return "Rinsing";
-        case STATE_L2_DRAINING_RINSE: return "Draining (Rinse)";
-        case STATE_L2_SPINNING: return "Spinning";
-        case STATE_L2_STEAM_CHECK: return "Steam Check";
-        case STATE_L2_STEAMING: return "Steaming";
-        case STATE_L2_COMPLETE: return "Complete";
+    if ((unsigned int)state < STATE_L2_COUNT) {
+        return l2_state_names[state];
     }
     return "Unknown L2";
 }
+
+uint32_t fsm_get_wash_cycle_state_timeout_ms(wash_cycle_state_t state)
+{
+    if ((unsigned int)state < STATE_L2_COUNT) {
+        return l2_state_timeouts_ms[state];
+    }
+    return 0;
+}
@@ -0,0 +1,325 @@
+#include "fsm_checkpoint.h"
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/storage/flash_map.h>
+#include <zephyr/drivers/flash.h>
+#include <zephyr/sys/crc.h>
+#include <stddef.h>
+#include <string.h>
+
+LOG_MODULE_REGISTER(fsm_checkpoint, CONFIG_LOG_DEFAULT_LEVEL);
+
+#define CHECKPOINT_MAGIC 0x434d5346 // "FSMC"
+#define CHECKPOINT_SLOTS 2
+
+#define FLAG_PREWASH BIT(0)
+#define FLAG_HEATING BIT(1)
+#define FLAG_STEAM   BIT(2)
+
+// One snapshot on flash. The reserved bytes are left at the erased value
+// so a later version can use them.
+typedef struct {
+    uint32_t magic;
+    uint8_t version;
+    uint8_t system_state;
+    uint8_t wash_cycle_state;
+    uint8_t program_flags;
+    uint32_t seq;
+    uint32_t phase_elapsed_ms;
+    uint32_t timer_remaining_ms;
+    // Records written before programmes existed hold the erased value,
+    // which names no programme.
+    uint8_t program_id;
+    uint8_t reserved[9];
+    uint16_t crc;           // CRC16-CCITT over the bytes before it
+} checkpoint_record_t;
+
+BUILD_ASSERT(sizeof(checkpoint_record_t) == 32, "Checkpoint records must be 32 bytes");
+BUILD_ASSERT(STATE_L1_COUNT <= UINT8_MAX && STATE_L2_COUNT <= UINT8_MAX,
+             "States must fit in a checkpoint record");
+
+static void spare_erase_handler(struct k_work *work);
+static K_WORK_DEFINE(spare_erase_work, spare_erase_handler);
+
+// checkpoint_lock protects everything below it.
+static K_MUTEX_DEFINE(checkpoint_lock);
+static const struct flash_area *checkpoint_fa;
+static size_t slot_size;
+static uint8_t active_slot;         // Sector saves go to
+static size_t write_offset;         // Next free byte in the active sector
+static bool spare_erased;           // The other sector is ready for use
+static checkpoint_record_t newest;
+static bool newest_valid;
+static fsm_checkpoint_stats_t stats;
+
+static uint16_t record_crc(const checkpoint_record_t *rec)
+{
+    return crc16_ccitt(0xffff, (const uint8_t *)rec, offsetof(checkpoint_record_t, crc));
+}
+
+static bool record_valid(const checkpoint_record_t *rec)
+{
+    return rec->magic == CHECKPOINT_MAGIC && rec->version == FSM_CHECKPOINT_VERSION &&
+           rec->system_state < STATE_L1_COUNT && rec->wash_cycle_state < STATE_L2_COUNT &&
+           rec->crc == record_crc(rec);
+}
+
+static bool record_erased(const checkpoint_record_t *rec)
+{
+    const uint8_t *bytes = (const uint8_t *)rec;
+    uint8_t erased = flash_area_erased_val(checkpoint_fa);
+
+    for (size_t i = 0; i < sizeof(*rec); i++) {
+        if (bytes[i] != erased) return false;
+    }
+    return true;
+}
+
+static inline off_t slot_offset(uint8_t slot)
+{
+    return (off_t)slot * slot_size;
+}
+
+static void record_pack(checkpoint_record_t *rec, const fsm_snapshot_t *snapshot, uint32_t seq)
+{
+    memset(rec, flash_area_erased_val(checkpoint_fa), sizeof(*rec));
+    rec->magic = CHECKPOINT_MAGIC;
+    rec->version = FSM_CHECKPOINT_VERSION;
+    rec->system_state = snapshot->fsm.system_state;
+    rec->wash_cycle_state = snapshot->fsm.wash_cycle_state;
+    rec->program_flags = (snapshot->fsm.program_has_prewash ? FLAG_PREWASH : 0) |
+                         (snapshot->fsm.program_has_heating ? FLAG_HEATING : 0) |
+                         (snapshot->fsm.program_has_steam ? FLAG_STEAM : 0);
+    rec->program_id = snapshot->fsm.program_id;
+    rec->seq = seq;
+    rec->phase_elapsed_ms = snapshot->phase_elapsed_ms;
+    rec->timer_remaining_ms = snapshot->timer_remaining_ms;
+    rec->crc = record_crc(rec);
+}
+
+static void record_unpack(const checkpoint_record_t *rec, fsm_snapshot_t *snapshot)
+{
+    snapshot->fsm.system_state = rec->system_state;
+    snapshot->fsm.wash_cycle_state = rec->wash_cycle_state;
+    snapshot->fsm.program_has_prewash = rec->program_flags & FLAG_PREWASH;
+    snapshot->fsm.program_has_heating = rec->program_flags & FLAG_HEATING;
+    snapshot->fsm.program_has_steam = rec->program_flags & FLAG_STEAM;
+    snapshot->fsm.program_id = rec->program_id;
+    snapshot->phase_elapsed_ms = rec->phase_elapsed_ms;
+    snapshot->timer_remaining_ms = rec->timer_remaining_ms;
+    snapshot->seq = rec->seq;
+}
+
+// Erases the spare sector off the save path. Saves never touch the spare
+// until it is marked erased, so the erase runs without holding the lock.
+static void spare_erase_handler(struct k_work *work)
+{
+    ARG_UNUSED(work);
+
+    k_mutex_lock(&checkpoint_lock, K_FOREVER);
+    const struct flash_area *fa = checkpoint_fa;
+    uint8_t spare = active_slot ^ 1;
+    bool needed = fa && !spare_erased;
+    k_mutex_unlock(&checkpoint_lock);
+
+    if (!needed) {
+        return;
+    }
+
+    int ret = flash_area_erase(fa, slot_offset(spare), slot_size);
+
+    k_mutex_lock(&checkpoint_lock, K_FOREVER);
+    if (ret) {
+        LOG_ERR("Failed to erase checkpoint sector %u (%d)", spare, ret);
+    } else if (fa == checkpoint_fa && spare == (active_slot ^ 1)) {
+        spare_erased = true;
+    }
+    k_mutex_unlock(&checkpoint_lock);
+}
+
+// Finds the newest valid record in a sector and the end of its used space.
+static int scan_slot(uint8_t slot, size_t *used)
+{
+    checkpoint_record_t rec;
+    size_t off;
+
+    for (off = 0; off + sizeof(rec) <= slot_size; off += sizeof(rec)) {
+        int ret = flash_area_read(checkpoint_fa, slot_offset(slot) + off, &rec, sizeof(rec));
+        if (ret) return ret;
+
+        if (record_erased(&rec)) {
+            break;
+        }
+        if (record_valid(&rec) && (!newest_valid || rec.seq > newest.seq)) {
+            newest = rec;
+            newest_valid = true;
+            active_slot = slot;
+        }
+    }
+    *used = off;
+    return 0;
+}
+
+static int checkpoint_open(uint8_t flash_area_id)
+{
+    struct flash_pages_info first, second;
+    const struct device *dev;
+    int ret;
+
+    ret = flash_area_open(flash_area_id, &checkpoint_fa);
+    if (ret) return ret;
+
+    dev = flash_area_get_device(checkpoint_fa);
+    if (!dev ||
+        flash_get_page_info_by_offs(dev, checkpoint_fa->fa_off, &first) ||
+        flash_get_page_info_by_offs(dev, checkpoint_fa->fa_off + first.size, &second)) {
+        LOG_ERR("Cannot read the checkpoint partition layout");
+        return -EIO;
+    }
+    if (first.start_offset != checkpoint_fa->fa_off || first.size != second.size ||
+        CHECKPOINT_SLOTS * first.size > checkpoint_fa->fa_size ||
+        sizeof(checkpoint_record_t) % flash_area_align(checkpoint_fa) != 0) {
+        LOG_ERR("The checkpoint needs two uniform, aligned sectors");
+        return -ENOTSUP;
+    }
+
+    slot_size = first.size;
+    return 0;
+}
+
+int fsm_checkpoint_init(uint8_t flash_area_id)
+{
+    struct k_work_sync sync;
+    size_t used[CHECKPOINT_SLOTS];
+    int ret;
+
+    // A previous instance may still be erasing.
+    k_work_flush(&spare_erase_work, &sync);
+
+    k_mutex_lock(&checkpoint_lock, K_FOREVER);
+
+    if (checkpoint_fa) {
+        flash_area_close(checkpoint_fa);
+        checkpoint_fa = NULL;
+    }
+    memset(&stats, 0, sizeof(stats));
+    newest_valid = false;
+    active_slot = 0;
+
+    ret = checkpoint_open(flash_area_id);
+    for (uint8_t slot = 0; ret == 0 && slot < CHECKPOINT_SLOTS; slot++) {
+        ret = scan_slot(slot, &used[slot]);
+    }
+    if (ret) {
+        LOG_ERR("Checkpoint init failed (%d)", ret);
+        if (checkpoint_fa) flash_area_close(checkpoint_fa);
+        checkpoint_fa = NULL;
+        k_mutex_unlock(&checkpoint_lock);
+        return ret;
+    }
+
+    write_offset = used[active_slot];
+    spare_erased = used[active_slot ^ 1] == 0;
+    if (!spare_erased) {
+        k_work_submit(&spare_erase_work);
+    }
+
+    if (newest_valid) {
+        LOG_INF("Checkpoint #%u found in sector %u", newest.seq, active_slot);
+    }
+    k_mutex_unlock(&checkpoint_lock);
+    return 0;
+}
+
+int fsm_checkpoint_save(fsm_snapshot_t *snapshot)
+{
+    uint32_t start = k_cycle_get_32();
+    checkpoint_record_t rec;
+    bool switched = false;
+    int ret;
+
+    if (!snapshot) {
+        return -EINVAL;
+    }
+
+    k_mutex_lock(&checkpoint_lock, K_FOREVER);
+
+    if (!checkpoint_fa) {
+        k_mutex_unlock(&checkpoint_lock);
+        return -ENODEV;
+    }
+
+    if (write_offset + sizeof(rec) > slot_size) {
+        if (!spare_erased) {
+            ret = -EBUSY;
+            goto out;
+        }
+        active_slot ^= 1;
+        write_offset = 0;
+        spare_erased = false;
+        switched = true;
+    }
+
+    record_pack(&rec, snapshot, newest_valid ? newest.seq + 1 : 1);
+    ret = flash_area_write(checkpoint_fa, slot_offset(active_slot) + write_offset,
+                           &rec, sizeof(rec));
+    // Never write the same spot twice, even after a failed write.
+    write_offset += sizeof(rec);
+    if (ret) {
+        goto out;
+    }
+
+    newest = rec;
+    newest_valid = true;
+    snapshot->seq = rec.seq;
+    stats.saves++;
+    if (switched) {
+        stats.slot_switches++;
+    }
+    // The sector just left, or one left by a failed save, is erased only
+    // now that a newer snapshot is on flash.
+    if (!spare_erased) {
+        k_work_submit(&spare_erase_work);
+    }
+
+out:
+    if (ret) {
+        stats.failures++;
+        LOG_ERR("Checkpoint save failed (%d)", ret);
+    }
+    stats.last_save_us = k_cyc_to_us_floor32(k_cycle_get_32() - start);
+    stats.max_save_us = MAX(stats.max_save_us, stats.last_save_us);
+    k_mutex_unlock(&checkpoint_lock);
+    return ret;
+}
+
+int fsm_checkpoint_restore(fsm_snapshot_t *snapshot)
+{
+    int ret = 0;
+
+    if (!snapshot) {
+        return -EINVAL;
+    }
+
+    k_mutex_lock(&checkpoint_lock, K_FOREVER);
+    if (!checkpoint_fa) {
+        ret = -ENODEV;
+    } else if (!newest_valid) {
+        ret = -ENOENT;
+    } else {
+        record_unpack(&newest, snapshot);
+    }
+    k_mutex_unlock(&checkpoint_lock);
+    return ret;
+}
+
+void fsm_checkpoint_get_stats(fsm_checkpoint_stats_t *out)
+{
+    if (!out) {
+        return;
+    }
+
+    k_mutex_lock(&checkpoint_lock, K_FOREVER);
+    *out = stats;
+    k_mutex_unlock(&checkpoint_lock);
+}
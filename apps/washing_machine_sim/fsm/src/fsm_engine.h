@@ -0,0 +1,108 @@
+#pragma once
+
+#include <stdint.h>
+#include "fsm.h"
+
+/**
+ * @brief Index of "no transition" in a machine's tables.
+ *
+ * Entry 0 of every transition pool is reserved, so zero-initialized table
+ * cells mean the event is ignored in that state.
+ */
+#define FSM_NO_TRANSITION 0
+
+/**
+ * @brief Returns true if the guarded transition may be taken.
+ */
+typedef bool (*fsm_guard_t)(const fsm_handle_t *fsm);
+
+/**
+ * @brief Runs after the state variable has been updated.
+ */
+typedef void (*fsm_action_t)(fsm_handle_t *fsm);
+
+/**
+ * @brief One edge of a state machine.
+ */
+typedef struct {
+    fsm_guard_t guard;      // NULL: always taken
+    fsm_action_t action;    // NULL: no action
+    uint8_t next_state;
+    uint8_t alternative;    // Transition tried when the guard fails
+} fsm_transition_t;
+
+/**
+ * @brief A state machine described by const tables.
+ *
+ * @c table is a [num_states][EVENT_ID_COUNT] array of indices into
+ * @c transitions. @c completion, if not NULL, holds per state a transition
+ * taken on any event; it is how the choice ("check") states resolve.
+ */
+typedef struct {
+    const fsm_transition_t *transitions;
+    const uint8_t *table;
+    const uint8_t *completion;
+    uint8_t num_states;
+} fsm_machine_t;
+
+/**
+ * @brief Walks the alternative chain starting at @p index.
+ *
+ * @return The first transition whose guard passes, or NULL.
+ */
+static inline const fsm_transition_t *fsm_engine_follow(const fsm_machine_t *machine,
+                                                        const fsm_handle_t *fsm,
+                                                        uint8_t index)
+{
+    while (index != FSM_NO_TRANSITION) {
+        const fsm_transition_t *transition = &machine->transitions[index];
+
+        if (!transition->guard || transition->guard(fsm)) {
+            return transition;
+        }
+        index = transition->alternative;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Looks up the transition @p event triggers in @p state.
+ *
+ * Constant time: one table load, then the guards of the (short)
+ * alternative chain.
+ *
+ * @return The transition to take, or NULL if the event is ignored.
+ */
+static inline const fsm_transition_t *fsm_engine_select(const fsm_machine_t *machine,
+                                                        const fsm_handle_t *fsm,
+                                                        unsigned int state, event_id_t event)
+{
+    uint8_t index = FSM_NO_TRANSITION;
+
+    if (state >= machine->num_states) {
+        return NULL;
+    }
+
+    if (machine->completion) {
+        index = machine->completion[state];
+    }
+    if (index == FSM_NO_TRANSITION && (unsigned int)event < EVENT_ID_COUNT) {
+        index = machine->table[state * EVENT_ID_COUNT + event];
+    }
+    return fsm_engine_follow(machine, fsm, index);
+}
+
+/**
+ * @brief Looks up the completion transition of @p state, ignoring events.
+ *
+ * @return The transition to take, or NULL if @p state has none.
+ */
+static inline const fsm_transition_t *fsm_engine_select_completion(const fsm_machine_t *machine,
+                                                                   const fsm_handle_t *fsm,
+                                                                   unsigned int state)
+{
+    if (!machine->completion || state >= machine->num_states) {
+        return NULL;
+    }
+    return fsm_engine_follow(machine, fsm, machine->completion[state]);
+}
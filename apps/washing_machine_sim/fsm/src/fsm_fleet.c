@@ -0,0 +1,143 @@
+#include "fsm_fleet.h"
+
+#include <errno.h>
+#include <zephyr/toolchain.h>
+#include <zephyr/sys/util.h>
+
+BUILD_ASSERT(FSM_FLEET_STATE_COUNT < UINT8_MAX, "combined state must fit a byte");
+
+// Marks table cells whose outcome depends on the programme flags, or on
+// anything else the table cannot see. Those events take the scalar path.
+#define FLEET_SLOW UINT8_MAX
+
+// Next combined state for every combined state and event, valid for any
+// programme. Built once from fsm_apply_event(), so it cannot drift from
+// the L1/L2 tables.
+static uint8_t fleet_next[FSM_FLEET_STATE_COUNT][EVENT_ID_COUNT];
+static bool fleet_table_built;
+
+static inline uint8_t fleet_pack(const fsm_handle_t *fsm)
+{
+    return fsm->system_state * STATE_L2_COUNT + fsm->wash_cycle_state;
+}
+
+static inline void fleet_unpack(fsm_handle_t *fsm, uint8_t state, uint8_t flags)
+{
+    fsm->system_state = state / STATE_L2_COUNT;
+    fsm->wash_cycle_state = state % STATE_L2_COUNT;
+    fsm->program_has_prewash = flags & FSM_FLEET_PREWASH;
+    fsm->program_has_heating = flags & FSM_FLEET_HEATING;
+    fsm->program_has_steam = flags & FSM_FLEET_STEAM;
+}
+
+static uint8_t fleet_apply_slow(uint8_t state, uint8_t flags, event_id_t event)
+{
+    // Only the states and flags are unpacked; the rest must read as unset.
+    fsm_handle_t fsm = { 0 };
+
+    fleet_unpack(&fsm, state, flags);
+    fsm_apply_event(&fsm, event);
+    return fleet_pack(&fsm);
+}
+
+static void fleet_build_table(void)
+{
+    const uint8_t all_flags = FSM_FLEET_PREWASH | FSM_FLEET_HEATING | FSM_FLEET_STEAM;
+
+    for (int state = 0; state < FSM_FLEET_STATE_COUNT; state++) {
+        for (int event = 0; event < EVENT_ID_COUNT; event++) {
+            uint8_t next = fleet_apply_slow(state, 0, event);
+
+            for (uint8_t flags = 1; flags <= all_flags; flags++) {
+                if (fleet_apply_slow(state, flags, event) != next) {
+                    next = FLEET_SLOW;
+                    break;
+                }
+            }
+            fleet_next[state][event] = next;
+        }
+    }
+    fleet_table_built = true;
+}
+
+int fsm_fleet_init(fsm_fleet_t *fleet)
+{
+    fsm_handle_t fsm;
+
+    if (!fleet) {
+        return -EINVAL;
+    }
+
+    if (!fleet_table_built) {
+        fleet_build_table();
+    }
+
+    fsm_init(&fsm);
+    for (int i = 0; i < fleet->num_machines; i++) {
+        fleet->state[i] = fleet_pack(&fsm);
+        fleet->flags[i] = 0;
+    }
+    return 0;
+}
+
+int fsm_fleet_set_program(fsm_fleet_t *fleet, uint16_t machine,
+                          bool prewash, bool heating, bool steam)
+{
+    if (!fleet || machine >= fleet->num_machines) {
+        return -EINVAL;
+    }
+
+    fleet->flags[machine] = (prewash ? FSM_FLEET_PREWASH : 0) |
+                            (heating ? FSM_FLEET_HEATING : 0) |
+                            (steam ? FSM_FLEET_STEAM : 0);
+    return 0;
+}
+
+int fsm_fleet_process_batch(fsm_fleet_t *fleet, const fsm_fleet_event_t *events, size_t count)
+{
+    int changes = 0;
+
+    if (!fleet || !events) {
+        return -EINVAL;
+    }
+
+    uint8_t *const state = fleet->state;
+    const uint16_t num_machines = fleet->num_machines;
+
+    // One table load per event. Events for the same machine must be
+    // applied in order, so this stays a plain loop rather than a gather.
+    for (size_t i = 0; i < count; i++) {
+        const uint16_t machine = events[i].machine;
+        const uint8_t event = events[i].event;
+
+        if (machine >= num_machines) {
+            continue;
+        }
+
+        const uint8_t current = state[machine];
+        uint8_t next = event < EVENT_ID_COUNT ? fleet_next[current][event] : FLEET_SLOW;
+
+        if (unlikely(next == FLEET_SLOW)) {
+            next = fleet_apply_slow(current, fleet->flags[machine], event);
+        }
+        changes += next != current;
+        state[machine] = next;
+    }
+    return changes;
+}
+
+system_state_t fsm_fleet_get_system_state(const fsm_fleet_t *fleet, uint16_t machine)
+{
+    if (!fleet || machine >= fleet->num_machines) {
+        return STATE_L1_POWER_OFF;
+    }
+    return fleet->state[machine] / STATE_L2_COUNT;
+}
+
+wash_cycle_state_t fsm_fleet_get_wash_cycle_state(const fsm_fleet_t *fleet, uint16_t machine)
+{
+    if (!fleet || machine >= fleet->num_machines) {
+        return STATE_L2_IDLE;
+    }
+    return fleet->state[machine] % STATE_L2_COUNT;
+}
@@ -0,0 +1,105 @@
+#include "fsm_notify.h"
+#include "event_bus.h"
+#include <errno.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_REGISTER(fsm_notify, CONFIG_LOG_DEFAULT_LEVEL);
+
+// All of this is only touched by the thread that processes the events.
+static const fsm_handle_t *notify_fsm;
+static bool coalesce;
+// States subscribers last heard of
+static system_state_t published_l1;
+static wash_cycle_state_t published_l2;
+static bool held;
+static fsm_notify_stats_t stats;
+
+static void publish(void)
+{
+    const fsm_state_change_t change = {
+        .old_l1 = published_l1,
+        .old_l2 = published_l2,
+        .new_l1 = notify_fsm->system_state,
+        .new_l2 = notify_fsm->wash_cycle_state,
+    };
+
+    held = false;
+    // Held changes that cancelled each other out leave nothing to say.
+    if (change.old_l1 == change.new_l1 && change.old_l2 == change.new_l2) {
+        return;
+    }
+
+    const app_event_t event = {
+        .id = EVENT_FSM_STATE_CHANGED,
+        .payload.u32 = fsm_state_change_pack(&change),
+    };
+
+    published_l1 = notify_fsm->system_state;
+    published_l2 = notify_fsm->wash_cycle_state;
+    stats.published++;
+    if (event_bus_post(&event) != 0) {
+        stats.failed++;
+        LOG_DBG("State change not delivered to every subscriber");
+    }
+}
+
+static void on_transition(const fsm_handle_t *fsm, system_state_t old_l1_state,
+                          wash_cycle_state_t old_l2_state)
+{
+    ARG_UNUSED(old_l2_state);
+
+    if (fsm != notify_fsm) {
+        return;
+    }
+    // A brownout is held as well: the controller has a checkpoint to take
+    // first and flushes right after it.
+    if (coalesce && (fsm->system_state == old_l1_state ||
+                     fsm->system_state == STATE_L1_BROWNOUT)) {
+        if (held) {
+            stats.coalesced++;
+        }
+        held = true;
+        return;
+    }
+    if (held) {
+        stats.coalesced++;
+    }
+    publish();
+}
+
+int fsm_notify_attach(const fsm_handle_t *fsm, bool coalesce_l2)
+{
+    if (!fsm) {
+        return -EINVAL;
+    }
+
+    notify_fsm = fsm;
+    coalesce = coalesce_l2;
+    published_l1 = fsm->system_state;
+    published_l2 = fsm->wash_cycle_state;
+    held = false;
+    stats = (fsm_notify_stats_t){ 0 };
+    fsm_set_transition_listener(on_transition);
+    return 0;
+}
+
+void fsm_notify_detach(void)
+{
+    fsm_set_transition_listener(NULL);
+    notify_fsm = NULL;
+    held = false;
+}
+
+void fsm_notify_flush(void)
+{
+    if (held && notify_fsm) {
+        publish();
+    }
+}
+
+void fsm_notify_get_stats(fsm_notify_stats_t *out)
+{
+    if (out) {
+        *out = stats;
+    }
+}
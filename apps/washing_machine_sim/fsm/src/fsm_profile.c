@@ -0,0 +1,281 @@
+#include "fsm_profile.h"
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/barrier.h>
+#include <zephyr/sys/math_extras.h>
+#include <string.h>
+
+uint8_t fsm_profile_attached;
+
+// One slot per profiled machine. Its lock serialises the writers of the
+// profile: the dispatcher recording an event, reset and re-attach. While
+// one of them is at work seq is odd, so snapshots can copy without the
+// lock and just retry when seq moved under them.
+typedef struct {
+    const fsm_handle_t *fsm;
+    fsm_profile_t *profile;
+    int64_t (*now_ms)(void);
+    struct k_spinlock lock;
+    atomic_t seq;
+} profile_slot_t;
+
+// registry_lock only orders attach and detach; it is taken before a slot
+// lock, never after.
+static struct k_spinlock registry_lock;
+static profile_slot_t slots[FSM_PROFILE_MAX_MACHINES];
+
+static profile_slot_t *find_slot(const fsm_handle_t *fsm)
+{
+    for (int i = 0; i < FSM_PROFILE_MAX_MACHINES; i++) {
+        if (slots[i].fsm == fsm && fsm) {
+            return &slots[i];
+        }
+    }
+    return NULL;
+}
+
+// Called with slot->lock held, around every change to the slot.
+static void write_begin(profile_slot_t *slot)
+{
+    // A full barrier: readers see seq odd before any of the writes.
+    atomic_inc(&slot->seq);
+}
+
+static void write_end(profile_slot_t *slot)
+{
+    atomic_inc(&slot->seq);
+}
+
+static void profile_clear(profile_slot_t *slot)
+{
+    fsm_profile_t *profile = slot->profile;
+    const int64_t now = slot->now_ms();
+
+    memset(profile, 0, sizeof(*profile));
+    profile->l1_entered_ms = now;
+    profile->l2_entered_ms = now;
+}
+
+static void count_edge(fsm_profile_t *profile, fsm_profile_level_t level, uint8_t from,
+                       event_id_t event, uint8_t to)
+{
+    for (int i = 0; i < profile->num_edges; i++) {
+        fsm_profile_edge_t *edge = &profile->edges[i];
+
+        if (edge->level == level && edge->from == from && edge->event == event && edge->to == to) {
+            edge->count++;
+            return;
+        }
+    }
+    if (profile->num_edges == FSM_PROFILE_MAX_EDGES) {
+        profile->edge_overflow++;
+        return;
+    }
+    profile->edges[profile->num_edges++] = (fsm_profile_edge_t){
+        .level = level,
+        .from = from,
+        .event = event,
+        .to = to,
+        .count = 1,
+    };
+}
+
+static void add_dwell(fsm_profile_dwell_t *dwell, int64_t entered_ms, int64_t now_ms)
+{
+    const int64_t elapsed = now_ms - entered_ms;
+    const uint32_t ms = elapsed < 0 ? 0 : (elapsed > UINT32_MAX ? UINT32_MAX : (uint32_t)elapsed);
+    uint32_t bucket = ms ? 32 - u32_count_leading_zeros(ms) : 0;
+
+    dwell->histogram[MIN(bucket, FSM_PROFILE_DWELL_BUCKETS - 1)]++;
+    dwell->count++;
+    dwell->total_ms += ms;
+    dwell->max_ms = MAX(dwell->max_ms, ms);
+}
+
+int fsm_profile_attach(const fsm_handle_t *fsm, fsm_profile_t *profile, int64_t (*now_ms)(void))
+{
+    if (!fsm || !profile) {
+        return -EINVAL;
+    }
+
+    k_spinlock_key_t registry_key = k_spin_lock(&registry_lock);
+    profile_slot_t *slot = find_slot(fsm);
+
+    if (!slot) {
+        for (int i = 0; !slot && i < FSM_PROFILE_MAX_MACHINES; i++) {
+            slot = slots[i].fsm ? NULL : &slots[i];
+        }
+        if (!slot) {
+            k_spin_unlock(&registry_lock, registry_key);
+            return -ENOMEM;
+        }
+        fsm_profile_attached++;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&slot->lock);
+
+    write_begin(slot);
+    slot->profile = profile;
+    slot->now_ms = now_ms ? now_ms : k_uptime_get;
+    profile_clear(slot);
+    slot->fsm = fsm;
+    write_end(slot);
+    k_spin_unlock(&slot->lock, key);
+    k_spin_unlock(&registry_lock, registry_key);
+    return 0;
+}
+
+int fsm_profile_detach(const fsm_handle_t *fsm)
+{
+    k_spinlock_key_t registry_key = k_spin_lock(&registry_lock);
+    profile_slot_t *slot = find_slot(fsm);
+
+    if (slot) {
+        k_spinlock_key_t key = k_spin_lock(&slot->lock);
+
+        write_begin(slot);
+        slot->fsm = NULL;
+        slot->profile = NULL;
+        write_end(slot);
+        k_spin_unlock(&slot->lock, key);
+        fsm_profile_attached--;
+    }
+    k_spin_unlock(&registry_lock, registry_key);
+    return slot ? 0 : -ENOENT;
+}
+
+/**
+ * @brief Finds the slot of @p fsm and takes its lock.
+ *
+ * The lookup runs without a lock; the machine is checked again once the
+ * slot is locked, in case it was detached meanwhile.
+ *
+ * @return The slot, or NULL if @p fsm is not profiled.
+ */
+static profile_slot_t *lock_slot(const fsm_handle_t *fsm, k_spinlock_key_t *key)
+{
+    profile_slot_t *slot = find_slot(fsm);
+
+    if (!slot) {
+        return NULL;
+    }
+    *key = k_spin_lock(&slot->lock);
+    if (slot->fsm != fsm) {
+        k_spin_unlock(&slot->lock, *key);
+        return NULL;
+    }
+    return slot;
+}
+
+int fsm_profile_reset(const fsm_handle_t *fsm)
+{
+    k_spinlock_key_t key;
+    profile_slot_t *slot = lock_slot(fsm, &key);
+
+    if (!slot) {
+        return -ENOENT;
+    }
+    write_begin(slot);
+    profile_clear(slot);
+    write_end(slot);
+    k_spin_unlock(&slot->lock, key);
+    return 0;
+}
+
+int fsm_profile_snapshot(const fsm_handle_t *fsm, fsm_profile_t *out)
+{
+    if (!out) {
+        return -EINVAL;
+    }
+
+    profile_slot_t *slot = find_slot(fsm);
+
+    if (!slot) {
+        return -ENOENT;
+    }
+
+    while (1) {
+        const atomic_val_t seq = atomic_get(&slot->seq);
+
+        // Writers hold the slot lock with interrupts off, so an odd seq
+        // only lasts while another CPU finishes its update.
+        if (seq & 1) {
+            continue;
+        }
+        const fsm_profile_t *profile = slot->profile;
+
+        if (slot->fsm != fsm || !profile) {
+            return -ENOENT;
+        }
+        *out = *profile;
+        // The copy has to be done before seq is checked again.
+        barrier_dmem_fence_full();
+        if (atomic_get(&slot->seq) == seq) {
+            return 0;
+        }
+    }
+}
+
+void fsm_profile_record(const fsm_handle_t *fsm, event_id_t event,
+                        system_state_t original_l1_state, wash_cycle_state_t original_l2_state)
+{
+    k_spinlock_key_t key;
+    profile_slot_t *slot = lock_slot(fsm, &key);
+
+    if (!slot) {
+        return;
+    }
+
+    fsm_profile_t *profile = slot->profile;
+    const int64_t now = slot->now_ms();
+    bool changed = false;
+
+    write_begin(slot);
+    profile->events++;
+    if (fsm->system_state != original_l1_state) {
+        count_edge(profile, FSM_PROFILE_L1, original_l1_state, event, fsm->system_state);
+        add_dwell(&profile->l1_dwell[original_l1_state], profile->l1_entered_ms, now);
+        profile->l1_entered_ms = now;
+        changed = true;
+    }
+    if (fsm->wash_cycle_state != original_l2_state) {
+        count_edge(profile, FSM_PROFILE_L2, original_l2_state, event, fsm->wash_cycle_state);
+        add_dwell(&profile->l2_dwell[original_l2_state], profile->l2_entered_ms, now);
+        profile->l2_entered_ms = now;
+        changed = true;
+    }
+
+    if (!changed) {
+        if (original_l1_state == STATE_L1_RUNNING) {
+            profile->l2_ignored[original_l2_state]++;
+        } else {
+            profile->l1_ignored[original_l1_state]++;
+        }
+        if ((unsigned int)event < EVENT_ID_COUNT) {
+            profile->ignored_by_event[event]++;
+        }
+    }
+    write_end(slot);
+    k_spin_unlock(&slot->lock, key);
+}
+
+void fsm_profile_record_completion(const fsm_handle_t *fsm, event_id_t event,
+                                   wash_cycle_state_t original_l2_state)
+{
+    k_spinlock_key_t key;
+    profile_slot_t *slot = lock_slot(fsm, &key);
+
+    if (!slot) {
+        return;
+    }
+
+    fsm_profile_t *profile = slot->profile;
+    const int64_t now = slot->now_ms();
+
+    write_begin(slot);
+    count_edge(profile, FSM_PROFILE_L2, original_l2_state, event, fsm->wash_cycle_state);
+    add_dwell(&profile->l2_dwell[original_l2_state], profile->l2_entered_ms, now);
+    profile->l2_entered_ms = now;
+    write_end(slot);
+    k_spin_unlock(&slot->lock, key);
+}
@@ -0,0 +1,45 @@
+#include "fsm_status.h"
+#include "wash_program.h"
+#include <zephyr/sys/barrier.h>
+
+void fsm_status_from_fsm(fsm_status_t *status, const fsm_handle_t *fsm)
+{
+    status->system_state = fsm->system_state;
+    status->wash_cycle_state = fsm->wash_cycle_state;
+    status->program_id = fsm->program_id;
+    status->options = (fsm->program_has_prewash ? WASH_PROGRAM_PREWASH : 0) |
+                      (fsm->program_has_heating ? WASH_PROGRAM_HEATING : 0) |
+                      (fsm->program_has_steam ? WASH_PROGRAM_STEAM : 0);
+}
+
+void fsm_status_publish(fsm_status_channel_t *channel, const fsm_status_t *status)
+{
+    // Single writer: nobody else moves seq, and readers only use the
+    // other slot until the increment below.
+    const uint32_t seq = (uint32_t)atomic_get(&channel->seq) + 1U;
+    fsm_status_t *next = &channel->slot[seq & 1U];
+
+    *next = *status;
+    next->seq = seq;
+    // The increment is a full barrier, so the copy is complete before any
+    // reader can pick this slot.
+    atomic_inc(&channel->seq);
+}
+
+uint32_t fsm_status_read(const fsm_status_channel_t *channel, fsm_status_t *out)
+{
+    uint32_t retries = 0;
+
+    while (1) {
+        const atomic_val_t seq = atomic_get(&channel->seq);
+
+        *out = channel->slot[seq & 1U];
+        // The copy has to be done before seq is checked again.
+        barrier_dmem_fence_full();
+        // Once the writer moved on, it may be overwriting our slot.
+        if (atomic_get(&channel->seq) == seq) {
+            return retries;
+        }
+        retries++;
+    }
+}
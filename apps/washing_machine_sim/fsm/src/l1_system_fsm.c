@@ -1,7 +1,27 @@
 #include "fsm.h"
+#include "fsm_engine.h"
 #include "l1_system_fsm.h"
 #include "l2_wash_cycle_fsm.h" // L1 needs to start/reset L2
 
+// --- Transition tables ---
+// Generated from model/l1_system.puml. The only actions are l2_fsm_start()
+// and l2_fsm_init(), declared in l2_wash_cycle_fsm.h.
+#include "l1_system_tables.inc"
+
+static bool l1_take(const fsm_machine_t *machine, fsm_handle_t *fsm, event_id_t event)
+{
+    const fsm_transition_t *t = fsm_engine_select(machine, fsm, fsm->system_state, event);
+
+    if (!t) {
+        return false;
+    }
+    fsm->system_state = t->next_state;
+    if (t->action) {
+        t->action(fsm);
+    }
+    return true;
+}
+
 void l1_fsm_init(fsm_handle_t *fsm)
 {
     if (fsm) {
@@ -11,24 +31,10 @@ void l1_fsm_init(fsm_handle_t *fsm)
 
 bool l1_system_process_override_events(fsm_handle_t *fsm, event_id_t event)
 {
-    if (!fsm || fsm->system_state != STATE_L1_RUNNING) {
+    if (!fsm) {
         return false;
     }
-
-    switch (event) {
-        case EVENT_PAUSE_BUTTON_PRESSED:
-            fsm->system_state = STATE_L1_PAUSED;
-            return true;
-        case EVENT_POWER_LOSS_DETECTED:
-            fsm->system_state = STATE_L1_BROWNOUT;
-            // In a real system, you would save state to NVM here
-            return true;
-        case EVENT_FATAL_FAULT_DETECTED:
-            fsm->system_state = STATE_L1_FAILURE;
-            return true;
-        default:
-            return false;
-    }
+    return l1_take(&l1_override_machine, fsm, event);
 }
 
 void l1_system_process_event(fsm_handle_t *fsm, event_id_t event)
@@ -36,71 +42,7 @@ void l1_system_process_event(fsm_handle_t *fsm, event_id_t event)
     if (!fsm) {
         return;
     }
-
-    switch (fsm->system_state) {
-        case STATE_L1_POWER_OFF:
-            if (event == EVENT_POWER_BUTTON_PRESSED) {
-                fsm->system_state = STATE_L1_STANDBY;
-            }
-            break;
-
-        case STATE_L1_STANDBY:
-            if (event == EVENT_CYCLE_SELECTED) {
-                fsm->system_state = STATE_L1_SELECTION;
-            } else if (event == EVENT_POWER_BUTTON_PRESSED) {
-                fsm->system_state = STATE_L1_POWER_OFF;
-            }
-            break;
-
-        case STATE_L1_SELECTION:
-            if (event == EVENT_START_BUTTON_PRESSED) {
-                fsm->system_state = STATE_L1_RUNNING;
-                // Activate the nested FSM
-                l2_fsm_start(fsm);
-            } else if (event == EVENT_POWER_BUTTON_PRESSED) {
-                fsm->system_state = STATE_L1_POWER_OFF;
-            }
-            break;
-
-        case STATE_L1_RUNNING:
-            // This state is only processed here for non-override events.
-            // The only such event is the completion signal from L2.
-            if (event == EVENT_CYCLE_FINISHED) {
-                fsm->system_state = STATE_L1_END;
-            }
-            break;
-
-        case STATE_L1_PAUSED:
-            if (event == EVENT_START_BUTTON_PRESSED) {
-                fsm->system_state = STATE_L1_RUNNING; // Resume
-            } else if (event == EVENT_CANCEL_BUTTON_PRESSED) {
-                fsm->system_state = STATE_L1_SELECTION;
-                l2_fsm_init(fsm); // Reset the L2 FSM to Idle
-            }
-            break;
-
-        case STATE_L1_END:
-            if (event == EVENT_ANY_KEY_PRESSED) {
-                fsm->system_state = STATE_L1_SELECTION;
-            }
-            break;
-
-        case STATE_L1_BROWNOUT:
-            if (event == EVENT_POWER_RESTORED) {
-                fsm->system_state = STATE_L1_RUNNING;
-            }
-            break;
-
-        case STATE_L1_FAILURE:
-            if (event == EVENT_POWER_BUTTON_PRESSED) {
-                fsm->system_state = STATE_L1_STANDBY;
-            }
-            break;
-        
-        default:
-            // No action needed for other states
-            break;
-    }
+    l1_take(&l1_machine, fsm, event);
 }
 
 system_state_t system_fsm_get_state(const fsm_handle_t *fsm)
@@ -109,4 +51,4 @@ system_state_t system_fsm_get_state(const fsm_handle_t *fsm)
         return fsm->system_state;
     }
     return STATE_L1_POWER_OFF; // Default state if fsm is NULL
-}
\ No newline at end of file
+}
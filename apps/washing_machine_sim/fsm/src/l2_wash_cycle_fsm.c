@@ -1,4 +1,14 @@
 #include "l2_wash_cycle_fsm.h"
+#include "fsm_engine.h"
+
+// --- Guards ---
+static bool has_prewash(const fsm_handle_t *fsm) { return fsm->program_has_prewash; }
+static bool has_heating(const fsm_handle_t *fsm) { return fsm->program_has_heating; }
+static bool has_steam(const fsm_handle_t *fsm) { return fsm->program_has_steam; }
+
+// --- Transition tables ---
+// Generated from model/l2_wash_cycle.puml, using the guards above.
+#include "l2_wash_cycle_tables.inc"
 
 void l2_fsm_init(fsm_handle_t *fsm)
 {
@@ -14,111 +24,30 @@ void l2_fsm_start(fsm_handle_t *fsm)
     }
 }
 
-void l2_wash_cycle_process_event(fsm_handle_t *fsm, event_id_t  event)
+static bool l2_take(const fsm_transition_t *t, fsm_handle_t *fsm)
+{
+    if (!t) {
+        return false;
+    }
+    fsm->wash_cycle_state = t->next_state;
+    if (t->action) {
+        t->action(fsm);
+    }
+    return true;
+}
+
+void l2_wash_cycle_process_event(fsm_handle_t *fsm, event_id_t event)
 {
     if (!fsm) {
         return;
     }
+    l2_take(fsm_engine_select(&l2_machine, fsm, fsm->wash_cycle_state, event), fsm);
+}
 
-    switch (fsm->wash_cycle_state) {
-        case STATE_L2_LOAD_SENSING:
-            if (event == EVENT_WEIGHT_CALCULATED) {
-                fsm->wash_cycle_state = STATE_L2_DOSING;
-            }
-            break;
-
-        case STATE_L2_DOSING:
-            if (event == EVENT_DOSING_COMPLETE) {
-                fsm->wash_cycle_state = STATE_L2_PREWASH_CHECK;
-            }
-            break;
-
-        case STATE_L2_PREWASH_CHECK:
-            if (fsm->program_has_prewash) {
-                fsm->wash_cycle_state = STATE_L2_PREWASH;
-            } else {
-                fsm->wash_cycle_state = STATE_L2_FILLING;
-            }
-            break;
-
-        case STATE_L2_PREWASH:
-            if (event == EVENT_TIMER_EXPIRED) {
-                fsm->wash_cycle_state = STATE_L2_DRAINING_PRE;
-            }
-            break;
-
-        case STATE_L2_DRAINING_PRE:
-            if (event == EVENT_DRUM_EMPTY) {
-                fsm->wash_cycle_state = STATE_L2_FILLING;
-            }
-            break;
-
-        case STATE_L2_FILLING:
-            if (event == EVENT_WATER_LEVEL_REACHED) {
-                fsm->wash_cycle_state = STATE_L2_HEATING_CHECK;
-            }
-            break;
-
-        case STATE_L2_HEATING_CHECK:
-            if (fsm->program_has_heating) {
-                fsm->wash_cycle_state = STATE_L2_HEATING;
-            } else {
-                fsm->wash_cycle_state = STATE_L2_WASHING;
-            }
-            break;
-
-        case STATE_L2_HEATING:
-            if (event == EVENT_TEMP_REACHED) {
-                fsm->wash_cycle_state = STATE_L2_WASHING;
-            }
-            break;
-
-        case STATE_L2_WASHING:
-            if (event == EVENT_TIMER_EXPIRED) {
-                fsm->wash_cycle_state = STATE_L2_DRAINING_WASH;
-            }
-            break;
-
-        case STATE_L2_DRAINING_WASH:
-            if (event == EVENT_DRUM_EMPTY) {
-                fsm->wash_cycle_state = STATE_L2_RINSING;
-            }
-            break;
-
-        case STATE_L2_RINSING:
-            if (event == EVENT_TIMER_EXPIRED) {
-                fsm->wash_cycle_state = STATE_L2_DRAINING_RINSE;
-            }
-            break;
-
-        case STATE_L2_DRAINING_RINSE:
-            if (event == EVENT_DRUM_EMPTY) {
-                fsm->wash_cycle_state = STATE_L2_SPINNING;
-            }
-            break;
-
-        case STATE_L2_SPINNING:
-            if (event == EVENT_TIMER_EXPIRED) {
-                fsm->wash_cycle_state = STATE_L2_STEAM_CHECK;
-            }
-            break;
-
-        case STATE_L2_STEAM_CHECK:
-            if (fsm->program_has_steam) {
-                fsm->wash_cycle_state = STATE_L2_STEAMING;
-            } else {
-                fsm->wash_cycle_state = STATE_L2_COMPLETE;
-            }
-            break;
-
-        case STATE_L2_STEAMING:
-            if (event == EVENT_TIMER_EXPIRED) {
-                fsm->wash_cycle_state = STATE_L2_COMPLETE;
-            }
-            break;
-
-        default:
-            // No action needed for IDLE or COMPLETE states here.
-            break;
+bool l2_wash_cycle_run_completion(fsm_handle_t *fsm)
+{
+    if (!fsm) {
+        return false;
     }
+    return l2_take(fsm_engine_select_completion(&l2_machine, fsm, fsm->wash_cycle_state), fsm);
 }
@@ -34,3 +34,15 @@ void l2_fsm_start(fsm_handle_t *fsm);
  * @param event The event to process.
  */
 void l2_wash_cycle_process_event(fsm_handle_t *fsm, event_id_t event);
+
+/**
+ * @brief Takes the completion transition of the current L2 state, if any.
+ *
+ * The check states have one, chosen by the programme options. The
+ * dispatcher calls this after every event so they never wait for the
+ * next one.
+ *
+ * @param fsm A pointer to the FSM handle.
+ * @return true if a transition was taken.
+ */
+bool l2_wash_cycle_run_completion(fsm_handle_t *fsm);
@@ -0,0 +1,274 @@
+#include "wash_program.h"
+
+#include <errno.h>
+#include <zephyr/toolchain.h>
+
+// Phases only programmes with the option run
+static const uint8_t phase_option[STATE_L2_COUNT] = {
+    [STATE_L2_PREWASH] = WASH_PROGRAM_PREWASH,
+    [STATE_L2_DRAINING_PRE] = WASH_PROGRAM_PREWASH,
+    [STATE_L2_HEATING] = WASH_PROGRAM_HEATING,
+    [STATE_L2_STEAMING] = WASH_PROGRAM_STEAM,
+};
+
+// Sensor-driven phases take about as long in every programme.
+#define PLANT_PHASES                        \
+    [STATE_L2_LOAD_SENSING] = 30,           \
+    [STATE_L2_DOSING] = 20,                 \
+    [STATE_L2_DRAINING_PRE] = 60,           \
+    [STATE_L2_FILLING] = 90,                \
+    [STATE_L2_DRAINING_WASH] = 60,          \
+    [STATE_L2_DRAINING_RINSE] = 60
+
+static const wash_program_t programs[WASH_PROGRAM_COUNT] = {
+    [WASH_PROGRAM_NORMAL] = {
+        .name = "Normal",
+        .options = 0,
+        .target_temp_c = 40,
+        .rinse_count = 1,
+        .water_level_pct = 60,
+        .wash_rpm = 50,
+        .spin_rpm = 1200,
+        .phase_s = {
+            PLANT_PHASES,
+            [STATE_L2_PREWASH] = 600,
+            [STATE_L2_HEATING] = 600,
+            [STATE_L2_WASHING] = 1800,
+            [STATE_L2_RINSING] = 720,
+            [STATE_L2_SPINNING] = 480,
+            [STATE_L2_STEAMING] = 900,
+        },
+    },
+    [WASH_PROGRAM_COTTON] = {
+        .name = "Cotton",
+        .options = WASH_PROGRAM_HEATING,
+        .target_temp_c = 60,
+        .rinse_count = 2,
+        .water_level_pct = 70,
+        .wash_rpm = 55,
+        .spin_rpm = 1400,
+        .phase_s = {
+            PLANT_PHASES,
+            [STATE_L2_PREWASH] = 600,
+            [STATE_L2_HEATING] = 900,
+            [STATE_L2_WASHING] = 2700,
+            [STATE_L2_RINSING] = 600,
+            [STATE_L2_SPINNING] = 600,
+            [STATE_L2_STEAMING] = 900,
+        },
+    },
+    [WASH_PROGRAM_SYNTHETICS] = {
+        .name = "Synthetics",
+        .options = WASH_PROGRAM_HEATING,
+        .target_temp_c = 40,
+        .rinse_count = 2,
+        .water_level_pct = 60,
+        .wash_rpm = 45,
+        .spin_rpm = 800,
+        .phase_s = {
+            PLANT_PHASES,
+            [STATE_L2_PREWASH] = 480,
+            [STATE_L2_HEATING] = 480,
+            [STATE_L2_WASHING] = 1800,
+            [STATE_L2_RINSING] = 540,
+            [STATE_L2_SPINNING] = 360,
+            [STATE_L2_STEAMING] = 600,
+        },
+    },
+    [WASH_PROGRAM_QUICK] = {
+        .name = "Quick",
+        .options = 0,
+        .target_temp_c = 30,
+        .rinse_count = 1,
+        .water_level_pct = 50,
+        .wash_rpm = 50,
+        .spin_rpm = 1000,
+        .phase_s = {
+            PLANT_PHASES,
+            [STATE_L2_PREWASH] = 300,
+            [STATE_L2_HEATING] = 300,
+            [STATE_L2_WASHING] = 900,
+            [STATE_L2_RINSING] = 300,
+            [STATE_L2_SPINNING] = 300,
+            [STATE_L2_STEAMING] = 300,
+        },
+    },
+    [WASH_PROGRAM_DELICATES] = {
+        .name = "Delicates",
+        .options = 0,
+        .target_temp_c = 30,
+        .rinse_count = 2,
+        .water_level_pct = 80,
+        .wash_rpm = 30,
+        .spin_rpm = 600,
+        .phase_s = {
+            PLANT_PHASES,
+            [STATE_L2_PREWASH] = 300,
+            [STATE_L2_HEATING] = 300,
+            [STATE_L2_WASHING] = 1200,
+            [STATE_L2_RINSING] = 480,
+            [STATE_L2_SPINNING] = 240,
+            [STATE_L2_STEAMING] = 600,
+        },
+    },
+    [WASH_PROGRAM_INTENSIVE] = {
+        .name = "Intensive",
+        .options = WASH_PROGRAM_PREWASH | WASH_PROGRAM_HEATING | WASH_PROGRAM_STEAM,
+        .target_temp_c = 90,
+        .rinse_count = 3,
+        .water_level_pct = 80,
+        .wash_rpm = 55,
+        .spin_rpm = 1400,
+        .phase_s = {
+            PLANT_PHASES,
+            [STATE_L2_PREWASH] = 900,
+            [STATE_L2_HEATING] = 1500,
+            [STATE_L2_WASHING] = 3600,
+            [STATE_L2_RINSING] = 600,
+            [STATE_L2_SPINNING] = 720,
+            [STATE_L2_STEAMING] = 1200,
+        },
+    },
+};
+
+const wash_program_t *wash_program_get(uint32_t id)
+{
+    return id < WASH_PROGRAM_COUNT ? &programs[id] : NULL;
+}
+
+int wash_program_select(fsm_handle_t *fsm, uint32_t id)
+{
+    const wash_program_t *program = wash_program_get(id);
+
+    if (!fsm || !program) {
+        return -EINVAL;
+    }
+
+    fsm->program_id = id;
+    fsm->program_has_prewash = program->options & WASH_PROGRAM_PREWASH;
+    fsm->program_has_heating = program->options & WASH_PROGRAM_HEATING;
+    fsm->program_has_steam = program->options & WASH_PROGRAM_STEAM;
+    return 0;
+}
+
+static uint8_t program_options(const fsm_handle_t *fsm)
+{
+    return (fsm->program_has_prewash ? WASH_PROGRAM_PREWASH : 0) |
+           (fsm->program_has_heating ? WASH_PROGRAM_HEATING : 0) |
+           (fsm->program_has_steam ? WASH_PROGRAM_STEAM : 0);
+}
+
+uint32_t wash_program_phase_ms(const fsm_handle_t *fsm, wash_cycle_state_t state)
+{
+    if (!fsm || (unsigned int)state >= STATE_L2_COUNT ||
+        (phase_option[state] & ~program_options(fsm))) {
+        return 0;
+    }
+
+    const wash_program_t *program = wash_program_get(fsm->program_id);
+
+    if (!program) {
+        program = &programs[WASH_PROGRAM_NORMAL];
+    }
+
+    uint32_t ms = program->phase_s[state] * 1000U;
+
+    if (state == STATE_L2_RINSING) {
+        ms *= MAX(program->rinse_count, 1);
+    }
+    return ms;
+}
+
+uint32_t wash_program_timeout_ms(const fsm_handle_t *fsm, wash_cycle_state_t state)
+{
+    const uint32_t model_ms = fsm_get_wash_cycle_state_timeout_ms(state);
+
+    if (model_ms == 0) {
+        return 0;
+    }
+
+    // A programme without a time for a timed phase keeps the model's.
+    const uint32_t ms = wash_program_phase_ms(fsm, state);
+
+    return ms ? ms : model_ms;
+}
+
+// --- Estimator ---
+
+static uint16_t plan_key(const fsm_handle_t *fsm)
+{
+    return (fsm->program_id << 8) | program_options(fsm);
+}
+
+// Works out the time still to come after each phase. The only O(states)
+// step, taken when the programme changes.
+static void estimate_plan(wash_estimate_t *est, const fsm_handle_t *fsm)
+{
+    uint32_t after = 0;
+
+    for (int state = STATE_L2_COUNT - 1; state >= 0; state--) {
+        est->after_ms[state] = after;
+        after += wash_program_phase_ms(fsm, state);
+    }
+    est->plan_key = plan_key(fsm);
+}
+
+static void estimate_enter(wash_estimate_t *est, const fsm_handle_t *fsm, int64_t now_ms)
+{
+    est->phase = fsm->wash_cycle_state;
+    est->phase_ms = wash_program_phase_ms(fsm, fsm->wash_cycle_state);
+    est->phase_done_ms = 0;
+    est->running_since_ms = fsm->system_state == STATE_L1_RUNNING ? now_ms : -1;
+}
+
+void wash_estimate_init(wash_estimate_t *est, const fsm_handle_t *fsm,
+                        uint32_t phase_elapsed_ms, int64_t now_ms)
+{
+    if (!est || !fsm) {
+        return;
+    }
+
+    estimate_plan(est, fsm);
+    estimate_enter(est, fsm, now_ms);
+    est->phase_done_ms = phase_elapsed_ms;
+}
+
+void wash_estimate_update(wash_estimate_t *est, const fsm_handle_t *fsm, int64_t now_ms)
+{
+    if (!est || !fsm) {
+        return;
+    }
+
+    // The programme only changes while L2 is idle, so the plan is checked
+    // there and on the way in and out.
+    if ((est->phase == STATE_L2_IDLE || fsm->wash_cycle_state == STATE_L2_IDLE) &&
+        plan_key(fsm) != est->plan_key) {
+        estimate_plan(est, fsm);
+    }
+
+    const bool running = fsm->system_state == STATE_L1_RUNNING;
+
+    if (fsm->wash_cycle_state != est->phase) {
+        estimate_enter(est, fsm, now_ms);
+    } else if (running && est->running_since_ms < 0) {
+        est->running_since_ms = now_ms;
+    } else if (!running && est->running_since_ms >= 0) {
+        est->phase_done_ms += now_ms - est->running_since_ms;
+        est->running_since_ms = -1;
+    }
+}
+
+uint32_t wash_estimate_remaining_ms(const wash_estimate_t *est, int64_t now_ms)
+{
+    if (!est) {
+        return 0;
+    }
+
+    uint64_t done = est->phase_done_ms;
+
+    if (est->running_since_ms >= 0 && now_ms > est->running_since_ms) {
+        done += now_ms - est->running_since_ms;
+    }
+    // A phase that overruns its plan is assumed to be about to end.
+    return est->after_ms[est->phase] + (done < est->phase_ms ? est->phase_ms - (uint32_t)done : 0);
+}
@@ -0,0 +1,127 @@
+#include <zephyr/ztest.h>
+#include <zephyr/kernel.h>
+#include <zephyr/storage/flash_map.h>
+#include "fsm_checkpoint.h"
+
+#define CHECKPOINT_PARTITION FIXED_PARTITION_ID(storage_partition)
+#define RECORD_SIZE 32
+
+static fsm_snapshot_t make_snapshot(uint32_t elapsed_ms)
+{
+    fsm_snapshot_t snapshot = {
+        .fsm = {
+            .system_state = STATE_L1_BROWNOUT,
+            .wash_cycle_state = STATE_L2_RINSING,
+            .program_has_prewash = true,
+            .program_has_steam = true,
+            .program_id = 3,
+        },
+        .phase_elapsed_ms = elapsed_ms,
+        .timer_remaining_ms = 90000 - elapsed_ms,
+    };
+    return snapshot;
+}
+
+static void fsm_checkpoint_before(void *data)
+{
+    const struct flash_area *fa;
+
+    ARG_UNUSED(data);
+
+    zassert_ok(flash_area_open(CHECKPOINT_PARTITION, &fa));
+    zassert_ok(flash_area_erase(fa, 0, fa->fa_size));
+    flash_area_close(fa);
+
+    zassert_ok(fsm_checkpoint_init(CHECKPOINT_PARTITION));
+}
+
+// --- Test Cases ---
+
+ZTEST(fsm_checkpoint_suite, test_empty_area_has_no_snapshot)
+{
+    fsm_snapshot_t snapshot;
+
+    zassert_equal(fsm_checkpoint_restore(&snapshot), -ENOENT);
+}
+
+ZTEST(fsm_checkpoint_suite, test_snapshot_survives_reboot)
+{
+    fsm_snapshot_t saved = make_snapshot(41000);
+    fsm_snapshot_t restored;
+
+    zassert_ok(fsm_checkpoint_save(&saved));
+    zassert_equal(saved.seq, 1, "First snapshot should be #1");
+
+    // Simulate a reset: the only state left is on flash.
+    zassert_ok(fsm_checkpoint_init(CHECKPOINT_PARTITION));
+    zassert_ok(fsm_checkpoint_restore(&restored));
+
+    zassert_equal(restored.fsm.system_state, STATE_L1_BROWNOUT);
+    zassert_equal(restored.fsm.wash_cycle_state, STATE_L2_RINSING);
+    zassert_true(restored.fsm.program_has_prewash);
+    zassert_false(restored.fsm.program_has_heating);
+    zassert_true(restored.fsm.program_has_steam);
+    zassert_equal(restored.fsm.program_id, 3);
+    zassert_equal(restored.phase_elapsed_ms, 41000);
+    zassert_equal(restored.timer_remaining_ms, 49000);
+    zassert_equal(restored.seq, 1);
+}
+
+ZTEST(fsm_checkpoint_suite, test_newest_snapshot_wins_across_sectors)
+{
+    fsm_checkpoint_stats_t stats;
+    fsm_snapshot_t snapshot;
+    uint32_t i;
+
+    // Fill both sectors, then come back to the first one.
+    for (i = 1; i < 10000; i++) {
+        snapshot = make_snapshot(i);
+        zassert_ok(fsm_checkpoint_save(&snapshot), "save %u failed", i);
+        // Let the system work queue erase the spare sector.
+        k_yield();
+        fsm_checkpoint_get_stats(&stats);
+        if (stats.slot_switches == 2) {
+            break;
+        }
+    }
+    zassert_equal(stats.slot_switches, 2, "Saves never wrapped around");
+    zassert_equal(stats.saves, i);
+    zassert_equal(stats.failures, 0);
+
+    zassert_ok(fsm_checkpoint_init(CHECKPOINT_PARTITION));
+    zassert_ok(fsm_checkpoint_restore(&snapshot));
+    zassert_equal(snapshot.seq, i, "Restored an older snapshot");
+    zassert_equal(snapshot.phase_elapsed_ms, i);
+}
+
+ZTEST(fsm_checkpoint_suite, test_torn_save_keeps_previous_snapshot)
+{
+    const struct flash_area *fa;
+    uint8_t torn[RECORD_SIZE / 2] = { 0 };
+    fsm_snapshot_t snapshot;
+
+    for (uint32_t i = 1; i <= 3; i++) {
+        snapshot = make_snapshot(i * 1000);
+        zassert_ok(fsm_checkpoint_save(&snapshot));
+    }
+
+    // Power fails halfway through writing snapshot #4.
+    zassert_ok(flash_area_open(CHECKPOINT_PARTITION, &fa));
+    zassert_ok(flash_area_write(fa, 3 * RECORD_SIZE, torn, sizeof(torn)));
+    flash_area_close(fa);
+
+    zassert_ok(fsm_checkpoint_init(CHECKPOINT_PARTITION));
+    zassert_ok(fsm_checkpoint_restore(&snapshot));
+    zassert_equal(snapshot.seq, 3);
+    zassert_equal(snapshot.phase_elapsed_ms, 3000);
+
+    // The next save goes after the torn record.
+    snapshot = make_snapshot(4000);
+    zassert_ok(fsm_checkpoint_save(&snapshot));
+    zassert_ok(fsm_checkpoint_init(CHECKPOINT_PARTITION));
+    zassert_ok(fsm_checkpoint_restore(&snapshot));
+    zassert_equal(snapshot.seq, 4);
+    zassert_equal(snapshot.phase_elapsed_ms, 4000);
+}
+
+ZTEST_SUITE(fsm_checkpoint_suite, NULL, NULL, fsm_checkpoint_before, NULL, NULL);
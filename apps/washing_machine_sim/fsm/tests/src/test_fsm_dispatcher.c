@@ -76,6 +76,105 @@ ZTEST(fsm_dispatcher_suite, test_l2_completion_event_promotion_to_l1)
     zassert_equal(fsm.system_state, STATE_L1_END, "L1 should transition to END after L2 completes");
 }
 
+ZTEST(fsm_dispatcher_suite, test_check_states_resolve_in_same_step)
+{
+    fsm.system_state = STATE_L1_RUNNING;
+    fsm.wash_cycle_state = STATE_L2_DOSING;
+    fsm.program_has_prewash = true;
+
+    // DOSING -> PREWASH_CHECK -> PREWASH without waiting for another event
+    fsm_process_event(&fsm, EVENT_DOSING_COMPLETE);
+    zassert_equal(fsm.wash_cycle_state, STATE_L2_PREWASH, "Pre-wash check should resolve immediately");
+
+    fsm.wash_cycle_state = STATE_L2_FILLING;
+    fsm_process_event(&fsm, EVENT_WATER_LEVEL_REACHED);
+    zassert_equal(fsm.wash_cycle_state, STATE_L2_WASHING, "Heating check should resolve immediately");
+}
+
+ZTEST(fsm_dispatcher_suite, test_cycle_finishes_without_extra_event)
+{
+    fsm.system_state = STATE_L1_RUNNING;
+    fsm.wash_cycle_state = STATE_L2_SPINNING;
+
+    // SPINNING -> STEAM_CHECK -> COMPLETE, then EVENT_CYCLE_FINISHED to L1
+    fsm_process_event(&fsm, EVENT_TIMER_EXPIRED);
+    zassert_equal(fsm.wash_cycle_state, STATE_L2_COMPLETE, "Steam check should resolve immediately");
+    zassert_equal(fsm.system_state, STATE_L1_END, "L1 should reach END in the same step");
+}
+
+ZTEST(fsm_dispatcher_suite, test_full_cycle_needs_only_real_events)
+{
+    static const event_id_t events[] = {
+        EVENT_POWER_BUTTON_PRESSED, EVENT_CYCLE_SELECTED, EVENT_START_BUTTON_PRESSED,
+        EVENT_WEIGHT_CALCULATED, EVENT_DOSING_COMPLETE,
+        EVENT_TIMER_EXPIRED, EVENT_DRUM_EMPTY,              // Pre-wash
+        EVENT_WATER_LEVEL_REACHED, EVENT_TEMP_REACHED,      // Heating
+        EVENT_TIMER_EXPIRED, EVENT_DRUM_EMPTY,              // Wash
+        EVENT_TIMER_EXPIRED, EVENT_DRUM_EMPTY,              // Rinse
+        EVENT_TIMER_EXPIRED,                                // Spin
+        EVENT_TIMER_EXPIRED,                                // Steam
+    };
+
+    fsm.program_has_prewash = true;
+    fsm.program_has_heating = true;
+    fsm.program_has_steam = true;
+
+    for (int i = 0; i < ARRAY_SIZE(events); i++) {
+        fsm_process_event(&fsm, events[i]);
+    }
+    zassert_equal(fsm.wash_cycle_state, STATE_L2_COMPLETE, "L2 cycle should be complete");
+    zassert_equal(fsm.system_state, STATE_L1_END, "L1 should be in END");
+}
+
+static int listener_calls;
+static system_state_t listener_old_l1;
+static wash_cycle_state_t listener_old_l2;
+
+static void record_transition(const fsm_handle_t *handle, system_state_t old_l1_state,
+                              wash_cycle_state_t old_l2_state)
+{
+    zassert_equal_ptr(handle, &fsm);
+    listener_calls++;
+    listener_old_l1 = old_l1_state;
+    listener_old_l2 = old_l2_state;
+}
+
+ZTEST(fsm_dispatcher_suite, test_transition_listener)
+{
+    listener_calls = 0;
+    fsm_set_transition_listener(record_transition);
+
+    fsm_process_event(&fsm, EVENT_POWER_BUTTON_PRESSED);
+    zassert_equal(listener_calls, 1);
+    zassert_equal(listener_old_l1, STATE_L1_POWER_OFF);
+    zassert_equal(listener_old_l2, STATE_L2_IDLE);
+
+    // Ignored in STANDBY, nothing changes.
+    fsm_process_event(&fsm, EVENT_DRUM_EMPTY);
+    zassert_equal(listener_calls, 1, "Called without a transition");
+
+    // Restoring a state is not a transition.
+    fsm_apply_event(&fsm, EVENT_CYCLE_SELECTED);
+    zassert_equal(listener_calls, 1, "Called from fsm_apply_event()");
+
+    // One call per event, even when L1 and L2 both move.
+    fsm.system_state = STATE_L1_RUNNING;
+    fsm.wash_cycle_state = STATE_L2_SPINNING;
+    fsm_process_event(&fsm, EVENT_TIMER_EXPIRED);
+    zassert_equal(listener_calls, 2);
+    zassert_equal(listener_old_l1, STATE_L1_RUNNING);
+    zassert_equal(listener_old_l2, STATE_L2_SPINNING);
+
+    fsm_set_transition_listener(NULL);
+}
+
+ZTEST(fsm_dispatcher_suite, test_state_names_from_model)
+{
+    // Names come from the state declarations in fsm/model/*.puml.
+    zassert_str_equal(fsm_get_system_state_name(STATE_L1_POWER_OFF), "Power Off");
+    zassert_str_equal(fsm_get_wash_cycle_state_name(STATE_L2_DRAINING_RINSE), "Draining (Rinse)");
+    zassert_str_equal(fsm_get_wash_cycle_state_name(STATE_L2_COUNT), "Unknown L2");
+}
 
 // --- Test Suite Definition ---
 ZTEST_SUITE(fsm_dispatcher_suite, NULL, NULL, fsm_dispatcher_before, NULL, NULL);
\ No newline at end of file
@@ -0,0 +1,143 @@
+#include <zephyr/ztest.h>
+#include "fsm.h"
+#include "fsm_fleet.h"
+
+#define FLEET_SIZE 16
+#define STREAM_LENGTH 20000
+
+FSM_FLEET_DEFINE(test_fleet, FLEET_SIZE);
+
+// Reference: one scalar handle per machine
+static fsm_handle_t reference[FLEET_SIZE];
+
+static uint32_t lcg_state;
+
+static uint32_t lcg_next(void)
+{
+    lcg_state = lcg_state * 1664525u + 1013904223u;
+    return lcg_state >> 8;
+}
+
+static void fsm_fleet_before(void *data)
+{
+    ARG_UNUSED(data);
+
+    zassert_ok(fsm_fleet_init(&test_fleet));
+    for (int i = 0; i < FLEET_SIZE; i++) {
+        fsm_init(&reference[i]);
+    }
+    lcg_state = 12345;
+}
+
+static void assert_matches_reference(void)
+{
+    for (uint16_t i = 0; i < FLEET_SIZE; i++) {
+        zassert_equal(fsm_fleet_get_system_state(&test_fleet, i), reference[i].system_state,
+                      "L1 mismatch on machine %u", i);
+        zassert_equal(fsm_fleet_get_wash_cycle_state(&test_fleet, i), reference[i].wash_cycle_state,
+                      "L2 mismatch on machine %u", i);
+    }
+}
+
+// --- Test Cases ---
+
+ZTEST(fsm_fleet_suite, test_initial_state)
+{
+    assert_matches_reference();
+    zassert_equal(fsm_fleet_get_system_state(&test_fleet, 0), STATE_L1_POWER_OFF);
+    zassert_equal(fsm_fleet_get_wash_cycle_state(&test_fleet, 0), STATE_L2_IDLE);
+}
+
+ZTEST(fsm_fleet_suite, test_full_cycle_one_machine)
+{
+    static const fsm_fleet_event_t cycle[] = {
+        { 3, EVENT_POWER_BUTTON_PRESSED },
+        { 3, EVENT_CYCLE_SELECTED },
+        { 3, EVENT_START_BUTTON_PRESSED },
+        { 3, EVENT_WEIGHT_CALCULATED },
+        { 3, EVENT_DOSING_COMPLETE },
+        { 3, EVENT_WATER_LEVEL_REACHED },
+        { 3, EVENT_TIMER_EXPIRED },
+        { 3, EVENT_DRUM_EMPTY },
+        { 3, EVENT_TIMER_EXPIRED },
+        { 3, EVENT_DRUM_EMPTY },
+        { 3, EVENT_TIMER_EXPIRED },
+    };
+
+    zassert_equal(fsm_fleet_process_batch(&test_fleet, cycle, ARRAY_SIZE(cycle)),
+                  ARRAY_SIZE(cycle), "every event should change state");
+    zassert_equal(fsm_fleet_get_system_state(&test_fleet, 3), STATE_L1_END);
+    zassert_equal(fsm_fleet_get_wash_cycle_state(&test_fleet, 3), STATE_L2_COMPLETE);
+    // The other machines did not move
+    zassert_equal(fsm_fleet_get_system_state(&test_fleet, 2), STATE_L1_POWER_OFF);
+}
+
+ZTEST(fsm_fleet_suite, test_program_flags_are_per_machine)
+{
+    fsm_fleet_event_t start[2 * 5];
+    static const event_id_t to_prewash_check[] = {
+        EVENT_POWER_BUTTON_PRESSED, EVENT_CYCLE_SELECTED, EVENT_START_BUTTON_PRESSED,
+        EVENT_WEIGHT_CALCULATED, EVENT_DOSING_COMPLETE,
+    };
+
+    zassert_ok(fsm_fleet_set_program(&test_fleet, 1, true, false, false));
+    for (int i = 0; i < ARRAY_SIZE(to_prewash_check); i++) {
+        start[2 * i] = (fsm_fleet_event_t){ 0, to_prewash_check[i] };
+        start[2 * i + 1] = (fsm_fleet_event_t){ 1, to_prewash_check[i] };
+    }
+    fsm_fleet_process_batch(&test_fleet, start, ARRAY_SIZE(start));
+
+    zassert_equal(fsm_fleet_get_wash_cycle_state(&test_fleet, 0), STATE_L2_FILLING);
+    zassert_equal(fsm_fleet_get_wash_cycle_state(&test_fleet, 1), STATE_L2_PREWASH);
+}
+
+ZTEST(fsm_fleet_suite, test_bad_arguments)
+{
+    const fsm_fleet_event_t outside = { FLEET_SIZE, EVENT_POWER_BUTTON_PRESSED };
+
+    zassert_equal(fsm_fleet_init(NULL), -EINVAL);
+    zassert_equal(fsm_fleet_set_program(&test_fleet, FLEET_SIZE, true, true, true), -EINVAL);
+    zassert_equal(fsm_fleet_process_batch(&test_fleet, NULL, 1), -EINVAL);
+    zassert_equal(fsm_fleet_process_batch(&test_fleet, &outside, 1), 0,
+                  "events for unknown machines should be skipped");
+    assert_matches_reference();
+}
+
+/**
+ * @brief A long random stream leaves every machine where the scalar
+ * dispatcher would.
+ */
+ZTEST(fsm_fleet_suite, test_batch_matches_scalar)
+{
+    static fsm_fleet_event_t stream[STREAM_LENGTH];
+    int expected_changes = 0;
+
+    for (uint16_t i = 0; i < FLEET_SIZE; i++) {
+        bool prewash = i & 1, heating = i & 2, steam = i & 4;
+
+        fsm_fleet_set_program(&test_fleet, i, prewash, heating, steam);
+        reference[i].program_has_prewash = prewash;
+        reference[i].program_has_heating = heating;
+        reference[i].program_has_steam = steam;
+    }
+
+    // Includes out-of-range events, which every state ignores
+    for (int i = 0; i < STREAM_LENGTH; i++) {
+        stream[i].machine = lcg_next() % FLEET_SIZE;
+        stream[i].event = lcg_next() % (EVENT_ID_COUNT + 2);
+    }
+
+    for (int i = 0; i < STREAM_LENGTH; i++) {
+        fsm_handle_t *fsm = &reference[stream[i].machine];
+        fsm_handle_t before = *fsm;
+
+        fsm_apply_event(fsm, stream[i].event);
+        expected_changes += before.system_state != fsm->system_state ||
+                            before.wash_cycle_state != fsm->wash_cycle_state;
+    }
+
+    zassert_equal(fsm_fleet_process_batch(&test_fleet, stream, STREAM_LENGTH), expected_changes);
+    assert_matches_reference();
+}
+
+ZTEST_SUITE(fsm_fleet_suite, NULL, NULL, fsm_fleet_before, NULL, NULL);
@@ -0,0 +1,258 @@
+#include <zephyr/ztest.h>
+#include "fsm.h"
+#include "fsm_profile.h"
+
+static fsm_handle_t fsm;
+static fsm_profile_t profile;
+static fsm_profile_t snapshot;
+static int64_t fake_now_ms;
+
+static int64_t fake_clock(void)
+{
+    return fake_now_ms;
+}
+
+static void fsm_profile_before(void *data)
+{
+    ARG_UNUSED(data);
+
+    fake_now_ms = 0;
+    fsm_init(&fsm);
+    zassert_ok(fsm_profile_attach(&fsm, &profile, fake_clock));
+}
+
+static void fsm_profile_after(void *data)
+{
+    ARG_UNUSED(data);
+
+    fsm_profile_detach(&fsm);
+}
+
+// Processes @p event @p ms after the previous one.
+static void process_at(int64_t ms, event_id_t event)
+{
+    fake_now_ms += ms;
+    fsm_process_event(&fsm, event);
+}
+
+static uint32_t edge_count(fsm_profile_level_t level, uint8_t from, event_id_t event, uint8_t to)
+{
+    for (int i = 0; i < snapshot.num_edges; i++) {
+        const fsm_profile_edge_t *edge = &snapshot.edges[i];
+
+        if (edge->level == level && edge->from == from && edge->event == event && edge->to == to) {
+            return edge->count;
+        }
+    }
+    return 0;
+}
+
+ZTEST(fsm_profile_suite, test_counts_transitions)
+{
+    for (int i = 0; i < 3; i++) {
+        process_at(1, EVENT_POWER_BUTTON_PRESSED);
+        process_at(1, EVENT_POWER_BUTTON_PRESSED);
+    }
+    process_at(1, EVENT_POWER_BUTTON_PRESSED);
+    process_at(1, EVENT_CYCLE_SELECTED);
+    process_at(1, EVENT_START_BUTTON_PRESSED);
+
+    zassert_ok(fsm_profile_snapshot(&fsm, &snapshot));
+    zassert_equal(snapshot.events, 9);
+    zassert_equal(edge_count(FSM_PROFILE_L1, STATE_L1_POWER_OFF, EVENT_POWER_BUTTON_PRESSED,
+                             STATE_L1_STANDBY), 4);
+    zassert_equal(edge_count(FSM_PROFILE_L1, STATE_L1_STANDBY, EVENT_POWER_BUTTON_PRESSED,
+                             STATE_L1_POWER_OFF), 3);
+    zassert_equal(edge_count(FSM_PROFILE_L1, STATE_L1_SELECTION, EVENT_START_BUTTON_PRESSED,
+                             STATE_L1_RUNNING), 1);
+    // Start also moves L2 out of IDLE: both levels see the same event.
+    zassert_equal(edge_count(FSM_PROFILE_L2, STATE_L2_IDLE, EVENT_START_BUTTON_PRESSED,
+                             STATE_L2_LOAD_SENSING), 1);
+    zassert_equal(snapshot.edge_overflow, 0);
+}
+
+ZTEST(fsm_profile_suite, test_dwell_times)
+{
+    process_at(0, EVENT_POWER_BUTTON_PRESSED);
+    process_at(1000, EVENT_CYCLE_SELECTED);
+    process_at(5, EVENT_START_BUTTON_PRESSED);
+    process_at(30000, EVENT_WEIGHT_CALCULATED);
+
+    zassert_ok(fsm_profile_snapshot(&fsm, &snapshot));
+
+    const fsm_profile_dwell_t *standby = &snapshot.l1_dwell[STATE_L1_STANDBY];
+    const fsm_profile_dwell_t *selection = &snapshot.l1_dwell[STATE_L1_SELECTION];
+    const fsm_profile_dwell_t *load_sensing = &snapshot.l2_dwell[STATE_L2_LOAD_SENSING];
+
+    zassert_equal(standby->count, 1);
+    zassert_equal(standby->total_ms, 1000);
+    zassert_equal(standby->histogram[10], 1, "1000 ms is not in [512, 1024)");
+    zassert_equal(selection->max_ms, 5);
+    zassert_equal(selection->histogram[3], 1, "5 ms is not in [4, 8)");
+    zassert_equal(load_sensing->count, 1);
+    zassert_equal(load_sensing->max_ms, 30000);
+    // The current state has not been left yet.
+    zassert_equal(snapshot.l1_dwell[STATE_L1_RUNNING].count, 0);
+}
+
+ZTEST(fsm_profile_suite, test_counts_ignored_events)
+{
+    process_at(1, EVENT_START_BUTTON_PRESSED);
+    process_at(1, EVENT_DRUM_EMPTY);
+    process_at(1, EVENT_POWER_BUTTON_PRESSED);
+    process_at(1, EVENT_CYCLE_SELECTED);
+    process_at(1, EVENT_START_BUTTON_PRESSED);
+    // Load sensing only waits for the weight.
+    process_at(1, EVENT_DRUM_EMPTY);
+    process_at(1, EVENT_DRUM_EMPTY);
+
+    zassert_ok(fsm_profile_snapshot(&fsm, &snapshot));
+    zassert_equal(snapshot.l1_ignored[STATE_L1_POWER_OFF], 2);
+    zassert_equal(snapshot.l2_ignored[STATE_L2_LOAD_SENSING], 2);
+    zassert_equal(snapshot.l1_ignored[STATE_L1_RUNNING], 0,
+                  "Events ignored while running are counted by L2 state");
+    zassert_equal(snapshot.ignored_by_event[EVENT_DRUM_EMPTY], 3);
+    zassert_equal(snapshot.ignored_by_event[EVENT_START_BUTTON_PRESSED], 1);
+}
+
+ZTEST(fsm_profile_suite, test_records_every_step_of_a_chain)
+{
+    process_at(1, EVENT_POWER_BUTTON_PRESSED);
+    process_at(1, EVENT_CYCLE_SELECTED);
+    process_at(1, EVENT_START_BUTTON_PRESSED);
+    process_at(1, EVENT_WEIGHT_CALCULATED);
+    // Dosing -> Pre-Wash Check -> Filling in one call
+    process_at(1, EVENT_DOSING_COMPLETE);
+    process_at(1, EVENT_WATER_LEVEL_REACHED);
+    process_at(1, EVENT_TIMER_EXPIRED);
+    process_at(1, EVENT_DRUM_EMPTY);
+    process_at(1, EVENT_TIMER_EXPIRED);
+    process_at(1, EVENT_DRUM_EMPTY);
+    // Spinning -> Steam Check -> Complete, then L1 Running -> End on the
+    // internal EVENT_CYCLE_FINISHED
+    process_at(1, EVENT_TIMER_EXPIRED);
+
+    zassert_ok(fsm_profile_snapshot(&fsm, &snapshot));
+    zassert_equal(fsm.system_state, STATE_L1_END);
+    zassert_equal(edge_count(FSM_PROFILE_L2, STATE_L2_DOSING, EVENT_DOSING_COMPLETE,
+                             STATE_L2_PREWASH_CHECK), 1);
+    zassert_equal(edge_count(FSM_PROFILE_L2, STATE_L2_PREWASH_CHECK, EVENT_DOSING_COMPLETE,
+                             STATE_L2_FILLING), 1);
+    zassert_equal(edge_count(FSM_PROFILE_L2, STATE_L2_STEAM_CHECK, EVENT_TIMER_EXPIRED,
+                             STATE_L2_COMPLETE), 1);
+    zassert_equal(snapshot.l2_dwell[STATE_L2_PREWASH_CHECK].count, 1,
+                  "Check state visit lost");
+    zassert_equal(snapshot.l2_dwell[STATE_L2_PREWASH_CHECK].total_ms, 0);
+    zassert_equal(edge_count(FSM_PROFILE_L1, STATE_L1_RUNNING, EVENT_CYCLE_FINISHED,
+                             STATE_L1_END), 1, "End not credited to the internal event");
+    zassert_equal(edge_count(FSM_PROFILE_L1, STATE_L1_RUNNING, EVENT_TIMER_EXPIRED,
+                             STATE_L1_END), 0);
+    // Eleven external events and the internal one
+    zassert_equal(snapshot.events, 12);
+}
+
+ZTEST(fsm_profile_suite, test_reset_and_detach)
+{
+    fsm_handle_t other;
+
+    process_at(1, EVENT_POWER_BUTTON_PRESSED);
+    zassert_ok(fsm_profile_reset(&fsm));
+    zassert_ok(fsm_profile_snapshot(&fsm, &snapshot));
+    zassert_equal(snapshot.events, 0);
+    zassert_equal(snapshot.num_edges, 0);
+
+    fsm_init(&other);
+    zassert_equal(fsm_profile_snapshot(&other, &snapshot), -ENOENT);
+    zassert_equal(fsm_profile_reset(&other), -ENOENT);
+    zassert_equal(fsm_profile_attach(NULL, &profile, NULL), -EINVAL);
+
+    zassert_ok(fsm_profile_detach(&fsm));
+    zassert_equal(fsm_profile_detach(&fsm), -ENOENT);
+    zassert_equal(fsm_profile_attached, 0);
+    process_at(1, EVENT_POWER_BUTTON_PRESSED);
+    zassert_equal(fsm.system_state, STATE_L1_POWER_OFF, "Unprofiled machine stopped working");
+}
+
+ZTEST(fsm_profile_suite, test_machine_limit)
+{
+    static fsm_handle_t others[FSM_PROFILE_MAX_MACHINES];
+    static fsm_profile_t other_profiles[FSM_PROFILE_MAX_MACHINES];
+
+    for (int i = 0; i < FSM_PROFILE_MAX_MACHINES - 1; i++) {
+        fsm_init(&others[i]);
+        zassert_ok(fsm_profile_attach(&others[i], &other_profiles[i], fake_clock));
+    }
+    fsm_init(&others[FSM_PROFILE_MAX_MACHINES - 1]);
+    zassert_equal(fsm_profile_attach(&others[FSM_PROFILE_MAX_MACHINES - 1],
+                                     &other_profiles[FSM_PROFILE_MAX_MACHINES - 1], fake_clock),
+                  -ENOMEM);
+    // Attaching again swaps the profile instead of taking a slot.
+    zassert_ok(fsm_profile_attach(&fsm, &profile, fake_clock));
+
+    for (int i = 0; i < FSM_PROFILE_MAX_MACHINES - 1; i++) {
+        zassert_ok(fsm_profile_detach(&others[i]));
+    }
+}
+
+// --- Concurrent snapshots ---
+
+#define STRESS_EVENTS 20000
+#define STRESS_STACK_SIZE 2048
+
+K_THREAD_STACK_DEFINE(recorder_stack, STRESS_STACK_SIZE);
+static struct k_thread recorder_thread;
+static atomic_t recorder_done;
+
+static void recorder_entry(void *p1, void *p2, void *p3)
+{
+    ARG_UNUSED(p1);
+    ARG_UNUSED(p2);
+    ARG_UNUSED(p3);
+
+    for (uint32_t n = 1; n <= STRESS_EVENTS; n++) {
+        fsm_process_event(&fsm, EVENT_POWER_BUTTON_PRESSED);
+        // Let the reader in at varying points of the update.
+        if ((n * 2654435761u) >> 29 == 0) {
+            k_yield();
+        }
+    }
+    atomic_set(&recorder_done, 1);
+}
+
+/**
+ * @brief Snapshots taken while another thread records are whole: every
+ * event of a power toggle is one transition, and no count goes back.
+ */
+ZTEST(fsm_profile_suite, test_snapshot_while_recording)
+{
+    uint32_t snapshots = 0;
+    uint32_t last_events = 0;
+
+    atomic_set(&recorder_done, 0);
+    k_thread_create(&recorder_thread, recorder_stack, K_THREAD_STACK_SIZEOF(recorder_stack),
+                    recorder_entry, NULL, NULL, NULL, k_thread_priority_get(k_current_get()),
+                    0, K_NO_WAIT);
+
+    while (!atomic_get(&recorder_done)) {
+        zassert_ok(fsm_profile_snapshot(&fsm, &snapshot));
+        const uint32_t on = edge_count(FSM_PROFILE_L1, STATE_L1_POWER_OFF,
+                                       EVENT_POWER_BUTTON_PRESSED, STATE_L1_STANDBY);
+        const uint32_t off = edge_count(FSM_PROFILE_L1, STATE_L1_STANDBY,
+                                        EVENT_POWER_BUTTON_PRESSED, STATE_L1_POWER_OFF);
+
+        zassert_equal(on + off, snapshot.events, "Torn snapshot: %u + %u edges for %u events",
+                      on, off, snapshot.events);
+        zassert_true(snapshot.events >= last_events, "Snapshot went back");
+        last_events = snapshot.events;
+        snapshots++;
+        k_yield();
+    }
+    zassert_ok(k_thread_join(&recorder_thread, K_SECONDS(10)), "Recorder did not finish");
+
+    zassert_ok(fsm_profile_snapshot(&fsm, &snapshot));
+    TC_PRINT("%u snapshots\n", snapshots);
+    zassert_true(snapshots > 0, "Never snapshotted while recording");
+    zassert_equal(snapshot.events, STRESS_EVENTS);
+}
+
+ZTEST_SUITE(fsm_profile_suite, NULL, NULL, fsm_profile_before, fsm_profile_after, NULL);
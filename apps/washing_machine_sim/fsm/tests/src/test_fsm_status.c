@@ -0,0 +1,181 @@
+#include <zephyr/ztest.h>
+#include <zephyr/kernel.h>
+#include <string.h>
+#include "fsm.h"
+#include "fsm_status.h"
+#include "wash_program.h"
+
+#define STRESS_PUBLICATIONS 100000
+#define STRESS_READERS 3
+#define STRESS_STACK_SIZE 1024
+
+static fsm_status_channel_t channel;
+
+// Every field follows from n, so a reader can tell a torn copy.
+static void make_status(fsm_status_t *status, uint32_t n)
+{
+    *status = (fsm_status_t){
+        .system_state = n % STATE_L1_COUNT,
+        .wash_cycle_state = n % STATE_L2_COUNT,
+        .program_id = n % WASH_PROGRAM_COUNT,
+        .options = n & 7,
+        .phase_start_ms = n,
+        .phase_timeout_ms = n * 3,
+        .remaining_ms = ~n,
+        .published_ms = n ^ 0x5a5a5a5a,
+    };
+}
+
+static bool status_is_consistent(const fsm_status_t *status, uint32_t n)
+{
+    fsm_status_t expected;
+
+    make_status(&expected, n);
+    expected.seq = status->seq;
+    return memcmp(status, &expected, sizeof(expected)) == 0;
+}
+
+static void fsm_status_before(void *data)
+{
+    ARG_UNUSED(data);
+
+    memset(&channel, 0, sizeof(channel));
+}
+
+ZTEST(fsm_status_suite, test_read_returns_the_latest_publication)
+{
+    fsm_status_t status;
+    fsm_status_t out;
+
+    zassert_equal(fsm_status_read(&channel, &out), 0);
+    zassert_equal(out.seq, 0, "Status before the first publication");
+
+    for (uint32_t n = 1; n <= 3; n++) {
+        make_status(&status, n);
+        fsm_status_publish(&channel, &status);
+        zassert_equal(fsm_status_read(&channel, &out), 0, "Retried without a writer");
+        zassert_equal(out.seq, n);
+        zassert_true(status_is_consistent(&out, n));
+    }
+}
+
+ZTEST(fsm_status_suite, test_from_fsm)
+{
+    fsm_handle_t fsm;
+    fsm_status_t status = { 0 };
+
+    fsm_init(&fsm);
+    zassert_ok(wash_program_select(&fsm, WASH_PROGRAM_COTTON));
+    fsm_process_event(&fsm, EVENT_POWER_BUTTON_PRESSED);
+    fsm_status_from_fsm(&status, &fsm);
+
+    zassert_equal(status.system_state, STATE_L1_STANDBY);
+    zassert_equal(status.wash_cycle_state, STATE_L2_IDLE);
+    zassert_equal(status.program_id, WASH_PROGRAM_COTTON);
+    zassert_equal(status.options, wash_program_get(WASH_PROGRAM_COTTON)->options);
+}
+
+// --- Stress ---
+
+K_THREAD_STACK_ARRAY_DEFINE(reader_stacks, STRESS_READERS, STRESS_STACK_SIZE);
+K_THREAD_STACK_DEFINE(writer_stack, STRESS_STACK_SIZE);
+static struct k_thread reader_threads[STRESS_READERS];
+static struct k_thread writer_thread;
+
+typedef struct {
+    uint32_t reads;
+    uint32_t retries;
+    uint32_t torn;          // Copies mixing two publications
+    uint32_t backwards;     // Copies older than one read before
+} reader_result_t;
+
+static reader_result_t reader_results[STRESS_READERS];
+static atomic_t writer_done;
+
+static void writer_entry(void *p1, void *p2, void *p3)
+{
+    fsm_status_t status;
+
+    ARG_UNUSED(p1);
+    ARG_UNUSED(p2);
+    ARG_UNUSED(p3);
+
+    for (uint32_t n = 1; n <= STRESS_PUBLICATIONS; n++) {
+        make_status(&status, n);
+        fsm_status_publish(&channel, &status);
+        // Let the readers in at varying points of the sequence.
+        if ((n * 2654435761u) >> 29 == 0) {
+            k_yield();
+        }
+    }
+    atomic_set(&writer_done, 1);
+}
+
+static void reader_entry(void *p1, void *p2, void *p3)
+{
+    reader_result_t *result = p1;
+    uint32_t last_seq = 0;
+    fsm_status_t status;
+
+    ARG_UNUSED(p2);
+    ARG_UNUSED(p3);
+
+    while (!atomic_get(&writer_done)) {
+        result->retries += fsm_status_read(&channel, &status);
+        result->reads++;
+        // seq 0 is the cleared channel before the first publication.
+        if (status.seq != 0 && !status_is_consistent(&status, status.seq)) {
+            result->torn++;
+        }
+        if (status.seq < last_seq) {
+            result->backwards++;
+        }
+        last_seq = status.seq;
+        k_yield();
+    }
+}
+
+/**
+ * @brief One writer publishing as fast as it can against several readers:
+ * every copy is whole and none goes back.
+ *
+ * All threads share one priority and yield to each other at varying
+ * points. On an SMP target they also run truly in parallel.
+ */
+ZTEST(fsm_status_suite, test_concurrent_readers_and_writer)
+{
+    const int priority = K_PRIO_PREEMPT(5);
+    fsm_status_t last;
+
+    atomic_set(&writer_done, 0);
+    memset(reader_results, 0, sizeof(reader_results));
+
+    for (int i = 0; i < STRESS_READERS; i++) {
+        k_thread_create(&reader_threads[i], reader_stacks[i],
+                        K_THREAD_STACK_SIZEOF(reader_stacks[i]), reader_entry,
+                        &reader_results[i], NULL, NULL, priority, 0, K_NO_WAIT);
+    }
+    k_thread_create(&writer_thread, writer_stack, K_THREAD_STACK_SIZEOF(writer_stack),
+                    writer_entry, NULL, NULL, NULL, priority, 0, K_NO_WAIT);
+
+    zassert_ok(k_thread_join(&writer_thread, K_SECONDS(60)), "Writer did not finish");
+    for (int i = 0; i < STRESS_READERS; i++) {
+        zassert_ok(k_thread_join(&reader_threads[i], K_SECONDS(10)), "Reader %d stuck", i);
+    }
+
+    for (int i = 0; i < STRESS_READERS; i++) {
+        const reader_result_t *result = &reader_results[i];
+
+        TC_PRINT("reader %d: %u reads, %u retries\n", i, result->reads, result->retries);
+        zassert_true(result->reads > 0, "Reader %d never ran", i);
+        zassert_equal(result->torn, 0, "Reader %d saw %u torn copies", i, result->torn);
+        zassert_equal(result->backwards, 0, "Reader %d went back %u times", i,
+                      result->backwards);
+    }
+
+    fsm_status_read(&channel, &last);
+    zassert_equal(last.seq, STRESS_PUBLICATIONS);
+    zassert_true(status_is_consistent(&last, STRESS_PUBLICATIONS));
+}
+
+ZTEST_SUITE(fsm_status_suite, NULL, NULL, fsm_status_before, NULL, NULL);
@@ -133,8 +133,10 @@ ZTEST(l1_fsm_suite, test_recovery_state_transitions)
 {
     // Test End state recovery
     fsm.system_state = STATE_L1_END;
+    fsm.wash_cycle_state = STATE_L2_COMPLETE;
     l1_system_process_event(&fsm, EVENT_ANY_KEY_PRESSED);
     zassert_equal(fsm.system_state, STATE_L1_SELECTION, "Failed to transition from END to SELECTION");
+    zassert_equal(fsm.wash_cycle_state, STATE_L2_IDLE, "L2 FSM was not reset after the cycle");
 
     // Test Brownout recovery
     fsm.system_state = STATE_L1_BROWNOUT;
@@ -143,8 +145,10 @@ ZTEST(l1_fsm_suite, test_recovery_state_transitions)
 
     // Test Failure recovery
     fsm.system_state = STATE_L1_FAILURE;
+    fsm.wash_cycle_state = STATE_L2_RINSING;
     l1_system_process_event(&fsm, EVENT_POWER_BUTTON_PRESSED);
     zassert_equal(fsm.system_state, STATE_L1_STANDBY, "Failed to recover from FAILURE to STANDBY");
+    zassert_equal(fsm.wash_cycle_state, STATE_L2_IDLE, "L2 FSM was not reset after the failure");
 }
 
 
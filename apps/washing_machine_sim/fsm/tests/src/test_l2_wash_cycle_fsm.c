@@ -105,6 +105,36 @@ ZTEST(l2_fsm_suite, test_steam_path_is_taken)
     zassert_equal(fsm.wash_cycle_state, STATE_L2_STEAMING, "Did not enter Steaming state when required");
 }
 
+ZTEST(l2_fsm_suite, test_unhandled_events_are_ignored)
+{
+    fsm.wash_cycle_state = STATE_L2_WASHING;
+
+    l2_wash_cycle_process_event(&fsm, EVENT_DRUM_EMPTY);
+    zassert_equal(fsm.wash_cycle_state, STATE_L2_WASHING, "Unhandled event changed the state");
+
+    // Out-of-range IDs must not index past the transition table.
+    l2_wash_cycle_process_event(&fsm, EVENT_ID_COUNT);
+    zassert_equal(fsm.wash_cycle_state, STATE_L2_WASHING, "Out-of-range event changed the state");
+}
+
+ZTEST(l2_fsm_suite, test_timed_phases_leave_on_expiry)
+{
+    int timed = 0;
+
+    for (int state = 0; state < STATE_L2_COUNT; state++) {
+        if (fsm_get_wash_cycle_state_timeout_ms(state) == 0) {
+            continue;
+        }
+        timed++;
+        fsm.wash_cycle_state = state;
+        l2_wash_cycle_process_event(&fsm, EVENT_TIMER_EXPIRED);
+        zassert_not_equal(fsm.wash_cycle_state, state, "%s did not time out",
+                          fsm_get_wash_cycle_state_name(state));
+    }
+    zassert_true(timed > 0, "No phase declares a timeout");
+    zassert_equal(fsm_get_wash_cycle_state_timeout_ms(STATE_L2_FILLING), 0,
+                  "Sensor-driven phases must not time out");
+}
 
 // --- Test Suite Definition ---
 ZTEST_SUITE(l2_fsm_suite, NULL, NULL, l2_fsm_before, NULL, NULL);
@@ -0,0 +1,191 @@
+#include <zephyr/ztest.h>
+#include "fsm.h"
+#include "wash_program.h"
+
+static fsm_handle_t fsm;
+static wash_estimate_t estimate;
+static int64_t now_ms;
+
+static void wash_program_before(void *data)
+{
+    ARG_UNUSED(data);
+
+    now_ms = 0;
+    fsm_init(&fsm);
+    wash_estimate_init(&estimate, &fsm, 0, now_ms);
+}
+
+// Processes @p event @p ms after the previous one and updates the estimate.
+static void process_at(int64_t ms, event_id_t event)
+{
+    now_ms += ms;
+    fsm_process_event(&fsm, event);
+    wash_estimate_update(&estimate, &fsm, now_ms);
+}
+
+// Sum of the programme's phases for the machine's current flags
+static uint32_t planned_cycle_ms(void)
+{
+    uint32_t total = 0;
+
+    for (int state = 0; state < STATE_L2_COUNT; state++) {
+        total += wash_program_phase_ms(&fsm, state);
+    }
+    return total;
+}
+
+ZTEST(wash_program_suite, test_select_sets_the_programme)
+{
+    const wash_program_t *intensive = wash_program_get(WASH_PROGRAM_INTENSIVE);
+
+    zassert_not_null(intensive);
+    zassert_ok(wash_program_select(&fsm, WASH_PROGRAM_INTENSIVE));
+    zassert_equal(fsm.program_id, WASH_PROGRAM_INTENSIVE);
+    zassert_true(fsm.program_has_prewash && fsm.program_has_heating && fsm.program_has_steam);
+
+    zassert_ok(wash_program_select(&fsm, WASH_PROGRAM_QUICK));
+    zassert_false(fsm.program_has_prewash || fsm.program_has_heating || fsm.program_has_steam);
+
+    zassert_equal(wash_program_select(&fsm, WASH_PROGRAM_COUNT), -EINVAL);
+    zassert_equal(fsm.program_id, WASH_PROGRAM_QUICK, "A bad ID changed the programme");
+    zassert_is_null(wash_program_get(WASH_PROGRAM_COUNT));
+}
+
+ZTEST(wash_program_suite, test_phase_times_follow_the_programme)
+{
+    const wash_program_t *cotton = wash_program_get(WASH_PROGRAM_COTTON);
+
+    zassert_ok(wash_program_select(&fsm, WASH_PROGRAM_COTTON));
+    zassert_equal(wash_program_timeout_ms(&fsm, STATE_L2_WASHING),
+                  cotton->phase_s[STATE_L2_WASHING] * 1000U);
+    zassert_equal(wash_program_timeout_ms(&fsm, STATE_L2_RINSING),
+                  cotton->rinse_count * cotton->phase_s[STATE_L2_RINSING] * 1000U,
+                  "Rinses do not run back to back");
+    // Untimed phases have no timeout, skipped ones take no time.
+    zassert_equal(wash_program_timeout_ms(&fsm, STATE_L2_FILLING), 0);
+    zassert_equal(wash_program_phase_ms(&fsm, STATE_L2_STEAMING), 0);
+
+    // The default programme runs the phases as long as the model says.
+    zassert_ok(wash_program_select(&fsm, WASH_PROGRAM_NORMAL));
+    for (int state = 0; state < STATE_L2_COUNT; state++) {
+        zassert_equal(wash_program_timeout_ms(&fsm, state),
+                      fsm_get_wash_cycle_state_timeout_ms(state), "%s",
+                      fsm_get_wash_cycle_state_name(state));
+    }
+}
+
+/**
+ * @brief Every timed phase of every programme has a time, and the cycle
+ * visits the L2 states in declaration order, which the estimator's plan
+ * relies on.
+ */
+ZTEST(wash_program_suite, test_programmes_fit_the_model)
+{
+    static const event_id_t events[] = {
+        EVENT_POWER_BUTTON_PRESSED, EVENT_CYCLE_SELECTED, EVENT_START_BUTTON_PRESSED,
+        EVENT_WEIGHT_CALCULATED, EVENT_DOSING_COMPLETE, EVENT_TIMER_EXPIRED,
+        EVENT_DRUM_EMPTY, EVENT_WATER_LEVEL_REACHED, EVENT_TEMP_REACHED,
+        EVENT_TIMER_EXPIRED, EVENT_DRUM_EMPTY, EVENT_TIMER_EXPIRED,
+        EVENT_DRUM_EMPTY, EVENT_TIMER_EXPIRED, EVENT_TIMER_EXPIRED,
+    };
+
+    for (uint32_t id = 0; id < WASH_PROGRAM_COUNT; id++) {
+        const wash_program_t *program = wash_program_get(id);
+
+        for (int state = 0; state < STATE_L2_COUNT; state++) {
+            zassert_true(fsm_get_wash_cycle_state_timeout_ms(state) == 0 ||
+                         program->phase_s[state] > 0, "%s has no time for %s",
+                         program->name, fsm_get_wash_cycle_state_name(state));
+        }
+        zassert_true(program->rinse_count > 0, "%s never rinses", program->name);
+
+        fsm_init(&fsm);
+        zassert_ok(wash_program_select(&fsm, id));
+        for (int i = 0; i < ARRAY_SIZE(events); i++) {
+            wash_cycle_state_t before = fsm.wash_cycle_state;
+
+            fsm_process_event(&fsm, events[i]);
+            zassert_true(fsm.wash_cycle_state >= before, "%s went back from %s to %s",
+                         program->name, fsm_get_wash_cycle_state_name(before),
+                         fsm_get_wash_cycle_state_name(fsm.wash_cycle_state));
+        }
+        zassert_equal(fsm.system_state, STATE_L1_END, "%s did not finish", program->name);
+    }
+}
+
+ZTEST(wash_program_suite, test_estimate_counts_down)
+{
+    const wash_program_t *synthetics = wash_program_get(WASH_PROGRAM_SYNTHETICS);
+
+    process_at(0, EVENT_POWER_BUTTON_PRESSED);
+    process_at(0, EVENT_CYCLE_SELECTED);
+    zassert_ok(wash_program_select(&fsm, WASH_PROGRAM_SYNTHETICS));
+    wash_estimate_update(&estimate, &fsm, now_ms);
+
+    const uint32_t total = planned_cycle_ms();
+
+    zassert_equal(wash_estimate_remaining_ms(&estimate, now_ms), total,
+                  "Not the whole cycle before the start");
+    // Selection time is not cycle time.
+    zassert_equal(wash_estimate_remaining_ms(&estimate, now_ms + 60000), total);
+
+    process_at(60000, EVENT_START_BUTTON_PRESSED);
+    zassert_equal(wash_estimate_remaining_ms(&estimate, now_ms + 10000), total - 10000);
+
+    // Load sensing finishes early: the estimate drops by what was saved.
+    process_at(10000, EVENT_WEIGHT_CALCULATED);
+    zassert_equal(wash_estimate_remaining_ms(&estimate, now_ms),
+                  total - synthetics->phase_s[STATE_L2_LOAD_SENSING] * 1000U);
+
+    // Dosing overruns: the estimate stops at the end of the phase.
+    zassert_equal(wash_estimate_remaining_ms(&estimate, now_ms + 3600000),
+                  total - (synthetics->phase_s[STATE_L2_LOAD_SENSING] +
+                           synthetics->phase_s[STATE_L2_DOSING]) * 1000U);
+}
+
+ZTEST(wash_program_suite, test_pause_holds_the_estimate)
+{
+    process_at(0, EVENT_POWER_BUTTON_PRESSED);
+    process_at(0, EVENT_CYCLE_SELECTED);
+    process_at(0, EVENT_START_BUTTON_PRESSED);
+    process_at(0, EVENT_WEIGHT_CALCULATED);
+    process_at(0, EVENT_DOSING_COMPLETE);
+    process_at(0, EVENT_WATER_LEVEL_REACHED);
+    zassert_equal(fsm.wash_cycle_state, STATE_L2_WASHING);
+
+    const uint32_t washing = wash_estimate_remaining_ms(&estimate, now_ms);
+
+    process_at(600000, EVENT_PAUSE_BUTTON_PRESSED);
+    zassert_equal(wash_estimate_remaining_ms(&estimate, now_ms), washing - 600000);
+    zassert_equal(wash_estimate_remaining_ms(&estimate, now_ms + 3600000), washing - 600000,
+                  "Paused time counted as progress");
+
+    process_at(300000, EVENT_START_BUTTON_PRESSED);
+    zassert_equal(wash_estimate_remaining_ms(&estimate, now_ms + 1000), washing - 601000);
+
+    // A restored estimate picks up where the phase was.
+    wash_estimate_init(&estimate, &fsm, 700000, now_ms);
+    zassert_equal(wash_estimate_remaining_ms(&estimate, now_ms), washing - 700000);
+}
+
+ZTEST(wash_program_suite, test_estimate_ends_at_zero)
+{
+    static const event_id_t events[] = {
+        EVENT_POWER_BUTTON_PRESSED, EVENT_CYCLE_SELECTED, EVENT_START_BUTTON_PRESSED,
+        EVENT_WEIGHT_CALCULATED, EVENT_DOSING_COMPLETE, EVENT_WATER_LEVEL_REACHED,
+        EVENT_TIMER_EXPIRED, EVENT_DRUM_EMPTY, EVENT_TIMER_EXPIRED,
+        EVENT_DRUM_EMPTY, EVENT_TIMER_EXPIRED,
+    };
+
+    for (int i = 0; i < ARRAY_SIZE(events); i++) {
+        process_at(1000, events[i]);
+    }
+    zassert_equal(fsm.system_state, STATE_L1_END);
+    zassert_equal(wash_estimate_remaining_ms(&estimate, now_ms), 0);
+
+    // Back in Selection the next cycle is planned again.
+    process_at(1000, EVENT_ANY_KEY_PRESSED);
+    zassert_equal(wash_estimate_remaining_ms(&estimate, now_ms), planned_cycle_ms());
+}
+
+ZTEST_SUITE(wash_program_suite, NULL, NULL, wash_program_before, NULL, NULL);
@@ -17,9 +17,11 @@ ZTEST(multithreaded_tests, test_start_button_event_triggers_fsm)
 
     k_sleep(K_MSEC(100));
 
-    fsm_handle_t *fsm = controller_fsm_get_handle();
-    zassert_equal(fsm->system_state, STATE_L1_RUNNING, "Expected L1 state: RUNNING");
-    zassert_equal(fsm->wash_cycle_state, STATE_L2_FILLING, "Expected L2 state: FILLING");
+    // The controller thread owns the FSM; read the state it published.
+    fsm_status_t status;
+    controller_get_status(&status);
+    zassert_equal(status.system_state, STATE_L1_RUNNING, "Expected L1 state: RUNNING");
+    zassert_equal(status.wash_cycle_state, STATE_L2_FILLING, "Expected L2 state: FILLING");
 }
 
 ZTEST_SUITE(multithreaded_tests, NULL, NULL, NULL, NULL, NULL);
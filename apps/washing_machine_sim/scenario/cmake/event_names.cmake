@@ -0,0 +1,28 @@
+# Generates the event name table and its perfect hash from event_defs.h.
+# Include this file, then call
+#
+#   event_names_generate(<target>)
+#
+# to make <target> depend on the generated file and see its directory.
+
+set(SCENARIO_DIR ${CMAKE_CURRENT_LIST_DIR}/..)
+set(SCENARIO_EVENT_DEFS ${SCENARIO_DIR}/../../../components/event_bus/include/event_defs.h)
+
+function(event_names_generate target)
+  set(gen_dir ${CMAKE_CURRENT_BINARY_DIR}/event_names_generated)
+  set(generator ${SCENARIO_DIR}/scripts/gen_event_names.py)
+  set(output ${gen_dir}/event_names.inc)
+
+  add_custom_command(
+    OUTPUT ${output}
+    COMMAND ${PYTHON_EXECUTABLE} ${generator} ${SCENARIO_EVENT_DEFS} --out-dir ${gen_dir}
+    DEPENDS ${generator} ${SCENARIO_EVENT_DEFS}
+    COMMENT "Generating the event name hash from event_defs.h"
+  )
+
+  # A custom target lets targets defined in other directories depend on
+  # the generated file too.
+  add_custom_target(${target}_event_names DEPENDS ${output})
+  add_dependencies(${target} ${target}_event_names)
+  target_include_directories(${target} PRIVATE ${gen_dir})
+endfunction()
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "event_defs.h"
+
+/**
+ * @brief Returns the event ID spelled @p name, e.g. "EVENT_DOOR_CLOSED".
+ *
+ * The names are hashed at build time into a collision-free table, so this
+ * is one hash and one string compare whatever the number of events.
+ *
+ * @return The ID, or EVENT_ID_COUNT if no event has that name.
+ */
+event_id_t event_id_from_name(const char *name);
+
+/**
+ * @brief Returns the enum name of @p id, or "?" for an invalid ID.
+ */
+const char *event_name(event_id_t id);
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <zephyr/kernel.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "event_defs.h"
+
+/**
+ * @file scenario.h
+ * @brief Scripted event injection for repeatable test runs.
+ *
+ * A scenario is a text script, one step per line:
+ *
+ * @code
+ * # Quick wash, with a burst of motor reports
+ * name quick wash
+ * EVENT_DOOR_CLOSED
+ * EVENT_CYCLE_SELECTED 3
+ * delay 500 ms
+ * EVENT_START_BUTTON_PRESSED
+ * repeat 100
+ *     EVENT_MOTOR_SPEED_REPORT 800
+ *     delay 10 ms
+ * end
+ * @endcode
+ *
+ * - An event line posts the event, with an optional payload: an integer,
+ *   decimal or 0x hex, or a float if it has a decimal point.
+ * - @c delay waits before the next step. The unit is us, ms (the default)
+ *   or s. Delays add up from the start of the run, so the posts do not
+ *   drift however long the scenario is.
+ * - @c repeat N ... @c end runs the steps between them N times. Repeats
+ *   nest up to SCENARIO_MAX_DEPTH deep.
+ * - @c name sets the name shown in the results. Blank lines and lines
+ *   starting with # are ignored.
+ *
+ * The runner injects the events from its own thread, above the
+ * controller's priority, and measures how late each one went out.
+ */
+
+#define SCENARIO_MAX_STEPS 128
+#define SCENARIO_MAX_DEPTH 4
+#define SCENARIO_NAME_LEN 32
+// Largest script scenario_load_host_file() reads
+#define SCENARIO_MAX_TEXT 4096
+
+enum scenario_op {
+    SCENARIO_POST,
+    SCENARIO_DELAY,
+    SCENARIO_REPEAT,
+    SCENARIO_END,
+};
+
+struct scenario_step {
+    uint8_t op;             // enum scenario_op
+    uint8_t id;             // SCENARIO_POST: the event
+    uint16_t match;         // SCENARIO_REPEAT and SCENARIO_END: the other end of the block
+    uint32_t arg;           // Delay in us, or repeat count
+    event_payload_t payload;
+};
+
+/**
+ * @brief A parsed script.
+ */
+struct scenario {
+    char name[SCENARIO_NAME_LEN];
+    uint16_t num_steps;
+    uint32_t total_events;  // Posts over the whole run, repeats included
+    uint64_t total_us;      // Sum of the delays over the whole run
+    struct scenario_step steps[SCENARIO_MAX_STEPS];
+};
+
+/**
+ * @brief Results of a run, see scenario_get_result().
+ */
+typedef struct {
+    char name[SCENARIO_NAME_LEN];
+    bool running;
+    bool stopped;           // Ended by scenario_stop()
+    uint32_t posted;
+    uint32_t failed;        // event_bus_post() returned an error
+    uint32_t elapsed_us;    // From the start to the end, or to now while running
+    uint32_t late_mean_us;  // How long after its scheduled time a post went out
+    uint32_t late_max_us;
+    uint32_t post_mean_us;  // Time spent in event_bus_post()
+    uint32_t post_max_us;
+} scenario_result_t;
+
+/**
+ * @brief Parses a script into @p out.
+ *
+ * @param text The script, need not be NUL terminated.
+ * @param error_line Set to the 1-based line of the error, if any.
+ * @return 0 on success, -EINVAL for a syntax error or an unknown event,
+ *         -ENOMEM if the script has too many steps or nests too deep,
+ *         -ERANGE if its repeats nest to 2^64 runs or more, or expand to
+ *         more than UINT32_MAX events or UINT64_MAX microseconds of delay.
+ */
+int scenario_parse(struct scenario *out, const char *text, size_t len, int *error_line);
+
+/**
+ * @brief Parses an event payload as written in a script: an integer,
+ * decimal or 0x hex, or a float if it has a decimal point.
+ *
+ * @return 0 on success, -EINVAL if @p s is not a payload or does not fit
+ *         in 32 bits.
+ */
+int scenario_parse_payload(const char *s, event_payload_t *payload);
+
+/**
+ * @brief Starts running @p scenario on the runner thread.
+ *
+ * The scenario is copied, so the caller may reuse it at once.
+ *
+ * @return 0 on success, -EBUSY if a scenario is already running.
+ */
+int scenario_start(const struct scenario *scenario);
+
+/**
+ * @brief Asks the running scenario to stop before its next step.
+ *
+ * @return 0 on success, -EALREADY if nothing is running.
+ */
+int scenario_stop(void);
+
+/**
+ * @brief Waits for the running scenario to finish.
+ *
+ * @return 0 once nothing is running, -EAGAIN on timeout.
+ */
+int scenario_wait(k_timeout_t timeout);
+
+/**
+ * @brief Copies the results of the current or last run.
+ */
+void scenario_get_result(scenario_result_t *result);
+
+/**
+ * @brief Called on the runner thread with true right before a run posts
+ * its first event, and with false once it has ended, before
+ * scenario_get_result() shows it as no longer running. Lets a caller take
+ * its own counters around exactly the run.
+ */
+typedef void (*scenario_hook_t)(bool running);
+
+/**
+ * @brief Installs @p hook, or removes it with NULL. Set it while nothing
+ * is running.
+ */
+void scenario_set_hook(scenario_hook_t hook);
+
+#if defined(CONFIG_ARCH_POSIX)
+/**
+ * @brief Reads and parses a script from the host's filesystem.
+ *
+ * native_sim only. A relative @p path is taken from the directory the
+ * simulator was started from.
+ *
+ * @return 0 on success, the host's negative errno if the file cannot be
+ *         read, -EFBIG if it is larger than SCENARIO_MAX_TEXT, or the
+ *         error of scenario_parse().
+ */
+int scenario_load_host_file(struct scenario *out, const char *path, int *error_line);
+#endif
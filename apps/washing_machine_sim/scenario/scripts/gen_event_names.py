@@ -0,0 +1,115 @@
+#!/usr/bin/env python3
+"""Generate the event name table and its perfect hash from event_defs.h.
+
+Every name of the event_id_t enum hashes to its own slot of a table of
+2^bits entries, so a lookup is one hash, one table read and one string
+compare:
+
+    h = FNV-1a 32 of the name, with the offset basis XORed with the seed
+    slot = h >> (32 - bits)
+    id = event_name_slots[slot], EVENT_ID_COUNT for an empty slot
+
+The generator tries seeds until no two names share a slot, starting with
+a table twice the size of the enum and doubling it if none is found.
+
+One file is written to the output directory:
+    event_names.inc  the seed, the slot table and the name of each ID
+"""
+
+import argparse
+import os
+import re
+import sys
+
+ENUM_RE = re.compile(r"typedef\s+enum\s*{(.*?)}\s*event_id_t\s*;", re.S)
+ENTRY_RE = re.compile(r"^\s*([A-Z][A-Z0-9_]*)\s*(?:=\s*0\s*)?,", re.M)
+COUNT = "EVENT_ID_COUNT"
+
+FNV_BASIS = 0x811C9DC5
+FNV_PRIME = 0x01000193
+MAX_SEEDS = 1 << 16
+
+
+def fnv1a(name, seed):
+    h = FNV_BASIS ^ seed
+    for byte in name.encode("ascii"):
+        h = ((h ^ byte) * FNV_PRIME) & 0xFFFFFFFF
+    return h
+
+
+def load_names(path):
+    with open(path, encoding="utf-8") as f:
+        text = f.read()
+    enum = ENUM_RE.search(text)
+    if not enum:
+        raise ValueError(f"{path}: no event_id_t enum")
+    body = re.sub(r"//[^\n]*|/\*.*?\*/", "", enum.group(1), flags=re.S)
+    names = [m.group(1) for m in ENTRY_RE.finditer(body)]
+    if not names or COUNT not in body:
+        raise ValueError(f"{path}: event_id_t does not end with {COUNT}")
+    if len(names) >= 255:
+        raise ValueError(f"{path}: {len(names)} events do not fit in a uint8_t slot")
+    return names
+
+
+def find_seed(names):
+    bits = max(1, (2 * len(names) - 1).bit_length())
+    while bits <= 16:
+        for seed in range(MAX_SEEDS):
+            slots = {fnv1a(name, seed) >> (32 - bits) for name in names}
+            if len(slots) == len(names):
+                return seed, bits
+        bits += 1
+    raise ValueError("no perfect hash found")
+
+
+def emit(names, seed, bits, src):
+    slots = ["EVENT_ID_COUNT"] * (1 << bits)
+    for name in names:
+        slots[fnv1a(name, seed) >> (32 - bits)] = name
+
+    out = [f"// Generated by gen_event_names.py from {src}. Do not edit.\n"]
+    out.append(f"#define EVENT_NAME_HASH_SEED 0x{seed:08x}u\n")
+    out.append(f"#define EVENT_NAME_HASH_BITS {bits}\n\n")
+    out.append("static const char *const event_name_table[EVENT_ID_COUNT] = {\n")
+    for name in names:
+        out.append(f"    [{name}] = \"{name}\",\n")
+    out.append("};\n\n")
+    out.append("static const uint8_t event_name_slots[1 << EVENT_NAME_HASH_BITS] = {\n")
+    for slot in slots:
+        out.append(f"    {slot},\n")
+    out.append("};\n")
+    return "".join(out)
+
+
+def write_if_changed(path, text):
+    # Leave unchanged outputs alone so dependents are not rebuilt.
+    if os.path.exists(path):
+        with open(path, encoding="utf-8") as f:
+            if f.read() == text:
+                return
+    with open(path, "w", encoding="utf-8") as f:
+        f.write(text)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("events", help="event_defs.h")
+    parser.add_argument("--out-dir", required=True, help="directory for the generated file")
+    args = parser.parse_args()
+
+    try:
+        names = load_names(args.events)
+        seed, bits = find_seed(names)
+    except (ValueError, OSError) as e:
+        print(f"gen_event_names: {e}", file=sys.stderr)
+        return 1
+
+    os.makedirs(args.out_dir, exist_ok=True)
+    write_if_changed(os.path.join(args.out_dir, "event_names.inc"),
+                     emit(names, seed, bits, os.path.basename(args.events)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
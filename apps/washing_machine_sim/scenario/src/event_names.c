@@ -0,0 +1,34 @@
+#include "event_names.h"
+#include <stdint.h>
+#include <string.h>
+
+// event_name_table and event_name_slots, generated from event_defs.h
+#include "event_names.inc"
+
+BUILD_ASSERT(EVENT_ID_COUNT < UINT8_MAX, "Event IDs must fit in a hash slot");
+
+// FNV-1a, as in gen_event_names.py
+static uint32_t name_hash(const char *name)
+{
+    uint32_t h = 0x811c9dc5u ^ EVENT_NAME_HASH_SEED;
+
+    while (*name) {
+        h = (h ^ (uint8_t)*name++) * 0x01000193u;
+    }
+    return h;
+}
+
+event_id_t event_id_from_name(const char *name)
+{
+    const event_id_t id = event_name_slots[name_hash(name) >> (32 - EVENT_NAME_HASH_BITS)];
+
+    if (id == EVENT_ID_COUNT || strcmp(event_name_table[id], name) != 0) {
+        return EVENT_ID_COUNT;
+    }
+    return id;
+}
+
+const char *event_name(event_id_t id)
+{
+    return id < EVENT_ID_COUNT ? event_name_table[id] : "?";
+}
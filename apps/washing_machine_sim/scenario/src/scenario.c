@@ -0,0 +1,453 @@
+#include "scenario.h"
+#include "event_names.h"
+#include "event_bus.h"
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/math_extras.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#if defined(CONFIG_ARCH_POSIX)
+#include "scenario_host_bottom.h"
+#endif
+
+LOG_MODULE_REGISTER(scenario, LOG_LEVEL_INF);
+
+#define SCENARIO_STACK_SIZE 1536
+// Above the controller and the plant, so posts go out when they are due
+#define SCENARIO_PRIORITY 2
+#define SCENARIO_LINE_LEN 96
+#define SCENARIO_MAX_ARGS 4
+
+K_THREAD_STACK_DEFINE(scenario_stack, SCENARIO_STACK_SIZE);
+static struct k_thread scenario_thread_data;
+static k_tid_t scenario_tid;
+
+static K_SEM_DEFINE(scenario_go, 0, 1);
+// Available while nothing is running
+static K_SEM_DEFINE(scenario_idle, 1, 1);
+// Wakes the runner from a delay when it is asked to stop
+static K_SEM_DEFINE(scenario_wake, 0, 1);
+static atomic_t stop_requested;
+// See scenario_set_hook()
+static scenario_hook_t run_hook;
+
+static struct scenario current;
+static k_ticks_t start_ticks;
+static uint32_t start_cycle;
+
+// result_lock protects everything below it.
+static K_MUTEX_DEFINE(result_lock);
+static scenario_result_t result;
+static k_ticks_t end_ticks;
+static uint64_t late_total_cycles;
+static uint64_t post_total_cycles;
+static uint32_t late_max_cycles;
+static uint32_t post_max_cycles;
+
+// --- Parser ---
+
+struct parser {
+    struct scenario *out;
+    int line;
+    int depth;
+    uint16_t open[SCENARIO_MAX_DEPTH];          // REPEAT steps waiting for their end
+    int open_line[SCENARIO_MAX_DEPTH];
+    uint64_t factor[SCENARIO_MAX_DEPTH + 1];    // Runs of the current block
+};
+
+static int split(char *line, char **argv)
+{
+    int argc = 0;
+
+    while (*line) {
+        while (isspace((unsigned char)*line)) *line++ = '\0';
+        if (*line == '\0') break;
+        if (argc == SCENARIO_MAX_ARGS) return -EINVAL;
+        argv[argc++] = line;
+        while (*line && !isspace((unsigned char)*line)) line++;
+    }
+    return argc;
+}
+
+static int parse_u32(const char *s, uint32_t *value, const char **rest)
+{
+    char *end;
+    const unsigned long long v = strtoull(s, &end, 0);
+
+    if (end == s || v > UINT32_MAX || (!rest && *end)) return -EINVAL;
+    *value = (uint32_t)v;
+    if (rest) *rest = end;
+    return 0;
+}
+
+int scenario_parse_payload(const char *s, event_payload_t *payload)
+{
+    char *end;
+
+    if (strchr(s, '.')) {
+        payload->f = strtof(s, &end);
+    } else if (*s == '-') {
+        const long long v = strtoll(s, &end, 0);
+
+        if (v < INT32_MIN) return -EINVAL;
+        payload->s32 = (int32_t)v;
+    } else {
+        const unsigned long long v = strtoull(s, &end, 0);
+
+        if (v > UINT32_MAX) return -EINVAL;
+        payload->u32 = (uint32_t)v;
+    }
+    return end != s && *end == '\0' ? 0 : -EINVAL;
+}
+
+// delay <n>[us|ms|s], or the unit as its own word
+static int parse_delay(int argc, char **argv, uint32_t *us)
+{
+    const char *unit;
+    uint32_t value;
+    uint32_t scale;
+
+    if (argc < 2 || argc > 3 || parse_u32(argv[1], &value, &unit)) return -EINVAL;
+    if (*unit == '\0' && argc == 3) {
+        unit = argv[2];
+    } else if (argc == 3) {
+        return -EINVAL;
+    }
+
+    if (*unit == '\0' || strcmp(unit, "ms") == 0) {
+        scale = USEC_PER_MSEC;
+    } else if (strcmp(unit, "us") == 0) {
+        scale = 1;
+    } else if (strcmp(unit, "s") == 0) {
+        scale = USEC_PER_SEC;
+    } else {
+        return -EINVAL;
+    }
+    if (value > UINT32_MAX / scale) return -EINVAL;
+    *us = value * scale;
+    return 0;
+}
+
+static event_id_t parse_event(const char *s)
+{
+    uint32_t id;
+
+    // Numbers too, as send_event takes them
+    if (isdigit((unsigned char)*s)) {
+        return parse_u32(s, &id, NULL) == 0 && id < EVENT_ID_COUNT ? (event_id_t)id
+                                                                   : EVENT_ID_COUNT;
+    }
+    return event_id_from_name(s);
+}
+
+static int parse_line(struct parser *ps, char *line)
+{
+    struct scenario *out = ps->out;
+    struct scenario_step step = { 0 };
+    char *argv[SCENARIO_MAX_ARGS];
+    char *comment = strchr(line, '#');
+    int argc;
+
+    if (comment) *comment = '\0';
+
+    // The name is the rest of the line, spaces and all.
+    while (isspace((unsigned char)*line)) line++;
+    if (strncmp(line, "name", 4) == 0 && isspace((unsigned char)line[4])) {
+        char *name = line + 5;
+        size_t len;
+
+        while (isspace((unsigned char)*name)) name++;
+        len = strlen(name);
+        while (len > 0 && isspace((unsigned char)name[len - 1])) len--;
+        if (len == 0) return -EINVAL;
+        len = MIN(len, sizeof(out->name) - 1);
+        memcpy(out->name, name, len);
+        out->name[len] = '\0';
+        return 0;
+    }
+
+    argc = split(line, argv);
+    if (argc <= 0) return argc;
+
+    if (strcmp(argv[0], "delay") == 0) {
+        uint64_t us;
+
+        step.op = SCENARIO_DELAY;
+        if (parse_delay(argc, argv, &step.arg)) return -EINVAL;
+        if (u64_mul_overflow(ps->factor[ps->depth], step.arg, &us) ||
+            u64_add_overflow(out->total_us, us, &out->total_us)) {
+            return -ERANGE;
+        }
+    } else if (strcmp(argv[0], "repeat") == 0) {
+        step.op = SCENARIO_REPEAT;
+        if (argc != 2 || parse_u32(argv[1], &step.arg, NULL)) return -EINVAL;
+        if (ps->depth == SCENARIO_MAX_DEPTH) return -ENOMEM;
+        ps->open[ps->depth] = out->num_steps;
+        ps->open_line[ps->depth] = ps->line;
+        if (u64_mul_overflow(ps->factor[ps->depth], step.arg, &ps->factor[ps->depth + 1])) {
+            return -ERANGE;
+        }
+        ps->depth++;
+    } else if (strcmp(argv[0], "end") == 0) {
+        if (argc != 1 || ps->depth == 0) return -EINVAL;
+        step.op = SCENARIO_END;
+        step.match = ps->open[--ps->depth];
+        if (out->num_steps < SCENARIO_MAX_STEPS) {
+            out->steps[step.match].match = out->num_steps;
+        }
+    } else {
+        step.op = SCENARIO_POST;
+        step.id = parse_event(argv[0]);
+        if (step.id == EVENT_ID_COUNT || argc > 2) return -EINVAL;
+        if (argc == 2 && scenario_parse_payload(argv[1], &step.payload)) return -EINVAL;
+        if (ps->factor[ps->depth] > UINT32_MAX - out->total_events) return -ERANGE;
+        out->total_events += ps->factor[ps->depth];
+    }
+
+    if (out->num_steps == SCENARIO_MAX_STEPS) return -ENOMEM;
+    out->steps[out->num_steps++] = step;
+    return 0;
+}
+
+int scenario_parse(struct scenario *out, const char *text, size_t len, int *error_line)
+{
+    struct parser ps = { .out = out, .factor = { 1 } };
+    const char *end = text + len;
+    char line[SCENARIO_LINE_LEN];
+    int ret = 0;
+
+    memset(out, 0, sizeof(*out));
+    strcpy(out->name, "scenario");
+
+    while (text < end && ret == 0) {
+        const char *eol = memchr(text, '\n', end - text);
+        const size_t line_len = (eol ? eol : end) - text;
+
+        ps.line++;
+        if (line_len >= sizeof(line)) {
+            ret = -EINVAL;
+            break;
+        }
+        memcpy(line, text, line_len);
+        line[line_len] = '\0';
+        ret = parse_line(&ps, line);
+        text += line_len + 1;
+    }
+    if (ret == 0 && ps.depth > 0) {
+        // Point at the repeat left open.
+        ret = -EINVAL;
+        ps.line = ps.open_line[ps.depth - 1];
+    }
+    if (ret && error_line) *error_line = ps.line;
+    return ret;
+}
+
+// --- Runner ---
+
+static void record_post(int ret, uint32_t late_cycles, uint32_t post_cycles)
+{
+    k_mutex_lock(&result_lock, K_FOREVER);
+    if (ret == 0) {
+        result.posted++;
+    } else {
+        result.failed++;
+    }
+    late_total_cycles += late_cycles;
+    post_total_cycles += post_cycles;
+    late_max_cycles = MAX(late_max_cycles, late_cycles);
+    post_max_cycles = MAX(post_max_cycles, post_cycles);
+    k_mutex_unlock(&result_lock);
+}
+
+// Sleeps until the tick before @p at_us, then busy-waits the rest, so posts
+// go out within microseconds of their time rather than within a tick.
+// Returns false if told to stop.
+static bool wait_until(uint64_t at_us, uint32_t *due_cycle)
+{
+    const k_ticks_t tick = start_ticks + k_us_to_ticks_floor64(at_us);
+
+    *due_cycle = start_cycle + (uint32_t)k_us_to_cyc_ceil64(at_us);
+
+    if (tick > k_uptime_ticks()) {
+        (void)k_sem_take(&scenario_wake, K_TIMEOUT_ABS_TICKS(tick));
+    }
+    if (atomic_get(&stop_requested)) return false;
+
+    const int32_t left = (int32_t)(*due_cycle - k_cycle_get_32());
+
+    if (left > 0) {
+        k_busy_wait(k_cyc_to_us_ceil32(left));
+    }
+    return true;
+}
+
+static void post_step(const struct scenario_step *step, uint32_t due_cycle)
+{
+    const app_event_t event = { .id = step->id, .payload = step->payload };
+    const uint32_t before = k_cycle_get_32();
+    const int ret = event_bus_post(&event);
+    const uint32_t after = k_cycle_get_32();
+    const int32_t late = (int32_t)(before - due_cycle);
+
+    record_post(ret, MAX(late, 0), after - before);
+}
+
+static void run_scenario(const struct scenario *sc)
+{
+    struct {
+        uint16_t step;
+        uint32_t left;
+    } loops[SCENARIO_MAX_DEPTH];
+    int depth = 0;
+    uint64_t at_us = 0;     // Time of the next post, from the start
+    uint32_t due_cycle;
+
+    for (uint16_t i = 0; i < sc->num_steps; i++) {
+        const struct scenario_step *step = &sc->steps[i];
+
+        switch (step->op) {
+        case SCENARIO_POST:
+            if (!wait_until(at_us, &due_cycle)) return;
+            post_step(step, due_cycle);
+            break;
+        case SCENARIO_DELAY:
+            at_us += step->arg;
+            break;
+        case SCENARIO_REPEAT:
+            if (step->arg == 0) {
+                i = step->match;
+            } else {
+                loops[depth].step = i;
+                loops[depth].left = step->arg;
+                depth++;
+            }
+            break;
+        case SCENARIO_END:
+            if (--loops[depth - 1].left > 0) {
+                i = loops[depth - 1].step;
+            } else {
+                depth--;
+            }
+            break;
+        }
+    }
+    // A trailing delay is part of the run.
+    (void)wait_until(at_us, &due_cycle);
+}
+
+// Fills in the times from the cycle counts. Called with result_lock held.
+static void fill_times(scenario_result_t *out)
+{
+    const uint32_t count = out->posted + out->failed;
+    const k_ticks_t end = out->running ? k_uptime_ticks() : end_ticks;
+
+    out->elapsed_us = (uint32_t)k_ticks_to_us_floor64(end - start_ticks);
+    out->late_mean_us = count ? k_cyc_to_us_floor32(late_total_cycles / count) : 0;
+    out->late_max_us = k_cyc_to_us_floor32(late_max_cycles);
+    out->post_mean_us = count ? k_cyc_to_us_floor32(post_total_cycles / count) : 0;
+    out->post_max_us = k_cyc_to_us_floor32(post_max_cycles);
+}
+
+static void scenario_thread(void *p1, void *p2, void *p3)
+{
+    ARG_UNUSED(p1); ARG_UNUSED(p2); ARG_UNUSED(p3);
+
+    while (1) {
+        k_sem_take(&scenario_go, K_FOREVER);
+
+        if (run_hook) {
+            run_hook(true);
+        }
+        start_ticks = k_uptime_ticks();
+        start_cycle = k_cycle_get_32();
+        run_scenario(&current);
+        if (run_hook) {
+            run_hook(false);
+        }
+
+        k_mutex_lock(&result_lock, K_FOREVER);
+        end_ticks = k_uptime_ticks();
+        result.running = false;
+        result.stopped = atomic_get(&stop_requested);
+        fill_times(&result);
+        k_mutex_unlock(&result_lock);
+
+        LOG_INF("'%s': %u events in %u ms, %u failed, late by up to %u us", result.name,
+                result.posted, result.elapsed_us / 1000, result.failed, result.late_max_us);
+        k_sem_give(&scenario_idle);
+    }
+}
+
+int scenario_start(const struct scenario *scenario)
+{
+    if (k_sem_take(&scenario_idle, K_NO_WAIT) != 0) return -EBUSY;
+
+    current = *scenario;
+    atomic_clear(&stop_requested);
+    k_sem_reset(&scenario_wake);
+
+    k_mutex_lock(&result_lock, K_FOREVER);
+    memset(&result, 0, sizeof(result));
+    strcpy(result.name, current.name);
+    result.running = true;
+    late_total_cycles = 0;
+    post_total_cycles = 0;
+    late_max_cycles = 0;
+    post_max_cycles = 0;
+    k_mutex_unlock(&result_lock);
+
+    if (!scenario_tid) {
+        scenario_tid = k_thread_create(&scenario_thread_data, scenario_stack,
+                                       K_THREAD_STACK_SIZEOF(scenario_stack),
+                                       scenario_thread, NULL, NULL, NULL,
+                                       SCENARIO_PRIORITY, 0, K_NO_WAIT);
+        k_thread_name_set(scenario_tid, "scenario");
+    }
+    k_sem_give(&scenario_go);
+    return 0;
+}
+
+int scenario_stop(void)
+{
+    if (k_sem_count_get(&scenario_idle) > 0) return -EALREADY;
+
+    atomic_set(&stop_requested, 1);
+    k_sem_give(&scenario_wake);
+    return 0;
+}
+
+int scenario_wait(k_timeout_t timeout)
+{
+    if (k_sem_take(&scenario_idle, timeout) != 0) return -EAGAIN;
+    k_sem_give(&scenario_idle);
+    return 0;
+}
+
+void scenario_set_hook(scenario_hook_t hook)
+{
+    run_hook = hook;
+}
+
+void scenario_get_result(scenario_result_t *out)
+{
+    k_mutex_lock(&result_lock, K_FOREVER);
+    *out = result;
+    if (result.running) {
+        fill_times(out);
+    }
+    k_mutex_unlock(&result_lock);
+}
+
+#if defined(CONFIG_ARCH_POSIX)
+int scenario_load_host_file(struct scenario *out, const char *path, int *error_line)
+{
+    // Too big for the shell stack; the shell runs one command at a time.
+    static char text[SCENARIO_MAX_TEXT];
+    const int len = scenario_host_read(path, text, sizeof(text));
+
+    if (len < 0) return len;
+    return scenario_parse(out, text, len, error_line);
+}
+#endif
@@ -0,0 +1,32 @@
+#include "scenario_host_bottom.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+int scenario_host_read(const char *path, char *buf, size_t size)
+{
+    size_t len = 0;
+    char extra;
+    int ret = 0;
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+
+    if (fd < 0) return -errno;
+
+    while (len < size) {
+        ssize_t n = read(fd, buf + len, size - len);
+
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            ret = -errno;
+            break;
+        }
+        if (n == 0) break;
+        len += n;
+    }
+    // One more byte means the file is larger than the buffer.
+    if (ret == 0 && len == size && read(fd, &extra, 1) > 0) {
+        ret = -EFBIG;
+    }
+    close(fd);
+    return ret ? ret : (int)len;
+}
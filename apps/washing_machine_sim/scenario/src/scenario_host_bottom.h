@@ -0,0 +1,14 @@
+#pragma once
+
+#include <stddef.h>
+
+/*
+ * Host side of scenario_load_host_file(). Built into the native simulator
+ * runner against the host C library; the embedded side only sees this
+ * prototype.
+ *
+ * Reads the whole of @p path into @p buf. Returns the number of bytes
+ * read, -EFBIG if the file does not fit in @p size bytes, or the host's
+ * negative errno.
+ */
+int scenario_host_read(const char *path, char *buf, size_t size);
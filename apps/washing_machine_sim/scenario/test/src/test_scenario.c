@@ -0,0 +1,288 @@
+#include <zephyr/ztest.h>
+#include <string.h>
+#include "event_bus.h"
+#include "event_names.h"
+#include "scenario.h"
+
+#define QUEUE_DEPTH 32
+
+// The events the scenarios inject
+K_MSGQ_DEFINE(injected_msgq, sizeof(app_event_t), QUEUE_DEPTH, 4);
+
+static struct scenario sc;
+
+static int parse(const char *text, int *line)
+{
+	return scenario_parse(&sc, text, strlen(text), line);
+}
+
+static void *scenario_suite_setup(void)
+{
+	static const event_id_t events[] = {
+		EVENT_DOOR_CLOSED,
+		EVENT_CYCLE_SELECTED,
+		EVENT_MOTOR_SPEED_REPORT,
+		EVENT_HEATER_TEMP_CHANGED,
+	};
+
+	zassert_ok(event_bus_init(), "event_bus_init() failed");
+	zassert_not_null(event_bus_subscribe(&injected_msgq, events, ARRAY_SIZE(events)));
+	return NULL;
+}
+
+static void scenario_before(void *data)
+{
+	ARG_UNUSED(data);
+
+	k_msgq_purge(&injected_msgq);
+}
+
+ZTEST(scenario_suite, test_every_event_name_round_trips)
+{
+	for (int id = 0; id < EVENT_ID_COUNT; id++) {
+		const char *name = event_name((event_id_t)id);
+
+		zassert_not_equal(strcmp(name, "?"), 0, "no name for %d", id);
+		zassert_equal(event_id_from_name(name), id, "%s", name);
+	}
+	zassert_equal(event_id_from_name("EVENT_DOOR_CLOSE"), EVENT_ID_COUNT);
+	zassert_equal(event_id_from_name("event_door_closed"), EVENT_ID_COUNT);
+	zassert_equal(event_id_from_name(""), EVENT_ID_COUNT);
+	zassert_equal(strcmp(event_name(EVENT_ID_COUNT), "?"), 0);
+}
+
+ZTEST(scenario_suite, test_parse_counts_repeats_and_delays)
+{
+	static const char text[] =
+		"# Comment\n"
+		"name  spin up  \n"
+		"EVENT_DOOR_CLOSED\n"
+		"EVENT_CYCLE_SELECTED 0x3   # trailing comment\n"
+		"\n"
+		"delay 2 s\n"
+		"repeat 3\n"
+		"    repeat 4\n"
+		"        EVENT_MOTOR_SPEED_REPORT -40\n"
+		"        delay 250us\n"
+		"    end\n"
+		"    EVENT_HEATER_TEMP_CHANGED 41.5\n"
+		"    delay 10\n"
+		"end\n"
+		"0";
+
+	zassert_ok(parse(text, NULL));
+	zassert_equal(strcmp(sc.name, "spin up"), 0, "name '%s'", sc.name);
+	zassert_equal(sc.num_steps, 12);
+	zassert_equal(sc.total_events, 2 + 3 * (4 + 1) + 1);
+	zassert_equal(sc.total_us, 2000000 + 3 * (4 * 250 + 10000));
+
+	zassert_equal(sc.steps[1].id, EVENT_CYCLE_SELECTED);
+	zassert_equal(sc.steps[1].payload.u32, 3);
+	zassert_equal(sc.steps[2].op, SCENARIO_DELAY);
+	zassert_equal(sc.steps[2].arg, 2000000);
+	zassert_equal(sc.steps[3].op, SCENARIO_REPEAT);
+	zassert_equal(sc.steps[3].match, 10);
+	zassert_equal(sc.steps[5].payload.s32, -40);
+	zassert_equal(sc.steps[6].arg, 250);
+	zassert_equal(sc.steps[8].payload.f, 41.5f);
+	zassert_equal(sc.steps[10].match, 3);
+	// Events by number, as send_event takes them
+	zassert_equal(sc.steps[11].id, COMMAND_DOOR_SET_LOCK);
+}
+
+ZTEST(scenario_suite, test_parse_errors_give_the_line)
+{
+	static const struct {
+		const char *text;
+		int ret;
+		int line;
+	} cases[] = {
+		{ "EVENT_DOOR_CLOSED\nEVENT_NO_SUCH_THING\n", -EINVAL, 2 },
+		{ "EVENT_DOOR_CLOSED 12abc\n", -EINVAL, 1 },
+		{ "delay\n", -EINVAL, 1 },
+		{ "delay 5 min\n", -EINVAL, 1 },
+		{ "\n\nend\n", -EINVAL, 3 },
+		{ "repeat 2\nEVENT_DOOR_CLOSED\nrepeat 3\nend\n", -EINVAL, 1 },
+		{ "repeat 1\nrepeat 1\nrepeat 1\nrepeat 1\nrepeat 1\n", -ENOMEM, 5 },
+		{ "999\n", -EINVAL, 1 },
+		{ "repeat 65536\nrepeat 65536\nEVENT_DOOR_CLOSED\n", -ERANGE, 3 },
+		{ "repeat 4294967295\nrepeat 4294967295\nrepeat 2\n", -ERANGE, 3 },
+		{ "repeat 4294967295\nrepeat 4294967295\ndelay 1 us\ndelay 1 us\n", -ERANGE, 4 },
+	};
+
+	for (int i = 0; i < ARRAY_SIZE(cases); i++) {
+		int line = 0;
+
+		zassert_equal(parse(cases[i].text, &line), cases[i].ret, "case %d", i);
+		zassert_equal(line, cases[i].line, "case %d: line %d", i, line);
+	}
+}
+
+ZTEST(scenario_suite, test_repeat_totals_up_to_the_limit)
+{
+	static const char text[] =
+		"repeat 65535\n"
+		"repeat 65537\n"
+		"EVENT_DOOR_CLOSED\n"
+		"end\n"
+		"end\n"
+		// 4294967295 * 641 * 6700417 runs is UINT64_MAX
+		"repeat 4294967295\nrepeat 641\nrepeat 6700417\n"
+		"delay 1 us\n"
+		"end\nend\nend\n";
+	int line = 0;
+
+	zassert_ok(parse(text, &line), "line %d", line);
+	zassert_equal(sc.total_events, UINT32_MAX);
+	zassert_equal(sc.total_us, UINT64_MAX);
+}
+
+ZTEST(scenario_suite, test_payload_range)
+{
+	event_payload_t payload;
+
+	zassert_ok(scenario_parse_payload("0xffffffff", &payload));
+	zassert_equal(payload.u32, UINT32_MAX);
+	zassert_ok(scenario_parse_payload("-2147483648", &payload));
+	zassert_equal(payload.s32, INT32_MIN);
+	zassert_ok(scenario_parse_payload("1.5", &payload));
+	zassert_equal(payload.f, 1.5f);
+	// Out of range is an error, not clamped
+	zassert_equal(scenario_parse_payload("4294967296", &payload), -EINVAL);
+	zassert_equal(scenario_parse_payload("-2147483649", &payload), -EINVAL);
+	zassert_equal(scenario_parse_payload("99999999999999999999", &payload), -EINVAL);
+	zassert_equal(scenario_parse_payload("", &payload), -EINVAL);
+}
+
+ZTEST(scenario_suite, test_too_many_steps)
+{
+	static char text[(SCENARIO_MAX_STEPS + 1) * 8 + 1];
+	int line = 0;
+
+	text[0] = '\0';
+	for (int i = 0; i <= SCENARIO_MAX_STEPS; i++) {
+		strcat(text, "delay 1\n");
+	}
+	zassert_equal(parse(text, &line), -ENOMEM);
+	zassert_equal(line, SCENARIO_MAX_STEPS + 1);
+}
+
+ZTEST(scenario_suite, test_run_posts_on_time)
+{
+	static const char text[] =
+		"EVENT_DOOR_CLOSED\n"
+		"delay 20\n"
+		"repeat 5\n"
+		"    EVENT_MOTOR_SPEED_REPORT 900\n"
+		"    delay 10 ms\n"
+		"end\n"
+		"EVENT_CYCLE_SELECTED 2\n";
+	const uint32_t cycles_per_ms = sys_clock_hw_cycles_per_sec() / 1000;
+	scenario_result_t result;
+	app_event_t event;
+	uint32_t first = 0;
+
+	zassert_ok(parse(text, NULL));
+	zassert_ok(scenario_start(&sc));
+	zassert_equal(scenario_start(&sc), -EBUSY);
+	zassert_ok(scenario_wait(K_SECONDS(1)));
+
+	for (int i = 0; i < 7; i++) {
+		// Each post is due 20 ms after the first, then every 10 ms.
+		const uint32_t due_ms = i == 0 ? 0 : 20 + (i - 1) * 10;
+
+		zassert_ok(k_msgq_get(&injected_msgq, &event, K_NO_WAIT), "event %d", i);
+		if (i == 0) {
+			zassert_equal(event.id, EVENT_DOOR_CLOSED);
+			first = event.timestamp;
+		} else if (i < 6) {
+			zassert_equal(event.id, EVENT_MOTOR_SPEED_REPORT);
+			zassert_equal(event.payload.u32, 900);
+		} else {
+			zassert_equal(event.id, EVENT_CYCLE_SELECTED);
+			zassert_equal(event.payload.u32, 2);
+		}
+		zassert_within(event.timestamp - first, due_ms * cycles_per_ms, cycles_per_ms,
+			       "event %d at %u cycles", i, event.timestamp - first);
+	}
+	zassert_not_equal(k_msgq_get(&injected_msgq, &event, K_NO_WAIT), 0);
+
+	scenario_get_result(&result);
+	zassert_false(result.running);
+	zassert_false(result.stopped);
+	zassert_equal(result.posted, 7);
+	zassert_equal(result.failed, 0);
+	zassert_within(result.elapsed_us, 70000, 1000, "%u us", result.elapsed_us);
+	zassert_true(result.late_max_us < 1000, "late by %u us", result.late_max_us);
+}
+
+ZTEST(scenario_suite, test_stop_ends_a_delay)
+{
+	static const char text[] =
+		"EVENT_DOOR_CLOSED\n"
+		"delay 10 s\n"
+		"EVENT_DOOR_CLOSED\n";
+	scenario_result_t result;
+
+	zassert_equal(scenario_stop(), -EALREADY);
+	zassert_ok(parse(text, NULL));
+	zassert_ok(scenario_start(&sc));
+	k_msleep(5);
+	zassert_ok(scenario_stop());
+	zassert_ok(scenario_wait(K_MSEC(100)));
+
+	scenario_get_result(&result);
+	zassert_true(result.stopped);
+	zassert_equal(result.posted, 1);
+	zassert_true(result.elapsed_us < 100000, "%u us", result.elapsed_us);
+	zassert_equal(k_msgq_num_used_get(&injected_msgq), 1);
+}
+
+static atomic_t hook_calls;
+static bool hook_arg[2];
+static bool hook_saw_running[2];
+
+// Runs on the runner thread, so it only takes notes.
+static void record_hook(bool running)
+{
+	const atomic_val_t n = atomic_inc(&hook_calls);
+	scenario_result_t result;
+
+	scenario_get_result(&result);
+	if (n < ARRAY_SIZE(hook_arg)) {
+		hook_arg[n] = running;
+		hook_saw_running[n] = result.running;
+	}
+}
+
+ZTEST(scenario_suite, test_hook_brackets_the_run)
+{
+	static const char text[] =
+		"EVENT_DOOR_CLOSED\n"
+		"delay 10\n"
+		"EVENT_DOOR_CLOSED\n";
+
+	atomic_clear(&hook_calls);
+	scenario_set_hook(record_hook);
+	zassert_ok(parse(text, NULL));
+	zassert_ok(scenario_start(&sc));
+	zassert_ok(scenario_wait(K_SECONDS(1)));
+	scenario_set_hook(NULL);
+
+	zassert_equal(atomic_get(&hook_calls), 2);
+	zassert_true(hook_arg[0], "First call is not the start");
+	zassert_false(hook_arg[1], "Second call is not the end");
+	// Both calls come while the run still shows as running.
+	zassert_true(hook_saw_running[0]);
+	zassert_true(hook_saw_running[1]);
+}
+
+ZTEST(scenario_suite, test_missing_host_file)
+{
+	int line = 0;
+
+	zassert_equal(scenario_load_host_file(&sc, "no/such/scenario.txt", &line), -ENOENT);
+	zassert_equal(line, 0);
+}
+
+ZTEST_SUITE(scenario_suite, NULL, scenario_suite_setup, scenario_before, NULL, NULL);
@@ -0,0 +1,73 @@
+#include <zephyr/ztest.h>
+#include <zephyr/kernel.h>
+#include "event_bus.h"
+#include "controller_thread.h"
+#include "sim_des.h"
+
+#define BENCH_CYCLES 2000
+
+static void *bench_setup(void)
+{
+    sim_des_config_t config = {
+        .deliver = controller_handle_event,
+        .fsm = controller_fsm_get_handle(),
+    };
+
+    zassert_ok(event_bus_init(), "event_bus_init() failed");
+    controller_set_clock(sim_des_now_ms);
+    config.num_events = controller_get_subscribed_events(&config.events);
+    zassert_ok(sim_des_init(&config));
+    controller_start();
+    return NULL;
+}
+
+static void run_until_l1(system_state_t state)
+{
+    while (controller_fsm_get_handle()->system_state != state) {
+        zassert_ok(sim_des_step(), "Simulation stalled");
+    }
+}
+
+/**
+ * @brief Full wash cycles back to back in virtual time, rotating through
+ * every programme.
+ *
+ * The headline figure is simulated seconds per wall-clock second.
+ */
+ZTEST(sim_des_bench_suite, test_full_cycles)
+{
+    fsm_handle_t *fsm = controller_fsm_get_handle();
+    sim_des_stats_t stats;
+
+    zassert_ok(sim_des_schedule(0, EVENT_POWER_BUTTON_PRESSED, 0));
+    zassert_ok(sim_des_schedule(1000, EVENT_CYCLE_SELECTED, 0));
+    run_until_l1(STATE_L1_SELECTION);
+
+    const int64_t sim_start = sim_des_now_ms();
+    const uint64_t start = k_cycle_get_64();
+
+    for (int i = 0; i < BENCH_CYCLES; i++) {
+        fsm->program_has_prewash = i & 1;
+        fsm->program_has_heating = i & 2;
+        fsm->program_has_steam = i & 4;
+        zassert_ok(sim_des_schedule(1000, EVENT_START_BUTTON_PRESSED, 0));
+        run_until_l1(STATE_L1_END);
+        zassert_ok(sim_des_schedule(1000, EVENT_ANY_KEY_PRESSED, 0));
+        run_until_l1(STATE_L1_SELECTION);
+    }
+
+    const uint64_t ns = k_cyc_to_ns_floor64(k_cycle_get_64() - start);
+    const uint64_t sim_ms = sim_des_now_ms() - sim_start;
+
+    sim_des_get_stats(&stats);
+    TC_PRINT("virtual-time simulation, %d full cycles\n", BENCH_CYCLES);
+    TC_PRINT("  simulated time:          %u h\n", (uint32_t)(sim_ms / 3600000));
+    TC_PRINT("  wall time:               %u ms\n", (uint32_t)(ns / 1000000));
+    TC_PRINT("  cycles/s:                %u\n",
+             (uint32_t)(ns ? BENCH_CYCLES * 1000000000ULL / ns : 0));
+    TC_PRINT("  events delivered:        %u\n", (uint32_t)stats.delivered);
+    TC_PRINT("  clock jumps:             %u\n", stats.instants);
+    TC_PRINT("  sim-seconds/wall-second: %u\n", (uint32_t)(ns ? sim_ms * 1000000ULL / ns : 0));
+}
+
+ZTEST_SUITE(sim_des_bench_suite, NULL, bench_setup, NULL, NULL, NULL);
@@ -0,0 +1,297 @@
+#include "sim_des.h"
+#include "event_bus.h"
+#include "timer_wheel.h"
+#include "sim_water_level.h"
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <string.h>
+
+LOG_MODULE_REGISTER(sim_des, CONFIG_LOG_DEFAULT_LEVEL);
+
+#define SIM_DES_MAX_PENDING 32
+// Every post is delivered before the next one, so the queue only has to
+// hold the expiries of one wheel tick.
+#define SIM_DES_QUEUE_DEPTH 16
+#define SIM_DES_NEVER INT64_MAX
+
+typedef struct {
+    int64_t due_ms;
+    uint32_t order;         // Scheduling order, breaks ties
+    uint32_t plant_gen;     // Plant phase it belongs to, 0 for scenario events
+    event_id_t event;
+    uint32_t payload;
+} sim_pending_t;
+
+// How the plant answers an L2 phase: once the physical process is done,
+// after delay_ms, its sensor reports with event.
+typedef struct {
+    uint32_t delay_ms;
+    event_id_t event;
+} plant_response_t;
+
+static const plant_response_t plant_responses[STATE_L2_COUNT] = {
+    [STATE_L2_LOAD_SENSING] = { 30000, EVENT_WEIGHT_CALCULATED },
+    [STATE_L2_DOSING] = { 20000, EVENT_DOSING_COMPLETE },
+    [STATE_L2_DRAINING_PRE] = { 60000, EVENT_DRUM_EMPTY },
+    [STATE_L2_FILLING] = { 90000, EVENT_WATER_LEVEL_REACHED },
+    [STATE_L2_HEATING] = { 600000, EVENT_TEMP_REACHED },
+    [STATE_L2_DRAINING_WASH] = { 60000, EVENT_DRUM_EMPTY },
+    [STATE_L2_DRAINING_RINSE] = { 60000, EVENT_DRUM_EMPTY },
+};
+
+K_MSGQ_DEFINE(sim_des_q, sizeof(app_event_t), SIM_DES_QUEUE_DEPTH, 4);
+
+static sim_des_config_t config;
+static event_subscription_t *subscription;
+
+// The schedule, a binary min-heap on (due_ms, order)
+static sim_pending_t pending[SIM_DES_MAX_PENDING];
+static uint32_t num_pending;
+static uint32_t next_order;
+
+static int64_t now_ms;
+static uint64_t wheel_ticks;    // Wheel ticks since init, without wrapping
+
+// Plant state: the phase it is serving and a generation that outdates
+// the responses of earlier phases.
+static uint32_t plant_gen;
+static system_state_t plant_l1;
+static wash_cycle_state_t plant_l2;
+
+static sim_des_stats_t stats;
+
+static bool pending_before(const sim_pending_t *a, const sim_pending_t *b)
+{
+    return a->due_ms < b->due_ms || (a->due_ms == b->due_ms && a->order < b->order);
+}
+
+static void pending_swap(uint32_t i, uint32_t j)
+{
+    sim_pending_t tmp = pending[i];
+
+    pending[i] = pending[j];
+    pending[j] = tmp;
+}
+
+static int pending_push(uint32_t delay_ms, event_id_t event, uint32_t payload, uint32_t gen)
+{
+    if (num_pending == SIM_DES_MAX_PENDING) {
+        return -ENOMEM;
+    }
+
+    uint32_t i = num_pending++;
+
+    pending[i] = (sim_pending_t){
+        .due_ms = now_ms + delay_ms,
+        .order = next_order++,
+        .plant_gen = gen,
+        .event = event,
+        .payload = payload,
+    };
+    while (i > 0 && pending_before(&pending[i], &pending[(i - 1) / 2])) {
+        pending_swap(i, (i - 1) / 2);
+        i = (i - 1) / 2;
+    }
+    return 0;
+}
+
+static sim_pending_t pending_pop(void)
+{
+    sim_pending_t top = pending[0];
+    uint32_t i = 0;
+
+    pending[0] = pending[--num_pending];
+    while (true) {
+        uint32_t smallest = i;
+        const uint32_t left = 2 * i + 1;
+        const uint32_t right = left + 1;
+
+        if (left < num_pending && pending_before(&pending[left], &pending[smallest])) {
+            smallest = left;
+        }
+        if (right < num_pending && pending_before(&pending[right], &pending[smallest])) {
+            smallest = right;
+        }
+        if (smallest == i) {
+            return top;
+        }
+        pending_swap(i, smallest);
+        i = smallest;
+    }
+}
+
+// Starts the plant on the phase the machine has just entered. A paused
+// or interrupted process starts over when the cycle resumes.
+static void plant_update(void)
+{
+    const fsm_handle_t *fsm = config.fsm;
+
+    if (!fsm || (fsm->system_state == plant_l1 && fsm->wash_cycle_state == plant_l2)) {
+        return;
+    }
+
+    plant_l1 = fsm->system_state;
+    plant_l2 = fsm->wash_cycle_state;
+    plant_gen++;
+
+    if (plant_l1 != STATE_L1_RUNNING || plant_responses[plant_l2].delay_ms == 0) {
+        return;
+    }
+    if (pending_push(plant_responses[plant_l2].delay_ms, plant_responses[plant_l2].event, 0,
+                     plant_gen) != 0) {
+        LOG_ERR("Schedule full, plant response to %s lost",
+                fsm_get_wash_cycle_state_name(plant_l2));
+    }
+}
+
+// Hands everything the bus has queued for us to the system under test,
+// one event at a time, letting the plant react after each.
+static void deliver_all(void)
+{
+    app_event_t event;
+
+    while (k_msgq_get(&sim_des_q, &event, K_NO_WAIT) == 0) {
+        config.deliver(&event);
+        stats.delivered++;
+        plant_update();
+    }
+}
+
+static void post_pending(const sim_pending_t *p)
+{
+    const app_event_t event = {
+        .id = p->event,
+        .payload.u32 = p->payload,
+    };
+
+    if (p->plant_gen != 0) {
+        if (p->plant_gen != plant_gen) {
+            stats.stale++;
+            return;
+        }
+        stats.plant_events++;
+        // The level sensor follows what the plant did.
+        if (p->event == EVENT_WATER_LEVEL_REACHED) {
+            water_level_sim_set_state(true);
+        } else if (p->event == EVENT_DRUM_EMPTY) {
+            water_level_sim_set_state(false);
+        }
+    }
+
+    if (event_bus_post(&event) != 0) {
+        LOG_WRN("Failed to post simulated event %d", event.id);
+    }
+    deliver_all();
+}
+
+static int64_t next_due_ms(void)
+{
+    const uint32_t wheel_next = timer_wheel_next_event();
+    int64_t due = SIM_DES_NEVER;
+
+    if (wheel_next != UINT32_MAX) {
+        due = (int64_t)(wheel_ticks + wheel_next) * CONFIG_TIMER_WHEEL_TICK_MS;
+    }
+    if (num_pending > 0) {
+        due = MIN(due, pending[0].due_ms);
+    }
+    return due;
+}
+
+// Moves the virtual clock to @p to_ms, bringing the wheel along.
+static void advance_to(int64_t to_ms)
+{
+    const uint64_t ticks = to_ms / CONFIG_TIMER_WHEEL_TICK_MS;
+
+    now_ms = to_ms;
+    if (ticks > wheel_ticks) {
+        timer_wheel_advance(ticks - wheel_ticks);
+        wheel_ticks = ticks;
+    }
+}
+
+int sim_des_init(const sim_des_config_t *cfg)
+{
+    if (!cfg || !cfg->deliver || !cfg->events || cfg->num_events == 0) {
+        return -EINVAL;
+    }
+
+    if (!subscription) {
+        subscription = event_bus_subscribe(&sim_des_q, cfg->events, cfg->num_events);
+        if (!subscription) {
+            LOG_ERR("Cannot subscribe to the event bus");
+            return -ENOMEM;
+        }
+    }
+
+    config = *cfg;
+    k_msgq_purge(&sim_des_q);
+    num_pending = 0;
+    next_order = 0;
+    now_ms = 0;
+    wheel_ticks = 0;
+    plant_gen = 1;
+    plant_l1 = cfg->fsm ? cfg->fsm->system_state : STATE_L1_POWER_OFF;
+    plant_l2 = cfg->fsm ? cfg->fsm->wash_cycle_state : STATE_L2_IDLE;
+    memset(&stats, 0, sizeof(stats));
+    water_level_sim_set_state(false);
+
+    return timer_wheel_init();
+}
+
+int64_t sim_des_now_ms(void)
+{
+    return now_ms;
+}
+
+int sim_des_schedule(uint32_t delay_ms, event_id_t event, uint32_t payload)
+{
+    return pending_push(delay_ms, event, payload, 0);
+}
+
+int sim_des_step(void)
+{
+    const int64_t due = next_due_ms();
+
+    if (due == SIM_DES_NEVER) {
+        return -ENODATA;
+    }
+
+    stats.instants++;
+    // Timer expiries of this instant first, then the scheduled events.
+    advance_to(due);
+    deliver_all();
+    while (num_pending > 0 && pending[0].due_ms <= now_ms) {
+        const sim_pending_t p = pending_pop();
+
+        post_pending(&p);
+    }
+    return 0;
+}
+
+uint32_t sim_des_run(int64_t until_ms)
+{
+    const uint64_t delivered = stats.delivered;
+
+    while (now_ms < until_ms) {
+        const int64_t due = next_due_ms();
+
+        if (due == SIM_DES_NEVER) {
+            break;
+        }
+        if (due > until_ms) {
+            // Nothing due before the end: the clock just moves on.
+            advance_to(until_ms);
+            break;
+        }
+        sim_des_step();
+    }
+    return stats.delivered - delivered;
+}
+
+void sim_des_get_stats(sim_des_stats_t *out)
+{
+    if (out) {
+        *out = stats;
+    }
+}
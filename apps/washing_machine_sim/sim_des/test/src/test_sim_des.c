@@ -0,0 +1,296 @@
+#include <zephyr/ztest.h>
+#include <string.h>
+#include "event_bus.h"
+#include "controller_thread.h"
+#include "fsm_notify.h"
+#include "sim_water_level.h"
+#include "wash_program.h"
+#include "sim_des.h"
+
+#define TRACE_MAX 64
+#define ONE_DAY_MS (24LL * 3600 * 1000)
+
+// Plant delays of sim_des.c and phase timeouts of l2_wash_cycle.puml
+#define BASE_CYCLE_MS ((30 + 20 + 90 + 1800 + 60 + 720 + 60 + 480) * 1000LL)
+#define PREWASH_MS ((600 + 60) * 1000LL)
+#define HEATING_MS (600 * 1000LL)
+#define STEAM_MS (900 * 1000LL)
+
+typedef struct {
+    int64_t time_ms;
+    event_id_t event;
+} trace_entry_t;
+
+static trace_entry_t trace[TRACE_MAX];
+static int trace_len;
+
+// State change notifications, delivered by the direct-dispatch bus
+K_MSGQ_DEFINE(changes_msgq, sizeof(app_event_t), TRACE_MAX, 4);
+
+static void deliver(const app_event_t *event)
+{
+    if (trace_len < TRACE_MAX) {
+        trace[trace_len++] = (trace_entry_t){ sim_des_now_ms(), event->id };
+    }
+    controller_handle_event(event);
+}
+
+static void *sim_des_suite_setup(void)
+{
+    static const event_id_t change_events[] = { EVENT_FSM_STATE_CHANGED };
+
+    zassert_ok(event_bus_init(), "event_bus_init() failed");
+    zassert_not_null(event_bus_subscribe(&changes_msgq, change_events,
+                                         ARRAY_SIZE(change_events)));
+    controller_set_clock(sim_des_now_ms);
+    return NULL;
+}
+
+static void sim_des_before(void *data)
+{
+    sim_des_config_t config = {
+        .deliver = deliver,
+        .fsm = controller_fsm_get_handle(),
+    };
+
+    ARG_UNUSED(data);
+
+    config.num_events = controller_get_subscribed_events(&config.events);
+    zassert_ok(sim_des_init(&config));
+    controller_start();
+    trace_len = 0;
+    k_msgq_purge(&changes_msgq);
+}
+
+static bool l1_is(system_state_t state)
+{
+    return controller_fsm_get_handle()->system_state == state;
+}
+
+// Runs until the machine reaches @p state and returns the virtual time.
+static int64_t run_until_l1(system_state_t state)
+{
+    while (!l1_is(state)) {
+        zassert_ok(sim_des_step(), "Simulation stalled before %s",
+                   fsm_get_system_state_name(state));
+    }
+    return sim_des_now_ms();
+}
+
+// Powers up, selects a programme and presses start. Returns the start time.
+static int64_t start_cycle(bool prewash, bool heating, bool steam)
+{
+    fsm_handle_t *fsm = controller_fsm_get_handle();
+
+    zassert_ok(sim_des_schedule(0, EVENT_POWER_BUTTON_PRESSED, 0));
+    zassert_ok(sim_des_schedule(1000, EVENT_CYCLE_SELECTED, 0));
+    run_until_l1(STATE_L1_SELECTION);
+
+    fsm->program_has_prewash = prewash;
+    fsm->program_has_heating = heating;
+    fsm->program_has_steam = steam;
+    zassert_ok(sim_des_schedule(1000, EVENT_START_BUTTON_PRESSED, 0));
+    return run_until_l1(STATE_L1_RUNNING);
+}
+
+ZTEST(sim_des_suite, test_basic_cycle_takes_its_phase_times)
+{
+    const int64_t start = start_cycle(false, false, false);
+    const int64_t end = run_until_l1(STATE_L1_END);
+
+    zassert_equal(end - start, BASE_CYCLE_MS, "Cycle took %lld ms", end - start);
+    zassert_equal(controller_fsm_get_handle()->wash_cycle_state, STATE_L2_COMPLETE);
+}
+
+ZTEST(sim_des_suite, test_all_options_cycle_takes_its_phase_times)
+{
+    const int64_t start = start_cycle(true, true, true);
+    const int64_t end = run_until_l1(STATE_L1_END);
+
+    zassert_equal(end - start, BASE_CYCLE_MS + PREWASH_MS + HEATING_MS + STEAM_MS,
+                  "Cycle took %lld ms", end - start);
+}
+
+ZTEST(sim_des_suite, test_pause_stretches_the_phase)
+{
+    const int64_t start = start_cycle(false, false, false);
+
+    // Ten minutes into the cycle the machine is washing.
+    zassert_ok(sim_des_schedule(600000, EVENT_PAUSE_BUTTON_PRESSED, 0));
+    zassert_ok(sim_des_schedule(600000 + 300000, EVENT_START_BUTTON_PRESSED, 0));
+    run_until_l1(STATE_L1_PAUSED);
+    zassert_equal(controller_fsm_get_handle()->wash_cycle_state, STATE_L2_WASHING);
+
+    const int64_t end = run_until_l1(STATE_L1_END);
+
+    zassert_equal(end - start, BASE_CYCLE_MS + 300000, "Cycle took %lld ms", end - start);
+}
+
+ZTEST(sim_des_suite, test_plant_drives_the_water_level)
+{
+    start_cycle(false, false, false);
+
+    while (controller_fsm_get_handle()->wash_cycle_state != STATE_L2_WASHING) {
+        zassert_ok(sim_des_step());
+    }
+    zassert_true(water_level_sim_get_state(), "Drum not full while washing");
+
+    while (controller_fsm_get_handle()->wash_cycle_state != STATE_L2_RINSING) {
+        zassert_ok(sim_des_step());
+    }
+    zassert_false(water_level_sim_get_state(), "Drum not drained after washing");
+}
+
+ZTEST(sim_des_suite, test_programme_from_the_selection_payload)
+{
+    const wash_program_t *cotton = wash_program_get(WASH_PROGRAM_COTTON);
+    // Cotton heats, and the plant reaches temperature in its own time.
+    const int64_t expected_ms = (30 + 20 + 90 + 600 + 60 + 60) * 1000LL +
+                                (cotton->phase_s[STATE_L2_WASHING] +
+                                 cotton->rinse_count * cotton->phase_s[STATE_L2_RINSING] +
+                                 cotton->phase_s[STATE_L2_SPINNING]) * 1000LL;
+
+    zassert_ok(sim_des_schedule(0, EVENT_POWER_BUTTON_PRESSED, 0));
+    zassert_ok(sim_des_schedule(1000, EVENT_CYCLE_SELECTED, WASH_PROGRAM_COTTON));
+    zassert_ok(sim_des_schedule(2000, EVENT_START_BUTTON_PRESSED, 0));
+
+    const int64_t start = run_until_l1(STATE_L1_RUNNING);
+    const uint32_t estimate = controller_get_remaining_ms();
+
+    zassert_equal(controller_fsm_get_handle()->program_id, WASH_PROGRAM_COTTON);
+    zassert_true(controller_fsm_get_handle()->program_has_heating);
+
+    const int64_t end = run_until_l1(STATE_L1_END);
+
+    zassert_equal(end - start, expected_ms, "Cycle took %lld ms", end - start);
+    // The estimate planned the nominal heating time, longer than it took.
+    zassert_equal(estimate, expected_ms + (cotton->phase_s[STATE_L2_HEATING] - 600) * 1000LL);
+    zassert_equal(controller_get_remaining_ms(), 0);
+}
+
+ZTEST(sim_des_suite, test_runs_are_repeatable)
+{
+    static trace_entry_t first[TRACE_MAX];
+    int first_len;
+
+    start_cycle(true, false, true);
+    run_until_l1(STATE_L1_END);
+    memcpy(first, trace, sizeof(first));
+    first_len = trace_len;
+
+    sim_des_before(NULL);
+    start_cycle(true, false, true);
+    run_until_l1(STATE_L1_END);
+
+    zassert_equal(trace_len, first_len, "Different number of events");
+    for (int i = 0; i < trace_len; i++) {
+        zassert_equal(trace[i].event, first[i].event, "Event %d differs", i);
+        zassert_equal(trace[i].time_ms, first[i].time_ms, "Event %d at a different time", i);
+    }
+}
+
+ZTEST(sim_des_suite, test_idle_machine_runs_out_of_work)
+{
+    sim_des_stats_t stats;
+
+    start_cycle(false, false, false);
+    run_until_l1(STATE_L1_END);
+
+    // Nothing left to do: the clock does not run away.
+    zassert_equal(sim_des_step(), -ENODATA);
+    zassert_equal(sim_des_run(ONE_DAY_MS), 0, "Events delivered after the cycle ended");
+
+    sim_des_get_stats(&stats);
+    zassert_equal(stats.stale, 0);
+    // A few stops per phase, not one per wheel tick.
+    zassert_true(stats.instants < 100, "The clock stopped %u times in one cycle",
+                 stats.instants);
+}
+
+ZTEST(sim_des_suite, test_state_changes_are_published)
+{
+    fsm_state_change_t previous = { STATE_L1_POWER_OFF, STATE_L2_IDLE };
+    fsm_state_change_t change;
+    app_event_t event;
+    int count = 0;
+
+    start_cycle(true, true, true);
+    run_until_l1(STATE_L1_END);
+
+    // Every change starts where the one before ended.
+    while (k_msgq_get(&changes_msgq, &event, K_NO_WAIT) == 0) {
+        change = fsm_state_change_unpack(event.payload.u32);
+        zassert_equal(change.old_l1, previous.new_l1, "Gap before change %d", count);
+        zassert_equal(change.old_l2, previous.new_l2, "Gap before change %d", count);
+        zassert_true(change.old_l1 != change.new_l1 || change.old_l2 != change.new_l2,
+                     "Change %d changes nothing", count);
+        previous = change;
+        count++;
+    }
+    zassert_true(count > 10, "Only %d changes in a full cycle", count);
+    zassert_equal(previous.new_l1, STATE_L1_END);
+    zassert_equal(previous.new_l2, STATE_L2_COMPLETE);
+}
+
+ZTEST(sim_des_suite, test_l2_changes_of_a_batch_are_coalesced)
+{
+    static const event_id_t batch[] = {
+        EVENT_WEIGHT_CALCULATED, EVENT_DOSING_COMPLETE, EVENT_WATER_LEVEL_REACHED,
+    };
+    fsm_notify_stats_t stats;
+    fsm_state_change_t change;
+    app_event_t event;
+
+    start_cycle(false, false, false);
+    zassert_equal(controller_fsm_get_handle()->wash_cycle_state, STATE_L2_LOAD_SENSING);
+    k_msgq_purge(&changes_msgq);
+
+    for (int i = 0; i < ARRAY_SIZE(batch); i++) {
+        event = (app_event_t){ .id = batch[i] };
+        zassert_ok(k_msgq_put(&fsm_msgq, &event, K_NO_WAIT));
+    }
+    zassert_equal(controller_drain(K_NO_WAIT), ARRAY_SIZE(batch));
+
+    zassert_ok(k_msgq_get(&changes_msgq, &event, K_NO_WAIT), "No change published");
+    change = fsm_state_change_unpack(event.payload.u32);
+    zassert_equal(change.old_l1, STATE_L1_RUNNING);
+    zassert_equal(change.old_l2, STATE_L2_LOAD_SENSING);
+    zassert_equal(change.new_l1, STATE_L1_RUNNING);
+    zassert_equal(change.new_l2, STATE_L2_WASHING);
+    zassert_equal(k_msgq_num_used_get(&changes_msgq), 0, "Batch published more than once");
+
+    fsm_notify_get_stats(&stats);
+    zassert_equal(stats.coalesced, 2);
+    zassert_equal(stats.failed, 0);
+}
+
+ZTEST(sim_des_suite, test_brownout_is_published_with_its_power_loss)
+{
+    static const event_id_t batch[] = {
+        EVENT_POWER_LOSS_DETECTED, EVENT_POWER_RESTORED,
+    };
+    fsm_state_change_t change;
+    app_event_t event;
+
+    start_cycle(false, false, false);
+    k_msgq_purge(&changes_msgq);
+
+    for (int i = 0; i < ARRAY_SIZE(batch); i++) {
+        event = (app_event_t){ .id = batch[i] };
+        zassert_ok(k_msgq_put(&fsm_msgq, &event, K_NO_WAIT));
+    }
+    zassert_equal(controller_drain(K_NO_WAIT), ARRAY_SIZE(batch));
+
+    // The brownout is held only until its checkpoint, not to the end of
+    // the batch, so it does not cancel out against the restore.
+    zassert_ok(k_msgq_get(&changes_msgq, &event, K_NO_WAIT), "Brownout not published");
+    change = fsm_state_change_unpack(event.payload.u32);
+    zassert_equal(change.old_l1, STATE_L1_RUNNING);
+    zassert_equal(change.new_l1, STATE_L1_BROWNOUT);
+    zassert_ok(k_msgq_get(&changes_msgq, &event, K_NO_WAIT), "Restore not published");
+    change = fsm_state_change_unpack(event.payload.u32);
+    zassert_equal(change.old_l1, STATE_L1_BROWNOUT);
+    zassert_equal(change.new_l1, STATE_L1_RUNNING);
+}
+
+ZTEST_SUITE(sim_des_suite, NULL, sim_des_suite_setup, sim_des_before, NULL, NULL);
@@ -1,8 +1,46 @@
+/*
+ * Copyright (c) 2024 Your Name
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
 #ifndef SENSOR_DOOR_THREAD_H
 #define SENSOR_DOOR_THREAD_H
 
-void sensor_door_thread(void *, void *, void *);
+#include <stdint.h>
+#include "event_defs.h"
+
+/*
+ * The door sensor on GPIO edge interrupts. Every edge restarts a debounce
+ * timer; once the line has been quiet for SENSOR_DOOR_DEBOUNCE_MS, the
+ * level is read and EVENT_DOOR_OPENED or EVENT_DOOR_CLOSED is posted if
+ * it differs from the last stable one. A bouncing contact costs one
+ * interrupt per edge and one event per real change, and nothing runs
+ * while the door stays put.
+ */
+
+#define SENSOR_DOOR_DEBOUNCE_MS 20
+
+typedef struct {
+	uint32_t edges;         // Interrupts taken
+	uint32_t changes;       // Stable changes posted
+	uint32_t bounces;       // Settled back to the state it had
+} sensor_door_stats_t;
+
+/**
+ * @brief Takes the current level as the stable state and enables the
+ * edge interrupts. Calling it again only re-reads the level.
+ *
+ * @retval 0 if successful.
+ * @retval -ENODEV if the GPIO controller is not ready.
+ * @retval other negative error code from the GPIO driver.
+ */
 int sensor_door_start(void);
+
+/**
+ * @brief The last stable state: EVENT_DOOR_CLOSED or EVENT_DOOR_OPENED.
+ */
 event_id_t sensor_door_get_state(void);
 
+void sensor_door_get_stats(sensor_door_stats_t *stats);
+
 #endif // SENSOR_DOOR_THREAD_H
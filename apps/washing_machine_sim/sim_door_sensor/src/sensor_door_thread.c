@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2024 Your Name
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/logging/log.h>
+
+#include "event_bus.h"
+#include "sensor_door_thread.h"
+
+LOG_MODULE_REGISTER(sensor_door, CONFIG_LOG_DEFAULT_LEVEL);
+
+#if !DT_HAS_ALIAS(sensor0)
+#error "The devicetree must have a 'sensor0' alias."
+#endif
+
+static const struct gpio_dt_spec sensor = GPIO_DT_SPEC_GET(DT_ALIAS(sensor0), gpios);
+static struct gpio_callback edge_cb;
+static struct k_work_delayable debounce_work;
+static bool started;
+
+// EVENT_DOOR_CLOSED or EVENT_DOOR_OPENED
+static atomic_t stable_state = ATOMIC_INIT(EVENT_DOOR_OPENED);
+static atomic_t edges;
+// Only touched by the debounce work
+static sensor_door_stats_t stats;
+
+static event_id_t read_state(void)
+{
+	return gpio_pin_get_dt(&sensor) > 0 ? EVENT_DOOR_CLOSED : EVENT_DOOR_OPENED;
+}
+
+// Runs once the line has been quiet for the debounce time.
+static void debounce_expired(struct k_work *work)
+{
+	ARG_UNUSED(work);
+
+	const event_id_t state = read_state();
+
+	if (state == (event_id_t)atomic_get(&stable_state)) {
+		stats.bounces++;
+		return;
+	}
+
+	atomic_set(&stable_state, state);
+	stats.changes++;
+
+	const app_event_t event = { .id = state };
+
+	if (event_bus_post(&event) != 0) {
+		LOG_WRN("Door event %d not delivered to every subscriber", state);
+	}
+}
+
+// Interrupt context: every edge pushes the deadline back.
+static void door_edge(const struct device *dev, struct gpio_callback *cb, uint32_t pins)
+{
+	ARG_UNUSED(dev);
+	ARG_UNUSED(cb);
+	ARG_UNUSED(pins);
+
+	atomic_inc(&edges);
+	k_work_reschedule(&debounce_work, K_MSEC(SENSOR_DOOR_DEBOUNCE_MS));
+}
+
+int sensor_door_start(void)
+{
+	int ret;
+
+	if (!gpio_is_ready_dt(&sensor)) {
+		return -ENODEV;
+	}
+
+	if (!started) {
+		ret = gpio_pin_configure_dt(&sensor, GPIO_INPUT);
+		if (ret != 0) {
+			return ret;
+		}
+
+		k_work_init_delayable(&debounce_work, debounce_expired);
+		gpio_init_callback(&edge_cb, door_edge, BIT(sensor.pin));
+		ret = gpio_add_callback_dt(&sensor, &edge_cb);
+		if (ret != 0) {
+			return ret;
+		}
+	}
+
+	atomic_set(&stable_state, read_state());
+
+	ret = gpio_pin_interrupt_configure_dt(&sensor, GPIO_INT_EDGE_BOTH);
+	if (ret != 0) {
+		LOG_ERR("Door sensor interrupt not available: %d", ret);
+		return ret;
+	}
+
+	started = true;
+	LOG_INF("Door sensor started, door %s",
+			atomic_get(&stable_state) == EVENT_DOOR_CLOSED ? "closed" : "open");
+	return 0;
+}
+
+event_id_t sensor_door_get_state(void)
+{
+	return (event_id_t)atomic_get(&stable_state);
+}
+
+void sensor_door_get_stats(sensor_door_stats_t *out)
+{
+	*out = stats;
+	out->edges = atomic_get(&edges);
+}
@@ -0,0 +1,90 @@
+#include <zephyr/ztest.h>
+#include "event_bus.h"
+#include "sim_door_sensor.h"
+#include "sensor_door_thread.h"
+
+// Long enough for the debounce work to run
+#define SETTLE K_MSEC(2 * SENSOR_DOOR_DEBOUNCE_MS)
+// Well inside the debounce time
+#define BOUNCE K_MSEC(SENSOR_DOOR_DEBOUNCE_MS / 5)
+
+K_MSGQ_DEFINE(door_msgq, sizeof(app_event_t), 8, 4);
+
+static const event_id_t door_events[] = { EVENT_DOOR_OPENED, EVENT_DOOR_CLOSED };
+
+static void *sensor_door_setup(void)
+{
+	zassert_ok(event_bus_init());
+	zassert_ok(event_bus_register_queue_sink(&door_msgq, door_events,
+											 ARRAY_SIZE(door_events), NULL));
+	zassert_ok(door_sensor_sim_init());
+	return NULL;
+}
+
+static void sensor_door_before(void *data)
+{
+	ARG_UNUSED(data);
+
+	// Every test starts with a settled, open door and nothing queued.
+	zassert_ok(door_sensor_sim_set_state(false));
+	zassert_ok(sensor_door_start());
+	k_sleep(SETTLE);
+	k_msgq_purge(&door_msgq);
+}
+
+// Toggles the line @p edges times, ending closed when @p edges is odd.
+static void bounce(int edges)
+{
+	for (int i = 1; i <= edges; i++) {
+		zassert_ok(door_sensor_sim_set_state(i % 2));
+		k_sleep(BOUNCE);
+	}
+}
+
+ZTEST(sensor_door_suite, test_bouncing_close_posts_once)
+{
+	app_event_t event;
+	sensor_door_stats_t before, after;
+
+	zassert_equal(sensor_door_get_state(), EVENT_DOOR_OPENED);
+	sensor_door_get_stats(&before);
+
+	bounce(7);
+	// Nothing until the line has been quiet for the debounce time
+	zassert_equal(k_msgq_num_used_get(&door_msgq), 0);
+	zassert_equal(sensor_door_get_state(), EVENT_DOOR_OPENED);
+
+	zassert_ok(k_msgq_get(&door_msgq, &event, SETTLE));
+	zassert_equal(event.id, EVENT_DOOR_CLOSED);
+	zassert_equal(sensor_door_get_state(), EVENT_DOOR_CLOSED);
+	zassert_equal(k_msgq_get(&door_msgq, &event, SETTLE), -EAGAIN, "One event per change");
+
+	sensor_door_get_stats(&after);
+	zassert_equal(after.edges - before.edges, 7);
+	zassert_equal(after.changes - before.changes, 1);
+
+	// And back open
+	bounce(4);
+	zassert_ok(door_sensor_sim_set_state(false));
+	zassert_ok(k_msgq_get(&door_msgq, &event, SETTLE));
+	zassert_equal(event.id, EVENT_DOOR_OPENED);
+}
+
+ZTEST(sensor_door_suite, test_glitch_posts_nothing)
+{
+	app_event_t event;
+	sensor_door_stats_t before, after;
+
+	sensor_door_get_stats(&before);
+
+	// Closed for less than the debounce time, then open again
+	bounce(2);
+	zassert_equal(k_msgq_get(&door_msgq, &event, SETTLE), -EAGAIN);
+	zassert_equal(sensor_door_get_state(), EVENT_DOOR_OPENED);
+
+	sensor_door_get_stats(&after);
+	zassert_equal(after.changes, before.changes);
+	zassert_equal(after.bounces - before.bounces, 1);
+}
+
+ZTEST_SUITE(sensor_door_suite, NULL, sensor_door_setup, sensor_door_before, NULL, NULL);
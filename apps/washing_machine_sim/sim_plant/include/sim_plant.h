@@ -0,0 +1,180 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "event_defs.h"
+
+/**
+ * @file sim_plant.h
+ * @brief Fixed-step physics model of the drum: water level, water
+ * temperature and drum speed.
+ *
+ * The model integrates at a fixed rate in fixed point, with no floats
+ * and no division in the step. It takes the machine's COMMAND_* events
+ * and answers with the sensor events a real machine would produce: level,
+ * temperature and speed reports as the values move, and the threshold
+ * events the wash cycle waits for.
+ *
+ * - Water: the inlet fills at a constant flow up to the overflow level,
+ *   the drain pump empties at a constant flow.
+ * - Temperature: a thermostat runs the heater towards the commanded
+ *   temperature; the water loses heat to the ambient with a time constant.
+ *   The heater does not run dry.
+ * - Drum: the motor ramps towards the commanded speed, more slowly the
+ *   more water is in the drum, and coasts down at a fixed rate.
+ *
+ * The bus has no valve command, so the water is set with
+ * sim_plant_set_water().
+ *
+ * A plant is a plain struct that only moves when the caller steps it, so
+ * tests and benchmarks can run it as fast as they like.
+ * sim_plant_thread.h runs one on the bus in real time.
+ */
+
+// Q11.20: whole units up to 2047, resolution about one millionth
+#define SIM_PLANT_FRAC_BITS 20
+#define SIM_PLANT_ONE (1 << SIM_PLANT_FRAC_BITS)
+
+// Faster rates would round the slowest per-step changes by several percent.
+#define SIM_PLANT_MAX_RATE_HZ 1000
+
+// Most events one step can produce; size the buffer for sim_plant_step()
+#define SIM_PLANT_MAX_EVENTS 8
+
+typedef int32_t sim_plant_q_t;
+
+typedef enum {
+    SIM_PLANT_WATER_HOLD,   // Inlet and drain closed
+    SIM_PLANT_WATER_FILL,   // Inlet open
+    SIM_PLANT_WATER_DRAIN,  // Drain pump running
+} sim_plant_water_t;
+
+/**
+ * @brief Physical constants of the machine, in whole units.
+ */
+typedef struct {
+    uint32_t rate_hz;               // Integration steps per second
+    uint16_t fill_level_mm;         // EVENT_WATER_LEVEL_REACHED once filled past this
+    uint16_t max_level_mm;          // Overflow protection stops the inlet here
+    uint16_t min_heat_level_mm;     // The heater stays off below this
+    uint16_t inlet_mm_per_min;
+    uint16_t drain_mm_per_min;
+    uint16_t heat_c_per_min;        // Heating rate at full power
+    uint16_t loss_tau_s;            // Cooling time constant towards the ambient
+    int16_t ambient_c;              // Room and inlet water temperature
+    uint16_t accel_rpm_per_s;       // Ramp up with an empty drum
+    uint16_t decel_rpm_per_s;
+    uint16_t max_rpm;
+    // Smallest change reported by the sensor events
+    uint16_t level_report_mm;
+    uint16_t temp_report_c;
+    uint16_t rpm_report;
+} sim_plant_params_t;
+
+/**
+ * @brief One plant. Only the sim_plant_* functions change it; read the
+ * values through sim_plant_level_mm() and friends.
+ */
+typedef struct {
+    sim_plant_params_t params;
+
+    // Per-step changes, derived from the parameters
+    sim_plant_q_t inlet_step;
+    sim_plant_q_t drain_step;
+    sim_plant_q_t heat_step;
+    sim_plant_q_t accel_step;
+    sim_plant_q_t decel_step;
+    uint32_t loss_coef;             // Share of the excess heat lost per step, Q0.32
+    int32_t load_coef;              // Ramp slowdown per mm of water, Q16
+
+    // Physical state
+    sim_plant_q_t level;            // mm
+    sim_plant_q_t temp;             // degrees C
+    sim_plant_q_t rpm;
+
+    // Actuators, as last commanded
+    sim_plant_water_t water;
+    int32_t target_temp_c;          // 0 switches the heater off
+    int32_t target_rpm;
+    bool heater_on;
+    bool door_locked;
+    bool door_changed;              // Lock state not reported yet
+
+    // Last reported values, and the threshold events still to come
+    int32_t reported_level_mm;
+    int32_t reported_temp_c;
+    int32_t reported_rpm;
+    bool level_armed;
+    bool empty_armed;
+    bool temp_armed;
+    bool stop_armed;
+
+    uint64_t steps;
+} sim_plant_t;
+
+/**
+ * @brief Fills @p params with a front loader: 100 mm of water in about a
+ * minute, 3 C per minute of heating, spin at up to 1600 rpm, stepped at
+ * 100 Hz.
+ */
+void sim_plant_get_default_params(sim_plant_params_t *params);
+
+/**
+ * @brief Starts @p plant empty, at the ambient temperature and at rest.
+ *
+ * @param params Machine constants, NULL for the defaults.
+ * @return 0 on success, -EINVAL for a rate of 0 or above
+ *         SIM_PLANT_MAX_RATE_HZ, or a fill level above the overflow level.
+ */
+int sim_plant_init(sim_plant_t *plant, const sim_plant_params_t *params);
+
+/**
+ * @brief Changes the integration rate, keeping the physical state.
+ *
+ * @return 0 on success, -EINVAL for a rate of 0 or above
+ *         SIM_PLANT_MAX_RATE_HZ.
+ */
+int sim_plant_set_rate(sim_plant_t *plant, uint32_t rate_hz);
+
+/**
+ * @brief Applies a COMMAND_* event: COMMAND_HEATER_SET_TEMP (degrees C,
+ * 0 for off), COMMAND_MOTOR_SET_SPEED (rpm) or COMMAND_DOOR_SET_LOCK.
+ *
+ * A new temperature or speed arms EVENT_TEMP_REACHED or
+ * EVENT_MOTOR_STOPPED again.
+ *
+ * @return 0 on success, -ENOTSUP for any other event.
+ */
+int sim_plant_command(sim_plant_t *plant, const app_event_t *command);
+
+/**
+ * @brief Opens the inlet, runs the drain pump or closes both. Filling arms
+ * EVENT_WATER_LEVEL_REACHED, draining arms EVENT_DRUM_EMPTY.
+ */
+void sim_plant_set_water(sim_plant_t *plant, sim_plant_water_t water);
+
+/**
+ * @brief Advances the plant by one step of 1 / rate_hz seconds.
+ *
+ * @param out Receives the sensor events of the step, in the order the
+ *            sensors saw them. Room for SIM_PLANT_MAX_EVENTS is enough.
+ * @param max Room in @p out; events beyond it are lost.
+ * @return The number of events written.
+ */
+size_t sim_plant_step(sim_plant_t *plant, app_event_t *out, size_t max);
+
+static inline int32_t sim_plant_level_mm(const sim_plant_t *plant)
+{
+    return plant->level >> SIM_PLANT_FRAC_BITS;
+}
+
+static inline int32_t sim_plant_temp_c(const sim_plant_t *plant)
+{
+    return plant->temp >> SIM_PLANT_FRAC_BITS;
+}
+
+static inline int32_t sim_plant_rpm(const sim_plant_t *plant)
+{
+    return plant->rpm >> SIM_PLANT_FRAC_BITS;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <stdint.h>
+#include "sim_plant.h"
+
+/**
+ * @file sim_plant_thread.h
+ * @brief Runs one plant in real time on the event bus.
+ *
+ * A thread steps the plant on a periodic kernel timer. It takes the
+ * COMMAND_* events off the bus before each step and posts the sensor
+ * events the step produced. When the thread falls behind, it catches up
+ * with a few extra steps, so the plant keeps pace with the wall clock.
+ */
+
+#define SIM_PLANT_THREAD_DEFAULT_HZ 100
+
+typedef struct {
+    uint32_t posted;        // Sensor events posted
+    uint32_t failed;        // Posts the bus did not take in full
+    uint32_t overruns;      // Steps skipped because the thread fell too far behind
+} sim_plant_thread_stats_t;
+
+/**
+ * @brief Starts the plant, or changes the rate of a running one.
+ *
+ * The first call sets the plant up with the default parameters and
+ * subscribes it to the COMMAND_* events. The bus must be initialized.
+ *
+ * @return 0 on success, -EINVAL for a bad rate, -ENOMEM if the bus has no
+ *         subscription left.
+ */
+int sim_plant_thread_start(uint32_t rate_hz);
+
+/**
+ * @brief Freezes the plant in its current state.
+ */
+void sim_plant_thread_stop(void);
+
+void sim_plant_thread_set_water(sim_plant_water_t water);
+
+/**
+ * @brief Copies the plant and the counters, either may be NULL.
+ */
+void sim_plant_thread_get(sim_plant_t *plant, sim_plant_thread_stats_t *stats);
@@ -0,0 +1,246 @@
+#include "sim_plant.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zephyr/sys/util.h>
+
+// Ramp factor with an empty drum, Q16
+#define LOAD_FACTOR_ONE 65536
+// First whole value out of the range of sim_plant_q_t
+#define Q_LIMIT (1 << (31 - SIM_PLANT_FRAC_BITS))
+#define MAX_TEMP_C 100
+
+void sim_plant_get_default_params(sim_plant_params_t *params)
+{
+    *params = (sim_plant_params_t){
+        .rate_hz = 100,
+        .fill_level_mm = 100,
+        .max_level_mm = 150,
+        .min_heat_level_mm = 30,
+        .inlet_mm_per_min = 100,
+        .drain_mm_per_min = 200,
+        .heat_c_per_min = 3,
+        .loss_tau_s = 3600,
+        .ambient_c = 15,
+        .accel_rpm_per_s = 200,
+        .decel_rpm_per_s = 300,
+        .max_rpm = 1600,
+        .level_report_mm = 1,
+        .temp_report_c = 1,
+        .rpm_report = 10,
+    };
+}
+
+// Rounded change per step of a rate given per second or per minute
+static sim_plant_q_t per_step(uint32_t amount, uint32_t per_s, uint32_t rate_hz)
+{
+    const uint64_t steps = (uint64_t)per_s * rate_hz;
+
+    return (sim_plant_q_t)((((uint64_t)amount << SIM_PLANT_FRAC_BITS) + steps / 2) / steps);
+}
+
+// Per-step changes at the current rate
+static void derive_steps(sim_plant_t *plant)
+{
+    const sim_plant_params_t *params = &plant->params;
+    const uint32_t hz = params->rate_hz;
+
+    plant->inlet_step = per_step(params->inlet_mm_per_min, 60, hz);
+    plant->drain_step = per_step(params->drain_mm_per_min, 60, hz);
+    plant->heat_step = per_step(params->heat_c_per_min, 60, hz);
+    plant->accel_step = per_step(params->accel_rpm_per_s, 1, hz);
+    plant->decel_step = per_step(params->decel_rpm_per_s, 1, hz);
+    // Excess * (1 - e^(-dt/tau)), with dt much shorter than tau
+    plant->loss_coef = 0;
+    if (params->loss_tau_s) {
+        const uint64_t steps = (uint64_t)params->loss_tau_s * hz;
+
+        plant->loss_coef = (uint32_t)(((1ULL << 32) + steps / 2) / steps);
+    }
+}
+
+int sim_plant_init(sim_plant_t *plant, const sim_plant_params_t *params)
+{
+    sim_plant_params_t defaults;
+
+    if (!params) {
+        sim_plant_get_default_params(&defaults);
+        params = &defaults;
+    }
+    if (params->rate_hz == 0 || params->rate_hz > SIM_PLANT_MAX_RATE_HZ ||
+        params->fill_level_mm > params->max_level_mm || params->max_level_mm == 0 ||
+        params->max_level_mm >= Q_LIMIT || params->max_rpm >= Q_LIMIT) {
+        return -EINVAL;
+    }
+
+    memset(plant, 0, sizeof(*plant));
+    plant->params = *params;
+    derive_steps(plant);
+    // A full drum ramps up at half the rate of an empty one.
+    plant->load_coef = LOAD_FACTOR_ONE / 2 / params->max_level_mm;
+
+    plant->temp = (sim_plant_q_t)params->ambient_c << SIM_PLANT_FRAC_BITS;
+    plant->reported_temp_c = params->ambient_c;
+    return 0;
+}
+
+int sim_plant_set_rate(sim_plant_t *plant, uint32_t rate_hz)
+{
+    if (rate_hz == 0 || rate_hz > SIM_PLANT_MAX_RATE_HZ) {
+        return -EINVAL;
+    }
+
+    plant->params.rate_hz = rate_hz;
+    derive_steps(plant);
+    return 0;
+}
+
+int sim_plant_command(sim_plant_t *plant, const app_event_t *command)
+{
+    switch (command->id) {
+    case COMMAND_HEATER_SET_TEMP:
+        plant->target_temp_c = CLAMP(command->payload.s32, 0, MAX_TEMP_C);
+        plant->heater_on = plant->target_temp_c > 0 &&
+                           plant->temp < (plant->target_temp_c << SIM_PLANT_FRAC_BITS);
+        plant->temp_armed = plant->target_temp_c > 0;
+        return 0;
+    case COMMAND_MOTOR_SET_SPEED:
+        plant->target_rpm = CLAMP(command->payload.s32, 0, plant->params.max_rpm);
+        plant->stop_armed = plant->target_rpm == 0 && plant->rpm > 0;
+        return 0;
+    case COMMAND_DOOR_SET_LOCK:
+        plant->door_changed = plant->door_locked != command->payload.b;
+        plant->door_locked = command->payload.b;
+        return 0;
+    default:
+        return -ENOTSUP;
+    }
+}
+
+void sim_plant_set_water(sim_plant_t *plant, sim_plant_water_t water)
+{
+    plant->water = water;
+    plant->level_armed = water == SIM_PLANT_WATER_FILL;
+    plant->empty_armed = water == SIM_PLANT_WATER_DRAIN;
+}
+
+static void integrate_water(sim_plant_t *plant)
+{
+    const sim_plant_q_t max = (sim_plant_q_t)plant->params.max_level_mm << SIM_PLANT_FRAC_BITS;
+
+    if (plant->water == SIM_PLANT_WATER_FILL) {
+        plant->level = MIN(plant->level + plant->inlet_step, max);
+    } else if (plant->water == SIM_PLANT_WATER_DRAIN) {
+        plant->level = MAX(plant->level - plant->drain_step, 0);
+    }
+}
+
+static void integrate_temp(sim_plant_t *plant)
+{
+    const sim_plant_q_t target = plant->target_temp_c << SIM_PLANT_FRAC_BITS;
+    const sim_plant_q_t ambient = (sim_plant_q_t)plant->params.ambient_c << SIM_PLANT_FRAC_BITS;
+
+    // Thermostat with half a degree of hysteresis, never dry
+    if (plant->target_temp_c <= 0 ||
+        plant->level < (sim_plant_q_t)plant->params.min_heat_level_mm << SIM_PLANT_FRAC_BITS ||
+        plant->temp >= target) {
+        plant->heater_on = false;
+    } else if (plant->temp < target - SIM_PLANT_ONE / 2) {
+        plant->heater_on = true;
+    }
+
+    if (plant->heater_on) {
+        plant->temp += plant->heat_step;
+    }
+    plant->temp -= (sim_plant_q_t)(((int64_t)(plant->temp - ambient) * plant->loss_coef) >> 32);
+}
+
+static void integrate_drum(sim_plant_t *plant)
+{
+    const sim_plant_q_t target = plant->target_rpm << SIM_PLANT_FRAC_BITS;
+
+    if (plant->rpm < target) {
+        // Wet laundry is heavier to get going.
+        const int32_t load = MAX(LOAD_FACTOR_ONE - sim_plant_level_mm(plant) * plant->load_coef,
+                                 0);
+        const sim_plant_q_t up = (sim_plant_q_t)(((int64_t)plant->accel_step * load) >> 16);
+
+        plant->rpm = MIN(plant->rpm + up, target);
+    } else if (plant->rpm > target) {
+        plant->rpm = MAX(plant->rpm - plant->decel_step, target);
+    }
+}
+
+typedef struct {
+    app_event_t *out;
+    size_t max;
+    size_t count;
+} event_sink_t;
+
+static void emit(event_sink_t *sink, event_id_t id, int32_t value)
+{
+    if (sink->count < sink->max) {
+        sink->out[sink->count++] = (app_event_t){ .id = id, .payload.s32 = value };
+    }
+}
+
+// Reports @p value when it moved at least @p step since the last report,
+// or settled on @p target short of that.
+static void report(event_sink_t *sink, event_id_t id, int32_t value, int32_t *reported,
+                   uint32_t step, int32_t target)
+{
+    if ((uint32_t)abs(value - *reported) >= MAX(step, 1U) ||
+        (value == target && value != *reported)) {
+        *reported = value;
+        emit(sink, id, value);
+    }
+}
+
+size_t sim_plant_step(sim_plant_t *plant, app_event_t *out, size_t max)
+{
+    event_sink_t sink = { .out = out, .max = max };
+
+    integrate_water(plant);
+    integrate_temp(plant);
+    integrate_drum(plant);
+    plant->steps++;
+
+    if (plant->door_changed) {
+        plant->door_changed = false;
+        emit(&sink, plant->door_locked ? EVENT_DOOR_LOCKED : EVENT_DOOR_UNLOCKED, 0);
+    }
+
+    const int32_t level_mm = sim_plant_level_mm(plant);
+
+    report(&sink, EVENT_WATER_LEVEL_CHANGED, level_mm, &plant->reported_level_mm,
+           plant->params.level_report_mm,
+           plant->water == SIM_PLANT_WATER_FILL ? plant->params.max_level_mm : 0);
+    if (plant->level_armed && level_mm >= plant->params.fill_level_mm) {
+        plant->level_armed = false;
+        emit(&sink, EVENT_WATER_LEVEL_REACHED, level_mm);
+    }
+    if (plant->empty_armed && plant->level == 0) {
+        plant->empty_armed = false;
+        emit(&sink, EVENT_DRUM_EMPTY, 0);
+    }
+
+    const int32_t temp_c = sim_plant_temp_c(plant);
+
+    report(&sink, EVENT_HEATER_TEMP_CHANGED, temp_c, &plant->reported_temp_c,
+           plant->params.temp_report_c, plant->target_temp_c);
+    if (plant->temp_armed && temp_c >= plant->target_temp_c) {
+        plant->temp_armed = false;
+        emit(&sink, EVENT_TEMP_REACHED, temp_c);
+    }
+
+    const int32_t rpm = sim_plant_rpm(plant);
+
+    report(&sink, EVENT_MOTOR_SPEED_REPORT, rpm, &plant->reported_rpm, plant->params.rpm_report,
+           plant->target_rpm);
+    if (plant->stop_armed && plant->rpm == 0) {
+        plant->stop_armed = false;
+        emit(&sink, EVENT_MOTOR_STOPPED, 0);
+    }
+
+    return sink.count;
+}
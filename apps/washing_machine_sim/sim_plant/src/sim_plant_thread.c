@@ -0,0 +1,149 @@
+#include "sim_plant_thread.h"
+#include "event_bus.h"
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_REGISTER(sim_plant, CONFIG_LOG_DEFAULT_LEVEL);
+
+#define SIM_PLANT_STACK_SIZE 1024
+// Below the controller, like a sensor driver
+#define SIM_PLANT_PRIORITY 6
+// Steps run back to back when the thread falls behind
+#define SIM_PLANT_MAX_CATCH_UP 10
+
+K_THREAD_STACK_DEFINE(sim_plant_stack, SIM_PLANT_STACK_SIZE);
+static struct k_thread sim_plant_thread_data;
+
+K_MSGQ_DEFINE(sim_plant_msgq, sizeof(app_event_t), 8, 4);
+static K_TIMER_DEFINE(step_timer, NULL, NULL);
+// Wakes the thread once the timer runs again
+static K_SEM_DEFINE(running, 0, 1);
+
+static const event_id_t commands[] = {
+    COMMAND_DOOR_SET_LOCK,
+    COMMAND_HEATER_SET_TEMP,
+    COMMAND_MOTOR_SET_SPEED,
+};
+
+// The plant is stepped by the thread and read by the shell.
+static struct k_spinlock plant_lock;
+static sim_plant_t plant;
+static sim_plant_thread_stats_t stats;
+static bool started;
+
+static void step_once(void)
+{
+    app_event_t events[SIM_PLANT_MAX_EVENTS];
+    app_event_t command;
+    size_t count;
+
+    k_spinlock_key_t key = k_spin_lock(&plant_lock);
+
+    while (k_msgq_get(&sim_plant_msgq, &command, K_NO_WAIT) == 0) {
+        sim_plant_command(&plant, &command);
+    }
+    count = sim_plant_step(&plant, events, ARRAY_SIZE(events));
+    k_spin_unlock(&plant_lock, key);
+
+    // Posted outside the lock: a callback bus runs its handlers in here.
+    for (size_t i = 0; i < count; i++) {
+        if (event_bus_post(&events[i]) != 0) {
+            stats.failed++;
+        }
+    }
+    stats.posted += count;
+}
+
+static void sim_plant_thread_entry(void *p1, void *p2, void *p3)
+{
+    ARG_UNUSED(p1);
+    ARG_UNUSED(p2);
+    ARG_UNUSED(p3);
+
+    while (1) {
+        // Periods elapsed since the last call, 0 once the timer is stopped
+        const uint32_t due = k_timer_status_sync(&step_timer);
+
+        if (due == 0) {
+            k_sem_take(&running, K_FOREVER);
+            continue;
+        }
+        if (due > SIM_PLANT_MAX_CATCH_UP) {
+            stats.overruns += due - SIM_PLANT_MAX_CATCH_UP;
+        }
+        for (uint32_t i = 0; i < MIN(due, SIM_PLANT_MAX_CATCH_UP); i++) {
+            step_once();
+        }
+    }
+}
+
+static int subscribe(void)
+{
+#if defined(CONFIG_EVENT_BUS_USE_CALLBACK)
+    return event_bus_register_queue_sink(&sim_plant_msgq, commands, ARRAY_SIZE(commands),
+                                         NULL);
+#else
+    return event_bus_subscribe(&sim_plant_msgq, commands, ARRAY_SIZE(commands)) ? 0 : -ENOMEM;
+#endif
+}
+
+int sim_plant_thread_start(uint32_t rate_hz)
+{
+    int ret;
+
+    if (rate_hz == 0 || rate_hz > SIM_PLANT_MAX_RATE_HZ) {
+        return -EINVAL;
+    }
+
+    if (!started) {
+        sim_plant_init(&plant, NULL);
+        ret = subscribe();
+        if (ret != 0) {
+            LOG_ERR("Failed to subscribe the plant to commands: %d", ret);
+            return ret;
+        }
+        k_thread_create(&sim_plant_thread_data, sim_plant_stack,
+                        K_THREAD_STACK_SIZEOF(sim_plant_stack), sim_plant_thread_entry, NULL,
+                        NULL, NULL, SIM_PLANT_PRIORITY, 0, K_NO_WAIT);
+        k_thread_name_set(&sim_plant_thread_data, "sim_plant");
+        started = true;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&plant_lock);
+
+    sim_plant_set_rate(&plant, rate_hz);
+    k_spin_unlock(&plant_lock, key);
+
+    const k_timeout_t period = K_USEC(USEC_PER_SEC / rate_hz);
+
+    k_timer_start(&step_timer, period, period);
+    k_sem_give(&running);
+    LOG_INF("Plant running at %u Hz", rate_hz);
+    return 0;
+}
+
+void sim_plant_thread_stop(void)
+{
+    k_timer_stop(&step_timer);
+}
+
+void sim_plant_thread_set_water(sim_plant_water_t water)
+{
+    k_spinlock_key_t key = k_spin_lock(&plant_lock);
+
+    sim_plant_set_water(&plant, water);
+    k_spin_unlock(&plant_lock, key);
+}
+
+void sim_plant_thread_get(sim_plant_t *out, sim_plant_thread_stats_t *stats_out)
+{
+    k_spinlock_key_t key = k_spin_lock(&plant_lock);
+
+    if (out) {
+        *out = plant;
+    }
+    k_spin_unlock(&plant_lock, key);
+    if (stats_out) {
+        *stats_out = stats;
+    }
+}
@@ -0,0 +1,225 @@
+#include <zephyr/ztest.h>
+#include <string.h>
+#include "sim_plant.h"
+
+// Defaults of sim_plant_get_default_params()
+#define RATE_HZ 100
+#define FILL_S 60           // 100 mm at 100 mm/min
+#define DRAIN_S 30          // 100 mm at 200 mm/min
+// 15 C to 40 C at 3 C/min, less the losses: 3600 s * ln(180 / 155)
+#define HEAT_TO_40_S 538
+
+static sim_plant_t plant;
+static uint32_t seen[EVENT_ID_COUNT];
+static app_event_t last[EVENT_ID_COUNT];
+
+static void sim_plant_before(void *data)
+{
+    ARG_UNUSED(data);
+
+    zassert_ok(sim_plant_init(&plant, NULL));
+    memset(seen, 0, sizeof(seen));
+}
+
+static void command(event_id_t id, int32_t value)
+{
+    const app_event_t event = { .id = id, .payload.s32 = value };
+
+    zassert_ok(sim_plant_command(&plant, &event));
+}
+
+static void step(void)
+{
+    app_event_t events[SIM_PLANT_MAX_EVENTS];
+    const size_t count = sim_plant_step(&plant, events, ARRAY_SIZE(events));
+
+    for (size_t i = 0; i < count; i++) {
+        seen[events[i].id]++;
+        last[events[i].id] = events[i];
+    }
+}
+
+// Steps until @p event and returns the steps taken.
+static uint32_t run_until(event_id_t event, uint32_t max_steps)
+{
+    const uint32_t before = seen[event];
+
+    for (uint32_t n = 1; n <= max_steps; n++) {
+        step();
+        if (seen[event] > before) {
+            return n;
+        }
+    }
+    zassert_unreachable("Event %d not seen in %u steps", event, max_steps);
+    return 0;
+}
+
+static void run_for_s(uint32_t seconds)
+{
+    for (uint32_t n = 0; n < seconds * plant.params.rate_hz; n++) {
+        step();
+    }
+}
+
+static void fill(void)
+{
+    sim_plant_set_water(&plant, SIM_PLANT_WATER_FILL);
+    run_until(EVENT_WATER_LEVEL_REACHED, 2 * FILL_S * RATE_HZ);
+    sim_plant_set_water(&plant, SIM_PLANT_WATER_HOLD);
+}
+
+ZTEST(sim_plant_suite, test_fill_and_drain)
+{
+    uint32_t steps;
+
+    sim_plant_set_water(&plant, SIM_PLANT_WATER_FILL);
+    steps = run_until(EVENT_WATER_LEVEL_REACHED, 2 * FILL_S * RATE_HZ);
+    zassert_within(steps, FILL_S * RATE_HZ, 1, "Filled in %u steps", steps);
+    zassert_equal(last[EVENT_WATER_LEVEL_REACHED].payload.u32, 100);
+    zassert_equal(seen[EVENT_WATER_LEVEL_CHANGED], 100, "One report per mm");
+
+    // The inlet stays open up to the overflow level, and reports once.
+    run_for_s(FILL_S);
+    zassert_equal(sim_plant_level_mm(&plant), 150);
+    zassert_equal(seen[EVENT_WATER_LEVEL_REACHED], 1);
+
+    // 150 mm this time
+    sim_plant_set_water(&plant, SIM_PLANT_WATER_DRAIN);
+    steps = run_until(EVENT_DRUM_EMPTY, 2 * DRAIN_S * RATE_HZ);
+    zassert_within(steps, 3 * DRAIN_S * RATE_HZ / 2, 1, "Drained in %u steps", steps);
+    zassert_equal(last[EVENT_WATER_LEVEL_CHANGED].payload.u32, 0);
+    run_for_s(1);
+    zassert_equal(seen[EVENT_DRUM_EMPTY], 1);
+}
+
+ZTEST(sim_plant_suite, test_heater_reaches_and_holds_the_target)
+{
+    fill();
+    command(COMMAND_HEATER_SET_TEMP, 40);
+
+    const uint32_t steps = run_until(EVENT_TEMP_REACHED, 2 * HEAT_TO_40_S * RATE_HZ);
+
+    zassert_within(steps, HEAT_TO_40_S * RATE_HZ, HEAT_TO_40_S * RATE_HZ / 100,
+                   "Took %u steps", steps);
+    zassert_equal(last[EVENT_TEMP_REACHED].payload.s32, 40);
+    zassert_equal(last[EVENT_HEATER_TEMP_CHANGED].payload.s32, 40);
+    zassert_equal(seen[EVENT_HEATER_TEMP_CHANGED], 25, "One report per degree");
+
+    // The thermostat keeps it within a degree.
+    for (int n = 0; n < 600 * RATE_HZ; n++) {
+        step();
+        zassert_true(sim_plant_temp_c(&plant) >= 39 && sim_plant_temp_c(&plant) <= 40);
+    }
+    zassert_equal(seen[EVENT_TEMP_REACHED], 1);
+
+    // Off, it cools towards the ambient.
+    command(COMMAND_HEATER_SET_TEMP, 0);
+    run_for_s(3600);
+
+    const int32_t temp_c = sim_plant_temp_c(&plant);
+
+    zassert_within(temp_c, 15 + 25 * 37 / 100, 1, "At %d C", temp_c);
+}
+
+ZTEST(sim_plant_suite, test_heater_never_runs_dry)
+{
+    command(COMMAND_HEATER_SET_TEMP, 60);
+    run_for_s(60);
+    zassert_false(plant.heater_on);
+    zassert_equal(sim_plant_temp_c(&plant), 15);
+    zassert_equal(seen[EVENT_HEATER_TEMP_CHANGED], 0);
+}
+
+// Steps until the drum turns at @p rpm.
+static uint32_t spin_up(int32_t rpm)
+{
+    uint32_t steps = 0;
+
+    command(COMMAND_MOTOR_SET_SPEED, rpm);
+    while (sim_plant_rpm(&plant) != rpm) {
+        step();
+        steps++;
+    }
+    return steps;
+}
+
+ZTEST(sim_plant_suite, test_drum_ramps_slower_with_water)
+{
+    uint32_t steps;
+
+    // 1000 rpm at 200 rpm/s
+    steps = spin_up(1000);
+    zassert_within(steps, 5 * RATE_HZ, 1, "Took %u steps", steps);
+    zassert_equal(last[EVENT_MOTOR_SPEED_REPORT].payload.s32, 1000, "Final speed reported");
+    zassert_equal(seen[EVENT_MOTOR_SPEED_REPORT], 100, "One report per 10 rpm");
+
+    // Down at 300 rpm/s
+    command(COMMAND_MOTOR_SET_SPEED, 0);
+    steps = run_until(EVENT_MOTOR_STOPPED, 10 * RATE_HZ);
+    zassert_within(steps, 10 * RATE_HZ / 3, 1, "Took %u steps", steps);
+    zassert_equal(last[EVENT_MOTOR_SPEED_REPORT].payload.s32, 0);
+
+    // Two thirds of the empty drum's rate with 100 mm of water
+    fill();
+    steps = spin_up(1000);
+    zassert_within(steps, 15 * RATE_HZ / 2, RATE_HZ / 10, "Took %u steps", steps);
+    zassert_equal(seen[EVENT_MOTOR_STOPPED], 1);
+}
+
+ZTEST(sim_plant_suite, test_same_physics_at_any_rate)
+{
+    static const uint32_t rates[] = { 10, 100, SIM_PLANT_MAX_RATE_HZ };
+    sim_plant_params_t params;
+
+    for (int i = 0; i < ARRAY_SIZE(rates); i++) {
+        sim_plant_get_default_params(&params);
+        params.rate_hz = rates[i];
+        zassert_ok(sim_plant_init(&plant, &params));
+
+        sim_plant_set_water(&plant, SIM_PLANT_WATER_FILL);
+        command(COMMAND_HEATER_SET_TEMP, 40);
+        const uint32_t steps = run_until(EVENT_TEMP_REACHED, 1000 * rates[i]);
+        // Filling past the heater's minimum takes 18 s.
+        const uint32_t expected = (HEAT_TO_40_S + 18) * rates[i];
+
+        zassert_within(steps, expected, expected / 100, "%u Hz: %u steps", rates[i], steps);
+    }
+}
+
+ZTEST(sim_plant_suite, test_door_lock)
+{
+    command(COMMAND_DOOR_SET_LOCK, true);
+    step();
+    zassert_equal(seen[EVENT_DOOR_LOCKED], 1);
+
+    // Already locked
+    command(COMMAND_DOOR_SET_LOCK, true);
+    step();
+    zassert_equal(seen[EVENT_DOOR_LOCKED], 1);
+
+    command(COMMAND_DOOR_SET_LOCK, false);
+    step();
+    zassert_equal(seen[EVENT_DOOR_UNLOCKED], 1);
+}
+
+ZTEST(sim_plant_suite, test_bad_arguments)
+{
+    sim_plant_params_t params;
+    const app_event_t sensor_event = { .id = EVENT_TEMP_REACHED };
+
+    sim_plant_get_default_params(&params);
+    params.rate_hz = 0;
+    zassert_equal(sim_plant_init(&plant, &params), -EINVAL);
+    params.rate_hz = SIM_PLANT_MAX_RATE_HZ + 1;
+    zassert_equal(sim_plant_init(&plant, &params), -EINVAL);
+
+    sim_plant_get_default_params(&params);
+    params.fill_level_mm = params.max_level_mm + 1;
+    zassert_equal(sim_plant_init(&plant, &params), -EINVAL);
+
+    zassert_ok(sim_plant_init(&plant, NULL));
+    zassert_equal(sim_plant_set_rate(&plant, 0), -EINVAL);
+    zassert_equal(sim_plant_command(&plant, &sensor_event), -ENOTSUP);
+}
+
+ZTEST_SUITE(sim_plant_suite, NULL, NULL, sim_plant_before, NULL, NULL);
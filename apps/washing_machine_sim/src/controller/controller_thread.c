@@ -3,6 +3,12 @@
 #include "event_bus.h"
 #include "event_defs.h"
 #include "fsm.h"
+#include "fsm_checkpoint.h"
+#include "fsm_notify.h"
+#include "fsm_profile.h"
+#include "fsm_status.h"
+#include "wash_program.h"
+#include "timer_wheel.h"
 #include "controller_thread.h"
 
 LOG_MODULE_REGISTER(controller_thread, LOG_LEVEL_INF);
@@ -11,6 +17,10 @@ LOG_MODULE_REGISTER(controller_thread, LOG_LEVEL_INF);
 // Defines the message queue for the FSM, matching the extern in the header.
 K_MSGQ_DEFINE(fsm_msgq, sizeof(app_event_t), 16, 4);
 
+// Most events handled before the batch summary is logged: the queue
+// depth, so a full queue drains in one pass.
+#define CONTROLLER_BATCH_MAX 16
+
 // --- Thread Definition ---
 #define CONTROLLER_STACK_SIZE 1024
 #define CONTROLLER_PRIORITY 5
@@ -19,24 +29,342 @@ static struct k_thread controller_thread_data;
 
 // --- FSM Handle ---
 static fsm_handle_t fsm;
+// Time base for phase progress, the uptime unless a simulation replaces it
+static int64_t (*controller_clock)(void) = k_uptime_get;
+// Time when the current L2 phase was entered
+static uint32_t phase_start_ms;
+// Ends the timed L2 phases with EVENT_TIMER_EXPIRED
+static struct timer_wheel_timer phase_timer;
+// Phase time left while the timer is not running, e.g. when paused
+static uint32_t phase_timer_pending_ms;
+// The newest checkpoint holds the FSM as it is now
+static bool checkpoint_current;
+// Transitions, dwell times and ignored events, read by the shell
+static fsm_profile_t fsm_profile;
+// Remaining cycle time, read by the UI from other threads
+static wash_estimate_t estimate;
+static struct k_spinlock estimate_lock;
+// States and phase progress for other threads, see controller_get_status()
+static fsm_status_channel_t status_channel;
+// Batch counters, only written by the thread that drains the queue
+static controller_stats_t stats;
+
+// List of all events the FSM cares about.
+static const event_id_t subscribed_events[] = {
+    EVENT_POWER_BUTTON_PRESSED,
+    EVENT_CYCLE_SELECTED,
+    EVENT_START_BUTTON_PRESSED,
+    EVENT_PAUSE_BUTTON_PRESSED,
+    EVENT_CANCEL_BUTTON_PRESSED,
+    EVENT_ANY_KEY_PRESSED,
+    EVENT_WEIGHT_CALCULATED,
+    EVENT_DOSING_COMPLETE,
+    EVENT_TIMER_EXPIRED,
+    EVENT_DRUM_EMPTY,
+    EVENT_WATER_LEVEL_REACHED,
+    EVENT_TEMP_REACHED,
+    EVENT_POWER_LOSS_DETECTED,
+    EVENT_POWER_RESTORED,
+    EVENT_FATAL_FAULT_DETECTED,
+    EVENT_CYCLE_FINISHED,
+};
 
 fsm_handle_t *controller_fsm_get_handle(void) {
     return &fsm;
 }
 
-// --- Lightweight Event Callback ---
+uint32_t controller_get_status(fsm_status_t *out)
+{
+    return fsm_status_read(&status_channel, out);
+}
+
+size_t controller_get_subscribed_events(const event_id_t **events) {
+    *events = subscribed_events;
+    return ARRAY_SIZE(subscribed_events);
+}
+
+void controller_set_clock(int64_t (*now_ms)(void)) {
+    controller_clock = now_ms ? now_ms : k_uptime_get;
+}
+
+static inline uint32_t controller_now_ms(void)
+{
+    return (uint32_t)controller_clock();
+}
+
+// The profiler keeps its clock, so it goes through the one set now.
+static int64_t controller_profile_clock(void)
+{
+    return controller_clock();
+}
+
+uint32_t controller_get_remaining_ms(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&estimate_lock);
+    uint32_t remaining = wash_estimate_remaining_ms(&estimate, controller_clock());
+
+    k_spin_unlock(&estimate_lock, key);
+    return remaining;
+}
+
+// Starts the estimate over, @p phase_elapsed_ms into the current phase.
+static void controller_init_estimate(uint32_t phase_elapsed_ms)
+{
+    k_spinlock_key_t key = k_spin_lock(&estimate_lock);
+
+    wash_estimate_init(&estimate, &fsm, phase_elapsed_ms, controller_clock());
+    k_spin_unlock(&estimate_lock, key);
+}
+
+static void controller_update_estimate(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&estimate_lock);
+
+    wash_estimate_update(&estimate, &fsm, controller_clock());
+    k_spin_unlock(&estimate_lock, key);
+}
+
+// Hands the FSM and the progress of its phase to readers on other threads.
+static void controller_publish_status(void)
+{
+    fsm_status_t status = {
+        .phase_start_ms = phase_start_ms,
+        .phase_timeout_ms = wash_program_timeout_ms(&fsm, fsm.wash_cycle_state),
+        .remaining_ms = controller_get_remaining_ms(),
+        .published_ms = controller_now_ms(),
+    };
+
+    fsm_status_from_fsm(&status, &fsm);
+    fsm_status_publish(&status_channel, &status);
+}
+
+// --- Checkpointing ---
+/**
+ * @brief Saves the FSM and the progress of the current phase, including
+ * what is left of its timeout.
+ */
+static void controller_checkpoint(void)
+{
+    fsm_snapshot_t snapshot = {
+        .fsm = fsm,
+        .phase_elapsed_ms = controller_now_ms() - phase_start_ms,
+        .timer_remaining_ms = timer_wheel_is_armed(&phase_timer) ?
+                              timer_wheel_remaining_ms(&phase_timer) : phase_timer_pending_ms,
+    };
+
+    int ret = fsm_checkpoint_save(&snapshot);
+    if (ret != 0 && ret != -ENODEV) {
+        LOG_WRN("FSM checkpoint failed (%d)", ret);
+    }
+    checkpoint_current = (ret == 0);
+}
+
 /**
- * @brief A lightweight, non-blocking callback to receive events for the FSM.
+ * @brief Takes over the FSM and phase progress from the last checkpoint.
  *
- * This function's only job is to place the received event into the FSM's
- * message queue. All processing is deferred to the controller thread.
+ * Time spent without power does not count towards the phase.
+ *
+ * @return true if a checkpoint was applied.
  */
-static void fsm_event_callback(const app_event_t *event)
+static bool controller_resume(void)
 {
-    LOG_INF("FSM Controller thread callback received event ID: %d", event->id);
-    int ret = k_msgq_put(&fsm_msgq, event, K_NO_WAIT);
-    if (ret != 0) {
-        LOG_WRN("Failed to enqueue event for FSM thread, queue may be full.");
+    fsm_snapshot_t snapshot;
+
+    if (fsm_checkpoint_restore(&snapshot) != 0) {
+        return false;
+    }
+
+    switch (snapshot.fsm.system_state) {
+        case STATE_L1_RUNNING:
+        case STATE_L1_PAUSED:
+        case STATE_L1_BROWNOUT:
+            break;
+        default:
+            // Nothing in progress worth resuming
+            return false;
+    }
+
+    fsm = snapshot.fsm;
+    phase_start_ms = controller_now_ms() - snapshot.phase_elapsed_ms;
+    // The timer is armed again once the cycle is running.
+    timer_wheel_cancel(&phase_timer);
+    phase_timer_pending_ms = snapshot.timer_remaining_ms;
+    controller_init_estimate(snapshot.phase_elapsed_ms);
+    LOG_INF("Resuming from checkpoint #%u: %s / %s, %u ms into the phase", snapshot.seq,
+            fsm_get_system_state_name(fsm.system_state),
+            fsm_get_wash_cycle_state_name(fsm.wash_cycle_state), snapshot.phase_elapsed_ms);
+    return true;
+}
+
+// --- Phase Timer ---
+/**
+ * @brief Keeps the phase timer in step with the FSM after an event.
+ *
+ * Entering a timed L2 phase loads its timeout from the programme. The timer
+ * only runs while the cycle is running; pausing or losing power parks
+ * the remaining time until the cycle resumes.
+ */
+static void controller_update_phase_timer(event_id_t event, wash_cycle_state_t original_l2_state)
+{
+    if (fsm.wash_cycle_state != original_l2_state) {
+        timer_wheel_cancel(&phase_timer);
+        phase_timer_pending_ms = wash_program_timeout_ms(&fsm, fsm.wash_cycle_state);
+    } else if (event == EVENT_TIMER_EXPIRED && fsm.system_state != STATE_L1_RUNNING &&
+               phase_timer_pending_ms == 0 &&
+               wash_program_timeout_ms(&fsm, fsm.wash_cycle_state) != 0) {
+        // Expired just as the cycle stopped: replay it on resume.
+        phase_timer_pending_ms = 1;
+    }
+
+    if (fsm.system_state == STATE_L1_RUNNING) {
+        if (phase_timer_pending_ms > 0) {
+            int ret = timer_wheel_arm(&phase_timer, phase_timer_pending_ms);
+            if (ret != 0) {
+                LOG_ERR("Failed to arm the phase timer (%d)", ret);
+            }
+            phase_timer_pending_ms = 0;
+        }
+    } else if (timer_wheel_is_armed(&phase_timer)) {
+        phase_timer_pending_ms = timer_wheel_remaining_ms(&phase_timer);
+        timer_wheel_cancel(&phase_timer);
+    }
+}
+
+// --- Event Handling ---
+void controller_start(void)
+{
+    fsm_init(&fsm);
+    if (fsm_profile_attach(&fsm, &fsm_profile, controller_profile_clock) != 0) {
+        LOG_WRN("FSM profiler not available");
+    }
+    phase_start_ms = controller_now_ms();
+    timer_wheel_timer_init(&phase_timer, EVENT_TIMER_EXPIRED, 0);
+    controller_init_estimate(0);
+    checkpoint_current = false;
+
+    // A cycle interrupted by a reset carries on. Power is back if we are
+    // running, so a brownout ends here.
+    const bool resumed = controller_resume();
+
+    // State changes go out on the bus from the state we start in. L2
+    // changes of one batch go out as one event.
+    fsm_notify_attach(&fsm, true);
+    if (resumed) {
+        if (fsm.system_state == STATE_L1_BROWNOUT) {
+            fsm_process_event(&fsm, EVENT_POWER_RESTORED);
+        }
+        controller_update_phase_timer(EVENT_POWER_RESTORED, fsm.wash_cycle_state);
+        controller_update_estimate();
+    }
+    controller_publish_status();
+}
+
+/**
+ * @brief Runs one event through the FSM and the remaining-time estimate.
+ * Every state change and every power loss is checkpointed, and the timed
+ * L2 phases are ended by the phase timer.
+ */
+static void controller_process(const app_event_t *event)
+{
+    // The power-loss checkpoint drops the brownout from the phase
+    // progress. If it was not saved, e.g. -EBUSY, the newest one is older
+    // than the FSM, so the FSM carries on as it is.
+    if (event->id == EVENT_POWER_RESTORED && fsm.system_state == STATE_L1_BROWNOUT &&
+        checkpoint_current) {
+        controller_resume();
+    }
+
+    system_state_t original_l1_state = fsm.system_state;
+    wash_cycle_state_t original_l2_state = fsm.wash_cycle_state;
+
+    fsm_process_event(&fsm, event->id);
+
+    // The payload picks the programme, in Selection or on the way there.
+    if (event->id == EVENT_CYCLE_SELECTED && fsm.system_state == STATE_L1_SELECTION &&
+        wash_program_select(&fsm, event->payload.u32) != 0) {
+        LOG_WRN("Unknown wash programme %u", event->payload.u32);
+    }
+
+    if (fsm.wash_cycle_state != original_l2_state) {
+        phase_start_ms = controller_now_ms();
+    }
+    controller_update_phase_timer(event->id, original_l2_state);
+    // The power-loss checkpoint has to land within the hold-up time, so it
+    // is taken as soon as the FSM and the phase timer are settled, before
+    // the estimate and the status publish.
+    if (event->id == EVENT_POWER_LOSS_DETECTED ||
+        fsm.system_state != original_l1_state ||
+        fsm.wash_cycle_state != original_l2_state) {
+        controller_checkpoint();
+    }
+    // The brownout was held back for the checkpoint; it goes out now.
+    if (event->id == EVENT_POWER_LOSS_DETECTED) {
+        fsm_notify_flush();
+    }
+    controller_update_estimate();
+    controller_publish_status();
+}
+
+void controller_handle_event(const app_event_t *event)
+{
+    controller_process(event);
+    fsm_notify_flush();
+}
+
+size_t controller_drain(k_timeout_t timeout)
+{
+    app_event_t event;
+    size_t handled = 0;
+    uint32_t changes = 0;
+
+    if (k_msgq_get(&fsm_msgq, &event, timeout) != 0) {
+        return 0;
+    }
+
+    // Whatever queued up while we waited goes through in one pass, with
+    // nothing formatted per event at production log levels.
+    do {
+        const system_state_t original_l1_state = fsm.system_state;
+        const wash_cycle_state_t original_l2_state = fsm.wash_cycle_state;
+
+        const uint32_t latency = event_bus_event_age_cycles(&event);
+
+        stats.latency_total_cycles += latency;
+        stats.latency_max_cycles = MAX(stats.latency_max_cycles, latency);
+        LOG_DBG("Processing event ID: %d", event.id);
+        controller_process(&event);
+        changes += fsm.system_state != original_l1_state ||
+                   fsm.wash_cycle_state != original_l2_state;
+        handled++;
+    } while (handled < CONTROLLER_BATCH_MAX && k_msgq_get(&fsm_msgq, &event, K_NO_WAIT) == 0);
+
+    // Observers hear of the L2 state the batch ended in.
+    fsm_notify_flush();
+
+    stats.events += handled;
+    stats.batches++;
+    stats.max_batch = MAX(stats.max_batch, handled);
+
+    if (changes > 0) {
+        LOG_INF("%u event(s), %u state change(s), now %s / %s", (uint32_t)handled, changes,
+                fsm_get_system_state_name(fsm.system_state),
+                fsm_get_wash_cycle_state_name(fsm.wash_cycle_state));
+    } else {
+        LOG_DBG("%u event(s), no state change", (uint32_t)handled);
+    }
+    return handled;
+}
+
+void controller_get_stats(controller_stats_t *out)
+{
+    if (!out) {
+        return;
+    }
+    *out = stats;
+    event_bus_sink_stats_t sink;
+
+    if (event_bus_get_sink_stats(&fsm_msgq, &sink) == 0) {
+        out->dropped = sink.dropped;
     }
 }
 
@@ -45,7 +373,7 @@ static void fsm_event_callback(const app_event_t *event)
  * @brief The main entry point for the controller thread.
  *
  * This thread waits indefinitely for events to arrive on its message queue,
- * then processes them through the main FSM dispatcher.
+ * then processes everything queued through the main FSM dispatcher.
  */
 static void controller_thread_entry(void *p1, void *p2, void *p3)
 {
@@ -53,46 +381,26 @@ static void controller_thread_entry(void *p1, void *p2, void *p3)
     ARG_UNUSED(p2);
     ARG_UNUSED(p3);
 
-    app_event_t received_event;
-    fsm_init(&fsm);
+    controller_start();
     LOG_INF("FSM Controller thread started, waiting for events.");
 
     while (1) {
-        // Wait forever for an event to arrive from the callback
-        k_msgq_get(&fsm_msgq, &received_event, K_FOREVER);
-
-        LOG_INF("Controller thread processing event ID: %d", received_event.id);
-        fsm_process_event(&fsm, received_event.id);
+        controller_drain(K_FOREVER);
     }
 }
 
+int controller_subscribe(void)
+{
+    // The bus copies our events into the queue without a callback work
+    // item, and drops and counts them rather than waiting when it is full.
+    return event_bus_register_queue_sink(&fsm_msgq, subscribed_events,
+                                         ARRAY_SIZE(subscribed_events), NULL);
+}
+
 // --- Initialization Function ---
 int controller_thread_init(void)
 {
-    // List of all events the FSM cares about.
-    static const event_id_t subscribed_events[] = {
-        EVENT_POWER_BUTTON_PRESSED,
-        EVENT_CYCLE_SELECTED,
-        EVENT_START_BUTTON_PRESSED,
-        EVENT_PAUSE_BUTTON_PRESSED,
-        EVENT_CANCEL_BUTTON_PRESSED,
-        EVENT_ANY_KEY_PRESSED,
-        EVENT_WEIGHT_CALCULATED,
-        EVENT_DOSING_COMPLETE,
-        EVENT_TIMER_EXPIRED,
-        EVENT_DRUM_EMPTY,
-        EVENT_WATER_LEVEL_REACHED,
-        EVENT_TEMP_REACHED,
-        EVENT_POWER_LOSS_DETECTED,
-        EVENT_POWER_RESTORED,
-        EVENT_FATAL_FAULT_DETECTED,
-        EVENT_CYCLE_FINISHED,
-    };
-
-    // Register our lightweight callback with the event bus
-    int ret = event_bus_register_handler(fsm_event_callback,
-                                         subscribed_events,
-                                         ARRAY_SIZE(subscribed_events));
+    int ret = controller_subscribe();
     if (ret != 0) {
         LOG_ERR("Failed to register FSM event handler!");
         return -1;
@@ -3,9 +3,10 @@
 
 #include <zephyr/kernel.h>
 #include "fsm.h"
+#include "fsm_status.h"
 #include "event_bus.h"
 
-// Declare the message queue as 'extern' so the callback can access it.
+// The queue the event bus delivers the controller's events into.
 extern struct k_msgq fsm_msgq;
 
 /**
@@ -20,11 +21,103 @@ extern struct k_msgq fsm_msgq;
  */
 int controller_thread_init(void);
 
+/**
+ * @brief Has the event bus deliver the controller's events into fsm_msgq
+ * from the posting path.
+ *
+ * controller_thread_init() calls this. A test or benchmark that drains
+ * the queue without the thread calls it instead.
+ *
+ * @return 0 on success, a negative error code otherwise.
+ */
+int controller_subscribe(void);
+
 /**
  * @brief Gets a handle to the main FSM structure.
  *
+ * The controller changes it while handling events. Other threads read the
+ * state with controller_get_status() instead.
+ *
  * @return A pointer to the fsm_handle_t instance.
  */
 fsm_handle_t *controller_fsm_get_handle(void);
 
+/**
+ * @brief Copies the FSM states, programme and phase progress as of the
+ * last event handled.
+ *
+ * Lock-free and consistent from any thread; the controller never waits
+ * for readers.
+ *
+ * @return How often the copy was retried, see fsm_status_read().
+ */
+uint32_t controller_get_status(fsm_status_t *out);
+
+/**
+ * @brief Gets the events the controller subscribes to.
+ *
+ * @param events Set to the array of event IDs.
+ * @return The number of entries in the array.
+ */
+size_t controller_get_subscribed_events(const event_id_t **events);
+
+/**
+ * @brief Initializes the FSM and resumes from the last checkpoint.
+ *
+ * The controller thread calls this when it starts. A simulation that
+ * drives the controller without its thread calls it instead.
+ */
+void controller_start(void);
+
+/**
+ * @brief Runs one event through the FSM, the phase timer and the
+ * checkpoints, in the caller's context, and publishes any state change.
+ */
+void controller_handle_event(const app_event_t *event);
+
+/**
+ * @brief Replaces the clock phase progress is measured with.
+ *
+ * @param now_ms Returns the current time in ms, NULL for k_uptime_get().
+ */
+void controller_set_clock(int64_t (*now_ms)(void));
+
+/**
+ * @brief Gets the time left until the current cycle completes.
+ *
+ * Before the start this is the whole cycle of the selected programme.
+ * Constant time and safe to call from any thread.
+ *
+ * @return The remaining time in ms.
+ */
+uint32_t controller_get_remaining_ms(void);
+
+/**
+ * @brief Controller counters, see controller_get_stats().
+ */
+typedef struct {
+    uint32_t events;        // Events handled
+    uint32_t batches;       // Passes over the queue
+    uint32_t max_batch;     // Most events handled in one pass
+    // Cycles from event_bus_post() to the FSM, from the event timestamps
+    uint64_t latency_total_cycles;
+    uint32_t latency_max_cycles;
+    uint32_t dropped;       // Events the bus found the queue full for
+} controller_stats_t;
+
+/**
+ * @brief Handles the events waiting in the controller queue in one pass.
+ *
+ * Waits up to @p timeout for the first event, then takes whatever else is
+ * queued without waiting, and logs one summary for the batch. L2 state
+ * changes within the batch are published as one EVENT_FSM_STATE_CHANGED. The
+ * controller thread loops on this; a test or benchmark without the thread
+ * can call it instead.
+ *
+ * @return The number of events handled, 0 if none arrived in time.
+ */
+size_t controller_drain(k_timeout_t timeout);
+
+void controller_get_stats(controller_stats_t *out);
+
 #endif // CONTROLLER_THREAD_H
\ No newline at end of file
@@ -1,11 +1,53 @@
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
+#include <zephyr/storage/flash_map.h>
 #include "event_bus.h"
+#include "event_journal.h"
+#include "timer_wheel.h"
+#include "telemetry.h"
+#include "fsm_checkpoint.h"
 #include "controller_thread.h"
 #include "shell_interface.h"
+#include "sim_plant_thread.h"
+#include "sim_door_sensor.h"
+#include "sensor_door_thread.h"
 
 LOG_MODULE_REGISTER(main, LOG_LEVEL_INF);
 
+// native_sim has no bootloader, so its scratch partition holds the journal.
+#define JOURNAL_PARTITION FIXED_PARTITION_ID(scratch_partition)
+// FSM snapshots for brownout recovery
+#define CHECKPOINT_PARTITION FIXED_PARTITION_ID(storage_partition)
+
+// Events worth keeping across a power cycle.
+static const event_id_t journaled_events[] = {
+    EVENT_POWER_LOSS_DETECTED,
+    EVENT_POWER_RESTORED,
+    EVENT_FATAL_FAULT_DETECTED,
+    EVENT_UI_CYCLE_SELECTED,
+    EVENT_CYCLE_FINISHED,
+};
+
+// Everything needed to replay a run offline: sensors, actuators and states.
+static const event_id_t telemetry_events[] = {
+    EVENT_MOTOR_SPEED_REPORT,
+    EVENT_HEATER_TEMP_CHANGED,
+    EVENT_WATER_LEVEL_CHANGED,
+    EVENT_WEIGHT_CALCULATED,
+    EVENT_TEMP_REACHED,
+    EVENT_WATER_LEVEL_REACHED,
+    EVENT_DRUM_EMPTY,
+    EVENT_MOTOR_STOPPED,
+    EVENT_DOOR_OPENED,
+    EVENT_DOOR_CLOSED,
+    EVENT_DOOR_LOCKED,
+    EVENT_DOOR_UNLOCKED,
+    COMMAND_DOOR_SET_LOCK,
+    COMMAND_HEATER_SET_TEMP,
+    COMMAND_MOTOR_SET_SPEED,
+    EVENT_FSM_STATE_CHANGED,
+};
+
 int main(void) {
     LOG_INF("System Init: Main");
 
@@ -15,6 +57,34 @@ int main(void) {
         return 1;
     }
 
+    // Phase timers post their expiry on the bus.
+    if (timer_wheel_init() != 0) {
+        LOG_ERR("Failed to initialize timer wheel!");
+        return 1;
+    }
+
+    // The journal recovers before anything else can post journaled events.
+    if (event_journal_init(JOURNAL_PARTITION, journaled_events, ARRAY_SIZE(journaled_events)) != 0) {
+        LOG_WRN("Event journal unavailable, continuing without it");
+    } else {
+        app_event_t last;
+        if (event_journal_get_latest(EVENT_POWER_LOSS_DETECTED, &last) == 0) {
+            LOG_INF("Journal: last power loss was bus event #%u", last.seq);
+        }
+    }
+
+#if defined(CONFIG_TELEMETRY_HOST_FILE)
+    if (telemetry_init_host_file("telemetry.bin", telemetry_events,
+                                 ARRAY_SIZE(telemetry_events)) != 0) {
+        LOG_WRN("Telemetry unavailable, continuing without it");
+    }
+#endif
+
+    // The controller resumes from the newest checkpoint when it starts.
+    if (fsm_checkpoint_init(CHECKPOINT_PARTITION) != 0) {
+        LOG_WRN("FSM checkpoint unavailable, cycles will not survive a reset");
+    }
+
     // Initialize our new FSM controller thread.
     // This will register the callback and start the thread.
     if (controller_thread_init() != 0) {
@@ -22,6 +92,16 @@ int main(void) {
         return 1;
     }
 
+    // The plant answers actuator commands with sensor events.
+    if (sim_plant_thread_start(SIM_PLANT_THREAD_DEFAULT_HZ) != 0) {
+        LOG_WRN("Plant simulation unavailable, sensors only change from the shell");
+    }
+
+    // The door posts its own open/close events from the GPIO interrupt.
+    if (door_sensor_sim_init() != 0 || sensor_door_start() != 0) {
+        LOG_WRN("Door sensor unavailable, door events only come from the shell");
+    }
+
     // Initialize the shell for user input.
     shell_interface_init();
 
@@ -1,10 +1,21 @@
 #include <zephyr/shell/shell.h>
 #include <zephyr/logging/log.h>
 #include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
 #include "event_defs.h"
 #include "event_bus.h"
 #include "shell_interface.h"
 #include "fsm.h"
+#include "fsm_profile.h"
+#include "fsm_notify.h"
+#include "wash_program.h"
+#include "controller_thread.h"
+#include "sim_plant_thread.h"
+#include "sim_door_sensor.h"
+#include "sensor_door_thread.h"
+#include "scenario.h"
+#include "event_names.h"
 
 LOG_MODULE_REGISTER(shell_interface, LOG_LEVEL_INF);
 
@@ -28,33 +39,504 @@ SHELL_CMD_REGISTER(start, NULL, "Start the wash cycle (event-based)", cmd_start)
 
 // --- Shell Command to Send an Event ---
 
+// An event name from event_defs.h, or its number.
+static event_id_t parse_event_id(const char *arg)
+{
+    char *end;
+    unsigned long id;
+
+    if (!isdigit((unsigned char)*arg)) return event_id_from_name(arg);
+    id = strtoul(arg, &end, 0);
+    return *end == '\0' && id < EVENT_ID_COUNT ? (event_id_t)id : EVENT_ID_COUNT;
+}
+
 static int cmd_send_event(const struct shell *shell, size_t argc, char **argv)
 {
-    if (argc < 2) {
-        shell_error(shell, "Please provide an event ID (integer).");
+    app_event_t event = { 0 };
+
+    event.id = parse_event_id(argv[1]);
+    if (event.id == EVENT_ID_COUNT) {
+        shell_error(shell, "Unknown event: %s", argv[1]);
         return -EINVAL;
     }
 
-    event_id_t event_id = (event_id_t)atoi(argv[1]);
+    // Payloads are written as in a scenario script.
+    if (argc > 2 && scenario_parse_payload(argv[2], &event.payload) != 0) {
+        shell_error(shell, "Invalid payload: %s", argv[2]);
+        return -EINVAL;
+    }
+
+    event_bus_post(&event);
+    shell_print(shell, "Posted %s (%d)", event_name(event.id), event.id);
+
+    return 0;
+}
+SHELL_CMD_ARG_REGISTER(send_event, NULL,
+                       "Send an event to the event bus: send_event <name|id> [payload]",
+                       cmd_send_event, 2, 1);
+
+// --- Scenarios ---
+
+// Controller counters at the start and the end of the last run, taken on
+// the runner thread, to tell the run's share apart
+static controller_stats_t scenario_base;
+static controller_stats_t scenario_end;
+static struct k_spinlock scenario_stats_lock;
+
+static void scenario_hook(bool running)
+{
+    controller_stats_t stats;
+
+    controller_get_stats(&stats);
+    k_spinlock_key_t key = k_spin_lock(&scenario_stats_lock);
+
+    if (running) {
+        scenario_base = stats;
+    } else {
+        scenario_end = stats;
+    }
+    k_spin_unlock(&scenario_stats_lock, key);
+}
+
+static int cmd_scenario_run(const struct shell *shell, size_t argc, char **argv)
+{
+    ARG_UNUSED(argc);
+
+#if defined(CONFIG_ARCH_POSIX)
+    // Too big for the shell stack
+    static struct scenario scenario;
+    int line = 0;
+    int ret = scenario_load_host_file(&scenario, argv[1], &line);
+
+    // Only parse errors have a line.
+    if (ret != 0 && line > 0) {
+        shell_error(shell, "%s:%d: %s", argv[1], line,
+                    ret == -EINVAL ? "syntax error or unknown event" :
+                    ret == -ERANGE ? "repeats expand too far" : "too many steps");
+        return ret;
+    }
+    if (ret != 0) {
+        shell_error(shell, "Cannot read %s: %d", argv[1], ret);
+        return ret;
+    }
+
+    scenario_set_hook(scenario_hook);
+    ret = scenario_start(&scenario);
+    if (ret != 0) {
+        shell_error(shell, "A scenario is already running, 'scenario stop' ends it");
+        return ret;
+    }
+    shell_print(shell, "Running '%s': %u events over %u.%03u s", scenario.name,
+                scenario.total_events, (uint32_t)(scenario.total_us / USEC_PER_SEC),
+                (uint32_t)(scenario.total_us % USEC_PER_SEC / USEC_PER_MSEC));
+    return 0;
+#else
+    ARG_UNUSED(argv);
+    shell_error(shell, "Scripts are read from the host, native_sim only");
+    return -ENOTSUP;
+#endif
+}
+
+static int cmd_scenario_show(const struct shell *shell, size_t argc, char **argv)
+{
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    scenario_result_t result;
+    controller_stats_t base;
+    controller_stats_t stats;
+
+    scenario_get_result(&result);
+    if (result.name[0] == '\0') {
+        shell_print(shell, "No scenario run yet");
+        return 0;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&scenario_stats_lock);
+
+    base = scenario_base;
+    stats = scenario_end;
+    k_spin_unlock(&scenario_stats_lock, key);
+    // A finished run keeps the counters it ended with.
+    if (result.running) {
+        controller_get_stats(&stats);
+    }
+
+    const uint32_t events = stats.events - base.events;
+    const uint64_t latency = stats.latency_total_cycles - base.latency_total_cycles;
+
+    shell_print(shell, "'%s' %s: %u events posted, %u failed, in %u ms", result.name,
+                result.running ? "running" : result.stopped ? "stopped" : "done",
+                result.posted, result.failed, result.elapsed_us / 1000);
+    shell_print(shell, "Throughput: %u events/s",
+                result.elapsed_us ? (uint32_t)((uint64_t)result.posted * USEC_PER_SEC /
+                                               result.elapsed_us) : 0);
+    shell_print(shell, "Late: mean %u us, max %u us", result.late_mean_us, result.late_max_us);
+    shell_print(shell, "Post: mean %u us, max %u us", result.post_mean_us, result.post_max_us);
+    shell_print(shell, "Controller, %u events during the run: post to FSM mean %u us",
+                events, events ? (uint32_t)k_cyc_to_us_floor64(latency / events) : 0);
+    return 0;
+}
 
-    // Simple check to prevent sending wildly invalid event IDs.
-    // This could be made more robust if needed.
-    if (event_id >= EVENT_ID_COUNT) {
-        shell_error(shell, "Invalid event ID: %d", event_id);
+static int cmd_scenario_stop(const struct shell *shell, size_t argc, char **argv)
+{
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    if (scenario_stop() != 0) {
+        shell_print(shell, "No scenario running");
+    }
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_scenario,
+    SHELL_CMD_ARG(run, NULL, "Run a script from the host: run <path>", cmd_scenario_run, 2, 0),
+    SHELL_CMD(show, NULL, "Latency and throughput of the current or last run",
+              cmd_scenario_show),
+    SHELL_CMD(stop, NULL, "Stop the running scenario", cmd_scenario_stop),
+    SHELL_SUBCMD_SET_END
+);
+SHELL_CMD_REGISTER(scenario, &sub_scenario, "Scripted event injection", NULL);
+
+// --- FSM Profile ---
+
+static void print_dwell(const struct shell *shell, const char *name,
+                        const fsm_profile_dwell_t *dwell, uint32_t ignored)
+{
+    if (dwell->count == 0 && ignored == 0) {
+        return;
+    }
+    shell_print(shell, "  %-22s %8u %10u %10u %8u", name, dwell->count,
+                dwell->count ? (uint32_t)(dwell->total_ms / dwell->count) : 0, dwell->max_ms,
+                ignored);
+}
+
+static int cmd_fsm_profile_show(const struct shell *shell, size_t argc, char **argv)
+{
+    // Too big for the shell stack
+    static fsm_profile_t profile;
+
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    if (fsm_profile_snapshot(controller_fsm_get_handle(), &profile) != 0) {
+        shell_error(shell, "The FSM is not profiled");
+        return -ENOENT;
+    }
+
+    shell_print(shell, "%u events, %u transitions", profile.events, profile.num_edges);
+    for (int i = 0; i < profile.num_edges; i++) {
+        const fsm_profile_edge_t *edge = &profile.edges[i];
+
+        shell_print(shell, "  %s %-22s --%3u--> %-22s %8u", edge->level == FSM_PROFILE_L1 ? "L1" : "L2",
+                    edge->level == FSM_PROFILE_L1 ? fsm_get_system_state_name(edge->from)
+                                                  : fsm_get_wash_cycle_state_name(edge->from),
+                    edge->event,
+                    edge->level == FSM_PROFILE_L1 ? fsm_get_system_state_name(edge->to)
+                                                  : fsm_get_wash_cycle_state_name(edge->to),
+                    edge->count);
+    }
+    if (profile.edge_overflow) {
+        shell_warn(shell, "%u transitions not recorded, edge table full", profile.edge_overflow);
+    }
+
+    shell_print(shell, "  %-22s %8s %10s %10s %8s", "state", "visits", "mean ms", "max ms",
+                "ignored");
+    for (int i = 0; i < STATE_L1_COUNT; i++) {
+        print_dwell(shell, fsm_get_system_state_name(i), &profile.l1_dwell[i],
+                    profile.l1_ignored[i]);
+    }
+    for (int i = 0; i < STATE_L2_COUNT; i++) {
+        print_dwell(shell, fsm_get_wash_cycle_state_name(i), &profile.l2_dwell[i],
+                    profile.l2_ignored[i]);
+    }
+
+    for (int i = 0; i < EVENT_ID_COUNT; i++) {
+        if (profile.ignored_by_event[i]) {
+            shell_print(shell, "  event %3d ignored %u times", i, profile.ignored_by_event[i]);
+        }
+    }
+    return 0;
+}
+
+static int cmd_fsm_profile_reset(const struct shell *shell, size_t argc, char **argv)
+{
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    if (fsm_profile_reset(controller_fsm_get_handle()) != 0) {
+        shell_error(shell, "The FSM is not profiled");
+        return -ENOENT;
+    }
+    shell_print(shell, "FSM profile cleared.");
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_fsm_profile,
+    SHELL_CMD(show, NULL, "Transitions, dwell times and ignored events", cmd_fsm_profile_show),
+    SHELL_CMD(reset, NULL, "Clear the profile", cmd_fsm_profile_reset),
+    SHELL_SUBCMD_SET_END
+);
+SHELL_CMD_REGISTER(fsm_profile, &sub_fsm_profile, "FSM transition profile", NULL);
+
+// --- Wash Programmes ---
+
+static int cmd_program_list(const struct shell *shell, size_t argc, char **argv)
+{
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    for (uint32_t id = 0; id < WASH_PROGRAM_COUNT; id++) {
+        const wash_program_t *program = wash_program_get(id);
+
+        shell_print(shell, "%u %-11s %2u C, %u rinse(s), %3u%% water, %4u rpm spin%s%s%s", id,
+                    program->name, program->target_temp_c, program->rinse_count,
+                    program->water_level_pct, program->spin_rpm,
+                    program->options & WASH_PROGRAM_PREWASH ? ", pre-wash" : "",
+                    program->options & WASH_PROGRAM_HEATING ? ", heating" : "",
+                    program->options & WASH_PROGRAM_STEAM ? ", steam" : "");
+    }
+    return 0;
+}
+
+static int cmd_program_select(const struct shell *shell, size_t argc, char **argv)
+{
+    ARG_UNUSED(argc);
+
+    const uint32_t id = (uint32_t)atoi(argv[1]);
+
+    if (!wash_program_get(id)) {
+        shell_error(shell, "Invalid programme: %u", id);
         return -EINVAL;
     }
 
-    const app_event_t event_to_post = { .id = event_id };
+    const app_event_t event = { .id = EVENT_CYCLE_SELECTED, .payload.u32 = id };
 
-    event_bus_post(&event_to_post);
-    shell_print(shell, "Posted event with ID: %d", event_id);
+    event_bus_post(&event);
+    shell_print(shell, "Selected %s.", wash_program_get(id)->name);
+    return 0;
+}
+
+static int cmd_program_remaining(const struct shell *shell, size_t argc, char **argv)
+{
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    const uint32_t remaining_s = controller_get_remaining_ms() / 1000;
+
+    shell_print(shell, "%u:%02u:%02u remaining", remaining_s / 3600, remaining_s / 60 % 60,
+                remaining_s % 60);
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_program,
+    SHELL_CMD(list, NULL, "List the wash programmes", cmd_program_list),
+    SHELL_CMD_ARG(select, NULL, "Select a programme: select <id>", cmd_program_select, 2, 0),
+    SHELL_CMD(remaining, NULL, "Time left in the cycle", cmd_program_remaining),
+    SHELL_SUBCMD_SET_END
+);
+SHELL_CMD_REGISTER(program, &sub_program, "Wash programmes", NULL);
+
+// --- Controller ---
+
+static int cmd_status(const struct shell *shell, size_t argc, char **argv)
+{
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    fsm_status_t status;
+    const wash_program_t *program;
+
+    controller_get_status(&status);
+    program = wash_program_get(status.program_id);
+    shell_print(shell, "%s / %s, %s", fsm_get_system_state_name(status.system_state),
+                fsm_get_wash_cycle_state_name(status.wash_cycle_state),
+                program ? program->name : "?");
+    if (status.phase_timeout_ms > 0) {
+        shell_print(shell, "Phase %u of %u s, %u s left in the cycle",
+                    (status.published_ms - status.phase_start_ms) / 1000,
+                    status.phase_timeout_ms / 1000, status.remaining_ms / 1000);
+    } else {
+        shell_print(shell, "Phase %u s, %u s left in the cycle",
+                    (status.published_ms - status.phase_start_ms) / 1000,
+                    status.remaining_ms / 1000);
+    }
+    return 0;
+}
+
+SHELL_CMD_REGISTER(status, NULL, "Machine state as of the last event", cmd_status);
+
+static int cmd_controller_stats(const struct shell *shell, size_t argc, char **argv)
+{
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    controller_stats_t stats;
+    fsm_notify_stats_t notify;
+
+    controller_get_stats(&stats);
+    fsm_notify_get_stats(&notify);
+    shell_print(shell, "%u events in %u batches, up to %u per batch", stats.events,
+                stats.batches, stats.max_batch);
+    shell_print(shell, "Post to FSM: mean %u us, max %u us",
+                stats.events ? (uint32_t)k_cyc_to_us_floor64(stats.latency_total_cycles /
+                                                             stats.events) : 0,
+                k_cyc_to_us_floor32(stats.latency_max_cycles));
+    shell_print(shell, "Dropped on a full queue: %u", stats.dropped);
+    shell_print(shell, "State changes: %u published, %u coalesced, %u not delivered",
+                notify.published, notify.coalesced, notify.failed);
+    return 0;
+}
+
+SHELL_CMD_REGISTER(controller_stats, NULL, "Controller queue, latency and drops",
+                   cmd_controller_stats);
+
+// --- Plant ---
+
+static int cmd_plant_show(const struct shell *shell, size_t argc, char **argv)
+{
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    static const char *const water_names[] = { "closed", "filling", "draining" };
+    sim_plant_t plant;
+    sim_plant_thread_stats_t stats;
+
+    sim_plant_thread_get(&plant, &stats);
+    shell_print(shell, "Water %d mm (%s), %d C (heater %s, target %d C), drum %d rpm (target %d)",
+                sim_plant_level_mm(&plant), water_names[plant.water], sim_plant_temp_c(&plant),
+                plant.heater_on ? "on" : "off", plant.target_temp_c, sim_plant_rpm(&plant),
+                plant.target_rpm);
+    shell_print(shell, "%u Hz, %llu steps, %u events posted, %u not delivered, %u steps skipped",
+                plant.params.rate_hz, plant.steps, stats.posted, stats.failed, stats.overruns);
+    return 0;
+}
+
+static int cmd_plant_rate(const struct shell *shell, size_t argc, char **argv)
+{
+    ARG_UNUSED(argc);
+
+    const uint32_t rate_hz = (uint32_t)atoi(argv[1]);
+
+    if (sim_plant_thread_start(rate_hz) != 0) {
+        shell_error(shell, "Rate must be 1 to %u Hz", SIM_PLANT_MAX_RATE_HZ);
+        return -EINVAL;
+    }
+    return 0;
+}
+
+static int cmd_plant_stop(const struct shell *shell, size_t argc, char **argv)
+{
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
 
+    sim_plant_thread_stop();
+    shell_print(shell, "Plant frozen, 'plant rate <hz>' runs it again.");
     return 0;
 }
-// Register the "send" command with subcommands for each event type
-// This makes the shell interface user-friendly and self-documenting.
-SHELL_CMD_REGISTER(send_event, NULL, "Send a specific event to the event bus", cmd_send_event);
+
+static int cmd_plant_water(const struct shell *shell, size_t argc, char **argv)
+{
+    ARG_UNUSED(argc);
+
+    if (strcmp(argv[1], "fill") == 0) {
+        sim_plant_thread_set_water(SIM_PLANT_WATER_FILL);
+    } else if (strcmp(argv[1], "drain") == 0) {
+        sim_plant_thread_set_water(SIM_PLANT_WATER_DRAIN);
+    } else if (strcmp(argv[1], "close") == 0) {
+        sim_plant_thread_set_water(SIM_PLANT_WATER_HOLD);
+    } else {
+        shell_error(shell, "Expected fill, drain or close");
+        return -EINVAL;
+    }
+    return 0;
+}
+
+// Actuators are commanded over the bus, as the controller would.
+static int post_command(event_id_t id, const char *arg)
+{
+    const app_event_t event = { .id = id, .payload.s32 = atoi(arg) };
+
+    return event_bus_post(&event);
+}
+
+static int cmd_plant_heat(const struct shell *shell, size_t argc, char **argv)
+{
+    ARG_UNUSED(shell);
+    ARG_UNUSED(argc);
+
+    return post_command(COMMAND_HEATER_SET_TEMP, argv[1]);
+}
+
+static int cmd_plant_spin(const struct shell *shell, size_t argc, char **argv)
+{
+    ARG_UNUSED(shell);
+    ARG_UNUSED(argc);
+
+    return post_command(COMMAND_MOTOR_SET_SPEED, argv[1]);
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_plant,
+    SHELL_CMD(show, NULL, "Water level, temperature and drum speed", cmd_plant_show),
+    SHELL_CMD_ARG(rate, NULL, "Run the plant: rate <hz>", cmd_plant_rate, 2, 0),
+    SHELL_CMD(stop, NULL, "Freeze the plant", cmd_plant_stop),
+    SHELL_CMD_ARG(water, NULL, "Water valves: water fill|drain|close", cmd_plant_water, 2, 0),
+    SHELL_CMD_ARG(heat, NULL, "Heater target: heat <celsius>, 0 for off", cmd_plant_heat, 2, 0),
+    SHELL_CMD_ARG(spin, NULL, "Drum speed: spin <rpm>", cmd_plant_spin, 2, 0),
+    SHELL_SUBCMD_SET_END
+);
+SHELL_CMD_REGISTER(plant, &sub_plant, "Physics simulation of water, heater and drum", NULL);
 
 void shell_interface_init(void) {
     // Nothing needed for now
 }
+
+// --- Door ---
+
+// Drives the emulated pin, the door sensor sees it as an interrupt.
+static int set_door(const struct shell *shell, bool closed)
+{
+    if (door_sensor_sim_set_state(closed) != 0) {
+        shell_error(shell, "Door sensor not initialized");
+        return -ENODEV;
+    }
+    return 0;
+}
+
+static int cmd_door_open(const struct shell *shell, size_t argc, char **argv)
+{
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    return set_door(shell, false);
+}
+
+static int cmd_door_close(const struct shell *shell, size_t argc, char **argv)
+{
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    return set_door(shell, true);
+}
+
+static int cmd_door_show(const struct shell *shell, size_t argc, char **argv)
+{
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    sensor_door_stats_t stats;
+
+    sensor_door_get_stats(&stats);
+    shell_print(shell, "Door %s, %u edges, %u changes, %u bounces",
+                sensor_door_get_state() == EVENT_DOOR_CLOSED ? "closed" : "open",
+                stats.edges, stats.changes, stats.bounces);
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_door,
+    SHELL_CMD(open, NULL, "Open the door", cmd_door_open),
+    SHELL_CMD(close, NULL, "Close the door", cmd_door_close),
+    SHELL_CMD(show, NULL, "Debounced state and counters", cmd_door_show),
+    SHELL_SUBCMD_SET_END
+);
+SHELL_CMD_REGISTER(door, &sub_door, "Door sensor", NULL);
@@ -0,0 +1,100 @@
+#include <zephyr/ztest.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include "event_bus.h"
+
+LOG_MODULE_REGISTER(bench_event_bus, CONFIG_LOG_DEFAULT_LEVEL);
+
+#define BENCH_ITERATIONS 2000
+#define BENCH_SUBSCRIBERS 2
+#define RECEIVER_STACK_SIZE 1024
+#define RECEIVER_PRIORITY 4
+
+// --- Context switch counting ---
+// Called by the kernel on every switch when CONFIG_TRACING_USER=y.
+static volatile uint32_t context_switches;
+
+void sys_trace_thread_switched_in_user(void)
+{
+	context_switches++;
+}
+
+#if defined(CONFIG_EVENT_BUS_USE_POLLING)
+
+K_MSGQ_DEFINE(bench_q0, sizeof(app_event_t), 8, 4);
+K_MSGQ_DEFINE(bench_q1, sizeof(app_event_t), 8, 4);
+static struct k_msgq *const bench_queues[BENCH_SUBSCRIBERS] = { &bench_q0, &bench_q1 };
+
+K_THREAD_STACK_ARRAY_DEFINE(receiver_stacks, BENCH_SUBSCRIBERS, RECEIVER_STACK_SIZE);
+static struct k_thread receiver_threads[BENCH_SUBSCRIBERS];
+static K_SEM_DEFINE(received_sem, 0, BENCH_SUBSCRIBERS);
+
+static void receiver_thread(void *p1, void *p2, void *p3)
+{
+	struct k_msgq *q = p1;
+	ARG_UNUSED(p2); ARG_UNUSED(p3);
+	app_event_t event;
+
+	while (1) {
+		k_msgq_get(q, &event, K_FOREVER);
+		k_sem_give(&received_sem);
+	}
+}
+
+static void *bench_setup(void)
+{
+	const event_id_t events[] = { EVENT_APP_MESSAGE_SENT };
+
+	zassert_ok(event_bus_init(), "event_bus_init() failed");
+	for (int i = 0; i < BENCH_SUBSCRIBERS; i++) {
+		zassert_not_null(event_bus_subscribe(bench_queues[i], events, ARRAY_SIZE(events)),
+				 "Subscription failed");
+		k_thread_create(&receiver_threads[i], receiver_stacks[i],
+				K_THREAD_STACK_SIZEOF(receiver_stacks[i]),
+				receiver_thread, bench_queues[i], NULL, NULL,
+				RECEIVER_PRIORITY, 0, K_NO_WAIT);
+	}
+	return NULL;
+}
+
+/**
+ * @brief Post-to-delivery round trip with every subscriber acknowledging.
+ *
+ * Measures cycles and context switches per event. The app_event_t copies
+ * per event are not measured: they follow from the mode, one per
+ * subscriber queue plus one into the central queue on the two-hop path,
+ * and are printed with the mode for reference.
+ */
+ZTEST(event_bus_bench_suite, test_polling_fan_out_cost)
+{
+	const app_event_t event = { .id = EVENT_APP_MESSAGE_SENT };
+	// By design, not counted
+	const uint32_t copies_per_event = BENCH_SUBSCRIBERS +
+		(IS_ENABLED(CONFIG_EVENT_BUS_DIRECT_DISPATCH) ? 0 : 1);
+
+	uint32_t switches_start = context_switches;
+	uint32_t start = k_cycle_get_32();
+
+	for (int i = 0; i < BENCH_ITERATIONS; i++) {
+		zassert_ok(event_bus_post(&event), "Post failed");
+		for (int s = 0; s < BENCH_SUBSCRIBERS; s++) {
+			zassert_ok(k_sem_take(&received_sem, K_MSEC(100)), "Event was not delivered");
+		}
+	}
+
+	uint32_t cycles = k_cycle_get_32() - start;
+	uint32_t switches = context_switches - switches_start;
+
+	TC_PRINT("mode: %s, subscribers: %d, event copies by design: %u\n",
+		 IS_ENABLED(CONFIG_EVENT_BUS_DIRECT_DISPATCH) ? "direct" : "two-hop",
+		 BENCH_SUBSCRIBERS, copies_per_event);
+	TC_PRINT("  cycles/event:           %u\n", cycles / BENCH_ITERATIONS);
+	TC_PRINT("  ns/event:               %u\n",
+		 (uint32_t)(k_cyc_to_ns_floor64(cycles) / BENCH_ITERATIONS));
+	TC_PRINT("  context switches/event: %u.%02u\n", switches / BENCH_ITERATIONS,
+		 (switches % BENCH_ITERATIONS) * 100 / BENCH_ITERATIONS);
+}
+
+ZTEST_SUITE(event_bus_bench_suite, NULL, bench_setup, NULL, NULL, NULL);
+
+#endif // CONFIG_EVENT_BUS_USE_POLLING
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "event_defs.h"
+#include "event_filter.h"
 #include <zephyr/kernel.h>
 
 #if defined(CONFIG_EVENT_BUS_USE_POLLING)
@@ -16,6 +17,19 @@ typedef struct event_subscription event_subscription_t;
 event_subscription_t* event_bus_subscribe(struct k_msgq *subscriber_msgq,
                                           const event_id_t *events_to_subscribe,
                                           size_t num_events);
+
+/**
+ * @brief Like event_bus_subscribe(), but only events whose payload passes
+ * @p filter are put into the queue. The filter is evaluated by the bus,
+ * so rejected events cost the subscriber neither a copy nor a wakeup.
+ *
+ * @param filter Payload filter, copied by the bus. NULL means no filter.
+ * @return Subscription handle, or NULL on failure or invalid filter.
+ */
+event_subscription_t* event_bus_subscribe_filtered(struct k_msgq *subscriber_msgq,
+                                                   const event_id_t *events_to_subscribe,
+                                                   size_t num_events,
+                                                   const event_filter_t *filter);
 /**
  * @brief Unsubscribes from events.
  */
@@ -39,14 +53,100 @@ typedef void (*event_handler_t)(const app_event_t *event);
 int event_bus_register_handler(event_handler_t handler,
                                const event_id_t *events_to_subscribe,
                                size_t num_events);
+
+/**
+ * @brief Like event_bus_register_handler(), but the handler is only scheduled
+ * for events whose payload passes @p filter.
+ *
+ * @param filter Payload filter, copied by the bus. NULL means no filter.
+ * @return 0 on success, -EINVAL for an invalid filter, or another negative error code.
+ */
+int event_bus_register_handler_filtered(event_handler_t handler,
+                                        const event_id_t *events_to_subscribe,
+                                        size_t num_events,
+                                        const event_filter_t *filter);
+
 #endif // CONFIG_EVENT_BUS_USE_CALLBACK
 
+/**
+ * @brief Backpressure counters of a queue sink, see event_bus_get_sink_stats().
+ */
+typedef struct {
+    uint32_t delivered;     // Events put into the queue
+    uint32_t dropped;       // Events lost because the queue was full
+    uint32_t high_water;    // Most messages seen in the queue after a put
+} event_bus_sink_stats_t;
+
+/**
+ * @brief Registers a message queue that receives specific events and is
+ * never waited on.
+ *
+ * An event that finds the queue full is dropped for this sink and
+ * counted, so a slow consumer never holds up the bus.
+ *
+ * In callback mode the event is copied into @p msgq straight from
+ * event_bus_post(), without a callback work item in between, and the post
+ * returns -ENOBUFS when the sink was full. In polling mode the sink is a
+ * subscription that the fan-out puts into with K_NO_WAIT; only a direct
+ * dispatch bus reports a full sink to the poster.
+ *
+ * @param filter Payload filter, copied by the bus. NULL means no filter.
+ * @return 0 on success, -EINVAL for invalid arguments or filter, -ENOMEM
+ *         when the sink or subscription table is full, or in polling mode
+ *         for more events than a subscription holds.
+ */
+int event_bus_register_queue_sink(struct k_msgq *msgq,
+                                  const event_id_t *events_to_subscribe,
+                                  size_t num_events,
+                                  const event_filter_t *filter);
+
+/**
+ * @brief Removes the queue sink feeding @p msgq and frees its slot.
+ *
+ * Waits for posts already delivering to the sink, so once this returns
+ * the bus no longer touches @p msgq. Do not call it from an ISR.
+ *
+ * @return 0 on success, -ENOENT if @p msgq is not a queue sink.
+ */
+int event_bus_unregister_queue_sink(struct k_msgq *msgq);
+
+/**
+ * @brief Gets the backpressure counters of the queue sink feeding @p msgq.
+ *
+ * @return 0 on success, -ENOENT if @p msgq is not a queue sink.
+ */
+int event_bus_get_sink_stats(struct k_msgq *msgq, event_bus_sink_stats_t *out);
+
 /**
  * @brief Initializes the Event Bus system.
+ *
+ * Drops every polling subscription and queue sink, so test suites can
+ * start from an empty bus.
  */
 int event_bus_init(void);
 
 /**
  * @brief Posts an event to all subscribers using the configured mechanism.
+ *
+ * The bus delivers a copy of @p event stamped with the sender thread, a
+ * cycle-counter timestamp and the next per-bus sequence number. Stamping
+ * uses no system call.
+ *
+ * Safe to call from an ISR: there the bus never waits for queue space,
+ * and an event that finds a queue full is lost.
+ *
+ * @return 0 on success, -EINVAL for an invalid event, -ENOBUFS if a queue
+ *         sink was full and missed the event, or another negative error code.
+ */
+int event_bus_post(const app_event_t *event);
+
+/**
+ * @brief Cycles elapsed since the event was posted.
+ *
+ * Convert with k_cyc_to_ns_floor64() or similar. Valid for intervals
+ * shorter than one wrap of the 32-bit cycle counter.
  */
-int event_bus_post(const app_event_t *event);
\ No newline at end of file
+static inline uint32_t event_bus_event_age_cycles(const app_event_t *event)
+{
+    return k_cycle_get_32() - event->timestamp;
+}
\ No newline at end of file
@@ -14,7 +14,7 @@ typedef enum {
     EVENT_APP_MESSAGE_SENT,         // Payload: message_id (int32_t)
     EVENT_CANCEL_BUTTON_PRESSED,
     EVENT_CYCLE_FINISHED,
-    EVENT_CYCLE_SELECTED,
+    EVENT_CYCLE_SELECTED,           // Payload: wash programme ID
     EVENT_DOOR_CLOSED,
     EVENT_DOOR_LOCKED,
     EVENT_DOOR_OPENED,
@@ -22,6 +22,7 @@ typedef enum {
     EVENT_DRUM_EMPTY,
     EVENT_DOSING_COMPLETE,
     EVENT_FATAL_FAULT_DETECTED,
+    EVENT_FSM_STATE_CHANGED,        // Payload: old and new FSM states, see fsm_notify.h
     EVENT_HEATER_TEMP_CHANGED,      // Payload: current_temp_celsius
     EVENT_MOTOR_SPEED_REPORT,       // Payload: current_rpm
     EVENT_MOTOR_STOPPED,
@@ -54,8 +55,17 @@ typedef union {
 } event_payload_t;
 
 
+/**
+ * @brief Event as seen by subscribers.
+ *
+ * Publishers only fill @c id and @c payload. event_bus_post() stamps the
+ * metadata fields on its own copy, so whatever the publisher left there
+ * is overwritten.
+ */
 typedef struct {
     event_id_t      id;
-    k_tid_t         sender_tid;
+    k_tid_t         sender_tid; // Posting thread, NULL when posted from an ISR
+    uint32_t        timestamp;  // k_cycle_get_32() when the event was posted
+    uint32_t        seq;        // Per-bus post counter, starts at 1 and wraps
     event_payload_t payload;
 } app_event_t;
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "event_defs.h"
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+
+/**
+ * @brief Kinds of payload predicates a subscription can attach.
+ *
+ * All filters interpret the payload as @c s32.
+ */
+typedef enum {
+    EVENT_FILTER_NONE = 0,          // Every event is delivered
+    EVENT_FILTER_RANGE,             // min <= s32 <= max
+    EVENT_FILTER_THRESHOLD_CROSSING,// s32 moved to the other side of 'level'
+    EVENT_FILTER_DELTA,             // |s32 - last delivered s32| >= min_change
+    EVENT_FILTER_EVERY_NTH,         // First event, then every n-th one
+} event_filter_type_t;
+
+/**
+ * @brief Declarative payload filter evaluated by the bus before delivery.
+ */
+typedef struct {
+    event_filter_type_t type;
+    union {
+        struct { int32_t min; int32_t max; } range;
+        struct { int32_t level; } threshold;
+        struct { int32_t min_change; } delta;
+        struct { uint32_t n; } every_nth;
+    };
+} event_filter_t;
+
+/**
+ * @brief Per-subscription filter instance: configuration plus the state
+ * the stateful filters need. Safe to evaluate from several posters.
+ */
+typedef struct {
+    event_filter_t filter;
+    atomic_t last;      // Last side (crossing) or last delivered value (delta)
+    atomic_t count;     // Events seen (every-Nth)
+    atomic_t primed;    // Set once 'last' holds a real sample
+} event_filter_state_t;
+
+/**
+ * @brief Checks a filter configuration.
+ *
+ * @return 0 if valid, -EINVAL otherwise.
+ */
+int event_filter_validate(const event_filter_t *filter);
+
+/**
+ * @brief Initializes a filter instance. A NULL filter means EVENT_FILTER_NONE.
+ */
+void event_filter_state_init(event_filter_state_t *state, const event_filter_t *filter);
+
+/**
+ * @brief Evaluates the filter for one payload and updates its state.
+ *
+ * The first sample only primes a threshold-crossing filter; a delta
+ * filter delivers it as its baseline.
+ *
+ * @return True if the event should be delivered.
+ */
+bool event_filter_match(event_filter_state_t *state, const event_payload_t *payload);
@@ -4,6 +4,51 @@
 
 LOG_MODULE_REGISTER(event_bus, CONFIG_LOG_DEFAULT_LEVEL);
 
+// Per-bus sequence counter used to stamp posted events.
+static atomic_t post_seq = ATOMIC_INIT(0);
+
+// --- Queue sinks ---
+// A queue sink is a subscriber queue the bus never waits on. An event
+// that finds it full is dropped for that queue and counted.
+typedef struct {
+    atomic_t delivered;
+    atomic_t dropped;
+    atomic_t high_water;
+} sink_counters_t;
+
+static void sink_counters_reset(sink_counters_t *counters)
+{
+    atomic_set(&counters->delivered, 0);
+    atomic_set(&counters->dropped, 0);
+    atomic_set(&counters->high_water, 0);
+}
+
+static void sink_counters_get(sink_counters_t *counters, event_bus_sink_stats_t *out)
+{
+    out->delivered = atomic_get(&counters->delivered);
+    out->dropped = atomic_get(&counters->dropped);
+    out->high_water = atomic_get(&counters->high_water);
+}
+
+// Puts the event into the sink's queue without waiting.
+// Returns -ENOBUFS if the queue was full.
+static int sink_put(sink_counters_t *counters, struct k_msgq *msgq, const app_event_t *event)
+{
+    if (k_msgq_put(msgq, event, K_NO_WAIT) != 0) {
+        atomic_inc(&counters->dropped);
+        return -ENOBUFS;
+    }
+    atomic_inc(&counters->delivered);
+
+    atomic_val_t used = k_msgq_num_used_get(msgq);
+    atomic_val_t seen = atomic_get(&counters->high_water);
+
+    while (used > seen && !atomic_cas(&counters->high_water, seen, used)) {
+        seen = atomic_get(&counters->high_water);
+    }
+    return 0;
+}
+
 #if defined(CONFIG_EVENT_BUS_USE_CALLBACK)
 // --- BEGIN: Corrected Callback Implementation ---
 
@@ -16,12 +61,14 @@ LOG_MODULE_REGISTER(event_bus, CONFIG_LOG_DEFAULT_LEVEL);
 // 1. Define the work queue struct and its stack separately.
 static struct k_work_q event_callback_q;
 K_THREAD_STACK_DEFINE(event_callback_q_stack, WORK_QUEUE_STACK_SIZE);
+static bool callback_q_started;
 // --- END CORRECT METHOD ---
 
 typedef struct {
     event_handler_t handler;
     event_id_t subscribed_events[MAX_EVENTS_PER_HANDLER];
     size_t num_events;
+    event_filter_state_t filter;
 } handler_subscription_t;
 
 static handler_subscription_t handler_subscriptions[MAX_EVENT_HANDLERS];
@@ -47,11 +94,21 @@ static void event_work_handler(struct k_work *work)
 int event_bus_register_handler(event_handler_t handler,
                                const event_id_t *events_to_subscribe,
                                size_t num_events)
+{
+    return event_bus_register_handler_filtered(handler, events_to_subscribe, num_events, NULL);
+}
+
+int event_bus_register_handler_filtered(event_handler_t handler,
+                                        const event_id_t *events_to_subscribe,
+                                        size_t num_events,
+                                        const event_filter_t *filter)
 {
     if (handler_count >= MAX_EVENT_HANDLERS) return -ENOMEM;
     if (num_events > MAX_EVENTS_PER_HANDLER) return -ENOMEM;
     if (!handler || !events_to_subscribe || num_events == 0) return -EINVAL;
+    if (event_filter_validate(filter) != 0) return -EINVAL;
 
+    event_filter_state_init(&handler_subscriptions[handler_count].filter, filter);
     handler_subscriptions[handler_count].handler = handler;
     handler_subscriptions[handler_count].num_events = num_events;
     memcpy(handler_subscriptions[handler_count].subscribed_events,
@@ -60,6 +117,149 @@ int event_bus_register_handler(event_handler_t handler,
     handler_count++;
     return 0;
 }
+
+// --- Queue sinks ---
+// Subscribers that only want the event in their own queue skip the work
+// item: event_bus_post() copies it there directly.
+#define MAX_QUEUE_SINKS CONFIG_EVENT_BUS_MAX_QUEUE_SINKS
+
+typedef struct {
+    atomic_ptr_t msgq;          // NULL while the slot is free
+    atomic_t readers;           // Posts currently using the slot
+    event_filter_state_t filter;
+    sink_counters_t counters;
+} queue_sink_t;
+
+static queue_sink_t queue_sinks[MAX_QUEUE_SINKS];
+// Serializes registration against itself; posters never take it.
+static K_MUTEX_DEFINE(sink_mutex);
+// Bit i of sink_mask[id] is set when queue sink i wants event 'id'. The
+// bits are set once the sink is complete, so posters never see half of it.
+BUILD_ASSERT(MAX_QUEUE_SINKS <= 32, "sink_mask holds one bit per sink");
+static atomic_t sink_mask[EVENT_ID_COUNT];
+
+// Must be called with sink_mutex held.
+static queue_sink_t *queue_sink_find(struct k_msgq *msgq)
+{
+    for (int i = 0; i < MAX_QUEUE_SINKS; i++) {
+        if (atomic_ptr_get(&queue_sinks[i].msgq) == msgq) {
+            return &queue_sinks[i];
+        }
+    }
+    return NULL;
+}
+
+static void queue_sinks_reset(void)
+{
+    k_mutex_lock(&sink_mutex, K_FOREVER);
+    for (int i = 0; i < EVENT_ID_COUNT; i++) {
+        atomic_clear(&sink_mask[i]);
+    }
+    for (int i = 0; i < MAX_QUEUE_SINKS; i++) {
+        atomic_ptr_clear(&queue_sinks[i].msgq);
+    }
+    k_mutex_unlock(&sink_mutex);
+}
+
+int event_bus_register_queue_sink(struct k_msgq *msgq,
+                                  const event_id_t *events_to_subscribe,
+                                  size_t num_events,
+                                  const event_filter_t *filter)
+{
+    if (!msgq || !events_to_subscribe || num_events == 0) return -EINVAL;
+    if (event_filter_validate(filter) != 0) return -EINVAL;
+
+    k_mutex_lock(&sink_mutex, K_FOREVER);
+    queue_sink_t *sink = queue_sink_find(NULL);
+
+    if (!sink) {
+        k_mutex_unlock(&sink_mutex);
+        return -ENOMEM;
+    }
+
+    int slot = sink - queue_sinks;
+
+    event_filter_state_init(&sink->filter, filter);
+    sink_counters_reset(&sink->counters);
+    atomic_ptr_set(&sink->msgq, msgq);
+    for (size_t i = 0; i < num_events; i++) {
+        if (events_to_subscribe[i] < EVENT_ID_COUNT) {
+            atomic_or(&sink_mask[events_to_subscribe[i]], BIT(slot));
+        }
+    }
+    k_mutex_unlock(&sink_mutex);
+    return 0;
+}
+
+int event_bus_unregister_queue_sink(struct k_msgq *msgq)
+{
+    if (!msgq) return -EINVAL;
+
+    k_mutex_lock(&sink_mutex, K_FOREVER);
+    queue_sink_t *sink = queue_sink_find(msgq);
+
+    if (!sink) {
+        k_mutex_unlock(&sink_mutex);
+        return -ENOENT;
+    }
+
+    int slot = sink - queue_sinks;
+
+    // Stop new posts first, then free the slot.
+    for (int i = 0; i < EVENT_ID_COUNT; i++) {
+        atomic_and(&sink_mask[i], ~BIT(slot));
+    }
+    atomic_ptr_clear(&sink->msgq);
+    // A post that picked the slot before may still be putting into the
+    // queue. It never waits, so sleep until it is done. Later posts see
+    // the slot cleared and leave it alone.
+    while (atomic_get(&sink->readers) != 0) {
+        k_msleep(1);
+    }
+    k_mutex_unlock(&sink_mutex);
+    return 0;
+}
+
+int event_bus_get_sink_stats(struct k_msgq *msgq, event_bus_sink_stats_t *out)
+{
+    if (!msgq) return -EINVAL;
+
+    k_mutex_lock(&sink_mutex, K_FOREVER);
+    queue_sink_t *sink = queue_sink_find(msgq);
+
+    if (sink && out) {
+        sink_counters_get(&sink->counters, out);
+    }
+    k_mutex_unlock(&sink_mutex);
+    return sink ? 0 : -ENOENT;
+}
+
+// Puts the event into every queue sink registered for its ID, never
+// waiting. Returns -ENOBUFS if any of them was full.
+static int dispatch_to_sinks(const app_event_t *event)
+{
+    int result = 0;
+    uint32_t mask = (uint32_t)atomic_get(&sink_mask[event->id]);
+
+    while (mask) {
+        int slot = find_lsb_set(mask) - 1;
+        queue_sink_t *sink = &queue_sinks[slot];
+
+        mask &= ~BIT(slot);
+        // Announce the post before looking at the slot, so unregistering
+        // waits for it. Skip a slot unregistered since the mask was read.
+        atomic_inc(&sink->readers);
+        struct k_msgq *msgq = atomic_ptr_get(&sink->msgq);
+
+        if (msgq && (atomic_get(&sink_mask[event->id]) & BIT(slot)) &&
+            event_filter_match(&sink->filter, &event->payload) &&
+            sink_put(&sink->counters, msgq, event) != 0) {
+            result = -ENOBUFS;
+        }
+        atomic_dec(&sink->readers);
+    }
+    return result;
+}
 // --- END: Corrected Callback Implementation ---
 #endif // CONFIG_EVENT_BUS_USE_CALLBACK
 
@@ -68,15 +268,150 @@ int event_bus_register_handler(event_handler_t handler,
 #define MAX_SUBSCRIPTIONS 16
 #define MAX_EVENTS_PER_SUBSCRIPTION 24
 #define CENTRAL_QUEUE_CAPACITY 32
+#define POST_TIMEOUT K_MSEC(100)
+// Upper bound a fan-out may block on one full subscriber queue. It also
+// bounds how long event_bus_unsubscribe() waits for in-flight deliveries.
+#define SUBSCRIBER_PUT_TIMEOUT K_MSEC(100)
 typedef struct {
     bool is_used;
+    bool is_sink;           // Never waited on, see event_bus_register_queue_sink()
     struct k_msgq *subscriber_msgq;
     event_id_t subscribed_events[MAX_EVENTS_PER_SUBSCRIPTION];
     size_t num_events;
+    event_filter_state_t filter;
+    sink_counters_t counters;
 } subscription_t;
-K_MSGQ_DEFINE(central_event_q, sizeof(app_event_t), CENTRAL_QUEUE_CAPACITY, 4);
+// Subscription bookkeeping, only touched by writers under subscription_mutex.
 static subscription_t subscription_pool[MAX_SUBSCRIPTIONS];
 static K_MUTEX_DEFINE(subscription_mutex);
+
+// --- Read-mostly subscription table ---
+// The fan-out never takes subscription_mutex. It reads an immutable,
+// published table instead. Writers copy the active table into the spare
+// one, modify the copy and publish it with a single atomic pointer store.
+// A table is only reused once its reader count has dropped to zero.
+//
+// Subscriber index: bit i of subscriber_mask[id] is set when slot i wants
+// event 'id'. Lets the fan-out visit only the matching queues instead of
+// scanning every subscription.
+BUILD_ASSERT(MAX_SUBSCRIPTIONS <= 32, "subscriber_mask holds one bit per subscription");
+typedef struct {
+    atomic_t readers;
+    struct k_msgq *subscriber_msgq[MAX_SUBSCRIPTIONS];
+    event_filter_state_t *subscriber_filter[MAX_SUBSCRIPTIONS]; // NULL: no filter
+    sink_counters_t *subscriber_sink[MAX_SUBSCRIPTIONS];        // NULL: may wait
+    uint32_t subscriber_mask[EVENT_ID_COUNT];
+} subscription_table_t;
+
+static subscription_table_t subscription_tables[2];
+static atomic_ptr_t active_table = ATOMIC_PTR_INIT(&subscription_tables[0]);
+
+static subscription_table_t *subscription_table_acquire(void)
+{
+    subscription_table_t *table;
+
+    while (1) {
+        table = atomic_ptr_get(&active_table);
+        atomic_inc(&table->readers);
+        // Re-check after announcing ourselves: if a writer published in
+        // between, the table may already be recycled, so try again.
+        if (table == atomic_ptr_get(&active_table)) {
+            return table;
+        }
+        atomic_dec(&table->readers);
+    }
+}
+
+static void subscription_table_release(subscription_table_t *table)
+{
+    atomic_dec(&table->readers);
+}
+
+static void subscription_table_wait_quiescent(subscription_table_t *table)
+{
+    // Readers hold a table for at most one fan-out, which is bounded by
+    // SUBSCRIBER_PUT_TIMEOUT per subscriber. Sleep so that lower priority
+    // readers can finish.
+    while (atomic_get(&table->readers) != 0) {
+        k_msleep(1);
+    }
+}
+
+// Returns the spare table holding a copy of the active one.
+// Must be called with subscription_mutex held.
+static subscription_table_t *subscription_table_begin_update(void)
+{
+    subscription_table_t *current = atomic_ptr_get(&active_table);
+    subscription_table_t *next = (current == &subscription_tables[0]) ?
+                                 &subscription_tables[1] : &subscription_tables[0];
+
+    subscription_table_wait_quiescent(next);
+    memcpy(next->subscriber_msgq, current->subscriber_msgq, sizeof(next->subscriber_msgq));
+    memcpy(next->subscriber_filter, current->subscriber_filter, sizeof(next->subscriber_filter));
+    memcpy(next->subscriber_sink, current->subscriber_sink, sizeof(next->subscriber_sink));
+    memcpy(next->subscriber_mask, current->subscriber_mask, sizeof(next->subscriber_mask));
+    return next;
+}
+
+// Publishes 'next' and returns the table it replaced.
+// Must be called with subscription_mutex held.
+static subscription_table_t *subscription_table_publish(subscription_table_t *next)
+{
+    return atomic_ptr_set(&active_table, next);
+}
+
+static void subscriber_index_update(subscription_table_t *table, int slot,
+                                    subscription_t *sub, bool subscribed)
+{
+    bool filtered = subscribed && sub->filter.filter.type != EVENT_FILTER_NONE;
+
+    table->subscriber_msgq[slot] = subscribed ? sub->subscriber_msgq : NULL;
+    table->subscriber_filter[slot] = filtered ? &sub->filter : NULL;
+    table->subscriber_sink[slot] = subscribed && sub->is_sink ? &sub->counters : NULL;
+    for (size_t j = 0; j < sub->num_events; j++) {
+        if (sub->subscribed_events[j] >= EVENT_ID_COUNT) continue;
+        if (subscribed) {
+            table->subscriber_mask[sub->subscribed_events[j]] |= BIT(slot);
+        } else {
+            table->subscriber_mask[sub->subscribed_events[j]] &= ~BIT(slot);
+        }
+    }
+}
+
+// Puts the event into every subscriber queue registered for its ID.
+// Lock-free with respect to subscribe/unsubscribe. Queue sinks are never
+// waited on; the result is -ENOBUFS if one of them was full.
+static int dispatch_to_subscribers(const app_event_t *event, k_timeout_t timeout)
+{
+    int result = 0;
+    subscription_table_t *table = subscription_table_acquire();
+    uint32_t mask = table->subscriber_mask[event->id];
+
+    while (mask) {
+        int slot = find_lsb_set(mask) - 1;
+        mask &= ~BIT(slot);
+        if (table->subscriber_filter[slot] &&
+            !event_filter_match(table->subscriber_filter[slot], &event->payload)) {
+            continue;
+        }
+        if (table->subscriber_sink[slot]) {
+            if (sink_put(table->subscriber_sink[slot], table->subscriber_msgq[slot], event) != 0) {
+                result = -ENOBUFS;
+            }
+            continue;
+        }
+        int ret = k_msgq_put(table->subscriber_msgq[slot], event, timeout);
+        if (ret != 0) {
+            LOG_WRN("Failed to put event %d into sub queue %p", event->id, (void*)table->subscriber_msgq[slot]);
+            result = ret;
+        }
+    }
+    subscription_table_release(table);
+    return result;
+}
+
+#if !defined(CONFIG_EVENT_BUS_DIRECT_DISPATCH)
+K_MSGQ_DEFINE(central_event_q, sizeof(app_event_t), CENTRAL_QUEUE_CAPACITY, 4);
 #define DISPATCHER_STACK_SIZE 1024
 #define DISPATCHER_PRIORITY 5
 K_THREAD_STACK_DEFINE(dispatcher_stack_area, DISPATCHER_STACK_SIZE);
@@ -87,29 +422,21 @@ static void event_dispatcher_thread(void *p1, void *p2, void *p3) {
     app_event_t received_event;
     while (1) {
         k_msgq_get(&central_event_q, &received_event, K_FOREVER);
-        k_mutex_lock(&subscription_mutex, K_FOREVER);
-        for (int i = 0; i < MAX_SUBSCRIPTIONS; i++) {
-            if (!subscription_pool[i].is_used) continue;
-            for (int j = 0; j < subscription_pool[i].num_events; j++) {
-                if (subscription_pool[i].subscribed_events[j] == received_event.id) {
-                    if (k_msgq_put(subscription_pool[i].subscriber_msgq, &received_event, K_FOREVER) != 0) {
-                         LOG_WRN("Failed to put event %d into sub queue %p", received_event.id, (void*)subscription_pool[i].subscriber_msgq);
-                    }
-                    break;
-                }
-            }
-        }
-        k_mutex_unlock(&subscription_mutex);
+        (void)dispatch_to_subscribers(&received_event, SUBSCRIBER_PUT_TIMEOUT);
     }
 }
-event_subscription_t* event_bus_subscribe(struct k_msgq *subscriber_msgq, const event_id_t *events_to_subscribe, size_t num_events) {
-    if (!subscriber_msgq || !events_to_subscribe || num_events == 0) return NULL;
-    if (num_events > MAX_EVENTS_PER_SUBSCRIPTION) return NULL;
+#endif // !CONFIG_EVENT_BUS_DIRECT_DISPATCH
+
+// Takes a free slot and publishes it. Arguments are checked by the caller.
+static subscription_t *subscribe(struct k_msgq *subscriber_msgq, const event_id_t *events_to_subscribe,
+                                 size_t num_events, const event_filter_t *filter, bool is_sink)
+{
     k_mutex_lock(&subscription_mutex, K_FOREVER);
     subscription_t *new_subscription = NULL;
-    for (int i = 0; i < MAX_SUBSCRIPTIONS; i++) {
-        if (!subscription_pool[i].is_used) {
-            new_subscription = &subscription_pool[i];
+    int slot;
+    for (slot = 0; slot < MAX_SUBSCRIPTIONS; slot++) {
+        if (!subscription_pool[slot].is_used) {
+            new_subscription = &subscription_pool[slot];
             new_subscription->is_used = true;
             break;
         }
@@ -118,60 +445,185 @@ event_subscription_t* event_bus_subscribe(struct k_msgq *subscriber_msgq, const
         k_mutex_unlock(&subscription_mutex);
         return NULL;
     }
+    new_subscription->is_sink = is_sink;
     new_subscription->subscriber_msgq = subscriber_msgq;
     new_subscription->num_events = num_events;
     memcpy(new_subscription->subscribed_events, events_to_subscribe, num_events * sizeof(event_id_t));
+    event_filter_state_init(&new_subscription->filter, filter);
+    sink_counters_reset(&new_subscription->counters);
+
+    subscription_table_t *next = subscription_table_begin_update();
+    subscriber_index_update(next, slot, new_subscription, true);
+    subscription_table_publish(next);
     k_mutex_unlock(&subscription_mutex);
-    return (event_subscription_t*)new_subscription;
+    return new_subscription;
+}
+
+// Must be called with subscription_mutex held.
+static void unsubscribe_locked(subscription_t *sub)
+{
+    if (sub->is_used) {
+        subscription_table_t *next = subscription_table_begin_update();
+        subscriber_index_update(next, sub - subscription_pool, sub, false);
+        subscription_table_t *old = subscription_table_publish(next);
+        // Fan-outs that started on the old table may still reference the
+        // queue. Once they drain, no further delivery can reach it.
+        subscription_table_wait_quiescent(old);
+        sub->is_used = false;
+    }
+}
+
+// Must be called with subscription_mutex held.
+static subscription_t *queue_sink_find(struct k_msgq *msgq)
+{
+    for (int i = 0; i < MAX_SUBSCRIPTIONS; i++) {
+        subscription_t *sub = &subscription_pool[i];
+
+        if (sub->is_used && sub->is_sink && sub->subscriber_msgq == msgq) {
+            return sub;
+        }
+    }
+    return NULL;
+}
+
+event_subscription_t* event_bus_subscribe(struct k_msgq *subscriber_msgq, const event_id_t *events_to_subscribe, size_t num_events) {
+    return event_bus_subscribe_filtered(subscriber_msgq, events_to_subscribe, num_events, NULL);
+}
+event_subscription_t* event_bus_subscribe_filtered(struct k_msgq *subscriber_msgq, const event_id_t *events_to_subscribe, size_t num_events, const event_filter_t *filter) {
+    if (!subscriber_msgq || !events_to_subscribe || num_events == 0) return NULL;
+    if (num_events > MAX_EVENTS_PER_SUBSCRIPTION) return NULL;
+    if (event_filter_validate(filter) != 0) return NULL;
+    return (event_subscription_t*)subscribe(subscriber_msgq, events_to_subscribe, num_events, filter, false);
 }
 int event_bus_unsubscribe(event_subscription_t* subscription) {
     if (!subscription) return -EINVAL;
     k_mutex_lock(&subscription_mutex, K_FOREVER);
-    ((subscription_t*)subscription)->is_used = false;
+    unsubscribe_locked((subscription_t*)subscription);
     k_mutex_unlock(&subscription_mutex);
     return 0;
 }
+
+int event_bus_register_queue_sink(struct k_msgq *msgq,
+                                  const event_id_t *events_to_subscribe,
+                                  size_t num_events,
+                                  const event_filter_t *filter)
+{
+    if (!msgq || !events_to_subscribe || num_events == 0) return -EINVAL;
+    if (event_filter_validate(filter) != 0) return -EINVAL;
+    if (num_events > MAX_EVENTS_PER_SUBSCRIPTION) return -ENOMEM;
+
+    return subscribe(msgq, events_to_subscribe, num_events, filter, true) ? 0 : -ENOMEM;
+}
+
+int event_bus_unregister_queue_sink(struct k_msgq *msgq)
+{
+    if (!msgq) return -EINVAL;
+
+    k_mutex_lock(&subscription_mutex, K_FOREVER);
+    subscription_t *sub = queue_sink_find(msgq);
+
+    if (sub) {
+        unsubscribe_locked(sub);
+    }
+    k_mutex_unlock(&subscription_mutex);
+    return sub ? 0 : -ENOENT;
+}
+
+int event_bus_get_sink_stats(struct k_msgq *msgq, event_bus_sink_stats_t *out)
+{
+    if (!msgq) return -EINVAL;
+
+    k_mutex_lock(&subscription_mutex, K_FOREVER);
+    subscription_t *sub = queue_sink_find(msgq);
+
+    if (sub && out) {
+        sink_counters_get(&sub->counters, out);
+    }
+    k_mutex_unlock(&subscription_mutex);
+    return sub ? 0 : -ENOENT;
+}
 // --- END: Polling-only Implementation ---
 #endif // CONFIG_EVENT_BUS_USE_POLLING
 
 
 int event_bus_init(void)
 {
+    atomic_set(&post_seq, 0);
+
 #if defined(CONFIG_EVENT_BUS_USE_POLLING)
     k_mutex_init(&subscription_mutex);
     for (int i = 0; i < MAX_SUBSCRIPTIONS; i++) {
         subscription_pool[i].is_used = false;
     }
-    dispatcher_tid = k_thread_create(&dispatcher_thread_data, dispatcher_stack_area,
-                                  K_THREAD_STACK_SIZEOF(dispatcher_stack_area),
-                                  event_dispatcher_thread, NULL, NULL, NULL,
-                                  DISPATCHER_PRIORITY, 0, K_NO_WAIT);
-    if (!dispatcher_tid) return -1;
-    k_thread_name_set(dispatcher_tid, "event_dispatcher");
+    memset(subscription_tables, 0, sizeof(subscription_tables));
+    atomic_ptr_set(&active_table, &subscription_tables[0]);
+#if !defined(CONFIG_EVENT_BUS_DIRECT_DISPATCH)
+    // A second init keeps the running dispatcher.
+    if (!dispatcher_tid) {
+        dispatcher_tid = k_thread_create(&dispatcher_thread_data, dispatcher_stack_area,
+                                      K_THREAD_STACK_SIZEOF(dispatcher_stack_area),
+                                      event_dispatcher_thread, NULL, NULL, NULL,
+                                      DISPATCHER_PRIORITY, 0, K_NO_WAIT);
+        if (!dispatcher_tid) return -1;
+        k_thread_name_set(dispatcher_tid, "event_dispatcher");
+    }
+#endif // !CONFIG_EVENT_BUS_DIRECT_DISPATCH
 #endif
 
 #if defined(CONFIG_EVENT_BUS_USE_CALLBACK)
-    k_work_queue_start(&event_callback_q, event_callback_q_stack,
-                       K_THREAD_STACK_SIZEOF(event_callback_q_stack), 5, /* Priority */
-                       NULL); /* Options */
-    k_thread_name_set(&event_callback_q.thread, "event_callbacks");
+    queue_sinks_reset();
+    // A second init keeps the running work queue.
+    if (!callback_q_started) {
+        k_work_queue_start(&event_callback_q, event_callback_q_stack,
+                           K_THREAD_STACK_SIZEOF(event_callback_q_stack), 5, /* Priority */
+                           NULL); /* Options */
+        k_thread_name_set(&event_callback_q.thread, "event_callbacks");
+        callback_q_started = true;
+    }
 #endif
 
     LOG_INF("Event Bus initialized.");
     return 0;
 }
 
-int event_bus_post(const app_event_t *event)
+// Copies the caller's event and fills in the metadata. Cheap enough for the
+// hot path: no system call, one atomic increment and a cycle counter read.
+static inline void event_stamp(app_event_t *stamped, const app_event_t *event)
 {
-    if (!event) return -EINVAL;
+    *stamped = *event;
+    stamped->sender_tid = k_is_in_isr() ? NULL : k_current_get();
+    stamped->timestamp = k_cycle_get_32();
+    stamped->seq = (uint32_t)atomic_inc(&post_seq) + 1U;
+}
 
-#if defined(CONFIG_EVENT_BUS_USE_POLLING)
-    return k_msgq_put(&central_event_q, event, K_MSEC(100));
+int event_bus_post(const app_event_t *posted_event)
+{
+    if (!posted_event) return -EINVAL;
+    if (posted_event->id >= EVENT_ID_COUNT) return -EINVAL;
+
+    app_event_t stamped;
+    const app_event_t *event = &stamped;
+    event_stamp(&stamped, posted_event);
+
+#if defined(CONFIG_EVENT_BUS_USE_POLLING) && defined(CONFIG_EVENT_BUS_DIRECT_DISPATCH)
+    // Single hop: copy straight into the subscriber queues from here.
+    // The fan-out is lock-free, so this is also safe from an ISR.
+    return dispatch_to_subscribers(event, k_is_in_isr() ? K_NO_WAIT : POST_TIMEOUT);
+
+#elif defined(CONFIG_EVENT_BUS_USE_POLLING)
+    // An ISR must not wait, so it gets -ENOMSG on a full central queue.
+    return k_msgq_put(&central_event_q, event, k_is_in_isr() ? K_NO_WAIT : POST_TIMEOUT);
 
 #elif defined(CONFIG_EVENT_BUS_USE_CALLBACK)
+    int result = dispatch_to_sinks(event);
+
     for (int i = 0; i < handler_count; ++i) {
         for (int j = 0; j < handler_subscriptions[i].num_events; ++j) {
             if (handler_subscriptions[i].subscribed_events[j] == event->id) {
+                // Evaluate the payload filter before spending a work item.
+                if (!event_filter_match(&handler_subscriptions[i].filter, &event->payload)) {
+                    break;
+                }
                 event_work_item_t *work_item;
                 if (k_mem_slab_alloc(&work_item_slab, (void **)&work_item, K_NO_WAIT) != 0) {
                     LOG_ERR("Failed to allocate work item.");
@@ -185,7 +637,7 @@ int event_bus_post(const app_event_t *event)
             }
         }
     }
-    return 0;
+    return result;
 
 #else
     #error "No event bus subscriber mechanism selected"
@@ -0,0 +1,87 @@
+#include "event_filter.h"
+#include <stdlib.h>
+
+int event_filter_validate(const event_filter_t *filter)
+{
+    if (!filter) return 0;
+
+    switch (filter->type) {
+        case EVENT_FILTER_NONE:
+        case EVENT_FILTER_THRESHOLD_CROSSING:
+            return 0;
+        case EVENT_FILTER_RANGE:
+            return (filter->range.min <= filter->range.max) ? 0 : -EINVAL;
+        case EVENT_FILTER_DELTA:
+            return (filter->delta.min_change >= 0) ? 0 : -EINVAL;
+        case EVENT_FILTER_EVERY_NTH:
+            return (filter->every_nth.n > 0) ? 0 : -EINVAL;
+    }
+    return -EINVAL;
+}
+
+void event_filter_state_init(event_filter_state_t *state, const event_filter_t *filter)
+{
+    if (!state) return;
+
+    if (filter) {
+        state->filter = *filter;
+    } else {
+        state->filter.type = EVENT_FILTER_NONE;
+    }
+    atomic_set(&state->last, 0);
+    atomic_set(&state->count, 0);
+    atomic_set(&state->primed, 0);
+}
+
+static bool match_crossing(event_filter_state_t *state, int32_t value)
+{
+    atomic_val_t side = (value >= state->filter.threshold.level) ? 1 : 0;
+    atomic_val_t previous_side = atomic_set(&state->last, side);
+
+    if (!atomic_cas(&state->primed, 0, 1)) {
+        return previous_side != side;
+    }
+    return false;
+}
+
+static bool match_delta(event_filter_state_t *state, int32_t value)
+{
+    if (atomic_cas(&state->primed, 0, 1)) {
+        atomic_set(&state->last, value);
+        return true;
+    }
+
+    while (1) {
+        atomic_val_t last = atomic_get(&state->last);
+        int64_t change = (int64_t)value - (int32_t)last;
+
+        if (llabs(change) < state->filter.delta.min_change) {
+            return false;
+        }
+        // Only the poster that moves 'last' delivers the sample.
+        if (atomic_cas(&state->last, last, value)) {
+            return true;
+        }
+    }
+}
+
+bool event_filter_match(event_filter_state_t *state, const event_payload_t *payload)
+{
+    if (!state || !payload) return true;
+
+    int32_t value = payload->s32;
+
+    switch (state->filter.type) {
+        case EVENT_FILTER_NONE:
+            return true;
+        case EVENT_FILTER_RANGE:
+            return value >= state->filter.range.min && value <= state->filter.range.max;
+        case EVENT_FILTER_THRESHOLD_CROSSING:
+            return match_crossing(state, value);
+        case EVENT_FILTER_DELTA:
+            return match_delta(state, value);
+        case EVENT_FILTER_EVERY_NTH:
+            return ((uint32_t)atomic_inc(&state->count) % state->filter.every_nth.n) == 0;
+    }
+    return true;
+}
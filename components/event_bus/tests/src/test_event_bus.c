@@ -9,18 +9,28 @@ LOG_MODULE_REGISTER(ztest_event_bus, CONFIG_LOG_DEFAULT_LEVEL);
 // All definitions and tests for this suite are now inside this block.
 #if defined(CONFIG_EVENT_BUS_USE_POLLING)
 
-static void event_bus_polling_before(void *data)
+static void *event_bus_polling_setup(void)
 {
-	ARG_UNUSED(data);
 	zassert_ok(event_bus_init(), "event_bus_init() failed");
+	return NULL;
 }
 
 K_MSGQ_DEFINE(polling_test_q, sizeof(app_event_t), 4, 4);
+K_MSGQ_DEFINE(polling_test_q2, sizeof(app_event_t), 4, 4);
+
+static event_subscription_t *test_subs[2];
 
 static void event_bus_polling_after(void *data)
 {
 	ARG_UNUSED(data);
+	for (int i = 0; i < ARRAY_SIZE(test_subs); i++) {
+		if (test_subs[i]) {
+			event_bus_unsubscribe(test_subs[i]);
+			test_subs[i] = NULL;
+		}
+	}
 	k_msgq_purge(&polling_test_q);
+	k_msgq_purge(&polling_test_q2);
 }
 
 ZTEST(event_bus_polling_suite, test_polling_subscribe_receive)
@@ -28,6 +38,7 @@ ZTEST(event_bus_polling_suite, test_polling_subscribe_receive)
 	const event_id_t events[] = { EVENT_APP_MESSAGE_SENT };
 	event_subscription_t* sub = event_bus_subscribe(&polling_test_q, events, ARRAY_SIZE(events));
 	zassert_not_null(sub, "Subscription failed");
+	test_subs[0] = sub;
 
 	const app_event_t event = { .id = EVENT_APP_MESSAGE_SENT, .payload.s32 = 123 };
 	zassert_ok(event_bus_post(&event), "Post failed");
@@ -39,7 +50,191 @@ ZTEST(event_bus_polling_suite, test_polling_subscribe_receive)
 	zassert_equal(rx_event.payload.s32, 123, "Incorrect payload received");
 }
 
-ZTEST_SUITE(event_bus_polling_suite, NULL, NULL, event_bus_polling_before, event_bus_polling_after, NULL);
+ZTEST(event_bus_polling_suite, test_polling_post_stamps_metadata)
+{
+	const event_id_t events[] = { EVENT_APP_MESSAGE_SENT };
+	test_subs[0] = event_bus_subscribe(&polling_test_q, events, ARRAY_SIZE(events));
+	zassert_not_null(test_subs[0], "Subscription failed");
+
+	// Whatever the publisher leaves in the metadata fields is overwritten.
+	const app_event_t event = { .id = EVENT_APP_MESSAGE_SENT, .sender_tid = NULL, .seq = 0xdead };
+	uint32_t before = k_cycle_get_32();
+	zassert_ok(event_bus_post(&event), "Post failed");
+	zassert_ok(event_bus_post(&event), "Post failed");
+
+	app_event_t first, second;
+	zassert_ok(k_msgq_get(&polling_test_q, &first, K_MSEC(100)), "First event not received");
+	zassert_ok(k_msgq_get(&polling_test_q, &second, K_MSEC(100)), "Second event not received");
+	uint32_t after = k_cycle_get_32();
+
+	zassert_equal(first.sender_tid, k_current_get(), "Sender not stamped");
+	zassert_equal(second.seq, first.seq + 1, "Sequence numbers not consecutive");
+	zassert_not_equal(first.seq, 0xdead, "Publisher seq not overwritten");
+	zassert_true(first.timestamp - before <= after - before, "Timestamp outside post window");
+	zassert_true(second.timestamp - first.timestamp <= after - before, "Timestamps out of order");
+	zassert_true(event_bus_event_age_cycles(&first) >= after - first.timestamp, "Age went backwards");
+}
+
+ZTEST(event_bus_polling_suite, test_polling_fan_out_only_to_matching)
+{
+	const event_id_t door_events[] = { EVENT_DOOR_OPENED, EVENT_DOOR_CLOSED };
+	const event_id_t msg_events[] = { EVENT_APP_MESSAGE_SENT, EVENT_DOOR_CLOSED };
+	test_subs[0] = event_bus_subscribe(&polling_test_q, door_events, ARRAY_SIZE(door_events));
+	test_subs[1] = event_bus_subscribe(&polling_test_q2, msg_events, ARRAY_SIZE(msg_events));
+	zassert_not_null(test_subs[0], "Subscription failed");
+	zassert_not_null(test_subs[1], "Subscription failed");
+
+	const app_event_t closed = { .id = EVENT_DOOR_CLOSED, .payload.s32 = 1 };
+	const app_event_t opened = { .id = EVENT_DOOR_OPENED, .payload.s32 = 2 };
+	zassert_ok(event_bus_post(&closed), "Post failed");
+	zassert_ok(event_bus_post(&opened), "Post failed");
+
+	app_event_t rx_event;
+	zassert_ok(k_msgq_get(&polling_test_q, &rx_event, K_MSEC(100)), "Missing first event");
+	zassert_equal(rx_event.id, EVENT_DOOR_CLOSED, "Events delivered out of order");
+	zassert_ok(k_msgq_get(&polling_test_q, &rx_event, K_MSEC(100)), "Missing second event");
+	zassert_equal(rx_event.id, EVENT_DOOR_OPENED, "Events delivered out of order");
+
+	zassert_ok(k_msgq_get(&polling_test_q2, &rx_event, K_MSEC(100)), "Shared event not fanned out");
+	zassert_equal(rx_event.id, EVENT_DOOR_CLOSED, "Incorrect event ID received");
+	zassert_not_ok(k_msgq_get(&polling_test_q2, &rx_event, K_MSEC(50)), "Unsubscribed event was delivered");
+}
+
+ZTEST(event_bus_polling_suite, test_polling_unsubscribe_stops_delivery)
+{
+	const event_id_t events[] = { EVENT_APP_MESSAGE_SENT };
+	event_subscription_t *sub = event_bus_subscribe(&polling_test_q, events, ARRAY_SIZE(events));
+	zassert_not_null(sub, "Subscription failed");
+	zassert_ok(event_bus_unsubscribe(sub), "Unsubscribe failed");
+
+	const app_event_t event = { .id = EVENT_APP_MESSAGE_SENT };
+	event_bus_post(&event);
+
+	app_event_t rx_event;
+	zassert_not_ok(k_msgq_get(&polling_test_q, &rx_event, K_MSEC(50)), "Event delivered after unsubscribe");
+}
+
+ZTEST(event_bus_polling_suite, test_polling_filter_drops_before_enqueue)
+{
+	const event_id_t events[] = { EVENT_HEATER_TEMP_CHANGED };
+	const event_filter_t filter = { .type = EVENT_FILTER_THRESHOLD_CROSSING, .threshold = { .level = 60 } };
+	const int32_t samples[] = { 20, 40, 59, 61, 70, 55 };
+
+	test_subs[0] = event_bus_subscribe_filtered(&polling_test_q, events, ARRAY_SIZE(events), &filter);
+	zassert_not_null(test_subs[0], "Subscription failed");
+
+	for (int i = 0; i < ARRAY_SIZE(samples); i++) {
+		const app_event_t event = { .id = EVENT_HEATER_TEMP_CHANGED, .payload.s32 = samples[i] };
+		zassert_ok(event_bus_post(&event), "Post failed");
+	}
+
+	app_event_t rx_event;
+	zassert_ok(k_msgq_get(&polling_test_q, &rx_event, K_MSEC(100)), "Upward crossing not delivered");
+	zassert_equal(rx_event.payload.s32, 61, "Incorrect sample delivered");
+	zassert_ok(k_msgq_get(&polling_test_q, &rx_event, K_MSEC(100)), "Downward crossing not delivered");
+	zassert_equal(rx_event.payload.s32, 55, "Incorrect sample delivered");
+	zassert_not_ok(k_msgq_get(&polling_test_q, &rx_event, K_MSEC(50)), "Filtered sample was delivered");
+}
+
+#define BLOCKED_POSTER_STACK_SIZE 1024
+K_THREAD_STACK_DEFINE(blocked_poster_stack, BLOCKED_POSTER_STACK_SIZE);
+static struct k_thread blocked_poster_thread;
+
+static void blocked_poster_entry(void *p1, void *p2, void *p3)
+{
+	ARG_UNUSED(p1); ARG_UNUSED(p2); ARG_UNUSED(p3);
+	const app_event_t event = { .id = EVENT_APP_MESSAGE_SENT };
+
+	// The subscriber queue is already full, so this fan-out blocks.
+	event_bus_post(&event);
+}
+
+// Fills polling_test_q and starts a fan-out that blocks on it.
+static void start_blocked_fan_out(void)
+{
+	const event_id_t events[] = { EVENT_APP_MESSAGE_SENT };
+	const app_event_t event = { .id = EVENT_APP_MESSAGE_SENT };
+
+	test_subs[0] = event_bus_subscribe(&polling_test_q, events, ARRAY_SIZE(events));
+	zassert_not_null(test_subs[0], "Subscription failed");
+	while (k_msgq_num_free_get(&polling_test_q) > 0) {
+		zassert_ok(event_bus_post(&event), "Post failed");
+		k_msleep(1);
+	}
+	k_thread_create(&blocked_poster_thread, blocked_poster_stack,
+			K_THREAD_STACK_SIZEOF(blocked_poster_stack),
+			blocked_poster_entry, NULL, NULL, NULL,
+			K_PRIO_PREEMPT(1), 0, K_NO_WAIT);
+	k_msleep(5);
+}
+
+ZTEST(event_bus_polling_suite, test_subscribe_not_stalled_by_blocked_fan_out)
+{
+	const event_id_t events[] = { EVENT_DOOR_OPENED };
+
+	start_blocked_fan_out();
+
+	int64_t start = k_uptime_get();
+	test_subs[1] = event_bus_subscribe(&polling_test_q2, events, ARRAY_SIZE(events));
+	int64_t elapsed = k_uptime_get() - start;
+
+	zassert_not_null(test_subs[1], "Subscription failed");
+	zassert_true(elapsed < 20, "Subscribe waited %lld ms for a blocked fan-out", elapsed);
+	k_thread_join(&blocked_poster_thread, K_FOREVER);
+}
+
+ZTEST(event_bus_polling_suite, test_unsubscribe_waits_for_in_flight_delivery)
+{
+	app_event_t rx_event;
+
+	start_blocked_fan_out();
+
+	zassert_ok(event_bus_unsubscribe(test_subs[0]), "Unsubscribe failed");
+	test_subs[0] = NULL;
+
+	// After unsubscribe returns, the queue no longer belongs to the bus.
+	k_msgq_purge(&polling_test_q);
+	zassert_not_ok(k_msgq_get(&polling_test_q, &rx_event, K_MSEC(150)),
+		       "Event delivered after unsubscribe returned");
+	k_thread_join(&blocked_poster_thread, K_FOREVER);
+}
+
+ZTEST(event_bus_polling_suite, test_polling_queue_sink_never_waits)
+{
+	const event_id_t events[] = { EVENT_APP_MESSAGE_SENT };
+	const app_event_t event = { .id = EVENT_APP_MESSAGE_SENT };
+	event_bus_sink_stats_t stats;
+	app_event_t rx_event;
+
+	zassert_equal(event_bus_get_sink_stats(&polling_test_q, &stats), -ENOENT);
+	zassert_ok(event_bus_register_queue_sink(&polling_test_q, events, ARRAY_SIZE(events), NULL),
+		   "Sink registration failed");
+
+	// Two more events than the queue holds: the fan-out drops them
+	// rather than blocking for SUBSCRIBER_PUT_TIMEOUT each.
+	int64_t start = k_uptime_get();
+
+	for (int i = 0; i < 6; i++) {
+		(void)event_bus_post(&event);
+		k_msleep(1);
+	}
+	int64_t elapsed = k_uptime_get() - start;
+
+	zassert_true(elapsed < 50, "Posting took %lld ms", elapsed);
+	zassert_ok(event_bus_get_sink_stats(&polling_test_q, &stats));
+	zassert_equal(stats.delivered, 4);
+	zassert_equal(stats.dropped, 2);
+	zassert_equal(stats.high_water, 4);
+
+	zassert_ok(event_bus_unregister_queue_sink(&polling_test_q));
+	zassert_equal(event_bus_unregister_queue_sink(&polling_test_q), -ENOENT);
+	k_msgq_purge(&polling_test_q);
+	zassert_ok(event_bus_post(&event));
+	zassert_not_ok(k_msgq_get(&polling_test_q, &rx_event, K_MSEC(20)),
+		       "Unregistered sink still fed");
+}
+
+ZTEST_SUITE(event_bus_polling_suite, NULL, event_bus_polling_setup, NULL, event_bus_polling_after, NULL);
 
 #endif // CONFIG_EVENT_BUS_USE_POLLING
 
@@ -57,12 +252,17 @@ static void test_callback_handler(const app_event_t *event)
 	k_sem_give(&test_sem);
 }
 
+static void *callback_suite_setup(void)
+{
+	// Initialize the bus once; it starts the callback work queue.
+	zassert_ok(event_bus_init(), "event_bus_init() failed");
+	return NULL;
+}
+
 static void callback_suite_before(void *data)
 {
 	ARG_UNUSED(data);
-	// Initialize the bus first
-	zassert_ok(event_bus_init(), "event_bus_init() failed");
-	// Then initialize test-specific resources
+	// Initialize test-specific resources
 	k_sem_init(&test_sem, 0, 1);
 	memset(&received_event_storage, 0, sizeof(app_event_t));
 }
@@ -82,8 +282,187 @@ ZTEST(event_bus_callback_suite, test_callback_invoked)
 	zassert_equal(received_event_storage.payload.s32, 456, "Incorrect payload in callback");
 }
 
-// THE FIX: The ZTEST_SUITE macro uses the setup function in the correct
-// 'test_before' slot (the 4th parameter) which expects the void (*)(void *) signature.
-ZTEST_SUITE(event_bus_callback_suite, NULL, NULL, callback_suite_before, NULL, NULL);
+ZTEST(event_bus_callback_suite, test_callback_event_is_stamped)
+{
+	const event_id_t events[] = { EVENT_DOOR_OPENED };
+	zassert_ok(event_bus_register_handler(test_callback_handler, events, ARRAY_SIZE(events)), "Handler registration failed");
+
+	const app_event_t event = { .id = EVENT_DOOR_OPENED };
+	zassert_ok(event_bus_post(&event), "Post failed");
+	zassert_ok(k_sem_take(&test_sem, K_MSEC(500)), "Callback was not invoked");
+
+	zassert_equal(received_event_storage.sender_tid, k_current_get(), "Sender not stamped");
+	zassert_not_equal(received_event_storage.seq, 0, "Sequence number not stamped");
+}
+
+static atomic_t filtered_callback_count;
+
+static void filtered_callback_handler(const app_event_t *event)
+{
+	ARG_UNUSED(event);
+	atomic_inc(&filtered_callback_count);
+}
+
+ZTEST(event_bus_callback_suite, test_filtered_callback_skips_rejected_payloads)
+{
+	const event_id_t events[] = { EVENT_MOTOR_SPEED_REPORT };
+	const event_filter_t filter = { .type = EVENT_FILTER_RANGE, .range = { .min = 1000, .max = 1400 } };
+	const int32_t rpm_samples[] = { 200, 1000, 1200, 1600, 1400 };
+
+	atomic_set(&filtered_callback_count, 0);
+	zassert_ok(event_bus_register_handler_filtered(filtered_callback_handler, events,
+						       ARRAY_SIZE(events), &filter),
+		   "Handler registration failed");
+
+	for (int i = 0; i < ARRAY_SIZE(rpm_samples); i++) {
+		const app_event_t event = { .id = EVENT_MOTOR_SPEED_REPORT, .payload.s32 = rpm_samples[i] };
+		zassert_ok(event_bus_post(&event), "Post failed");
+		k_msleep(10);
+	}
+
+	zassert_equal(atomic_get(&filtered_callback_count), 3, "Expected only in-range samples");
+}
+
+K_MSGQ_DEFINE(sink_test_q, sizeof(app_event_t), 2, 4);
+K_MSGQ_DEFINE(sink_filter_q, sizeof(app_event_t), 4, 4);
+
+ZTEST(event_bus_callback_suite, test_queue_sink_receives_in_post)
+{
+	const event_id_t events[] = { EVENT_DOOR_CLOSED };
+	event_bus_sink_stats_t stats;
+	app_event_t rx_event;
+
+	zassert_ok(event_bus_register_queue_sink(&sink_test_q, events, ARRAY_SIZE(events), NULL),
+		   "Sink registration failed");
+
+	const app_event_t event = { .id = EVENT_DOOR_CLOSED, .payload.s32 = 789 };
+	zassert_ok(event_bus_post(&event), "Post failed");
+
+	// No work item in between: the event is queued when the post returns.
+	zassert_ok(k_msgq_get(&sink_test_q, &rx_event, K_NO_WAIT), "Event not in the sink queue");
+	zassert_equal(rx_event.payload.s32, 789, "Incorrect payload received");
+	zassert_equal(rx_event.sender_tid, k_current_get(), "Sender not stamped");
+
+	// A full queue is reported to the poster and counted, never waited on.
+	zassert_ok(event_bus_post(&event));
+	zassert_ok(event_bus_post(&event));
+	zassert_equal(event_bus_post(&event), -ENOBUFS, "Full sink not reported");
+
+	zassert_ok(event_bus_get_sink_stats(&sink_test_q, &stats));
+	zassert_equal(stats.delivered, 3);
+	zassert_equal(stats.dropped, 1);
+	zassert_equal(stats.high_water, 2);
+	zassert_ok(event_bus_unregister_queue_sink(&sink_test_q));
+	k_msgq_purge(&sink_test_q);
+}
+
+ZTEST(event_bus_callback_suite, test_queue_sink_filter_and_bad_arguments)
+{
+	const event_id_t events[] = { EVENT_HEATER_TEMP_CHANGED };
+	const event_filter_t filter = { .type = EVENT_FILTER_RANGE, .range = { .min = 40, .max = 60 } };
+	const event_filter_t bad_filter = { .type = EVENT_FILTER_EVERY_NTH, .every_nth = { .n = 0 } };
+	const int32_t temps[] = { 20, 40, 50, 70 };
+
+	zassert_equal(event_bus_register_queue_sink(NULL, events, 1, NULL), -EINVAL);
+	zassert_equal(event_bus_register_queue_sink(&sink_filter_q, events, 0, NULL), -EINVAL);
+	zassert_equal(event_bus_register_queue_sink(&sink_filter_q, events, 1, &bad_filter), -EINVAL);
+	zassert_equal(event_bus_get_sink_stats(&sink_filter_q, NULL), -ENOENT);
+
+	zassert_ok(event_bus_register_queue_sink(&sink_filter_q, events, ARRAY_SIZE(events), &filter));
+	for (int i = 0; i < ARRAY_SIZE(temps); i++) {
+		const app_event_t event = { .id = EVENT_HEATER_TEMP_CHANGED, .payload.s32 = temps[i] };
+		zassert_ok(event_bus_post(&event), "Post failed");
+	}
+	zassert_equal(k_msgq_num_used_get(&sink_filter_q), 2, "Expected only in-range samples");
+	zassert_ok(event_bus_unregister_queue_sink(&sink_filter_q));
+	k_msgq_purge(&sink_filter_q);
+}
+
+// One queue per sink slot and one more
+#define SINK_SLOT_QUEUES (CONFIG_EVENT_BUS_MAX_QUEUE_SINKS + 1)
+static struct k_msgq sink_slot_q[SINK_SLOT_QUEUES];
+static char __aligned(4) sink_slot_buf[SINK_SLOT_QUEUES][2 * sizeof(app_event_t)];
+
+ZTEST(event_bus_callback_suite, test_queue_sink_unregister_frees_the_slot)
+{
+	const int last = SINK_SLOT_QUEUES - 1;
+	const event_id_t events[] = { EVENT_DRUM_EMPTY };
+	const app_event_t event = { .id = EVENT_DRUM_EMPTY };
+
+	for (int i = 0; i < SINK_SLOT_QUEUES; i++) {
+		k_msgq_init(&sink_slot_q[i], sink_slot_buf[i], sizeof(app_event_t), 2);
+	}
+	for (int i = 0; i < last; i++) {
+		zassert_ok(event_bus_register_queue_sink(&sink_slot_q[i], events, 1, NULL), "sink %d", i);
+	}
+	zassert_equal(event_bus_register_queue_sink(&sink_slot_q[last], events, 1, NULL), -ENOMEM);
+
+	zassert_ok(event_bus_unregister_queue_sink(&sink_slot_q[1]));
+	zassert_equal(event_bus_unregister_queue_sink(&sink_slot_q[1]), -ENOENT);
+	zassert_equal(event_bus_get_sink_stats(&sink_slot_q[1], NULL), -ENOENT);
+	zassert_ok(event_bus_register_queue_sink(&sink_slot_q[last], events, 1, NULL));
+
+	zassert_ok(event_bus_post(&event));
+	zassert_equal(k_msgq_num_used_get(&sink_slot_q[1]), 0, "Unregistered sink still fed");
+	zassert_equal(k_msgq_num_used_get(&sink_slot_q[last]), 1, "Sink in the freed slot not fed");
+
+	// Re-initializing the bus frees every slot.
+	zassert_ok(event_bus_init());
+	zassert_equal(event_bus_get_sink_stats(&sink_slot_q[0], NULL), -ENOENT);
+	for (int i = 0; i < last; i++) {
+		zassert_ok(event_bus_register_queue_sink(&sink_slot_q[i], events, 1, NULL), "sink %d", i);
+		zassert_ok(event_bus_unregister_queue_sink(&sink_slot_q[i]));
+		k_msgq_purge(&sink_slot_q[i]);
+	}
+	k_msgq_purge(&sink_slot_q[last]);
+}
+
+K_MSGQ_DEFINE(sink_race_q, sizeof(app_event_t), 8, 4);
+
+#define SINK_POSTER_STACK_SIZE 1024
+K_THREAD_STACK_DEFINE(sink_poster_stack, SINK_POSTER_STACK_SIZE);
+static struct k_thread sink_poster_thread;
+static atomic_t sink_poster_stop;
+
+static void sink_poster_entry(void *p1, void *p2, void *p3)
+{
+	ARG_UNUSED(p1); ARG_UNUSED(p2); ARG_UNUSED(p3);
+	const app_event_t event = { .id = EVENT_DOOR_LOCKED };
+
+	while (!atomic_get(&sink_poster_stop)) {
+		event_bus_post(&event);
+		k_yield();
+	}
+}
+
+ZTEST(event_bus_callback_suite, test_queue_sink_unregister_waits_for_posts)
+{
+	const event_id_t events[] = { EVENT_DOOR_LOCKED };
+
+	atomic_set(&sink_poster_stop, 0);
+	k_thread_create(&sink_poster_thread, sink_poster_stack,
+			K_THREAD_STACK_SIZEOF(sink_poster_stack),
+			sink_poster_entry, NULL, NULL, NULL,
+			k_thread_priority_get(k_current_get()), 0, K_NO_WAIT);
+
+	for (int round = 0; round < 200; round++) {
+		zassert_ok(event_bus_register_queue_sink(&sink_race_q, events, 1, NULL));
+		k_yield();
+		zassert_ok(event_bus_unregister_queue_sink(&sink_race_q));
+
+		// Once unregister returns, the queue no longer belongs to the bus.
+		k_msgq_purge(&sink_race_q);
+		k_yield();
+		zassert_equal(k_msgq_num_used_get(&sink_race_q), 0,
+			      "Event put after unregister returned (round %d)", round);
+	}
+
+	atomic_set(&sink_poster_stop, 1);
+	k_thread_join(&sink_poster_thread, K_FOREVER);
+}
+
+// The bus is initialized once in the suite setup slot (3rd parameter); per-test
+// resources are reset in the 'test_before' slot (4th parameter).
+ZTEST_SUITE(event_bus_callback_suite, NULL, callback_suite_setup, callback_suite_before, NULL, NULL);
 
 #endif // CONFIG_EVENT_BUS_USE_CALLBACK
\ No newline at end of file
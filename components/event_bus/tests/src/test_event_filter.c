@@ -0,0 +1,76 @@
+#include <zephyr/ztest.h>
+#include "../../include/event_filter.h"
+
+static event_filter_state_t state;
+
+static bool feed(int32_t value)
+{
+	const event_payload_t payload = { .s32 = value };
+	return event_filter_match(&state, &payload);
+}
+
+ZTEST(event_filter_suite, test_no_filter_passes_everything)
+{
+	event_filter_state_init(&state, NULL);
+	zassert_true(feed(0), "Unfiltered event was dropped");
+	zassert_true(feed(-5), "Unfiltered event was dropped");
+}
+
+ZTEST(event_filter_suite, test_range)
+{
+	const event_filter_t filter = { .type = EVENT_FILTER_RANGE, .range = { .min = 10, .max = 20 } };
+
+	event_filter_state_init(&state, &filter);
+	zassert_false(feed(9), "Value below range passed");
+	zassert_true(feed(10), "Lower bound should be inclusive");
+	zassert_true(feed(20), "Upper bound should be inclusive");
+	zassert_false(feed(21), "Value above range passed");
+}
+
+ZTEST(event_filter_suite, test_threshold_crossing)
+{
+	const event_filter_t filter = { .type = EVENT_FILTER_THRESHOLD_CROSSING, .threshold = { .level = 60 } };
+
+	event_filter_state_init(&state, &filter);
+	zassert_false(feed(20), "First sample only primes the filter");
+	zassert_false(feed(40), "No crossing yet");
+	zassert_true(feed(60), "Upward crossing missed");
+	zassert_false(feed(65), "Staying above should not pass");
+	zassert_true(feed(59), "Downward crossing missed");
+}
+
+ZTEST(event_filter_suite, test_delta)
+{
+	const event_filter_t filter = { .type = EVENT_FILTER_DELTA, .delta = { .min_change = 5 } };
+
+	event_filter_state_init(&state, &filter);
+	zassert_true(feed(100), "First sample is the baseline");
+	zassert_false(feed(104), "Change below delta passed");
+	zassert_true(feed(105), "Change of exactly delta missed");
+	zassert_false(feed(101), "Change is measured from the last delivered value");
+	zassert_true(feed(99), "Negative change missed");
+}
+
+ZTEST(event_filter_suite, test_every_nth)
+{
+	const event_filter_t filter = { .type = EVENT_FILTER_EVERY_NTH, .every_nth = { .n = 3 } };
+	int passed = 0;
+
+	event_filter_state_init(&state, &filter);
+	for (int i = 0; i < 9; i++) {
+		passed += feed(i) ? 1 : 0;
+	}
+	zassert_equal(passed, 3, "Expected every third event to pass");
+}
+
+ZTEST(event_filter_suite, test_invalid_filters_rejected)
+{
+	const event_filter_t bad_range = { .type = EVENT_FILTER_RANGE, .range = { .min = 5, .max = 1 } };
+	const event_filter_t bad_nth = { .type = EVENT_FILTER_EVERY_NTH, .every_nth = { .n = 0 } };
+
+	zassert_equal(event_filter_validate(&bad_range), -EINVAL, "Inverted range accepted");
+	zassert_equal(event_filter_validate(&bad_nth), -EINVAL, "n == 0 accepted");
+	zassert_ok(event_filter_validate(NULL), "NULL filter means no filter");
+}
+
+ZTEST_SUITE(event_filter_suite, NULL, NULL, NULL, NULL, NULL);
@@ -0,0 +1,108 @@
+#include <zephyr/ztest.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/storage/flash_map.h>
+#include "event_bus.h"
+#include "event_journal.h"
+
+LOG_MODULE_REGISTER(bench_event_journal, CONFIG_LOG_DEFAULT_LEVEL);
+
+#define JOURNAL_PARTITION FIXED_PARTITION_ID(scratch_partition)
+#define RECORD_SIZE 16
+#define APPEND_ITERATIONS 4096
+// Flush before the intake queue can overflow, so nothing is dropped.
+#define FLUSH_EVERY (CONFIG_EVENT_JOURNAL_QUEUE_DEPTH / 2)
+
+static uint32_t sector_size;
+static uint32_t sector_count;
+
+static void *bench_setup(void)
+{
+	static struct flash_sector sectors[CONFIG_EVENT_JOURNAL_MAX_SECTORS];
+	const event_id_t events[] = { EVENT_UI_CYCLE_SELECTED };
+
+	sector_count = ARRAY_SIZE(sectors);
+	zassert_ok(flash_area_get_sectors(JOURNAL_PARTITION, &sector_count, sectors),
+		   "Cannot read the partition layout");
+	sector_size = sectors[0].fs_size;
+
+	zassert_ok(event_bus_init(), "event_bus_init() failed");
+	zassert_ok(event_journal_init(JOURNAL_PARTITION, events, ARRAY_SIZE(events)),
+		   "event_journal_init() failed");
+	return NULL;
+}
+
+static void fill_journal(uint32_t records)
+{
+	for (uint32_t i = 0; i < records; i++) {
+		const app_event_t event = { .id = EVENT_UI_CYCLE_SELECTED, .payload.u32 = i };
+
+		zassert_ok(event_journal_append(&event), "Append failed");
+		if (i % FLUSH_EVERY == FLUSH_EVERY - 1) {
+			zassert_ok(event_journal_flush(), "Flush failed");
+		}
+	}
+	zassert_ok(event_journal_flush(), "Flush failed");
+}
+
+/**
+ * @brief Sustained append rate, from the first append until the last
+ * record is on flash.
+ */
+ZTEST(event_journal_bench_suite, test_sustained_append_rate)
+{
+	event_journal_stats_t before, after;
+
+	zassert_ok(event_journal_erase(), "Erase failed");
+	event_journal_get_stats(&before);
+
+	uint32_t start = k_cycle_get_32();
+	fill_journal(APPEND_ITERATIONS);
+	uint32_t cycles = k_cycle_get_32() - start;
+
+	event_journal_get_stats(&after);
+	uint64_t ns = k_cyc_to_ns_floor64(cycles);
+	uint32_t writes = after.flash_writes - before.flash_writes;
+
+	TC_PRINT("batch size: %d, records: %d\n", CONFIG_EVENT_JOURNAL_BATCH_SIZE,
+		 APPEND_ITERATIONS);
+	TC_PRINT("  ns/record:          %u\n", (uint32_t)(ns / APPEND_ITERATIONS));
+	TC_PRINT("  records/s:          %u\n",
+		 (uint32_t)(ns ? APPEND_ITERATIONS * 1000000000ULL / ns : 0));
+	TC_PRINT("  flash writes:       %u\n", writes);
+	TC_PRINT("  sector rotations:   %u\n", after.sectors_erased - before.sectors_erased);
+	TC_PRINT("  dropped:            %u\n", after.dropped - before.dropped);
+	zassert_equal(after.appended - before.appended, APPEND_ITERATIONS, "Records lost");
+}
+
+/**
+ * @brief Recovery time against the amount of data in the journal.
+ *
+ * Recovery reads one header per sector and then only the newest sector,
+ * so the time should stay flat as the journal grows.
+ */
+ZTEST(event_journal_bench_suite, test_recovery_time_vs_size)
+{
+	const uint32_t sizes[] = { 1, 4, 16, sector_count - 2 };
+	const uint32_t records_per_sector = sector_size / RECORD_SIZE;
+
+	TC_PRINT("sector size: %u, sectors: %u\n", sector_size, sector_count);
+	for (int i = 0; i < ARRAY_SIZE(sizes); i++) {
+		event_journal_stats_t stats;
+
+		if (sizes[i] == 0 || sizes[i] >= sector_count) continue;
+
+		zassert_ok(event_journal_erase(), "Erase failed");
+		fill_journal(sizes[i] * records_per_sector);
+
+		uint32_t start = k_cycle_get_32();
+		zassert_ok(event_journal_recover(), "Recovery failed");
+		uint32_t cycles = k_cycle_get_32() - start;
+
+		event_journal_get_stats(&stats);
+		TC_PRINT("  %2u sectors written: recovery %u us, %u records replayed\n",
+			 sizes[i], (uint32_t)(k_cyc_to_ns_floor64(cycles) / 1000), stats.recovered);
+	}
+}
+
+ZTEST_SUITE(event_journal_bench_suite, NULL, bench_setup, NULL, NULL, NULL);
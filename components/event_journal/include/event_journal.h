@@ -0,0 +1,89 @@
+#pragma once
+
+#include "event_defs.h"
+#include <zephyr/kernel.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @brief Journal counters, see event_journal_get_stats().
+ */
+typedef struct {
+    uint32_t appended;       // Records written to flash
+    uint32_t dropped;        // Events lost because the intake queue was full, bus drops included
+    uint32_t flash_writes;   // Batched flash_area_write() calls
+    uint32_t sectors_erased; // Sector rotations, each writes a new checkpoint
+    uint32_t recovered;      // Records replayed by the last recovery scan
+} event_journal_stats_t;
+
+/**
+ * @brief Opens the journal, recovers its state and starts journaling.
+ *
+ * Recovery only reads the newest sector: every sector starts with a
+ * checkpoint of the latest record per event ID, so older sectors are never
+ * needed to rebuild the state. The journal then subscribes to @p events on
+ * the event bus, which must already be initialized.
+ *
+ * @param flash_area_id Partition to use, e.g. FIXED_PARTITION_ID(scratch_partition).
+ * @param events Event IDs to journal.
+ * @param num_events Number of entries in @p events.
+ * @return 0 on success, or a negative error code on failure.
+ */
+int event_journal_init(uint8_t flash_area_id, const event_id_t *events, size_t num_events);
+
+/**
+ * @brief Queues an event for journaling without blocking.
+ *
+ * For events from outside the bus; bus events reach the queue through a
+ * queue sink, which drops and counts the same way. It is ISR safe.
+ *
+ * @return 0 on success, -ENOSPC if the intake queue is full (the event is
+ *         dropped and counted), -EINVAL for an invalid event.
+ */
+int event_journal_append(const app_event_t *event);
+
+/**
+ * @brief Writes everything queued so far to flash before returning.
+ */
+int event_journal_flush(void);
+
+/**
+ * @brief Starts a new sector, checkpointing the current state.
+ *
+ * Rotation happens on its own whenever a sector fills up; this forces it,
+ * for instance before an expected power-down, so the next recovery reads
+ * nothing but the checkpoint.
+ */
+int event_journal_checkpoint(void);
+
+/**
+ * @brief Returns the most recent journaled event with the given ID.
+ *
+ * @c sender_tid is always NULL, it has no meaning across a reboot.
+ *
+ * @return 0 on success, -ENOENT if the event was never journaled.
+ */
+int event_journal_get_latest(event_id_t id, app_event_t *event);
+
+/**
+ * @brief Rebuilds the in-RAM state from flash, discarding the current one.
+ *
+ * Called by event_journal_init(). Exposed so tests and benchmarks can
+ * simulate a reboot.
+ */
+int event_journal_recover(void);
+
+/**
+ * @brief Erases the whole journal and starts an empty one.
+ *
+ * Events queued before the call are dropped along with the journal;
+ * events appended after it go to the new one.
+ *
+ * @return 0 on success, -ENODEV before init, or a flash error code.
+ */
+int event_journal_erase(void);
+
+/**
+ * @brief Copies the journal counters.
+ */
+void event_journal_get_stats(event_journal_stats_t *stats);
@@ -0,0 +1,504 @@
+#include "event_journal.h"
+#include "event_bus.h"
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/storage/flash_map.h>
+#include <zephyr/sys/crc.h>
+#include <string.h>
+
+LOG_MODULE_REGISTER(event_journal, CONFIG_LOG_DEFAULT_LEVEL);
+
+#define JOURNAL_MAGIC 0x4c4e4a45 // "EJNL"
+#define JOURNAL_VERSION 1
+#define JOURNAL_READ_CHUNK 16    // Records read per flash access during recovery
+
+enum {
+    RECORD_SECTOR_HEADER = 0x01,
+    RECORD_CHECKPOINT = 0x02,
+    RECORD_EVENT = 0x03,
+};
+
+// Every item on flash is one 16 byte record. A sector starts with a header
+// record, followed by the checkpoint records and then the event records.
+// The header reuses the fields: id is the format version, seq the sector
+// sequence number, timestamp the magic and payload the checkpoint size.
+typedef struct {
+    uint8_t type;
+    uint8_t id;
+    uint16_t crc;       // CRC16-CCITT over the other 14 bytes
+    uint32_t seq;
+    uint32_t timestamp;
+    uint32_t payload;
+} journal_record_t;
+
+BUILD_ASSERT(sizeof(journal_record_t) == 16, "Journal records must be 16 bytes");
+BUILD_ASSERT(EVENT_ID_COUNT < UINT8_MAX, "Event IDs must fit in a journal record");
+
+// Control requests travel through the intake queue behind the events they
+// must follow, marked with this otherwise invalid event ID.
+#define JOURNAL_REQUEST_ID EVENT_ID_COUNT
+enum {
+    JOURNAL_REQUEST_FLUSH,
+    JOURNAL_REQUEST_CHECKPOINT,
+    JOURNAL_REQUEST_ERASE,
+};
+
+K_MSGQ_DEFINE(journal_q, sizeof(app_event_t), CONFIG_EVENT_JOURNAL_QUEUE_DEPTH, 4);
+K_THREAD_STACK_DEFINE(journal_stack_area, CONFIG_EVENT_JOURNAL_THREAD_STACK_SIZE);
+static struct k_thread journal_thread_data;
+static k_tid_t journal_tid;
+
+// journal_lock protects everything below it. request_lock serializes the
+// callers of journal_request().
+static K_MUTEX_DEFINE(request_lock);
+static K_SEM_DEFINE(request_done, 0, 1);
+static int request_result;
+
+static K_MUTEX_DEFINE(journal_lock);
+static const struct flash_area *journal_fa;
+static struct flash_sector journal_sectors[CONFIG_EVENT_JOURNAL_MAX_SECTORS];
+static size_t sector_size;
+static uint32_t sector_count;
+static uint32_t current_sector;
+static uint32_t sector_seq;
+static size_t write_offset;     // Next free byte in the current sector
+
+static journal_record_t latest[EVENT_ID_COUNT];
+static bool latest_valid[EVENT_ID_COUNT];
+
+static journal_record_t batch[CONFIG_EVENT_JOURNAL_BATCH_SIZE];
+static size_t batch_len;
+static int64_t batch_deadline;
+
+static journal_record_t scratch[MAX(EVENT_ID_COUNT, JOURNAL_READ_CHUNK)];
+
+static event_journal_stats_t stats;
+static atomic_t dropped;
+
+static uint16_t record_crc(const journal_record_t *rec)
+{
+    const uint8_t *bytes = (const uint8_t *)rec;
+    const size_t tail = offsetof(journal_record_t, seq);
+    uint16_t crc = crc16_ccitt(0xffff, bytes, offsetof(journal_record_t, crc));
+
+    return crc16_ccitt(crc, bytes + tail, sizeof(*rec) - tail);
+}
+
+static bool record_valid(const journal_record_t *rec)
+{
+    return rec->crc == record_crc(rec);
+}
+
+static bool record_erased(const journal_record_t *rec)
+{
+    const uint8_t *bytes = (const uint8_t *)rec;
+    uint8_t erased = flash_area_erased_val(journal_fa);
+
+    for (size_t i = 0; i < sizeof(*rec); i++) {
+        if (bytes[i] != erased) return false;
+    }
+    return true;
+}
+
+static bool record_is_header(const journal_record_t *rec)
+{
+    return rec->type == RECORD_SECTOR_HEADER && rec->id == JOURNAL_VERSION &&
+           rec->timestamp == JOURNAL_MAGIC && record_valid(rec);
+}
+
+static inline off_t sector_offset(uint32_t sector)
+{
+    return (off_t)sector * sector_size;
+}
+
+static void latest_reset(void)
+{
+    memset(latest_valid, 0, sizeof(latest_valid));
+}
+
+static void latest_apply(const journal_record_t *rec)
+{
+    latest[rec->id] = *rec;
+    latest_valid[rec->id] = true;
+}
+
+// Moves to the next sector: erase it, write the checkpoint, then the header.
+// The header goes last, so any sector with a valid header also holds a
+// complete checkpoint. A rotation torn by power loss leaves the previous
+// sector as the newest valid one. Reusing the oldest sector this way is
+// also the journal's compaction: its records are covered by the checkpoint.
+static int journal_rotate(void)
+{
+    uint32_t next = (current_sector + 1) % sector_count;
+    size_t checkpoint_len = 0;
+    int ret;
+
+    ret = flash_area_erase(journal_fa, sector_offset(next), sector_size);
+    if (ret) return ret;
+    stats.sectors_erased++;
+
+    for (int id = 0; id < EVENT_ID_COUNT; id++) {
+        if (!latest_valid[id]) continue;
+        scratch[checkpoint_len] = latest[id];
+        scratch[checkpoint_len].type = RECORD_CHECKPOINT;
+        scratch[checkpoint_len].crc = record_crc(&scratch[checkpoint_len]);
+        checkpoint_len++;
+    }
+    if (checkpoint_len > 0) {
+        ret = flash_area_write(journal_fa, sector_offset(next) + sizeof(journal_record_t),
+                               scratch, checkpoint_len * sizeof(journal_record_t));
+        if (ret) return ret;
+    }
+
+    journal_record_t header = {
+        .type = RECORD_SECTOR_HEADER,
+        .id = JOURNAL_VERSION,
+        .seq = sector_seq + 1,
+        .timestamp = JOURNAL_MAGIC,
+        .payload = checkpoint_len,
+    };
+    header.crc = record_crc(&header);
+    ret = flash_area_write(journal_fa, sector_offset(next), &header, sizeof(header));
+    if (ret) return ret;
+
+    current_sector = next;
+    sector_seq++;
+    write_offset = (checkpoint_len + 1) * sizeof(journal_record_t);
+    return 0;
+}
+
+static int journal_write_records(const journal_record_t *recs, size_t count)
+{
+    while (count > 0) {
+        size_t room = (sector_size - write_offset) / sizeof(journal_record_t);
+        int ret;
+
+        if (room == 0) {
+            ret = journal_rotate();
+            if (ret) return ret;
+            continue;
+        }
+        size_t n = MIN(room, count);
+        ret = flash_area_write(journal_fa, sector_offset(current_sector) + write_offset,
+                               recs, n * sizeof(journal_record_t));
+        if (ret) return ret;
+        stats.flash_writes++;
+        stats.appended += n;
+        for (size_t i = 0; i < n; i++) {
+            latest_apply(&recs[i]);
+        }
+        write_offset += n * sizeof(journal_record_t);
+        recs += n;
+        count -= n;
+    }
+    return 0;
+}
+
+static int journal_flush_batch(void)
+{
+    if (batch_len == 0) return 0;
+
+    int ret = journal_write_records(batch, batch_len);
+    if (ret) {
+        LOG_ERR("Failed to write %zu journal records (%d)", batch_len, ret);
+    }
+    batch_len = 0;
+    return ret;
+}
+
+// Drops the batch and everything on flash and starts an empty journal.
+static int journal_erase(void)
+{
+    int ret;
+
+    batch_len = 0;
+    latest_reset();
+    ret = flash_area_erase(journal_fa, 0, sector_count * sector_size);
+    if (ret) return ret;
+    current_sector = sector_count - 1;
+    sector_seq = 0;
+    return journal_rotate();
+}
+
+static void journal_process(const app_event_t *event)
+{
+    if (event->id == JOURNAL_REQUEST_ID) {
+        if (event->payload.u32 == JOURNAL_REQUEST_ERASE) {
+            request_result = journal_erase();
+        } else {
+            request_result = journal_flush_batch();
+        }
+        if (request_result == 0 && event->payload.u32 == JOURNAL_REQUEST_CHECKPOINT) {
+            request_result = journal_rotate();
+        }
+        k_sem_give(&request_done);
+        return;
+    }
+
+    journal_record_t *rec = &batch[batch_len++];
+    rec->type = RECORD_EVENT;
+    rec->id = event->id;
+    rec->seq = event->seq;
+    rec->timestamp = event->timestamp;
+    rec->payload = event->payload.u32;
+    rec->crc = record_crc(rec);
+
+    if (batch_len == 1) {
+        batch_deadline = k_uptime_get() + CONFIG_EVENT_JOURNAL_FLUSH_INTERVAL_MS;
+    }
+    if (batch_len == ARRAY_SIZE(batch) || k_uptime_get() >= batch_deadline) {
+        journal_flush_batch();
+    }
+}
+
+static void journal_thread(void *p1, void *p2, void *p3)
+{
+    ARG_UNUSED(p1); ARG_UNUSED(p2); ARG_UNUSED(p3);
+    app_event_t event;
+
+    while (1) {
+        k_timeout_t timeout = K_FOREVER;
+
+        k_mutex_lock(&journal_lock, K_FOREVER);
+        if (batch_len > 0) {
+            timeout = K_MSEC(MAX(batch_deadline - k_uptime_get(), 0));
+        }
+        k_mutex_unlock(&journal_lock);
+
+        int ret = k_msgq_get(&journal_q, &event, timeout);
+
+        k_mutex_lock(&journal_lock, K_FOREVER);
+        if (ret == 0) {
+            journal_process(&event);
+        } else {
+            // The oldest record in the batch has waited long enough.
+            journal_flush_batch();
+        }
+        k_mutex_unlock(&journal_lock);
+    }
+}
+
+// Queues a control request behind everything already queued and waits for
+// the journal thread to carry it out.
+static int journal_request(uint32_t request)
+{
+    const app_event_t marker = { .id = JOURNAL_REQUEST_ID, .payload.u32 = request };
+    int ret;
+
+    if (!journal_tid) return -ENODEV;
+
+    k_mutex_lock(&request_lock, K_FOREVER);
+    ret = k_msgq_put(&journal_q, &marker, K_FOREVER);
+    if (ret == 0) {
+        k_sem_take(&request_done, K_FOREVER);
+        ret = request_result;
+    }
+    k_mutex_unlock(&request_lock);
+    return ret;
+}
+
+// Replays the newest sector. Called with journal_lock held.
+static int journal_recover_locked(void)
+{
+    journal_record_t header;
+    bool found = false;
+    uint32_t newest = 0;
+    uint32_t newest_seq = 0;
+    int ret;
+
+    latest_reset();
+    batch_len = 0;
+    stats.recovered = 0;
+
+    for (uint32_t s = 0; s < sector_count; s++) {
+        ret = flash_area_read(journal_fa, sector_offset(s), &header, sizeof(header));
+        if (ret) return ret;
+        if (!record_is_header(&header)) continue;
+        if (!found || (int32_t)(header.seq - newest_seq) > 0) {
+            found = true;
+            newest = s;
+            newest_seq = header.seq;
+        }
+    }
+
+    if (!found) {
+        LOG_INF("No journal found, starting a new one");
+        current_sector = sector_count - 1;
+        sector_seq = 0;
+        return journal_rotate();
+    }
+
+    current_sector = newest;
+    sector_seq = newest_seq;
+    // If the sector turns out to be full, the next write rotates.
+    write_offset = sector_size;
+
+    size_t off = sizeof(journal_record_t);
+    while (off < sector_size) {
+        size_t n = MIN(ARRAY_SIZE(scratch), (sector_size - off) / sizeof(journal_record_t));
+
+        ret = flash_area_read(journal_fa, sector_offset(newest) + off, scratch,
+                              n * sizeof(journal_record_t));
+        if (ret) return ret;
+
+        for (size_t i = 0; i < n; i++, off += sizeof(journal_record_t)) {
+            const journal_record_t *rec = &scratch[i];
+
+            if (record_erased(rec)) {
+                write_offset = off;
+                goto done;
+            }
+            if (!record_valid(rec) || rec->id >= EVENT_ID_COUNT ||
+                (rec->type != RECORD_CHECKPOINT && rec->type != RECORD_EVENT)) {
+                // Torn write. The rest of the sector may be partially
+                // programmed, so leave it alone and rotate on the next write.
+                LOG_WRN("Corrupt journal record in sector %u at offset %zu", newest, off);
+                goto done;
+            }
+            latest_apply(rec);
+            stats.recovered++;
+        }
+    }
+
+done:
+    LOG_INF("Recovered %u journal records from sector %u (seq %u)",
+            stats.recovered, newest, newest_seq);
+    return 0;
+}
+
+int event_journal_recover(void)
+{
+    if (!journal_fa) return -ENODEV;
+
+    k_mutex_lock(&journal_lock, K_FOREVER);
+    int ret = journal_recover_locked();
+    k_mutex_unlock(&journal_lock);
+    return ret;
+}
+
+int event_journal_erase(void)
+{
+    // On the journal thread, so an event it has already taken from the
+    // queue cannot be written after the erase.
+    return journal_request(JOURNAL_REQUEST_ERASE);
+}
+
+int event_journal_append(const app_event_t *event)
+{
+    if (!event || event->id >= EVENT_ID_COUNT) return -EINVAL;
+
+    if (k_msgq_put(&journal_q, event, K_NO_WAIT) != 0) {
+        atomic_inc(&dropped);
+        return -ENOSPC;
+    }
+    return 0;
+}
+
+int event_journal_flush(void)
+{
+    return journal_request(JOURNAL_REQUEST_FLUSH);
+}
+
+int event_journal_checkpoint(void)
+{
+    return journal_request(JOURNAL_REQUEST_CHECKPOINT);
+}
+
+int event_journal_get_latest(event_id_t id, app_event_t *event)
+{
+    int ret = 0;
+
+    if (!event || id >= EVENT_ID_COUNT) return -EINVAL;
+
+    k_mutex_lock(&journal_lock, K_FOREVER);
+    if (!latest_valid[id]) {
+        ret = -ENOENT;
+    } else {
+        memset(event, 0, sizeof(*event));
+        event->id = id;
+        event->seq = latest[id].seq;
+        event->timestamp = latest[id].timestamp;
+        event->payload.u32 = latest[id].payload;
+    }
+    k_mutex_unlock(&journal_lock);
+    return ret;
+}
+
+void event_journal_get_stats(event_journal_stats_t *out)
+{
+    event_bus_sink_stats_t sink;
+
+    k_mutex_lock(&journal_lock, K_FOREVER);
+    *out = stats;
+    k_mutex_unlock(&journal_lock);
+    out->dropped = atomic_get(&dropped);
+    if (event_bus_get_sink_stats(&journal_q, &sink) == 0) {
+        out->dropped += sink.dropped;
+    }
+}
+
+static int journal_open(uint8_t flash_area_id)
+{
+    uint32_t count = ARRAY_SIZE(journal_sectors);
+    int ret;
+
+    ret = flash_area_open(flash_area_id, &journal_fa);
+    if (ret) return ret;
+
+    ret = flash_area_get_sectors(flash_area_id, &count, journal_sectors);
+    if (ret) {
+        LOG_ERR("Cannot read the journal partition layout (%d)", ret);
+        return ret;
+    }
+    if (count < 2) {
+        LOG_ERR("The journal needs at least two sectors");
+        return -ENOSPC;
+    }
+    for (uint32_t i = 1; i < count; i++) {
+        if (journal_sectors[i].fs_size != journal_sectors[0].fs_size) {
+            LOG_ERR("The journal needs uniform sectors");
+            return -ENOTSUP;
+        }
+    }
+    // Room for the header, a full checkpoint and at least one event.
+    if (journal_sectors[0].fs_size < (EVENT_ID_COUNT + 2) * sizeof(journal_record_t) ||
+        sizeof(journal_record_t) % flash_area_align(journal_fa) != 0) {
+        LOG_ERR("Unsupported journal sector size or write alignment");
+        return -ENOTSUP;
+    }
+
+    sector_size = journal_sectors[0].fs_size;
+    sector_count = count;
+    return 0;
+}
+
+int event_journal_init(uint8_t flash_area_id, const event_id_t *events, size_t num_events)
+{
+    int ret;
+
+    if (!events || num_events == 0) return -EINVAL;
+    if (journal_tid) return -EALREADY;
+
+    ret = journal_open(flash_area_id);
+    if (ret == 0) ret = event_journal_recover();
+    if (ret) {
+        LOG_ERR("Failed to open the event journal (%d)", ret);
+        if (journal_fa) flash_area_close(journal_fa);
+        journal_fa = NULL;
+        return ret;
+    }
+
+    journal_tid = k_thread_create(&journal_thread_data, journal_stack_area,
+                                  K_THREAD_STACK_SIZEOF(journal_stack_area),
+                                  journal_thread, NULL, NULL, NULL,
+                                  CONFIG_EVENT_JOURNAL_THREAD_PRIORITY, 0, K_NO_WAIT);
+    k_thread_name_set(journal_tid, "event_journal");
+
+    // A queue sink: the bus puts into the intake queue without waiting and
+    // counts what a full queue drops, in either bus mode.
+    ret = event_bus_register_queue_sink(&journal_q, events, num_events, NULL);
+    if (ret) {
+        LOG_ERR("Failed to subscribe the event journal (%d)", ret);
+    }
+    return ret;
+}
@@ -0,0 +1,223 @@
+#include <zephyr/ztest.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/storage/flash_map.h>
+#include "event_bus.h"
+#include "event_journal.h"
+
+LOG_MODULE_REGISTER(ztest_event_journal, CONFIG_LOG_DEFAULT_LEVEL);
+
+// native_sim has no bootloader, so its scratch partition is free to use.
+#define JOURNAL_PARTITION FIXED_PARTITION_ID(scratch_partition)
+#define RECORD_SIZE 16
+
+static const event_id_t journaled_events[] = {
+	EVENT_POWER_LOSS_DETECTED,
+	EVENT_UI_CYCLE_SELECTED,
+};
+
+static void *journal_suite_setup(void)
+{
+	zassert_ok(event_bus_init(), "event_bus_init() failed");
+	zassert_ok(event_journal_init(JOURNAL_PARTITION, journaled_events,
+				      ARRAY_SIZE(journaled_events)),
+		   "event_journal_init() failed");
+	return NULL;
+}
+
+static void journal_suite_before(void *data)
+{
+	ARG_UNUSED(data);
+	zassert_ok(event_journal_erase(), "event_journal_erase() failed");
+}
+
+static void append(event_id_t id, uint32_t value)
+{
+	const app_event_t event = { .id = id, .payload.u32 = value };
+
+	zassert_ok(event_journal_append(&event), "Append failed");
+}
+
+static uint32_t latest_value(event_id_t id)
+{
+	app_event_t event;
+
+	zassert_ok(event_journal_get_latest(id, &event), "No journaled value");
+	return event.payload.u32;
+}
+
+ZTEST(event_journal_suite, test_flushed_events_survive_recovery)
+{
+	event_journal_stats_t stats;
+	app_event_t event;
+
+	append(EVENT_UI_CYCLE_SELECTED, 1);
+	append(EVENT_UI_CYCLE_SELECTED, 2);
+	zassert_equal(event_journal_get_latest(EVENT_POWER_LOSS_DETECTED, &event), -ENOENT,
+		      "Unexpected value for an event never journaled");
+	zassert_ok(event_journal_flush(), "Flush failed");
+
+	zassert_ok(event_journal_recover(), "Recovery failed");
+	zassert_equal(latest_value(EVENT_UI_CYCLE_SELECTED), 2, "Wrong value after recovery");
+	event_journal_get_stats(&stats);
+	zassert_equal(stats.recovered, 2, "Expected two records to be replayed");
+}
+
+ZTEST(event_journal_suite, test_bus_events_are_journaled)
+{
+	const app_event_t power_loss = { .id = EVENT_POWER_LOSS_DETECTED, .payload.u32 = 42 };
+	const app_event_t ignored = { .id = EVENT_DOOR_OPENED, .payload.u32 = 1 };
+	app_event_t event;
+
+	zassert_ok(event_bus_post(&power_loss), "Post failed");
+	zassert_ok(event_bus_post(&ignored), "Post failed");
+	// Let the bus hand the events over before flushing.
+	k_msleep(50);
+	zassert_ok(event_journal_flush(), "Flush failed");
+
+	zassert_ok(event_journal_get_latest(EVENT_POWER_LOSS_DETECTED, &event), "Event not journaled");
+	zassert_equal(event.payload.u32, 42, "Wrong payload journaled");
+	zassert_not_equal(event.seq, 0, "Bus sequence number not journaled");
+	zassert_equal(event_journal_get_latest(EVENT_DOOR_OPENED, &event), -ENOENT,
+		      "Event outside the journaled set was stored");
+}
+
+ZTEST(event_journal_suite, test_recovery_reads_only_newest_sector)
+{
+	const int count = 600;
+	event_journal_stats_t before, after;
+
+	event_journal_get_stats(&before);
+	append(EVENT_POWER_LOSS_DETECTED, 7);
+	for (int i = 0; i < count; i++) {
+		append(EVENT_UI_CYCLE_SELECTED, i);
+		if (i % 16 == 15) {
+			zassert_ok(event_journal_flush(), "Flush failed");
+		}
+	}
+	zassert_ok(event_journal_flush(), "Flush failed");
+	event_journal_get_stats(&after);
+	zassert_true(after.sectors_erased - before.sectors_erased >= 2,
+		     "Expected the journal to span several sectors");
+
+	zassert_ok(event_journal_recover(), "Recovery failed");
+	event_journal_get_stats(&after);
+	zassert_equal(latest_value(EVENT_UI_CYCLE_SELECTED), count - 1, "Wrong value after recovery");
+	// Only survives through the checkpoints carried into each new sector.
+	zassert_equal(latest_value(EVENT_POWER_LOSS_DETECTED), 7, "Checkpoint lost");
+	zassert_true(after.recovered < count, "Recovery scanned more than the newest sector");
+}
+
+ZTEST(event_journal_suite, test_torn_record_is_skipped)
+{
+	const struct flash_area *fa;
+	const uint8_t junk[RECORD_SIZE / 2] = { 0 };
+	event_journal_stats_t stats;
+
+	// After an erase the journal starts in sector 0: header, then records.
+	append(EVENT_POWER_LOSS_DETECTED, 1);
+	append(EVENT_UI_CYCLE_SELECTED, 2);
+	zassert_ok(event_journal_flush(), "Flush failed");
+
+	// Simulate power loss in the middle of writing the third record.
+	zassert_ok(flash_area_open(JOURNAL_PARTITION, &fa), "flash_area_open() failed");
+	zassert_ok(flash_area_write(fa, 3 * RECORD_SIZE, junk, sizeof(junk)), "Write failed");
+	flash_area_close(fa);
+
+	zassert_ok(event_journal_recover(), "Recovery failed");
+	event_journal_get_stats(&stats);
+	zassert_equal(stats.recovered, 2, "Torn record was replayed");
+	zassert_equal(latest_value(EVENT_UI_CYCLE_SELECTED), 2, "Wrong value after recovery");
+
+	// New records must go to a fresh sector, not over the torn one.
+	append(EVENT_UI_CYCLE_SELECTED, 3);
+	zassert_ok(event_journal_flush(), "Flush failed");
+	zassert_ok(event_journal_recover(), "Recovery failed");
+	zassert_equal(latest_value(EVENT_UI_CYCLE_SELECTED), 3, "Record after torn write lost");
+	zassert_equal(latest_value(EVENT_POWER_LOSS_DETECTED), 1, "Checkpoint lost");
+}
+
+ZTEST(event_journal_suite, test_checkpoint_leaves_only_checkpoint_to_replay)
+{
+	event_journal_stats_t stats;
+
+	for (int i = 0; i < 10; i++) {
+		append(EVENT_UI_CYCLE_SELECTED, i);
+	}
+	append(EVENT_POWER_LOSS_DETECTED, 5);
+	zassert_ok(event_journal_checkpoint(), "Checkpoint failed");
+
+	zassert_ok(event_journal_recover(), "Recovery failed");
+	event_journal_get_stats(&stats);
+	zassert_equal(stats.recovered, ARRAY_SIZE(journaled_events),
+		      "Expected one checkpoint record per journaled event");
+	zassert_equal(latest_value(EVENT_UI_CYCLE_SELECTED), 9, "Wrong value after checkpoint");
+}
+
+ZTEST(event_journal_suite, test_erase_drops_what_was_queued_before_it)
+{
+	app_event_t event;
+
+	append(EVENT_POWER_LOSS_DETECTED, 1);
+	append(EVENT_UI_CYCLE_SELECTED, 2);
+	zassert_ok(event_journal_erase(), "Erase failed");
+	append(EVENT_UI_CYCLE_SELECTED, 3);
+	zassert_ok(event_journal_flush(), "Flush failed");
+
+	zassert_equal(event_journal_get_latest(EVENT_POWER_LOSS_DETECTED, &event), -ENOENT,
+		      "Event from before the erase was journaled");
+	zassert_equal(latest_value(EVENT_UI_CYCLE_SELECTED), 3, "Event after the erase lost");
+	zassert_ok(event_journal_recover(), "Recovery failed");
+	zassert_equal(event_journal_get_latest(EVENT_POWER_LOSS_DETECTED, &event), -ENOENT,
+		      "Event from before the erase was written to flash");
+}
+
+ZTEST(event_journal_suite, test_full_queue_drops_without_blocking)
+{
+	event_journal_stats_t before, after;
+	const app_event_t event = { .id = EVENT_UI_CYCLE_SELECTED };
+	uint32_t rejected = 0;
+
+	event_journal_get_stats(&before);
+	// Keep the journal thread from draining the queue meanwhile.
+	k_sched_lock();
+	for (int i = 0; i < CONFIG_EVENT_JOURNAL_QUEUE_DEPTH + 8; i++) {
+		if (event_journal_append(&event) == -ENOSPC) {
+			rejected++;
+		}
+	}
+	k_sched_unlock();
+	zassert_ok(event_journal_flush(), "Flush failed");
+
+	event_journal_get_stats(&after);
+	zassert_true(rejected > 0, "Queue never filled up");
+	zassert_equal(after.dropped - before.dropped, rejected, "Drops not counted");
+}
+
+ZTEST(event_journal_suite, test_full_queue_never_blocks_the_bus)
+{
+	event_journal_stats_t before, after;
+	const app_event_t event = { .id = EVENT_UI_CYCLE_SELECTED };
+	const int extra = 8;
+
+	event_journal_get_stats(&before);
+	// Fill the intake queue while the journal thread cannot drain it, then
+	// post more through the bus.
+	k_sched_lock();
+	for (int i = 0; i < CONFIG_EVENT_JOURNAL_QUEUE_DEPTH; i++) {
+		zassert_ok(event_journal_append(&event), "Append failed");
+	}
+	for (int i = 0; i < extra; i++) {
+		(void)event_bus_post(&event);
+	}
+	k_sched_unlock();
+	// A dispatcher thread hands the events over once it runs, ahead of
+	// the lower priority journal thread.
+	k_msleep(10);
+	zassert_ok(event_journal_flush(), "Flush failed");
+
+	event_journal_get_stats(&after);
+	zassert_equal(after.dropped - before.dropped, extra, "Bus waited for the journal");
+}
+
+ZTEST_SUITE(event_journal_suite, NULL, journal_suite_setup, journal_suite_before, NULL, NULL);
@@ -0,0 +1,110 @@
+#include <zephyr/ztest.h>
+#include <zephyr/kernel.h>
+#include "event_bus.h"
+#include "sample_pipeline.h"
+
+// 128000 samples, 2 s of a 64 kHz sensor
+#define BENCH_BLOCKS 2000
+#define BENCH_SAMPLES (BENCH_BLOCKS * SAMPLE_PIPELINE_BLOCK)
+#define DECIMATION 100
+
+static int32_t samples[SAMPLE_PIPELINE_BLOCK];
+static int32_t out[SAMPLE_PIPELINE_BLOCK];
+static struct sample_filter filter;
+static struct sample_pipeline pipeline;
+
+static void *bench_setup(void)
+{
+	uint32_t seed = 12345;
+
+	zassert_ok(event_bus_init(), "event_bus_init() failed");
+	// 40 C with a degree of noise
+	for (int i = 0; i < SAMPLE_PIPELINE_BLOCK; i++) {
+		seed = seed * 1664525u + 1013904223u;
+		samples[i] = sample_from_int(40) + (int32_t)(seed >> 24) - 128;
+	}
+	return NULL;
+}
+
+static void print_rate(const char *what, uint32_t cycles, uint32_t count)
+{
+	const uint64_t ns = MAX(k_cyc_to_ns_floor64(cycles), 1);
+
+	TC_PRINT("  %-24s %u ns/sample, %u ksamples/s\n", what, (uint32_t)(ns / count),
+		 (uint32_t)((uint64_t)count * NSEC_PER_SEC / ns / 1000));
+}
+
+static void bench_filter(const char *name, enum sample_filter_type type, uint8_t param)
+{
+	uint32_t start;
+
+	zassert_ok(sample_filter_init(&filter, type, param));
+	start = k_cycle_get_32();
+	for (int i = 0; i < BENCH_BLOCKS; i++) {
+		sample_filter_run(&filter, samples, out, SAMPLE_PIPELINE_BLOCK);
+	}
+	print_rate(name, k_cycle_get_32() - start, BENCH_SAMPLES);
+}
+
+/**
+ * @brief Samples per second through each filter, in blocks of 64.
+ *
+ * The moving average and the median vectorize; the IIR carries its
+ * output from one sample to the next and cannot.
+ */
+ZTEST(sample_pipeline_bench_suite, test_filters)
+{
+	TC_PRINT("filters, %d samples\n", BENCH_SAMPLES);
+	bench_filter("none:", SAMPLE_FILTER_NONE, 0);
+	bench_filter("moving average 4:", SAMPLE_FILTER_MOVING_AVERAGE, 4);
+	bench_filter("moving average 16:", SAMPLE_FILTER_MOVING_AVERAGE, 16);
+	bench_filter("iir 1/16:", SAMPLE_FILTER_IIR, 4);
+	bench_filter("median 3:", SAMPLE_FILTER_MEDIAN, 3);
+	bench_filter("median 5:", SAMPLE_FILTER_MEDIAN, 5);
+}
+
+/**
+ * @brief The whole pipeline against one event per sample.
+ *
+ * Ring, 16 sample average, decimation by 100 and the posts, next to
+ * posting every raw sample on the bus.
+ */
+ZTEST(sample_pipeline_bench_suite, test_pipeline_against_event_per_sample)
+{
+	const struct sample_pipeline_config config = {
+		.filter = SAMPLE_FILTER_MOVING_AVERAGE,
+		.filter_param = 16,
+		.decimation = DECIMATION,
+		.report_event = EVENT_HEATER_TEMP_CHANGED,
+		.threshold_event = EVENT_TEMP_REACHED,
+		.threshold = sample_from_int(40),
+		.hysteresis = sample_from_int(2),
+	};
+	app_event_t event = { .id = EVENT_HEATER_TEMP_CHANGED };
+	size_t posted = 0;
+	uint32_t start;
+
+	zassert_ok(sample_pipeline_init(&pipeline, &config));
+
+	TC_PRINT("pipeline, %d samples, decimation %d\n", BENCH_SAMPLES, DECIMATION);
+	start = k_cycle_get_32();
+	for (int i = 0; i < BENCH_BLOCKS; i++) {
+		sample_pipeline_push(&pipeline, samples, SAMPLE_PIPELINE_BLOCK);
+		posted += sample_pipeline_post(&pipeline);
+	}
+	print_rate("pipeline:", k_cycle_get_32() - start, BENCH_SAMPLES);
+	TC_PRINT("  %-24s %u\n", "events posted:", (uint32_t)posted);
+	zassert_equal(posted, BENCH_SAMPLES / DECIMATION + 1, "Reports plus one threshold");
+
+	start = k_cycle_get_32();
+	for (int i = 0; i < BENCH_BLOCKS; i++) {
+		for (int j = 0; j < SAMPLE_PIPELINE_BLOCK; j++) {
+			event.payload.s32 = sample_to_int(samples[j]);
+			event_bus_post(&event);
+		}
+	}
+	print_rate("event per sample:", k_cycle_get_32() - start, BENCH_SAMPLES);
+	TC_PRINT("  %-24s %u\n", "events posted:", BENCH_SAMPLES);
+}
+
+ZTEST_SUITE(sample_pipeline_bench_suite, NULL, bench_setup, NULL, NULL, NULL);
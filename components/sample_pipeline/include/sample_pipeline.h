@@ -0,0 +1,178 @@
+#pragma once
+
+#include "event_defs.h"
+#include <zephyr/kernel.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @file sample_pipeline.h
+ * @brief High rate sensor samples in, a few filtered events out.
+ *
+ * A producer, typically a sensor ISR or driver thread, pushes raw samples
+ * into the pipeline's ring. The consumer takes them out in blocks, runs
+ * the block through a filter, keeps every Nth filtered sample and turns
+ * each kept sample into a report event, plus a threshold event when the
+ * signal rises through a level. One event per N samples instead of one
+ * per sample keeps the bus and its subscribers out of the sample loop.
+ */
+
+// Samples are Q23.8 fixed point in the sensor's unit: 1 C is 256.
+#define SAMPLE_FRAC_BITS 8
+// Samples filtered in one go
+#define SAMPLE_PIPELINE_BLOCK 64
+#define SAMPLE_FILTER_MAX_WINDOW 32
+// No event, for sample_pipeline_config.report_event and threshold_event
+#define SAMPLE_PIPELINE_NO_EVENT EVENT_ID_COUNT
+
+static inline int32_t sample_from_int(int32_t value)
+{
+    return value * (1 << SAMPLE_FRAC_BITS);
+}
+
+// Rounded to the nearest whole unit
+static inline int32_t sample_to_int(int32_t sample)
+{
+    return (sample + (1 << (SAMPLE_FRAC_BITS - 1))) >> SAMPLE_FRAC_BITS;
+}
+
+/**
+ * @brief Single producer, single consumer ring of raw samples.
+ *
+ * The producer only writes @c tail and the consumer only writes @c head,
+ * so neither side takes a lock and the producer may be an ISR.
+ */
+struct sample_ring {
+    atomic_t head;          // Next sample to read, free running
+    atomic_t tail;          // Next slot to write, free running
+    int32_t buf[CONFIG_SAMPLE_PIPELINE_RING_SIZE];
+};
+
+enum sample_filter_type {
+    SAMPLE_FILTER_NONE,
+    SAMPLE_FILTER_MOVING_AVERAGE,   // Mean of the last `window` samples
+    SAMPLE_FILTER_IIR,              // First order low pass, y += (x - y) / 2^shift
+    SAMPLE_FILTER_MEDIAN,           // Median of the last 3 or 5 samples
+};
+
+/**
+ * @brief Filter state, carried from one block to the next.
+ *
+ * The first sample seen fills the history, so the output starts at the
+ * signal instead of ramping up from zero.
+ */
+struct sample_filter {
+    enum sample_filter_type type;
+    uint8_t window;
+    uint8_t shift;
+    bool primed;
+    int64_t iir;            // IIR output with SAMPLE_FRAC_BITS extra bits
+    int32_t history[SAMPLE_FILTER_MAX_WINDOW - 1];
+};
+
+struct sample_pipeline_config {
+    enum sample_filter_type filter;
+    // Moving average: window, a power of two up to SAMPLE_FILTER_MAX_WINDOW.
+    // Median: window, 3 or 5. IIR: shift, 1 to 15. Ignored for NONE.
+    uint8_t filter_param;
+    uint16_t decimation;        // One output per this many samples
+    event_id_t report_event;    // Posted with every output, in whole units
+    event_id_t threshold_event; // Posted when an output reaches threshold
+    int32_t threshold;          // Q23.8
+    // The output must fall this far below the threshold before the
+    // threshold event can fire again. Q23.8.
+    int32_t hysteresis;
+};
+
+typedef struct {
+    uint32_t pushed;        // Samples taken into the ring
+    uint32_t dropped;       // Samples pushed while the ring was full
+    uint32_t filtered;      // Samples through the filter
+    uint32_t outputs;       // Samples kept by the decimation
+    uint32_t events;        // Events produced
+    uint32_t failed;        // Posts the bus did not take in full
+} sample_pipeline_stats_t;
+
+struct sample_pipeline {
+    struct sample_ring ring;
+    struct sample_filter filter;
+    struct sample_pipeline_config config;
+    uint16_t phase;         // Samples into the current decimation period
+    bool above;             // Threshold reached and not yet re-armed
+    sample_pipeline_stats_t stats;
+};
+
+void sample_ring_init(struct sample_ring *ring);
+
+/**
+ * @brief Copies up to @p count samples into the ring. Producer side, ISR safe.
+ *
+ * @return The number of samples copied, less than @p count if the ring filled.
+ */
+size_t sample_ring_put(struct sample_ring *ring, const int32_t *samples, size_t count);
+
+/**
+ * @brief Takes up to @p max samples out of the ring. Consumer side.
+ *
+ * @return The number of samples taken.
+ */
+size_t sample_ring_get(struct sample_ring *ring, int32_t *out, size_t max);
+
+size_t sample_ring_used(const struct sample_ring *ring);
+
+/**
+ * @brief Sets up a filter, see sample_pipeline_config.filter_param for @p param.
+ *
+ * @return 0 on success, -EINVAL for an unknown type or a bad parameter.
+ */
+int sample_filter_init(struct sample_filter *filter, enum sample_filter_type type,
+                       uint8_t param);
+
+/**
+ * @brief Filters @p count samples, at most SAMPLE_PIPELINE_BLOCK.
+ *
+ * @p in and @p out must not overlap. Every output depends only on the
+ * filter state and the inputs, so the moving average and the median
+ * vectorize; the IIR is a recurrence and runs one sample at a time.
+ */
+void sample_filter_run(struct sample_filter *filter, const int32_t *in, int32_t *out,
+                       size_t count);
+
+/**
+ * @brief Sets up a pipeline with an empty ring.
+ *
+ * @return 0 on success, -EINVAL for a NULL argument or a bad configuration.
+ */
+int sample_pipeline_init(struct sample_pipeline *pipeline,
+                         const struct sample_pipeline_config *config);
+
+/**
+ * @brief Queues raw samples. Producer side, ISR safe.
+ *
+ * @return The number of samples queued; the rest were dropped.
+ */
+size_t sample_pipeline_push(struct sample_pipeline *pipeline, const int32_t *samples,
+                            size_t count);
+
+/**
+ * @brief Runs the queued samples through the pipeline. Consumer side.
+ *
+ * Stops early rather than produce more than @p max_events events; the
+ * samples left over stay in the ring for the next call. @p max_events
+ * should be at least 2, one output can give two events.
+ *
+ * @return The number of events written to @p events.
+ */
+size_t sample_pipeline_process(struct sample_pipeline *pipeline, app_event_t *events,
+                               size_t max_events);
+
+/**
+ * @brief Runs every queued sample through the pipeline and posts the events.
+ *
+ * @return The number of events posted.
+ */
+size_t sample_pipeline_post(struct sample_pipeline *pipeline);
+
+void sample_pipeline_get_stats(const struct sample_pipeline *pipeline,
+                               sample_pipeline_stats_t *out);
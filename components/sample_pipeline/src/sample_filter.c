@@ -0,0 +1,150 @@
+#include "sample_pipeline.h"
+#include <zephyr/sys/util.h>
+#include <string.h>
+
+// The filters below are written for the vectorizer: fixed trip counts,
+// no branches in the loop bodies, and restrict pointers so the compiler
+// knows the output does not alias the input.
+
+int sample_filter_init(struct sample_filter *filter, enum sample_filter_type type,
+                       uint8_t param)
+{
+    if (!filter) {
+        return -EINVAL;
+    }
+
+    memset(filter, 0, sizeof(*filter));
+    filter->type = type;
+    filter->window = 1;
+
+    switch (type) {
+    case SAMPLE_FILTER_NONE:
+        break;
+    case SAMPLE_FILTER_MOVING_AVERAGE:
+        if (param == 0 || param > SAMPLE_FILTER_MAX_WINDOW || !IS_POWER_OF_TWO(param)) {
+            return -EINVAL;
+        }
+        filter->window = param;
+        // Divide by shifting
+        filter->shift = u32_count_trailing_zeros(param);
+        break;
+    case SAMPLE_FILTER_IIR:
+        if (param < 1 || param > 15) {
+            return -EINVAL;
+        }
+        filter->shift = param;
+        break;
+    case SAMPLE_FILTER_MEDIAN:
+        if (param != 3 && param != 5) {
+            return -EINVAL;
+        }
+        filter->window = param;
+        break;
+    default:
+        return -EINVAL;
+    }
+    return 0;
+}
+
+static void prime(struct sample_filter *filter, int32_t first)
+{
+    for (int i = 0; i < SAMPLE_FILTER_MAX_WINDOW - 1; i++) {
+        filter->history[i] = first;
+    }
+    filter->iir = (int64_t)first << SAMPLE_FRAC_BITS;
+    filter->primed = true;
+}
+
+static inline int32_t median3(int32_t a, int32_t b, int32_t c)
+{
+    return MAX(MIN(a, b), MIN(MAX(a, b), c));
+}
+
+// Sorting network: the median of five is the median of e and the two
+// middle values of the pairs (a, b) and (c, d).
+static inline int32_t median5(int32_t a, int32_t b, int32_t c, int32_t d, int32_t e)
+{
+    return median3(e, MAX(MIN(a, b), MIN(c, d)), MIN(MAX(a, b), MAX(c, d)));
+}
+
+static void moving_average(const int32_t *restrict x, int32_t *restrict out, size_t count,
+                           uint8_t window, uint8_t shift)
+{
+    // Q23.8 samples use all 32 bits, so the sums of up to 32 of them take
+    // 37 bits. The mean fits in 32 again.
+    int64_t sum[SAMPLE_PIPELINE_BLOCK];
+
+    for (size_t i = 0; i < count; i++) {
+        sum[i] = x[i];
+    }
+    for (size_t k = 1; k < window; k++) {
+        for (size_t i = 0; i < count; i++) {
+            sum[i] += x[i + k];
+        }
+    }
+    for (size_t i = 0; i < count; i++) {
+        out[i] = (int32_t)(sum[i] >> shift);
+    }
+}
+
+static void median(const int32_t *restrict x, int32_t *restrict out, size_t count,
+                   uint8_t window)
+{
+    if (window == 3) {
+        for (size_t i = 0; i < count; i++) {
+            out[i] = median3(x[i], x[i + 1], x[i + 2]);
+        }
+    } else {
+        for (size_t i = 0; i < count; i++) {
+            out[i] = median5(x[i], x[i + 1], x[i + 2], x[i + 3], x[i + 4]);
+        }
+    }
+}
+
+static void iir(struct sample_filter *filter, const int32_t *restrict in,
+                int32_t *restrict out, size_t count)
+{
+    int64_t y = filter->iir;
+
+    for (size_t i = 0; i < count; i++) {
+        y += (((int64_t)in[i] << SAMPLE_FRAC_BITS) - y) >> filter->shift;
+        out[i] = (int32_t)(y >> SAMPLE_FRAC_BITS);
+    }
+    filter->iir = y;
+}
+
+void sample_filter_run(struct sample_filter *filter, const int32_t *in, int32_t *out,
+                       size_t count)
+{
+    // The history followed by the block, so every output reads one array
+    int32_t x[SAMPLE_FILTER_MAX_WINDOW - 1 + SAMPLE_PIPELINE_BLOCK];
+    const size_t keep = filter->window - 1;
+
+    __ASSERT(count <= SAMPLE_PIPELINE_BLOCK, "Block of %u samples", count);
+    if (count == 0) {
+        return;
+    }
+    if (!filter->primed) {
+        prime(filter, in[0]);
+    }
+
+    switch (filter->type) {
+    case SAMPLE_FILTER_MOVING_AVERAGE:
+    case SAMPLE_FILTER_MEDIAN:
+        memcpy(x, filter->history, keep * sizeof(int32_t));
+        memcpy(x + keep, in, count * sizeof(int32_t));
+        if (filter->type == SAMPLE_FILTER_MEDIAN) {
+            median(x, out, count, filter->window);
+        } else {
+            moving_average(x, out, count, filter->window, filter->shift);
+        }
+        memcpy(filter->history, x + count, keep * sizeof(int32_t));
+        break;
+    case SAMPLE_FILTER_IIR:
+        iir(filter, in, out, count);
+        break;
+    default:
+        memcpy(out, in, count * sizeof(int32_t));
+        break;
+    }
+}
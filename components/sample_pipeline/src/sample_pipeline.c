@@ -0,0 +1,194 @@
+#include "sample_pipeline.h"
+#include "event_bus.h"
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/util.h>
+#include <string.h>
+
+LOG_MODULE_REGISTER(sample_pipeline, CONFIG_LOG_DEFAULT_LEVEL);
+
+#define RING_SIZE CONFIG_SAMPLE_PIPELINE_RING_SIZE
+#define RING_MASK (RING_SIZE - 1)
+
+BUILD_ASSERT(IS_POWER_OF_TWO(RING_SIZE), "CONFIG_SAMPLE_PIPELINE_RING_SIZE must be a power of two");
+
+// Events handed to the bus per batch in sample_pipeline_post()
+#define POST_BATCH 8
+
+// --- Ring ---
+
+void sample_ring_init(struct sample_ring *ring)
+{
+    atomic_set(&ring->head, 0);
+    atomic_set(&ring->tail, 0);
+}
+
+size_t sample_ring_used(const struct sample_ring *ring)
+{
+    return (uint32_t)atomic_get(&ring->tail) - (uint32_t)atomic_get(&ring->head);
+}
+
+size_t sample_ring_put(struct sample_ring *ring, const int32_t *samples, size_t count)
+{
+    const uint32_t tail = atomic_get(&ring->tail);
+    const uint32_t head = atomic_get(&ring->head);
+    const size_t n = MIN(count, RING_SIZE - (tail - head));
+    const size_t start = tail & RING_MASK;
+    const size_t first = MIN(n, RING_SIZE - start);
+
+    memcpy(&ring->buf[start], samples, first * sizeof(int32_t));
+    memcpy(&ring->buf[0], samples + first, (n - first) * sizeof(int32_t));
+    // Publishes the samples: the consumer reads the tail before the buffer.
+    atomic_set(&ring->tail, tail + n);
+    return n;
+}
+
+size_t sample_ring_get(struct sample_ring *ring, int32_t *out, size_t max)
+{
+    const uint32_t head = atomic_get(&ring->head);
+    const uint32_t tail = atomic_get(&ring->tail);
+    const size_t n = MIN(max, tail - head);
+    const size_t start = head & RING_MASK;
+    const size_t first = MIN(n, RING_SIZE - start);
+
+    memcpy(out, &ring->buf[start], first * sizeof(int32_t));
+    memcpy(out + first, &ring->buf[0], (n - first) * sizeof(int32_t));
+    // Hands the slots back to the producer once they have been copied.
+    atomic_set(&ring->head, head + n);
+    return n;
+}
+
+// --- Pipeline ---
+
+static bool event_valid(event_id_t id)
+{
+    return id < EVENT_ID_COUNT || id == SAMPLE_PIPELINE_NO_EVENT;
+}
+
+int sample_pipeline_init(struct sample_pipeline *pipeline,
+                         const struct sample_pipeline_config *config)
+{
+    if (!pipeline || !config) {
+        return -EINVAL;
+    }
+    if (config->decimation == 0 || config->hysteresis < 0 ||
+        !event_valid(config->report_event) || !event_valid(config->threshold_event)) {
+        return -EINVAL;
+    }
+
+    memset(pipeline, 0, sizeof(*pipeline));
+    if (sample_filter_init(&pipeline->filter, config->filter, config->filter_param) != 0) {
+        return -EINVAL;
+    }
+    pipeline->config = *config;
+    sample_ring_init(&pipeline->ring);
+    return 0;
+}
+
+size_t sample_pipeline_push(struct sample_pipeline *pipeline, const int32_t *samples,
+                            size_t count)
+{
+    const size_t n = sample_ring_put(&pipeline->ring, samples, count);
+
+    // Only the producer writes these two.
+    pipeline->stats.pushed += n;
+    pipeline->stats.dropped += count - n;
+    return n;
+}
+
+// Keeps the last sample of every decimation period, in place.
+static size_t decimate(struct sample_pipeline *pipeline, int32_t *samples, size_t count)
+{
+    const uint16_t period = pipeline->config.decimation;
+    size_t kept = 0;
+
+    for (size_t i = period - 1 - pipeline->phase; i < count; i += period) {
+        samples[kept++] = samples[i];
+    }
+    pipeline->phase = (pipeline->phase + count) % period;
+    return kept;
+}
+
+static size_t emit(struct sample_pipeline *pipeline, int32_t sample, app_event_t *events)
+{
+    const struct sample_pipeline_config *config = &pipeline->config;
+    size_t n = 0;
+
+    if (config->report_event != SAMPLE_PIPELINE_NO_EVENT) {
+        events[n++] = (app_event_t){ .id = config->report_event,
+                                     .payload.s32 = sample_to_int(sample) };
+    }
+    if (config->threshold_event != SAMPLE_PIPELINE_NO_EVENT) {
+        if (!pipeline->above && sample >= config->threshold) {
+            pipeline->above = true;
+            events[n++] = (app_event_t){ .id = config->threshold_event,
+                                         .payload.s32 = sample_to_int(sample) };
+        } else if (pipeline->above && sample < config->threshold - config->hysteresis) {
+            pipeline->above = false;
+        }
+    }
+    return n;
+}
+
+size_t sample_pipeline_process(struct sample_pipeline *pipeline, app_event_t *events,
+                               size_t max_events)
+{
+    const struct sample_pipeline_config *config = &pipeline->config;
+    const size_t per_output = (config->report_event != SAMPLE_PIPELINE_NO_EVENT) +
+                              (config->threshold_event != SAMPLE_PIPELINE_NO_EVENT);
+    int32_t raw[SAMPLE_PIPELINE_BLOCK];
+    int32_t filtered[SAMPLE_PIPELINE_BLOCK];
+    size_t count = 0;
+
+    while (1) {
+        size_t room = SAMPLE_PIPELINE_BLOCK;
+
+        if (per_output > 0) {
+            // The most samples that give no more outputs than there is room for
+            const size_t outputs = (max_events - count) / per_output;
+
+            room = MIN(room, outputs * config->decimation +
+                                 (config->decimation - 1 - pipeline->phase));
+        }
+
+        const size_t n = sample_ring_get(&pipeline->ring, raw, room);
+
+        if (n == 0) {
+            break;
+        }
+        sample_filter_run(&pipeline->filter, raw, filtered, n);
+        pipeline->stats.filtered += n;
+
+        const size_t kept = decimate(pipeline, filtered, n);
+
+        pipeline->stats.outputs += kept;
+        for (size_t i = 0; i < kept; i++) {
+            count += emit(pipeline, filtered[i], &events[count]);
+        }
+    }
+    pipeline->stats.events += count;
+    return count;
+}
+
+size_t sample_pipeline_post(struct sample_pipeline *pipeline)
+{
+    app_event_t events[POST_BATCH];
+    size_t posted = 0;
+    size_t n;
+
+    while ((n = sample_pipeline_process(pipeline, events, ARRAY_SIZE(events))) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            if (event_bus_post(&events[i]) != 0) {
+                pipeline->stats.failed++;
+            }
+        }
+        posted += n;
+    }
+    return posted;
+}
+
+void sample_pipeline_get_stats(const struct sample_pipeline *pipeline,
+                               sample_pipeline_stats_t *out)
+{
+    *out = pipeline->stats;
+}
@@ -0,0 +1,299 @@
+#include <zephyr/ztest.h>
+#include <zephyr/kernel.h>
+#include "event_bus.h"
+#include "sample_pipeline.h"
+
+#define RING_SIZE CONFIG_SAMPLE_PIPELINE_RING_SIZE
+
+K_MSGQ_DEFINE(report_q, sizeof(app_event_t), 32, 4);
+
+static const event_id_t pipeline_events[] = {
+	EVENT_HEATER_TEMP_CHANGED,
+	EVENT_TEMP_REACHED,
+};
+
+static struct sample_pipeline pipeline;
+static struct sample_filter filter;
+static int32_t in[SAMPLE_PIPELINE_BLOCK];
+static int32_t out[SAMPLE_PIPELINE_BLOCK];
+
+static void *sample_pipeline_suite_setup(void)
+{
+	zassert_ok(event_bus_init(), "event_bus_init() failed");
+	zassert_not_null(event_bus_subscribe(&report_q, pipeline_events,
+					     ARRAY_SIZE(pipeline_events)),
+			 "Subscription failed");
+	return NULL;
+}
+
+static void sample_pipeline_before(void *data)
+{
+	ARG_UNUSED(data);
+	k_msgq_purge(&report_q);
+}
+
+// Temperature pipeline: 16 sample average, one report per 100 samples,
+// 40 C reached with 2 C of hysteresis.
+static void temp_pipeline(void)
+{
+	const struct sample_pipeline_config config = {
+		.filter = SAMPLE_FILTER_MOVING_AVERAGE,
+		.filter_param = 16,
+		.decimation = 100,
+		.report_event = EVENT_HEATER_TEMP_CHANGED,
+		.threshold_event = EVENT_TEMP_REACHED,
+		.threshold = sample_from_int(40),
+		.hysteresis = sample_from_int(2),
+	};
+
+	zassert_ok(sample_pipeline_init(&pipeline, &config));
+}
+
+// Pushes @p count samples of @p celsius, a whole block at a time.
+static void push_temp(int32_t celsius, size_t count)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(in); i++) {
+		in[i] = sample_from_int(celsius);
+	}
+	while (count > 0) {
+		const size_t n = MIN(count, ARRAY_SIZE(in));
+
+		zassert_equal(sample_pipeline_push(&pipeline, in, n), n, "Ring full");
+		count -= n;
+	}
+}
+
+ZTEST(sample_pipeline_suite, test_ring_wraps_and_drops_when_full)
+{
+	struct sample_ring *ring = &pipeline.ring;
+	int32_t samples[RING_SIZE];
+	int32_t got[RING_SIZE];
+
+	for (int i = 0; i < RING_SIZE; i++) {
+		samples[i] = i;
+	}
+	sample_ring_init(ring);
+
+	// Move the indexes so the next copies wrap around the end.
+	zassert_equal(sample_ring_put(ring, samples, RING_SIZE - 3), RING_SIZE - 3);
+	zassert_equal(sample_ring_get(ring, got, RING_SIZE), RING_SIZE - 3);
+
+	zassert_equal(sample_ring_put(ring, samples, 10), 10);
+	zassert_equal(sample_ring_used(ring), 10);
+	zassert_equal(sample_ring_get(ring, got, RING_SIZE), 10);
+	for (int i = 0; i < 10; i++) {
+		zassert_equal(got[i], i, "Sample %d is %d", i, got[i]);
+	}
+
+	// Full: the excess is refused, what was taken is intact.
+	zassert_equal(sample_ring_put(ring, samples, RING_SIZE), RING_SIZE);
+	zassert_equal(sample_ring_put(ring, samples, 1), 0);
+	zassert_equal(sample_ring_get(ring, got, RING_SIZE), RING_SIZE);
+	zassert_mem_equal(got, samples, sizeof(samples));
+	zassert_equal(sample_ring_get(ring, got, RING_SIZE), 0);
+}
+
+ZTEST(sample_pipeline_suite, test_moving_average_of_a_step)
+{
+	zassert_ok(sample_filter_init(&filter, SAMPLE_FILTER_MOVING_AVERAGE, 4));
+
+	// Primed with the first sample, so a constant input comes out unchanged.
+	for (int i = 0; i < 8; i++) {
+		in[i] = 100;
+	}
+	// Then a step to 500, one sample at a time across the window
+	for (int i = 8; i < 16; i++) {
+		in[i] = 500;
+	}
+	sample_filter_run(&filter, in, out, 16);
+
+	zassert_equal(out[0], 100);
+	zassert_equal(out[7], 100);
+	zassert_equal(out[8], 200);
+	zassert_equal(out[9], 300);
+	zassert_equal(out[10], 400);
+	zassert_equal(out[11], 500);
+
+	// The window carries over to the next block.
+	in[0] = 100;
+	sample_filter_run(&filter, in, out, 1);
+	zassert_equal(out[0], 400);
+}
+
+ZTEST(sample_pipeline_suite, test_moving_average_of_full_scale_samples)
+{
+	zassert_ok(sample_filter_init(&filter, SAMPLE_FILTER_MOVING_AVERAGE,
+				      SAMPLE_FILTER_MAX_WINDOW));
+
+	for (int i = 0; i < SAMPLE_FILTER_MAX_WINDOW; i++) {
+		in[i] = INT32_MAX;
+	}
+	for (int i = SAMPLE_FILTER_MAX_WINDOW; i < 2 * SAMPLE_FILTER_MAX_WINDOW; i++) {
+		in[i] = INT32_MIN;
+	}
+	sample_filter_run(&filter, in, out, 2 * SAMPLE_FILTER_MAX_WINDOW);
+
+	// The sums overflow 32 bits; the means do not.
+	zassert_equal(out[0], INT32_MAX);
+	zassert_equal(out[SAMPLE_FILTER_MAX_WINDOW - 1], INT32_MAX);
+	zassert_equal(out[SAMPLE_FILTER_MAX_WINDOW + SAMPLE_FILTER_MAX_WINDOW / 2 - 1], -1);
+	zassert_equal(out[2 * SAMPLE_FILTER_MAX_WINDOW - 1], INT32_MIN);
+}
+
+ZTEST(sample_pipeline_suite, test_median_removes_spikes)
+{
+	static const int32_t noisy[] = { 10, 10, 900, 10, 10, -900, 10, 10, 900, 900, 10, 10 };
+	static const int32_t median3[] = { 10, 10, 10, 10, 10, 10, 10, 10, 10, 900, 900, 10 };
+
+	zassert_ok(sample_filter_init(&filter, SAMPLE_FILTER_MEDIAN, 3));
+	sample_filter_run(&filter, noisy, out, ARRAY_SIZE(noisy));
+	zassert_mem_equal(out, median3, sizeof(median3));
+
+	// Five samples wide, two spikes in a row go as well.
+	zassert_ok(sample_filter_init(&filter, SAMPLE_FILTER_MEDIAN, 5));
+	sample_filter_run(&filter, noisy, out, ARRAY_SIZE(noisy));
+	for (int i = 0; i < ARRAY_SIZE(noisy); i++) {
+		zassert_equal(out[i], 10, "Sample %d is %d", i, out[i]);
+	}
+}
+
+ZTEST(sample_pipeline_suite, test_iir_settles_on_the_input)
+{
+	zassert_ok(sample_filter_init(&filter, SAMPLE_FILTER_IIR, 3));
+
+	in[0] = 0;
+	sample_filter_run(&filter, in, out, 1);
+	for (int i = 0; i < SAMPLE_PIPELINE_BLOCK; i++) {
+		in[i] = sample_from_int(1000);
+	}
+	// One eighth of the way on each sample
+	sample_filter_run(&filter, in, out, 1);
+	zassert_equal(out[0], sample_from_int(125));
+
+	// Sixty more and the error is below one part in a thousand.
+	sample_filter_run(&filter, in, out, SAMPLE_PIPELINE_BLOCK);
+	zassert_within(sample_to_int(out[SAMPLE_PIPELINE_BLOCK - 1]), 1000, 1);
+}
+
+ZTEST(sample_pipeline_suite, test_decimation_across_pushes)
+{
+	app_event_t events[16];
+	size_t count = 0;
+
+	temp_pipeline();
+
+	// 1000 samples in uneven pushes, processed after each one
+	for (int pushed = 0; pushed < 1000; pushed += 37) {
+		push_temp(20, MIN(37, 1000 - pushed));
+		count += sample_pipeline_process(&pipeline, &events[count],
+						 ARRAY_SIZE(events) - count);
+	}
+
+	sample_pipeline_stats_t stats;
+
+	sample_pipeline_get_stats(&pipeline, &stats);
+	zassert_equal(count, 10, "One report per 100 samples, got %u", count);
+	zassert_equal(stats.filtered, 1000);
+	zassert_equal(stats.outputs, 10);
+	for (int i = 0; i < count; i++) {
+		zassert_equal(events[i].id, EVENT_HEATER_TEMP_CHANGED);
+		zassert_equal(events[i].payload.s32, 20);
+	}
+}
+
+ZTEST(sample_pipeline_suite, test_process_stops_when_events_are_full)
+{
+	app_event_t events[4];
+
+	temp_pipeline();
+	push_temp(20, 250);
+
+	// Room for two events is room for one output, which could also cross
+	// the threshold. The samples after that output's period stay queued.
+	zassert_equal(sample_pipeline_process(&pipeline, events, 2), 1);
+	zassert_equal(sample_ring_used(&pipeline.ring), 51);
+	zassert_equal(sample_pipeline_process(&pipeline, events, ARRAY_SIZE(events)), 1);
+	zassert_equal(sample_ring_used(&pipeline.ring), 0);
+	push_temp(20, 50);
+	zassert_equal(sample_pipeline_process(&pipeline, events, ARRAY_SIZE(events)), 1);
+}
+
+// Feeds @p count samples of @p celsius through the bus a block at a time
+// and returns how many times the threshold event came out.
+static int feed(int32_t celsius, size_t count)
+{
+	app_event_t event;
+	int reached = 0;
+
+	while (count > 0) {
+		const size_t n = MIN(count, SAMPLE_PIPELINE_BLOCK);
+
+		push_temp(celsius, n);
+		sample_pipeline_post(&pipeline);
+		while (k_msgq_get(&report_q, &event, K_NO_WAIT) == 0) {
+			if (event.id == EVENT_TEMP_REACHED) {
+				zassert_equal(event.payload.s32, 40);
+				reached++;
+			}
+		}
+		count -= n;
+	}
+	return reached;
+}
+
+ZTEST(sample_pipeline_suite, test_threshold_posted_once_with_hysteresis)
+{
+	int reached = 0;
+
+	temp_pipeline();
+
+	// Heating through 40 C, then hovering around it, 1000 samples a degree
+	for (int celsius = 30; celsius <= 45; celsius++) {
+		reached += feed(celsius, 1000);
+	}
+	for (int i = 0; i < 10; i++) {
+		reached += feed(i % 2 ? 41 : 39, 1000);
+	}
+	zassert_equal(reached, 1, "Reached %d times", reached);
+
+	// Below the hysteresis, then back up: a second time
+	reached += feed(37, 1000);
+	reached += feed(40, 1000);
+	zassert_equal(reached, 2, "Reached %d times", reached);
+
+	sample_pipeline_stats_t stats;
+
+	sample_pipeline_get_stats(&pipeline, &stats);
+	zassert_equal(stats.failed, 0);
+	zassert_equal(stats.dropped, 0);
+}
+
+ZTEST(sample_pipeline_suite, test_bad_configuration)
+{
+	struct sample_pipeline_config config = {
+		.filter = SAMPLE_FILTER_MOVING_AVERAGE,
+		.filter_param = 12,
+		.decimation = 10,
+		.report_event = EVENT_MOTOR_SPEED_REPORT,
+		.threshold_event = SAMPLE_PIPELINE_NO_EVENT,
+	};
+
+	zassert_equal(sample_pipeline_init(&pipeline, &config), -EINVAL, "Not a power of two");
+	config.filter_param = 64;
+	zassert_equal(sample_pipeline_init(&pipeline, &config), -EINVAL, "Window too long");
+	config.filter_param = 8;
+	zassert_ok(sample_pipeline_init(&pipeline, &config));
+
+	config.decimation = 0;
+	zassert_equal(sample_pipeline_init(&pipeline, &config), -EINVAL);
+	config.decimation = 10;
+	config.report_event = EVENT_ID_COUNT + 1;
+	zassert_equal(sample_pipeline_init(&pipeline, &config), -EINVAL);
+
+	zassert_equal(sample_filter_init(&filter, SAMPLE_FILTER_MEDIAN, 4), -EINVAL);
+	zassert_equal(sample_filter_init(&filter, SAMPLE_FILTER_IIR, 0), -EINVAL);
+	zassert_equal(sample_filter_init(&filter, SAMPLE_FILTER_IIR, 16), -EINVAL);
+}
+
+ZTEST_SUITE(sample_pipeline_suite, NULL, sample_pipeline_suite_setup, sample_pipeline_before, NULL,
+	    NULL);
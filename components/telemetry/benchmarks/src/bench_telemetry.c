@@ -0,0 +1,150 @@
+#include <zephyr/ztest.h>
+#include <zephyr/kernel.h>
+#include <stdio.h>
+#include "telemetry_codec.h"
+
+#define BENCH_EVENTS 4096
+#define BENCH_ROUNDS 20
+
+static app_event_t events[BENCH_EVENTS];
+static app_event_t decoded[CONFIG_TELEMETRY_BLOCK_SIZE];
+static uint8_t stream[BENCH_EVENTS * TELEMETRY_MAX_EVENT_SIZE];
+static size_t stream_len;
+
+// Sensor reports every 100 ms with a little noise, as the plant posts them
+static void make_sensor_events(void)
+{
+	const uint32_t period = sys_clock_hw_cycles_per_sec() / 10;
+	const event_id_t ids[] = {
+		EVENT_MOTOR_SPEED_REPORT, EVENT_HEATER_TEMP_CHANGED, EVENT_WATER_LEVEL_CHANGED,
+	};
+	uint32_t seed = 1;
+	uint32_t timestamp = 0;
+
+	for (int i = 0; i < BENCH_EVENTS; i++) {
+		seed = seed * 1664525u + 1013904223u;
+		timestamp += period / ARRAY_SIZE(ids) + (seed >> 24);
+		events[i] = (app_event_t){
+			.id = ids[i % ARRAY_SIZE(ids)],
+			.seq = 1 + i,
+			.timestamp = timestamp,
+			.payload.s32 = 100 * (i % ARRAY_SIZE(ids)) + (int32_t)(seed >> 29),
+		};
+	}
+}
+
+// Unrelated IDs, sequence gaps and random payloads: nothing to exploit
+static void make_random_events(void)
+{
+	uint32_t seed = 7;
+	uint32_t seq = 1;
+	uint32_t timestamp = 0;
+
+	for (int i = 0; i < BENCH_EVENTS; i++) {
+		seed = seed * 1664525u + 1013904223u;
+		seq += 1 + (seed >> 28);
+		timestamp += seed >> 12;
+		events[i] = (app_event_t){
+			.id = (event_id_t)(seed % EVENT_ID_COUNT),
+			.seq = seq,
+			.timestamp = timestamp,
+			.payload.u32 = seed * 2654435761u,
+		};
+	}
+}
+
+static size_t text_bytes(void)
+{
+	size_t len = 0;
+	char line[96];
+
+	for (int i = 0; i < BENCH_EVENTS; i++) {
+		len += snprintf(line, sizeof(line),
+				"[00:00:00.000,000] <inf> telemetry: id=%u seq=%u payload=%d\r\n",
+				events[i].id, events[i].seq, events[i].payload.s32);
+	}
+	return len;
+}
+
+static void encode_all(void)
+{
+	struct telemetry_encoder enc;
+	uint8_t *block = stream;
+
+	stream_len = 0;
+	telemetry_encoder_start(&enc, block, CONFIG_TELEMETRY_BLOCK_SIZE);
+	for (int i = 0; i < BENCH_EVENTS; i++) {
+		if (!telemetry_encoder_add(&enc, &events[i])) {
+			stream_len += telemetry_encoder_finish(&enc);
+			block = &stream[stream_len];
+			telemetry_encoder_start(&enc, block, CONFIG_TELEMETRY_BLOCK_SIZE);
+			telemetry_encoder_add(&enc, &events[i]);
+		}
+	}
+	stream_len += telemetry_encoder_finish(&enc);
+}
+
+static void decode_all(void)
+{
+	size_t off = 0;
+
+	while (off < stream_len) {
+		size_t block_len;
+		int n = telemetry_decode_block(&stream[off], stream_len - off, decoded,
+					       ARRAY_SIZE(decoded), &block_len);
+
+		zassert_true(n > 0, "Block at %zu does not decode (%d)", off, n);
+		off += block_len;
+	}
+}
+
+static void bench_stream(const char *name)
+{
+	uint32_t start, encode_cycles, decode_cycles;
+	const size_t text = text_bytes();
+
+	start = k_cycle_get_32();
+	for (int i = 0; i < BENCH_ROUNDS; i++) {
+		encode_all();
+	}
+	encode_cycles = k_cycle_get_32() - start;
+
+	start = k_cycle_get_32();
+	for (int i = 0; i < BENCH_ROUNDS; i++) {
+		decode_all();
+	}
+	decode_cycles = k_cycle_get_32() - start;
+
+	TC_PRINT("%s, %d events in %u byte blocks\n", name, BENCH_EVENTS,
+		 CONFIG_TELEMETRY_BLOCK_SIZE);
+	TC_PRINT("  %-16s %zu.%02zu\n", "bytes per event:", stream_len / BENCH_EVENTS,
+		 stream_len * 100 / BENCH_EVENTS % 100);
+	TC_PRINT("  %-16s %zu.%01zux smaller than text, %zu.%01zux than app_event_t\n", "",
+		 text / stream_len, text * 10 / stream_len % 10,
+		 BENCH_EVENTS * sizeof(app_event_t) / stream_len,
+		 BENCH_EVENTS * sizeof(app_event_t) * 10 / stream_len % 10);
+	TC_PRINT("  %-16s %u ns/event\n", "encode:",
+		 (uint32_t)(k_cyc_to_ns_floor64(encode_cycles) / (BENCH_ROUNDS * BENCH_EVENTS)));
+	TC_PRINT("  %-16s %u ns/event\n", "decode:",
+		 (uint32_t)(k_cyc_to_ns_floor64(decode_cycles) / (BENCH_ROUNDS * BENCH_EVENTS)));
+}
+
+/**
+ * @brief Size and speed of the encoding for a typical sensor stream.
+ */
+ZTEST(telemetry_bench_suite, test_sensor_stream)
+{
+	make_sensor_events();
+	bench_stream("sensor stream");
+}
+
+/**
+ * @brief The same for events with nothing in common, the worst case.
+ */
+ZTEST(telemetry_bench_suite, test_random_stream)
+{
+	make_random_events();
+	bench_stream("random stream");
+}
+
+ZTEST_SUITE(telemetry_bench_suite, NULL, NULL, NULL, NULL, NULL);
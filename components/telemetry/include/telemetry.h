@@ -0,0 +1,92 @@
+#pragma once
+
+#include "event_defs.h"
+#include <zephyr/kernel.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @file telemetry.h
+ * @brief Compact stream of selected event bus events, for offline analysis.
+ *
+ * Subscribed events are queued without blocking the publisher and encoded
+ * by the telemetry thread into blocks, see telemetry_codec.h. A finished
+ * block goes to a second, writer thread while the next one fills, so a
+ * slow sink delays neither the bus nor the encoder until both blocks are
+ * in use.
+ */
+
+/**
+ * @brief Writes one chunk of the stream.
+ *
+ * Called from the writer thread only, with the file header first and then
+ * one whole block per call.
+ *
+ * @return 0 on success, or a negative error code.
+ */
+typedef int (*telemetry_write_t)(const void *data, size_t len, void *user_data);
+
+/**
+ * @brief Telemetry counters, see telemetry_get_stats().
+ */
+typedef struct {
+    uint32_t events;         // Events encoded
+    uint32_t dropped;        // Events lost because the intake queue was full, bus drops included
+    uint32_t blocks;         // Blocks written
+    uint32_t bytes;          // Bytes written, file header included
+    uint32_t stalls;         // Times the encoder waited for the writer
+    uint32_t write_errors;   // Failed writes, their blocks are lost
+} telemetry_stats_t;
+
+/**
+ * @brief Writes the file header and starts streaming @p events.
+ *
+ * The event bus must already be initialized.
+ *
+ * @param events Event IDs to stream.
+ * @param num_events Number of entries in @p events.
+ * @param write Sink for the encoded stream.
+ * @param user_data Passed to @p write.
+ * @return 0 on success, -EALREADY if already started, the error of the
+ *         header write or of the subscription.
+ */
+int telemetry_init(const event_id_t *events, size_t num_events, telemetry_write_t write,
+                   void *user_data);
+
+#if defined(CONFIG_TELEMETRY_HOST_FILE)
+/**
+ * @brief telemetry_init() with a file on the host as the sink.
+ *
+ * native_sim only. The file is created, or truncated, relative to the
+ * directory the simulator was started from.
+ *
+ * @return 0 on success, the host's negative errno if the file cannot be
+ *         opened, or the error of telemetry_init().
+ */
+int telemetry_init_host_file(const char *path, const event_id_t *events, size_t num_events);
+#endif
+
+/**
+ * @brief Queues an event for the stream without blocking.
+ *
+ * Bus events do not come through here: the intake queue is a bus queue
+ * sink, which drops and counts the same way. It is ISR safe.
+ *
+ * @return 0 on success, -ENOSPC if the intake queue is full (the event is
+ *         dropped and counted), -EINVAL for an invalid event.
+ */
+int telemetry_append(const app_event_t *event);
+
+/**
+ * @brief Writes everything queued so far, including a partial block,
+ * before returning.
+ *
+ * @return 0 on success, -ENODEV if not started, or the first write error
+ *         since the previous flush.
+ */
+int telemetry_flush(void);
+
+/**
+ * @brief Copies the telemetry counters.
+ */
+void telemetry_get_stats(telemetry_stats_t *stats);
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "event_defs.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/**
+ * @file telemetry_codec.h
+ * @brief Encoding of the telemetry stream, shared by the sink and decoders.
+ *
+ * A stream is a file header followed by blocks. All integers are little
+ * endian.
+ *
+ * @code
+ * file:   magic:u32 | version:u16 | reserved:u16 | cycles_per_sec:u32
+ * block:  sync:u8 | version:u8 | body_len:u16 | count:u16 | crc16:u16 |
+ *         first_seq:u32 | first_timestamp:u32 | event...
+ * event:  tag:u8 | [seq delta] | timestamp delta | [payload delta]
+ * @endcode
+ *
+ * The low six bits of the tag are the event ID. Deltas are LEB128 varints,
+ * the payload delta zigzag encoded first so small negative steps stay
+ * short. Sequence numbers are implied when they follow on from the
+ * previous event; otherwise TELEMETRY_TAG_SEQ_GAP is set and the delta is
+ * stored. The payload is relative to the last payload of the same event ID
+ * in the block, and left out when unchanged (TELEMETRY_TAG_SAME_PAYLOAD).
+ *
+ * Every block starts with empty history, so any block decodes on its own
+ * and a truncated stream loses at most its last block.
+ */
+
+#define TELEMETRY_FILE_MAGIC 0x4d4c5445 // "ETLM"
+#define TELEMETRY_VERSION 1
+#define TELEMETRY_FILE_HEADER_SIZE 12
+
+#define TELEMETRY_BLOCK_SYNC 0xe7
+#define TELEMETRY_BLOCK_HEADER_SIZE 16
+// Largest encoded event: the tag and three 5 byte varints
+#define TELEMETRY_MAX_EVENT_SIZE 16
+#define TELEMETRY_MAX_BLOCK_SIZE (TELEMETRY_BLOCK_HEADER_SIZE + UINT16_MAX)
+
+#define TELEMETRY_TAG_ID_MASK 0x3f
+#define TELEMETRY_TAG_SAME_PAYLOAD 0x40
+#define TELEMETRY_TAG_SEQ_GAP 0x80
+
+BUILD_ASSERT(EVENT_ID_COUNT <= TELEMETRY_TAG_ID_MASK + 1, "Event IDs must fit in the tag");
+
+/**
+ * @brief Builds one block. Owned by a single thread.
+ */
+struct telemetry_encoder {
+    uint8_t *block;
+    size_t size;
+    size_t len;                 // Bytes used, header included
+    uint16_t count;
+    uint32_t prev_seq;
+    uint32_t prev_timestamp;
+    uint32_t last_payload[EVENT_ID_COUNT];
+};
+
+/**
+ * @brief Writes the file header to @p out, which must hold
+ * TELEMETRY_FILE_HEADER_SIZE bytes.
+ *
+ * @param cycles_per_sec Rate of the event timestamps, for the decoder.
+ * @return The number of bytes written.
+ */
+size_t telemetry_file_header(uint8_t *out, uint32_t cycles_per_sec);
+
+/**
+ * @brief Checks a file header and returns the timestamp rate from it.
+ *
+ * @return 0 on success, -EAGAIN if @p len is too short, -EINVAL if it is
+ *         not a telemetry stream of this version.
+ */
+int telemetry_parse_file_header(const uint8_t *data, size_t len, uint32_t *cycles_per_sec);
+
+/**
+ * @brief Starts an empty block in @p block.
+ *
+ * @param size Size of @p block, at least TELEMETRY_BLOCK_HEADER_SIZE +
+ *             TELEMETRY_MAX_EVENT_SIZE and at most TELEMETRY_MAX_BLOCK_SIZE.
+ */
+void telemetry_encoder_start(struct telemetry_encoder *enc, uint8_t *block, size_t size);
+
+/**
+ * @brief Appends @p event to the block.
+ *
+ * @return false if the block is full; the event was not added.
+ */
+bool telemetry_encoder_add(struct telemetry_encoder *enc, const app_event_t *event);
+
+/**
+ * @brief Fills in the block header.
+ *
+ * The encoder must be started again before it takes more events.
+ *
+ * @return The length of the finished block, 0 if it holds no events.
+ */
+size_t telemetry_encoder_finish(struct telemetry_encoder *enc);
+
+/**
+ * @brief Decodes the block at the start of @p data.
+ *
+ * @c sender_tid is always NULL in the decoded events.
+ *
+ * @param block_len Set to the length of the block, to find the next one.
+ * @return The number of events decoded, -EAGAIN if @p len does not hold
+ *         the whole block, -EINVAL if @p data does not start with a block
+ *         of this version, -EBADMSG if the block is corrupt, -ENOSPC if
+ *         @p max_events is too small.
+ */
+int telemetry_decode_block(const uint8_t *data, size_t len, app_event_t *events,
+                           size_t max_events, size_t *block_len);
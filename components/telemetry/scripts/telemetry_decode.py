@@ -0,0 +1,174 @@
+#!/usr/bin/env python3
+"""Decodes a telemetry stream written by the telemetry component.
+
+Prints one CSV line per event: time in seconds, bus sequence number, event
+name and payload. The format is described in include/telemetry_codec.h.
+
+Usage: telemetry_decode.py telemetry.bin [--events event_defs.h] [--float ID...]
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+FILE_MAGIC = 0x4D4C5445  # "ETLM"
+VERSION = 1
+FILE_HEADER = struct.Struct("<IHHI")
+BLOCK_SYNC = 0xE7
+BLOCK_HEADER = struct.Struct("<BBHHHII")
+
+TAG_ID_MASK = 0x3F
+TAG_SAME_PAYLOAD = 0x40
+TAG_SEQ_GAP = 0x80
+
+DEFAULT_EVENTS = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                              "../../event_bus/include/event_defs.h")
+
+
+class CorruptBlock(Exception):
+    pass
+
+
+def crc16_ccitt(data, seed=0xFFFF):
+    """Zephyr's crc16_ccitt(): reflected polynomial 0x8408."""
+    for byte in data:
+        e = (seed ^ byte) & 0xFF
+        f = (e ^ (e << 4)) & 0xFF
+        seed = (seed >> 8) ^ (f << 8) ^ (f << 3) ^ (f >> 4)
+    return seed & 0xFFFF
+
+
+def event_names(path):
+    """Event names in enum order, from the event_id_t enum in event_defs.h."""
+    try:
+        with open(path, encoding="utf-8") as f:
+            text = f.read()
+    except OSError:
+        return []
+    enum = re.search(r"typedef enum\s*{(.*?)}\s*event_id_t;", text, re.S)
+    if not enum:
+        return []
+    body = re.sub(r"//[^\n]*|/\*.*?\*/", "", enum.group(1), flags=re.S)
+    return [m.group(1) for m in re.finditer(r"\b([A-Z][A-Z0-9_]*)\b\s*(?:=\s*\d+\s*)?(?:,|$)", body)]
+
+
+def varint(data, pos, end):
+    result = 0
+    for shift in range(0, 35, 7):
+        if pos >= end:
+            raise CorruptBlock("varint runs past the block")
+        byte = data[pos]
+        pos += 1
+        result |= (byte & 0x7F) << shift
+        if not byte & 0x80:
+            return result & 0xFFFFFFFF, pos
+    raise CorruptBlock("varint too long")
+
+
+def zigzag(value):
+    return (value >> 1) ^ -(value & 1)
+
+
+def decode_block(data, pos):
+    """Returns (events, next position). Events are (id, seq, timestamp, payload)."""
+    sync, version, body_len, count, crc, seq, timestamp = BLOCK_HEADER.unpack_from(data, pos)
+    if sync != BLOCK_SYNC or version != VERSION:
+        raise CorruptBlock("no block header")
+    start = pos + BLOCK_HEADER.size
+    end = start + body_len
+    if end > len(data):
+        raise CorruptBlock("truncated block")
+    if crc16_ccitt(data[start:end]) != crc:
+        raise CorruptBlock("CRC mismatch")
+
+    last_payload = {}
+    events = []
+    seq = (seq - 1) & 0xFFFFFFFF
+    pos = start
+    for _ in range(count):
+        if pos >= end:
+            raise CorruptBlock("fewer events than the header says")
+        tag = data[pos]
+        pos += 1
+        event_id = tag & TAG_ID_MASK
+        if tag & TAG_SEQ_GAP:
+            delta, pos = varint(data, pos, end)
+        else:
+            delta = 1
+        seq = (seq + delta) & 0xFFFFFFFF
+        delta, pos = varint(data, pos, end)
+        timestamp = (timestamp + delta) & 0xFFFFFFFF
+        payload = last_payload.get(event_id, 0)
+        if not tag & TAG_SAME_PAYLOAD:
+            delta, pos = varint(data, pos, end)
+            payload = (payload + zigzag(delta)) & 0xFFFFFFFF
+        last_payload[event_id] = payload
+        events.append((event_id, seq, timestamp, payload))
+    if pos != end:
+        raise CorruptBlock("trailing bytes")
+    return events, end
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("stream", help="file written by telemetry_init_host_file()")
+    parser.add_argument("--events", default=DEFAULT_EVENTS,
+                        help="event_defs.h to take the event names from")
+    parser.add_argument("--float", nargs="*", default=[], metavar="ID",
+                        help="event names whose payload is a float")
+    args = parser.parse_args()
+
+    with open(args.stream, "rb") as f:
+        data = f.read()
+    if len(data) < FILE_HEADER.size:
+        sys.exit("%s: too short for a telemetry stream" % args.stream)
+    magic, version, _, cycles_per_sec = FILE_HEADER.unpack_from(data)
+    if magic != FILE_MAGIC or version != VERSION:
+        sys.exit("%s: not a version %d telemetry stream" % (args.stream, VERSION))
+
+    names = event_names(args.events)
+    floats = set(args.float)
+    out = sys.stdout
+    out.write("time_s,seq,event,payload\n")
+
+    # Timestamps are 32 bit cycle counts. Unwrap them into a running time,
+    # assuming consecutive events are less than one wrap apart.
+    elapsed = 0
+    prev = None
+    events = blocks = skipped = 0
+    pos = FILE_HEADER.size
+    while pos + BLOCK_HEADER.size <= len(data):
+        try:
+            block, pos = decode_block(data, pos)
+        except CorruptBlock as err:
+            # Resynchronize on the next sync byte.
+            print("offset %d: %s, skipping" % (pos, err), file=sys.stderr)
+            skipped += 1
+            pos = data.find(bytes([BLOCK_SYNC]), pos + 1)
+            if pos < 0:
+                break
+            continue
+        blocks += 1
+        for event_id, seq, timestamp, payload in block:
+            if prev is not None:
+                elapsed += (timestamp - prev) & 0xFFFFFFFF
+            prev = timestamp
+            name = names[event_id] if event_id < len(names) else str(event_id)
+            if name in floats:
+                value = "%g" % struct.unpack("<f", struct.pack("<I", payload))[0]
+            else:
+                value = str(struct.unpack("<i", struct.pack("<I", payload))[0])
+            out.write("%.6f,%u,%s,%s\n" % (elapsed / cycles_per_sec, seq, name, value))
+            events += 1
+
+    if events:
+        print("%d events in %d blocks, %d bytes, %.2f bytes per event%s" %
+              (events, blocks, len(data), len(data) / events,
+               ", %d corrupt blocks skipped" % skipped if skipped else ""),
+              file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,236 @@
+#include "telemetry.h"
+#include "telemetry_codec.h"
+#include "event_bus.h"
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_REGISTER(telemetry, CONFIG_LOG_DEFAULT_LEVEL);
+
+BUILD_ASSERT(CONFIG_TELEMETRY_BLOCK_SIZE >= TELEMETRY_BLOCK_HEADER_SIZE + TELEMETRY_MAX_EVENT_SIZE &&
+             CONFIG_TELEMETRY_BLOCK_SIZE <= TELEMETRY_MAX_BLOCK_SIZE,
+             "Telemetry block size out of range");
+
+// Flush requests travel through the intake queue behind the events they
+// must follow, marked with this otherwise invalid event ID.
+#define TELEMETRY_REQUEST_ID EVENT_ID_COUNT
+
+// A block handed from the encoder to the writer.
+struct sealed_block {
+    uint16_t index;     // Into blocks[]
+    uint16_t len;       // 0 for a request with nothing to write
+    bool request;       // Signal request_done once written
+};
+
+K_MSGQ_DEFINE(telemetry_q, sizeof(app_event_t), CONFIG_TELEMETRY_QUEUE_DEPTH, 4);
+K_MSGQ_DEFINE(writer_q, sizeof(struct sealed_block), 1, 4);
+K_THREAD_STACK_DEFINE(encoder_stack_area, CONFIG_TELEMETRY_THREAD_STACK_SIZE);
+K_THREAD_STACK_DEFINE(writer_stack_area, CONFIG_TELEMETRY_WRITER_STACK_SIZE);
+static struct k_thread encoder_thread_data;
+static struct k_thread writer_thread_data;
+static k_tid_t encoder_tid;
+
+// The encoder fills one block while the writer drains the other. The
+// semaphore is given when the block not being filled is free again.
+static uint8_t blocks[2][CONFIG_TELEMETRY_BLOCK_SIZE];
+static K_SEM_DEFINE(block_free, 1, 1);
+
+// Encoder thread only
+static struct telemetry_encoder encoder;
+static uint16_t active;
+static int64_t flush_deadline;
+
+static telemetry_write_t sink_write;
+static void *sink_user_data;
+
+// request_lock serializes the callers of telemetry_flush().
+static K_MUTEX_DEFINE(request_lock);
+static K_SEM_DEFINE(request_done, 0, 1);
+static int request_result;
+
+static atomic_t stat_events;
+static atomic_t stat_dropped;
+static atomic_t stat_blocks;
+static atomic_t stat_bytes;
+static atomic_t stat_stalls;
+static atomic_t stat_write_errors;
+
+// Hands the current block to the writer and starts on the other one. Waits
+// while the writer still holds the other block; the intake queue absorbs
+// the events that arrive meanwhile.
+static void seal_block(bool request)
+{
+    const struct sealed_block sealed = {
+        .index = active,
+        .len = telemetry_encoder_finish(&encoder),
+        .request = request,
+    };
+
+    if (sealed.len == 0 && !request) return;
+
+    if (k_sem_take(&block_free, K_NO_WAIT) != 0) {
+        atomic_inc(&stat_stalls);
+        k_sem_take(&block_free, K_FOREVER);
+    }
+    // Cannot wait: only the holder of block_free puts.
+    (void)k_msgq_put(&writer_q, &sealed, K_FOREVER);
+
+    active ^= 1;
+    telemetry_encoder_start(&encoder, blocks[active], sizeof(blocks[active]));
+}
+
+static void encode_event(const app_event_t *event)
+{
+    if (!telemetry_encoder_add(&encoder, event)) {
+        seal_block(false);
+        // An empty block always has room.
+        (void)telemetry_encoder_add(&encoder, event);
+    }
+    if (encoder.count == 1) {
+        flush_deadline = k_uptime_get() + CONFIG_TELEMETRY_FLUSH_INTERVAL_MS;
+    }
+    atomic_inc(&stat_events);
+}
+
+static void encoder_thread(void *p1, void *p2, void *p3)
+{
+    ARG_UNUSED(p1); ARG_UNUSED(p2); ARG_UNUSED(p3);
+    app_event_t event;
+
+    while (1) {
+        k_timeout_t timeout = K_FOREVER;
+
+        if (encoder.count > 0) {
+            timeout = K_MSEC(MAX(flush_deadline - k_uptime_get(), 0));
+        }
+        if (k_msgq_get(&telemetry_q, &event, timeout) != 0) {
+            // The oldest event in the block has waited long enough.
+            seal_block(false);
+        } else if (event.id == TELEMETRY_REQUEST_ID) {
+            seal_block(true);
+        } else {
+            encode_event(&event);
+        }
+    }
+}
+
+static void writer_thread(void *p1, void *p2, void *p3)
+{
+    ARG_UNUSED(p1); ARG_UNUSED(p2); ARG_UNUSED(p3);
+    struct sealed_block sealed;
+    int error = 0;  // First failure since the last request
+
+    while (1) {
+        k_msgq_get(&writer_q, &sealed, K_FOREVER);
+
+        if (sealed.len > 0) {
+            int ret = sink_write(blocks[sealed.index], sealed.len, sink_user_data);
+
+            if (ret) {
+                LOG_ERR("Failed to write a %u byte telemetry block (%d)", sealed.len, ret);
+                atomic_inc(&stat_write_errors);
+                if (error == 0) error = ret;
+            } else {
+                atomic_inc(&stat_blocks);
+                atomic_add(&stat_bytes, sealed.len);
+            }
+        }
+        k_sem_give(&block_free);
+
+        if (sealed.request) {
+            request_result = error;
+            error = 0;
+            k_sem_give(&request_done);
+        }
+    }
+}
+
+int telemetry_append(const app_event_t *event)
+{
+    if (!event || event->id >= EVENT_ID_COUNT) return -EINVAL;
+
+    if (k_msgq_put(&telemetry_q, event, K_NO_WAIT) != 0) {
+        atomic_inc(&stat_dropped);
+        return -ENOSPC;
+    }
+    return 0;
+}
+
+int telemetry_flush(void)
+{
+    const app_event_t marker = { .id = TELEMETRY_REQUEST_ID };
+    int ret;
+
+    if (!encoder_tid) return -ENODEV;
+
+    k_mutex_lock(&request_lock, K_FOREVER);
+    ret = k_msgq_put(&telemetry_q, &marker, K_FOREVER);
+    if (ret == 0) {
+        k_sem_take(&request_done, K_FOREVER);
+        ret = request_result;
+    }
+    k_mutex_unlock(&request_lock);
+    return ret;
+}
+
+void telemetry_get_stats(telemetry_stats_t *out)
+{
+    event_bus_sink_stats_t sink;
+
+    out->events = atomic_get(&stat_events);
+    out->dropped = atomic_get(&stat_dropped);
+    if (event_bus_get_sink_stats(&telemetry_q, &sink) == 0) {
+        out->dropped += sink.dropped;
+    }
+    out->blocks = atomic_get(&stat_blocks);
+    out->bytes = atomic_get(&stat_bytes);
+    out->stalls = atomic_get(&stat_stalls);
+    out->write_errors = atomic_get(&stat_write_errors);
+}
+
+int telemetry_init(const event_id_t *events, size_t num_events, telemetry_write_t write,
+                   void *user_data)
+{
+    uint8_t header[TELEMETRY_FILE_HEADER_SIZE];
+    int ret;
+
+    if (!events || num_events == 0 || !write) return -EINVAL;
+    if (encoder_tid) return -EALREADY;
+
+    sink_write = write;
+    sink_user_data = user_data;
+
+    // Timestamps are k_cycle_get_32() values, the decoder needs their rate.
+    const size_t header_len = telemetry_file_header(header, sys_clock_hw_cycles_per_sec());
+
+    ret = write(header, header_len, user_data);
+    if (ret) {
+        LOG_ERR("Failed to write the telemetry header (%d)", ret);
+        return ret;
+    }
+    atomic_set(&stat_bytes, header_len);
+
+    active = 0;
+    telemetry_encoder_start(&encoder, blocks[active], sizeof(blocks[active]));
+
+    // The writer is the lowest of the two, so it runs when nothing else
+    // wants the CPU and a slow sink only ever holds up the spare block.
+    k_thread_create(&writer_thread_data, writer_stack_area,
+                    K_THREAD_STACK_SIZEOF(writer_stack_area),
+                    writer_thread, NULL, NULL, NULL,
+                    CONFIG_TELEMETRY_WRITER_PRIORITY, 0, K_NO_WAIT);
+    k_thread_name_set(&writer_thread_data, "telemetry_writer");
+
+    encoder_tid = k_thread_create(&encoder_thread_data, encoder_stack_area,
+                                  K_THREAD_STACK_SIZEOF(encoder_stack_area),
+                                  encoder_thread, NULL, NULL, NULL,
+                                  CONFIG_TELEMETRY_THREAD_PRIORITY, 0, K_NO_WAIT);
+    k_thread_name_set(encoder_tid, "telemetry");
+
+    // Events skip the callback work item, and the bus drops rather than
+    // waits when the encoder falls behind.
+    ret = event_bus_register_queue_sink(&telemetry_q, events, num_events, NULL);
+    if (ret) {
+        LOG_ERR("Failed to subscribe the telemetry sink (%d)", ret);
+    }
+    return ret;
+}
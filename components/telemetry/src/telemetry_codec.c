@@ -0,0 +1,194 @@
+#include "telemetry_codec.h"
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/crc.h>
+#include <errno.h>
+#include <string.h>
+
+// Block header layout
+#define OFF_SYNC 0
+#define OFF_VERSION 1
+#define OFF_BODY_LEN 2
+#define OFF_COUNT 4
+#define OFF_CRC 6
+#define OFF_FIRST_SEQ 8
+#define OFF_FIRST_TIMESTAMP 12
+
+static inline uint32_t zigzag_encode(int32_t v)
+{
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static inline int32_t zigzag_decode(uint32_t v)
+{
+    return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+}
+
+static uint8_t *put_varint(uint8_t *p, uint32_t v)
+{
+    while (v >= 0x80) {
+        *p++ = (uint8_t)v | 0x80;
+        v >>= 7;
+    }
+    *p++ = (uint8_t)v;
+    return p;
+}
+
+// Returns NULL if the varint runs past @p end or is longer than 32 bits.
+static const uint8_t *get_varint(const uint8_t *p, const uint8_t *end, uint32_t *v)
+{
+    uint32_t result = 0;
+
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (p == end) return NULL;
+        const uint8_t byte = *p++;
+
+        result |= (uint32_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            *v = result;
+            return p;
+        }
+    }
+    return NULL;
+}
+
+size_t telemetry_file_header(uint8_t *out, uint32_t cycles_per_sec)
+{
+    sys_put_le32(TELEMETRY_FILE_MAGIC, &out[0]);
+    sys_put_le16(TELEMETRY_VERSION, &out[4]);
+    sys_put_le16(0, &out[6]);
+    sys_put_le32(cycles_per_sec, &out[8]);
+    return TELEMETRY_FILE_HEADER_SIZE;
+}
+
+int telemetry_parse_file_header(const uint8_t *data, size_t len, uint32_t *cycles_per_sec)
+{
+    if (len < TELEMETRY_FILE_HEADER_SIZE) return -EAGAIN;
+    if (sys_get_le32(&data[0]) != TELEMETRY_FILE_MAGIC ||
+        sys_get_le16(&data[4]) != TELEMETRY_VERSION) {
+        return -EINVAL;
+    }
+    *cycles_per_sec = sys_get_le32(&data[8]);
+    return 0;
+}
+
+void telemetry_encoder_start(struct telemetry_encoder *enc, uint8_t *block, size_t size)
+{
+    enc->block = block;
+    enc->size = MIN(size, TELEMETRY_MAX_BLOCK_SIZE);
+    enc->len = TELEMETRY_BLOCK_HEADER_SIZE;
+    enc->count = 0;
+    memset(enc->last_payload, 0, sizeof(enc->last_payload));
+}
+
+bool telemetry_encoder_add(struct telemetry_encoder *enc, const app_event_t *event)
+{
+    if (enc->size - enc->len < TELEMETRY_MAX_EVENT_SIZE || enc->count == UINT16_MAX) {
+        return false;
+    }
+
+    if (enc->count == 0) {
+        // The first event is stored relative to the header.
+        sys_put_le32(event->seq, &enc->block[OFF_FIRST_SEQ]);
+        sys_put_le32(event->timestamp, &enc->block[OFF_FIRST_TIMESTAMP]);
+        enc->prev_seq = event->seq - 1;
+        enc->prev_timestamp = event->timestamp;
+    }
+
+    const uint32_t seq_delta = event->seq - enc->prev_seq;
+    const uint32_t payload = event->payload.u32;
+    uint8_t *p = &enc->block[enc->len];
+    uint8_t *tag = p++;
+
+    *tag = (uint8_t)event->id;
+    if (seq_delta != 1) {
+        *tag |= TELEMETRY_TAG_SEQ_GAP;
+        p = put_varint(p, seq_delta);
+    }
+    p = put_varint(p, event->timestamp - enc->prev_timestamp);
+    if (payload == enc->last_payload[event->id]) {
+        *tag |= TELEMETRY_TAG_SAME_PAYLOAD;
+    } else {
+        p = put_varint(p, zigzag_encode((int32_t)(payload - enc->last_payload[event->id])));
+    }
+
+    enc->last_payload[event->id] = payload;
+    enc->prev_seq = event->seq;
+    enc->prev_timestamp = event->timestamp;
+    enc->len = p - enc->block;
+    enc->count++;
+    return true;
+}
+
+size_t telemetry_encoder_finish(struct telemetry_encoder *enc)
+{
+    uint8_t *header = enc->block;
+    const size_t body_len = enc->len - TELEMETRY_BLOCK_HEADER_SIZE;
+
+    if (enc->count == 0) return 0;
+
+    header[OFF_SYNC] = TELEMETRY_BLOCK_SYNC;
+    header[OFF_VERSION] = TELEMETRY_VERSION;
+    sys_put_le16(body_len, &header[OFF_BODY_LEN]);
+    sys_put_le16(enc->count, &header[OFF_COUNT]);
+    sys_put_le16(crc16_ccitt(0xffff, &header[TELEMETRY_BLOCK_HEADER_SIZE], body_len),
+                 &header[OFF_CRC]);
+    return enc->len;
+}
+
+int telemetry_decode_block(const uint8_t *data, size_t len, app_event_t *events,
+                           size_t max_events, size_t *block_len)
+{
+    uint32_t last_payload[EVENT_ID_COUNT] = { 0 };
+
+    if (len < TELEMETRY_BLOCK_HEADER_SIZE) return -EAGAIN;
+    if (data[OFF_SYNC] != TELEMETRY_BLOCK_SYNC || data[OFF_VERSION] != TELEMETRY_VERSION) {
+        return -EINVAL;
+    }
+
+    const size_t body_len = sys_get_le16(&data[OFF_BODY_LEN]);
+    const size_t count = sys_get_le16(&data[OFF_COUNT]);
+    const uint8_t *p = &data[TELEMETRY_BLOCK_HEADER_SIZE];
+    const uint8_t *end = p + body_len;
+
+    if (len < TELEMETRY_BLOCK_HEADER_SIZE + body_len) return -EAGAIN;
+    if (sys_get_le16(&data[OFF_CRC]) != crc16_ccitt(0xffff, p, body_len)) return -EBADMSG;
+    if (count > max_events) return -ENOSPC;
+
+    uint32_t seq = sys_get_le32(&data[OFF_FIRST_SEQ]) - 1;
+    uint32_t timestamp = sys_get_le32(&data[OFF_FIRST_TIMESTAMP]);
+
+    for (size_t i = 0; i < count; i++) {
+        uint32_t delta;
+
+        if (p == end) return -EBADMSG;
+        const uint8_t tag = *p++;
+        const uint8_t id = tag & TELEMETRY_TAG_ID_MASK;
+
+        if (id >= EVENT_ID_COUNT) return -EBADMSG;
+        if (tag & TELEMETRY_TAG_SEQ_GAP) {
+            p = get_varint(p, end, &delta);
+            if (!p) return -EBADMSG;
+            seq += delta;
+        } else {
+            seq++;
+        }
+        p = get_varint(p, end, &delta);
+        if (!p) return -EBADMSG;
+        timestamp += delta;
+        if (!(tag & TELEMETRY_TAG_SAME_PAYLOAD)) {
+            p = get_varint(p, end, &delta);
+            if (!p) return -EBADMSG;
+            last_payload[id] += (uint32_t)zigzag_decode(delta);
+        }
+
+        memset(&events[i], 0, sizeof(events[i]));
+        events[i].id = id;
+        events[i].seq = seq;
+        events[i].timestamp = timestamp;
+        events[i].payload.u32 = last_payload[id];
+    }
+    if (p != end) return -EBADMSG;
+
+    *block_len = TELEMETRY_BLOCK_HEADER_SIZE + body_len;
+    return count;
+}
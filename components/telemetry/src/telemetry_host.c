@@ -0,0 +1,26 @@
+#include "telemetry.h"
+#include "telemetry_host_bottom.h"
+#include <zephyr/logging/log.h>
+#include <stdint.h>
+
+LOG_MODULE_DECLARE(telemetry, CONFIG_LOG_DEFAULT_LEVEL);
+
+// Runs on the writer thread. The host write stops the whole simulated CPU
+// while it lasts, but no simulated time passes, so it costs the firmware
+// nothing.
+static int host_file_write(const void *data, size_t len, void *user_data)
+{
+    return telemetry_host_write((int)(intptr_t)user_data, data, len);
+}
+
+int telemetry_init_host_file(const char *path, const event_id_t *events, size_t num_events)
+{
+    int fd = telemetry_host_open(path);
+
+    if (fd < 0) {
+        LOG_ERR("Cannot open %s on the host (%d)", path, fd);
+        return fd;
+    }
+    LOG_INF("Telemetry stream in %s", path);
+    return telemetry_init(events, num_events, host_file_write, (void *)(intptr_t)fd);
+}
@@ -0,0 +1,28 @@
+#include "telemetry_host_bottom.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+int telemetry_host_open(const char *path)
+{
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+    return fd < 0 ? -errno : fd;
+}
+
+int telemetry_host_write(int fd, const void *data, size_t len)
+{
+    const char *p = data;
+
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -errno;
+        }
+        p += n;
+        len -= n;
+    }
+    return 0;
+}
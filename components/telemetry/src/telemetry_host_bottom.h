@@ -0,0 +1,12 @@
+#pragma once
+
+#include <stddef.h>
+
+/*
+ * Host side of the native_sim file sink. These functions are built into
+ * the native simulator runner against the host C library; the embedded
+ * side only sees these prototypes. Errors are the host's negative errno.
+ */
+
+int telemetry_host_open(const char *path);
+int telemetry_host_write(int fd, const void *data, size_t len);
@@ -0,0 +1,331 @@
+#include <zephyr/ztest.h>
+#include <zephyr/kernel.h>
+#include <stdio.h>
+#include "event_bus.h"
+#include "telemetry.h"
+#include "telemetry_codec.h"
+
+#define CAPTURE_SIZE 8192
+#define MAX_EVENTS 512
+
+static const event_id_t streamed_events[] = {
+	EVENT_MOTOR_SPEED_REPORT,
+	EVENT_HEATER_TEMP_CHANGED,
+	EVENT_WATER_LEVEL_CHANGED,
+	EVENT_FSM_STATE_CHANGED,
+};
+
+// The stream as the sink received it, file header excluded
+static uint8_t capture[CAPTURE_SIZE];
+static size_t capture_len;
+static uint8_t file_header[TELEMETRY_FILE_HEADER_SIZE];
+static size_t writes;
+static int32_t write_delay_ms;
+static int write_error;
+
+static app_event_t sent[MAX_EVENTS];
+static app_event_t decoded[MAX_EVENTS];
+
+// Runs on the writer thread.
+static int capture_write(const void *data, size_t len, void *user_data)
+{
+	ARG_UNUSED(user_data);
+
+	if (write_delay_ms > 0) {
+		k_msleep(write_delay_ms);
+	}
+	if (write_error) return write_error;
+	if (len == TELEMETRY_FILE_HEADER_SIZE && writes == 0) {
+		memcpy(file_header, data, len);
+	} else {
+		zassert_true(capture_len + len <= sizeof(capture), "Capture full");
+		memcpy(&capture[capture_len], data, len);
+		capture_len += len;
+	}
+	writes++;
+	return 0;
+}
+
+static void *telemetry_suite_setup(void)
+{
+	zassert_ok(event_bus_init(), "event_bus_init() failed");
+	zassert_ok(telemetry_init(streamed_events, ARRAY_SIZE(streamed_events), capture_write,
+				  NULL),
+		   "telemetry_init() failed");
+	return NULL;
+}
+
+static void telemetry_suite_before(void *data)
+{
+	ARG_UNUSED(data);
+	write_delay_ms = 0;
+	write_error = 0;
+	zassert_ok(telemetry_flush(), "Flush failed");
+	capture_len = 0;
+}
+
+// Decodes every block in the capture and returns the number of events.
+static size_t decode_capture(void)
+{
+	size_t off = 0;
+	size_t count = 0;
+
+	while (off < capture_len) {
+		size_t block_len;
+		int n = telemetry_decode_block(&capture[off], capture_len - off, &decoded[count],
+					       ARRAY_SIZE(decoded) - count, &block_len);
+
+		zassert_true(n > 0, "Block at %zu does not decode (%d)", off, n);
+		off += block_len;
+		count += n;
+	}
+	return count;
+}
+
+static void assert_same_events(const app_event_t *expected, const app_event_t *actual,
+			       size_t count)
+{
+	for (size_t i = 0; i < count; i++) {
+		zassert_equal(actual[i].id, expected[i].id, "Event %zu: wrong ID", i);
+		zassert_equal(actual[i].seq, expected[i].seq, "Event %zu: wrong seq", i);
+		zassert_equal(actual[i].timestamp, expected[i].timestamp,
+			      "Event %zu: wrong timestamp", i);
+		zassert_equal(actual[i].payload.u32, expected[i].payload.u32,
+			      "Event %zu: wrong payload", i);
+	}
+}
+
+// A minute of a wash: motor and temperature reports every 100 ms, a water
+// level report every 500 ms, with the noise a real sensor has.
+static size_t make_sensor_stream(app_event_t *events, size_t max)
+{
+	const uint32_t period = sys_clock_hw_cycles_per_sec() / 10;
+	uint32_t seed = 1;
+	uint32_t seq = 1000;
+	uint32_t timestamp = 0;
+	size_t n = 0;
+
+	for (int tick = 0; n + 3 <= max; tick++) {
+		seed = seed * 1664525u + 1013904223u;
+		timestamp += period + (seed >> 24) % (period / 100);
+
+		events[n++] = (app_event_t){
+			.id = EVENT_MOTOR_SPEED_REPORT, .seq = seq++, .timestamp = timestamp,
+			.payload.s32 = 800 + (int32_t)(seed >> 29) - 4,
+		};
+		events[n++] = (app_event_t){
+			.id = EVENT_HEATER_TEMP_CHANGED, .seq = seq++, .timestamp = timestamp + 40,
+			.payload.s32 = 20 + tick / 20,
+		};
+		if (tick % 5 == 0) {
+			events[n++] = (app_event_t){
+				.id = EVENT_WATER_LEVEL_CHANGED, .seq = seq++,
+				.timestamp = timestamp + 90, .payload.s32 = MIN(tick, 120),
+			};
+		}
+	}
+	return n;
+}
+
+// Appends and flushes in chunks the intake queue can take.
+static void append_all(const app_event_t *events, size_t count)
+{
+	for (size_t i = 0; i < count; i++) {
+		if (i % (CONFIG_TELEMETRY_QUEUE_DEPTH / 2) == 0) {
+			zassert_ok(telemetry_flush(), "Flush failed");
+		}
+		zassert_ok(telemetry_append(&events[i]), "Append %zu failed", i);
+	}
+	zassert_ok(telemetry_flush(), "Flush failed");
+}
+
+ZTEST(telemetry_suite, test_codec_round_trip)
+{
+	static const uint32_t payloads[] = { 0, 0, 1, 0xffffffff, 7, 0x80000000, 7, 12345678 };
+	struct telemetry_encoder enc;
+	uint8_t block[128];
+	size_t block_len;
+	size_t i = 0;
+
+	// Sequence gaps and wraparound, timestamps that wrap, payloads that
+	// repeat, jump both ways and cover the full 32 bits
+	for (i = 0; i < 40; i++) {
+		sent[i] = (app_event_t){
+			.id = (event_id_t)(i * 7 % EVENT_ID_COUNT),
+			.seq = UINT32_MAX - 20 + (i % 3 ? i : 2 * i),
+			.timestamp = UINT32_MAX - 5000 + (uint32_t)i * 300,
+			.payload.u32 = payloads[i % ARRAY_SIZE(payloads)],
+		};
+	}
+
+	i = 0;
+	while (i < 40) {
+		size_t first = i;
+
+		telemetry_encoder_start(&enc, block, sizeof(block));
+		while (i < 40 && telemetry_encoder_add(&enc, &sent[i])) {
+			i++;
+		}
+		zassert_true(i > first, "A fresh block must take an event");
+
+		size_t len = telemetry_encoder_finish(&enc);
+		int n = telemetry_decode_block(block, len, decoded, ARRAY_SIZE(decoded),
+					       &block_len);
+
+		zassert_equal(n, i - first, "Decoded %d of %zu events", n, i - first);
+		zassert_equal(block_len, len);
+		assert_same_events(&sent[first], decoded, n);
+	}
+
+	// A corrupt byte is caught, a short buffer is reported as such.
+	telemetry_encoder_start(&enc, block, sizeof(block));
+	zassert_true(telemetry_encoder_add(&enc, &sent[3]));
+	size_t len = telemetry_encoder_finish(&enc);
+
+	zassert_equal(telemetry_decode_block(block, len - 1, decoded, 1, &block_len), -EAGAIN);
+	block[len - 1] ^= 0x01;
+	zassert_equal(telemetry_decode_block(block, len, decoded, 1, &block_len), -EBADMSG);
+	block[0] = 0;
+	zassert_equal(telemetry_decode_block(block, len, decoded, 1, &block_len), -EINVAL);
+}
+
+ZTEST(telemetry_suite, test_stream_decodes_to_the_same_events)
+{
+	const size_t count = make_sensor_stream(sent, 300);
+	telemetry_stats_t before, after;
+	uint32_t cycles_per_sec;
+
+	zassert_ok(telemetry_parse_file_header(file_header, sizeof(file_header), &cycles_per_sec));
+	zassert_equal(cycles_per_sec, sys_clock_hw_cycles_per_sec());
+
+	telemetry_get_stats(&before);
+	append_all(sent, count);
+	telemetry_get_stats(&after);
+
+	zassert_equal(decode_capture(), count, "Events lost in the stream");
+	assert_same_events(sent, decoded, count);
+	zassert_equal(after.events - before.events, count);
+	zassert_equal(after.dropped, before.dropped);
+	zassert_equal(after.bytes - before.bytes, capture_len);
+}
+
+ZTEST(telemetry_suite, test_bytes_per_event_against_text_logs)
+{
+	const size_t count = make_sensor_stream(sent, MAX_EVENTS);
+	size_t text_len = 0;
+	char line[96];
+
+	// What LOG_INF() with the default timestamp would print for each event
+	for (size_t i = 0; i < count; i++) {
+		const uint32_t us = (uint64_t)sent[i].timestamp * USEC_PER_SEC /
+				    sys_clock_hw_cycles_per_sec();
+
+		text_len += snprintf(line, sizeof(line),
+				     "[00:%02u:%02u.%03u,%03u] <inf> telemetry: id=%u seq=%u "
+				     "payload=%d\r\n",
+				     us / 60000000, us / 1000000 % 60, us / 1000 % 1000, us % 1000,
+				     sent[i].id, sent[i].seq, sent[i].payload.s32);
+	}
+
+	append_all(sent, count);
+	zassert_equal(decode_capture(), count);
+
+	TC_PRINT("%zu events: %zu bytes of blocks, %zu bytes of text, %zu.%02zu bytes per event\n",
+		 count, capture_len, text_len, capture_len / count, capture_len * 100 / count % 100);
+	zassert_true(capture_len * 5 <= text_len, "Less than 5 times smaller than text logs");
+	zassert_true(capture_len <= count * sizeof(app_event_t) / 4,
+		     "Less than 4 times smaller than raw events");
+}
+
+ZTEST(telemetry_suite, test_bus_events_are_streamed)
+{
+	const app_event_t speed = { .id = EVENT_MOTOR_SPEED_REPORT, .payload.s32 = 1200 };
+	const app_event_t ignored = { .id = EVENT_DOOR_OPENED, .payload.u32 = 1 };
+
+	zassert_ok(event_bus_post(&speed), "Post failed");
+	zassert_ok(event_bus_post(&ignored), "Post failed");
+	zassert_ok(event_bus_post(&speed), "Post failed");
+	// Let the bus hand the events over before flushing.
+	k_msleep(50);
+	zassert_ok(telemetry_flush(), "Flush failed");
+
+	zassert_equal(decode_capture(), 2, "Expected only the subscribed events");
+	zassert_equal(decoded[0].payload.s32, 1200);
+	zassert_equal(decoded[1].payload.s32, 1200);
+	zassert_equal(decoded[1].seq, decoded[0].seq + 2, "Bus sequence numbers not kept");
+	zassert_true(decoded[1].timestamp - decoded[0].timestamp < sys_clock_hw_cycles_per_sec(),
+		     "Bus timestamps not kept");
+}
+
+ZTEST(telemetry_suite, test_slow_sink_does_not_hold_up_appends)
+{
+	const size_t count = make_sensor_stream(sent, CONFIG_TELEMETRY_QUEUE_DEPTH);
+	telemetry_stats_t before, after;
+	int64_t start;
+
+	telemetry_get_stats(&before);
+	write_delay_ms = 20;
+
+	// Enough for several blocks, appended while the writer sleeps in the sink
+	start = k_uptime_get();
+	for (size_t i = 0; i < count; i++) {
+		zassert_ok(telemetry_append(&sent[i]), "Append %zu failed", i);
+	}
+	zassert_true(k_uptime_get() - start < write_delay_ms, "Appends waited for the sink");
+
+	zassert_ok(telemetry_flush(), "Flush failed");
+	telemetry_get_stats(&after);
+
+	zassert_equal(decode_capture(), count);
+	assert_same_events(sent, decoded, count);
+	zassert_true(after.blocks - before.blocks > 2, "Expected several blocks");
+	zassert_true(after.stalls > before.stalls, "The encoder never waited for the writer");
+	zassert_equal(after.dropped, before.dropped);
+}
+
+ZTEST(telemetry_suite, test_full_queue_never_blocks_the_bus)
+{
+	const app_event_t event = { .id = EVENT_MOTOR_SPEED_REPORT, .payload.s32 = 900 };
+	telemetry_stats_t before, after;
+	const int extra = 4;
+
+	telemetry_get_stats(&before);
+	// The encoder cannot drain the queue meanwhile.
+	k_sched_lock();
+	for (int i = 0; i < CONFIG_TELEMETRY_QUEUE_DEPTH; i++) {
+		zassert_ok(telemetry_append(&event), "Append %d failed", i);
+	}
+	for (int i = 0; i < extra; i++) {
+		(void)event_bus_post(&event);
+	}
+	k_sched_unlock();
+	// A dispatcher thread hands the events over ahead of the encoder.
+	k_msleep(10);
+	zassert_ok(telemetry_flush(), "Flush failed");
+
+	telemetry_get_stats(&after);
+	zassert_equal(after.dropped - before.dropped, extra, "Bus waited for the encoder");
+	zassert_equal(decode_capture(), CONFIG_TELEMETRY_QUEUE_DEPTH);
+}
+
+ZTEST(telemetry_suite, test_write_errors_are_reported_once)
+{
+	const app_event_t event = {
+		.id = EVENT_HEATER_TEMP_CHANGED, .seq = 1, .payload.s32 = 60,
+	};
+	telemetry_stats_t before, after;
+
+	telemetry_get_stats(&before);
+	write_error = -EIO;
+	zassert_ok(telemetry_append(&event));
+	zassert_equal(telemetry_flush(), -EIO, "Write error not reported");
+	telemetry_get_stats(&after);
+	zassert_equal(after.write_errors - before.write_errors, 1);
+
+	write_error = 0;
+	zassert_ok(telemetry_append(&event));
+	zassert_ok(telemetry_flush(), "Error reported twice");
+	zassert_equal(decode_capture(), 1);
+}
+
+ZTEST_SUITE(telemetry_suite, NULL, telemetry_suite_setup, telemetry_suite_before, NULL, NULL);
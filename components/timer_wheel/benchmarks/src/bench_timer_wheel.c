@@ -0,0 +1,98 @@
+#include <zephyr/ztest.h>
+#include <zephyr/kernel.h>
+#include "event_bus.h"
+#include "timer_wheel.h"
+
+#define BENCH_TIMERS 10000
+// Spread the timeouts over all levels of the wheel.
+#define MAX_TIMEOUT_TICKS 100000
+
+static struct timer_wheel_timer timers[BENCH_TIMERS];
+static struct k_timer ktimers[BENCH_TIMERS];
+static uint32_t timeouts_ms[BENCH_TIMERS];
+
+static void *bench_setup(void)
+{
+	uint32_t seed = 12345;
+
+	zassert_ok(event_bus_init(), "event_bus_init() failed");
+	for (int i = 0; i < BENCH_TIMERS; i++) {
+		seed = seed * 1664525u + 1013904223u;
+		timeouts_ms[i] = (1 + (seed >> 8) % MAX_TIMEOUT_TICKS) * CONFIG_TIMER_WHEEL_TICK_MS;
+		k_timer_init(&ktimers[i], NULL, NULL);
+	}
+	return NULL;
+}
+
+static void print_rate(const char *what, uint32_t cycles, uint32_t ops)
+{
+	TC_PRINT("  %-24s %u ns/op\n", what, (uint32_t)(k_cyc_to_ns_floor64(cycles) / ops));
+}
+
+/**
+ * @brief Arm, cancel and expire cost with 10000 timers on the wheel.
+ *
+ * Expire is the cost of advancing the wheel through every timeout,
+ * cascades included, divided by the number of timers.
+ */
+ZTEST(timer_wheel_bench_suite, test_wheel)
+{
+	timer_wheel_stats_t stats;
+	uint32_t start;
+
+	zassert_ok(timer_wheel_init());
+	for (int i = 0; i < BENCH_TIMERS; i++) {
+		timer_wheel_timer_init(&timers[i], EVENT_TIMER_EXPIRED, i);
+	}
+
+	TC_PRINT("timer wheel, %d timers\n", BENCH_TIMERS);
+	start = k_cycle_get_32();
+	for (int i = 0; i < BENCH_TIMERS; i++) {
+		timer_wheel_arm(&timers[i], timeouts_ms[i]);
+	}
+	print_rate("arm:", k_cycle_get_32() - start, BENCH_TIMERS);
+
+	start = k_cycle_get_32();
+	for (int i = 0; i < BENCH_TIMERS; i++) {
+		timer_wheel_cancel(&timers[i]);
+	}
+	print_rate("cancel:", k_cycle_get_32() - start, BENCH_TIMERS);
+
+	for (int i = 0; i < BENCH_TIMERS; i++) {
+		timer_wheel_arm(&timers[i], timeouts_ms[i]);
+	}
+	start = k_cycle_get_32();
+	timer_wheel_advance(MAX_TIMEOUT_TICKS);
+	print_rate("expire:", k_cycle_get_32() - start, BENCH_TIMERS);
+
+	timer_wheel_get_stats(&stats);
+	TC_PRINT("  cascades per timer:      %u.%02u\n", stats.cascaded / BENCH_TIMERS,
+		 (stats.cascaded % BENCH_TIMERS) * 100 / BENCH_TIMERS);
+	zassert_equal(stats.expired, BENCH_TIMERS, "Timers lost");
+}
+
+/**
+ * @brief Baseline: one k_timer per timer, started and stopped.
+ *
+ * The kernel keeps its timeouts in a sorted list, so start gets slower as
+ * more timers are pending.
+ */
+ZTEST(timer_wheel_bench_suite, test_k_timer_baseline)
+{
+	uint32_t start;
+
+	TC_PRINT("k_timer baseline, %d timers\n", BENCH_TIMERS);
+	start = k_cycle_get_32();
+	for (int i = 0; i < BENCH_TIMERS; i++) {
+		k_timer_start(&ktimers[i], K_MSEC(timeouts_ms[i]), K_NO_WAIT);
+	}
+	print_rate("start:", k_cycle_get_32() - start, BENCH_TIMERS);
+
+	start = k_cycle_get_32();
+	for (int i = 0; i < BENCH_TIMERS; i++) {
+		k_timer_stop(&ktimers[i]);
+	}
+	print_rate("stop:", k_cycle_get_32() - start, BENCH_TIMERS);
+}
+
+ZTEST_SUITE(timer_wheel_bench_suite, NULL, bench_setup, NULL, NULL, NULL);
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "event_defs.h"
+#include <zephyr/kernel.h>
+#include <zephyr/sys/dlist.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief A timer on the wheel.
+ *
+ * Owned by the caller, typically embedded in a per-machine structure; the
+ * wheel only links it into a list. When it expires, @c event is posted on
+ * the event bus with @c machine as its payload. Initialize it with
+ * timer_wheel_timer_init() and leave the other fields alone.
+ */
+struct timer_wheel_timer {
+    sys_dnode_t node;
+    uint32_t expires;       // Absolute wheel tick
+    event_id_t event;
+    uint32_t machine;
+};
+
+/**
+ * @brief Wheel counters, see timer_wheel_get_stats().
+ */
+typedef struct {
+    uint32_t armed;         // Timers currently armed
+    uint32_t expired;       // Expiry events posted
+    uint32_t cancelled;     // Timers cancelled before expiring
+    uint32_t cascaded;      // Moves from a coarse level to a finer one
+} timer_wheel_stats_t;
+
+/**
+ * @brief Resets the wheel. Timers still armed are dropped.
+ *
+ * The event bus must already be initialized.
+ *
+ * @return 0 on success.
+ */
+int timer_wheel_init(void);
+
+/**
+ * @brief Prepares a timer that posts @p event for @p machine.
+ */
+void timer_wheel_timer_init(struct timer_wheel_timer *timer, event_id_t event, uint32_t machine);
+
+/**
+ * @brief Arms @p timer to expire in @p timeout_ms, re-arming it if needed.
+ *
+ * O(1) and ISR safe. The timeout is rounded up to whole ticks, with a
+ * minimum of one tick.
+ *
+ * @return 0 on success, -EINVAL for a NULL timer, -ERANGE if the timeout
+ *         exceeds 2^24 - 1 ticks, -ENODEV before timer_wheel_init().
+ */
+int timer_wheel_arm(struct timer_wheel_timer *timer, uint32_t timeout_ms);
+
+/**
+ * @brief Cancels @p timer. O(1) and ISR safe.
+ *
+ * @return 0 on success, -EALREADY if it was not armed, -EINVAL for NULL.
+ */
+int timer_wheel_cancel(struct timer_wheel_timer *timer);
+
+bool timer_wheel_is_armed(const struct timer_wheel_timer *timer);
+
+/**
+ * @brief Time left before @p timer expires, 0 if it is not armed.
+ */
+uint32_t timer_wheel_remaining_ms(const struct timer_wheel_timer *timer);
+
+/**
+ * @brief Moves the wheel forward by @p ticks, posting the events of the
+ * timers that expire on the way.
+ *
+ * With CONFIG_TIMER_WHEEL_KERNEL_TIMER the wheel's own kernel timer calls
+ * this; otherwise the application does. Must not be called concurrently
+ * with itself.
+ */
+void timer_wheel_advance(uint32_t ticks);
+
+/**
+ * @brief Ticks until the wheel next has work to do, an expiry or a
+ * cascade, or UINT32_MAX when no timer is armed.
+ *
+ * Lets a simulated clock in manual mode jump straight to the next tick
+ * that matters instead of advancing one tick at a time.
+ */
+uint32_t timer_wheel_next_event(void);
+
+/**
+ * @brief Ticks elapsed since timer_wheel_init().
+ */
+uint32_t timer_wheel_now(void);
+
+void timer_wheel_get_stats(timer_wheel_stats_t *out);
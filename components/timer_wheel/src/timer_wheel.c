@@ -0,0 +1,359 @@
+#include "timer_wheel.h"
+#include "event_bus.h"
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/math_extras.h>
+#include <string.h>
+
+LOG_MODULE_REGISTER(timer_wheel, CONFIG_LOG_DEFAULT_LEVEL);
+
+// Four levels of 64 slots. A timer due within 64 ticks sits in level 0,
+// within 64^2 ticks in level 1, and so on. When a finer level wraps, the
+// next slot of the coarser one is redistributed, so every timer moves at
+// most three times before it expires.
+#define WHEEL_LEVELS 4
+#define WHEEL_SLOT_BITS 6
+#define WHEEL_SLOTS BIT(WHEEL_SLOT_BITS)
+#define WHEEL_SLOT_MASK (WHEEL_SLOTS - 1)
+#define WHEEL_MAX_TICKS (BIT(WHEEL_LEVELS * WHEEL_SLOT_BITS) - 1)
+
+// wheel_lock protects everything below it.
+static struct k_spinlock wheel_lock;
+static sys_dlist_t wheel[WHEEL_LEVELS][WHEEL_SLOTS];
+// One bit per slot that may hold timers. Cancelling leaves the bit set;
+// wheel_first_occupied() clears it when it finds the slot empty.
+static uint64_t occupied[WHEEL_LEVELS];
+static bool wheel_ready;         // The lists have been initialized
+static uint32_t wheel_now;
+static timer_wheel_stats_t stats;
+
+#if defined(CONFIG_TIMER_WHEEL_KERNEL_TIMER)
+static void wheel_timer_expiry(struct k_timer *timer);
+static void wheel_work_handler(struct k_work *work);
+
+static K_TIMER_DEFINE(wheel_timer, wheel_timer_expiry, NULL);
+static K_WORK_DEFINE(wheel_work, wheel_work_handler);
+static bool wheel_timer_running;
+static int64_t wheel_last_ms;       // Uptime of the last whole tick
+#endif
+
+static inline uint32_t level_span(int level)
+{
+    return BIT(level * WHEEL_SLOT_BITS);
+}
+
+static void wheel_place(struct timer_wheel_timer *timer)
+{
+    const uint32_t delta = timer->expires - wheel_now;
+    int level = 0;
+
+    while (level < WHEEL_LEVELS - 1 && delta >= level_span(level + 1)) {
+        level++;
+    }
+    const uint32_t slot = (timer->expires >> (level * WHEEL_SLOT_BITS)) & WHEEL_SLOT_MASK;
+
+    sys_dlist_append(&wheel[level][slot], &timer->node);
+    occupied[level] |= BIT64(slot);
+}
+
+// Offset from slot @p from to the first occupied slot of @p level,
+// wrapping around, or WHEEL_SLOTS if the level is empty.
+static uint32_t wheel_first_occupied(int level, uint32_t from)
+{
+    while (occupied[level] != 0) {
+        const uint32_t shift = from & WHEEL_SLOT_MASK;
+        const uint64_t bits = occupied[level];
+        const uint64_t rotated = shift ? (bits >> shift) | (bits << (WHEEL_SLOTS - shift)) : bits;
+        const uint32_t offset = u64_count_trailing_zeros(rotated);
+        const uint32_t slot = (from + offset) & WHEEL_SLOT_MASK;
+
+        if (!sys_dlist_is_empty(&wheel[level][slot])) {
+            return offset;
+        }
+        occupied[level] &= ~BIT64(slot);
+    }
+    return WHEEL_SLOTS;
+}
+
+static void wheel_cascade(int level, uint32_t slot)
+{
+    sys_dnode_t *node;
+
+    // Timers always move to a finer level, never back into this list.
+    while ((node = sys_dlist_get(&wheel[level][slot])) != NULL) {
+        wheel_place(CONTAINER_OF(node, struct timer_wheel_timer, node));
+        stats.cascaded++;
+    }
+    occupied[level] &= ~BIT64(slot);
+}
+
+static void wheel_tick(void)
+{
+    wheel_now++;
+    for (int level = 1; level < WHEEL_LEVELS; level++) {
+        if ((wheel_now & (level_span(level) - 1)) != 0) {
+            break;
+        }
+        wheel_cascade(level, (wheel_now >> (level * WHEEL_SLOT_BITS)) & WHEEL_SLOT_MASK);
+    }
+}
+
+#if defined(CONFIG_TIMER_WHEEL_KERNEL_TIMER)
+static void wheel_timer_expiry(struct k_timer *timer)
+{
+    ARG_UNUSED(timer);
+    // Expiries are posted from thread context.
+    k_work_submit(&wheel_work);
+}
+
+static void wheel_work_handler(struct k_work *work)
+{
+    ARG_UNUSED(work);
+
+    // Catch up on every tick since the last run, even if the work queue
+    // was late, so timers never drift.
+    int64_t elapsed = k_uptime_get() - wheel_last_ms;
+    uint32_t ticks = elapsed / CONFIG_TIMER_WHEEL_TICK_MS;
+
+    wheel_last_ms += (int64_t)ticks * CONFIG_TIMER_WHEEL_TICK_MS;
+    timer_wheel_advance(ticks);
+
+    k_spinlock_key_t key = k_spin_lock(&wheel_lock);
+    if (stats.armed == 0 && wheel_timer_running) {
+        k_timer_stop(&wheel_timer);
+        wheel_timer_running = false;
+    }
+    k_spin_unlock(&wheel_lock, key);
+}
+
+// Called with wheel_lock held.
+static void wheel_timer_ensure_running(void)
+{
+    if (!wheel_timer_running) {
+        wheel_last_ms = k_uptime_get();
+        k_timer_start(&wheel_timer, K_MSEC(CONFIG_TIMER_WHEEL_TICK_MS),
+                      K_MSEC(CONFIG_TIMER_WHEEL_TICK_MS));
+        wheel_timer_running = true;
+    }
+}
+#endif // CONFIG_TIMER_WHEEL_KERNEL_TIMER
+
+int timer_wheel_init(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&wheel_lock);
+
+    for (int level = 0; level < WHEEL_LEVELS; level++) {
+        for (int slot = 0; slot < WHEEL_SLOTS; slot++) {
+            // Unlink leftovers so their owners see them as disarmed.
+            while (wheel_ready && sys_dlist_get(&wheel[level][slot]) != NULL) {
+            }
+            sys_dlist_init(&wheel[level][slot]);
+        }
+    }
+    wheel_now = 0;
+    memset(occupied, 0, sizeof(occupied));
+    memset(&stats, 0, sizeof(stats));
+    wheel_ready = true;
+
+#if defined(CONFIG_TIMER_WHEEL_KERNEL_TIMER)
+    if (wheel_timer_running) {
+        k_timer_stop(&wheel_timer);
+        wheel_timer_running = false;
+    }
+#endif
+    k_spin_unlock(&wheel_lock, key);
+    return 0;
+}
+
+void timer_wheel_timer_init(struct timer_wheel_timer *timer, event_id_t event, uint32_t machine)
+{
+    if (!timer) {
+        return;
+    }
+
+    sys_dnode_init(&timer->node);
+    timer->expires = 0;
+    timer->event = event;
+    timer->machine = machine;
+}
+
+int timer_wheel_arm(struct timer_wheel_timer *timer, uint32_t timeout_ms)
+{
+    if (!timer) {
+        return -EINVAL;
+    }
+
+    // Rounded up without DIV_ROUND_UP(), which overflows near UINT32_MAX.
+    uint32_t ticks = timeout_ms / CONFIG_TIMER_WHEEL_TICK_MS +
+                     (timeout_ms % CONFIG_TIMER_WHEEL_TICK_MS != 0);
+    ticks = MAX(1, ticks);
+    if (ticks > WHEEL_MAX_TICKS) {
+        return -ERANGE;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&wheel_lock);
+
+    if (!wheel_ready) {
+        k_spin_unlock(&wheel_lock, key);
+        return -ENODEV;
+    }
+    if (sys_dnode_is_linked(&timer->node)) {
+        sys_dlist_remove(&timer->node);
+    } else {
+        stats.armed++;
+    }
+    timer->expires = wheel_now + ticks;
+    wheel_place(timer);
+
+#if defined(CONFIG_TIMER_WHEEL_KERNEL_TIMER)
+    wheel_timer_ensure_running();
+#endif
+    k_spin_unlock(&wheel_lock, key);
+    return 0;
+}
+
+int timer_wheel_cancel(struct timer_wheel_timer *timer)
+{
+    int ret = 0;
+
+    if (!timer) {
+        return -EINVAL;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&wheel_lock);
+    if (sys_dnode_is_linked(&timer->node)) {
+        sys_dlist_remove(&timer->node);
+        stats.armed--;
+        stats.cancelled++;
+    } else {
+        ret = -EALREADY;
+    }
+    k_spin_unlock(&wheel_lock, key);
+    return ret;
+}
+
+bool timer_wheel_is_armed(const struct timer_wheel_timer *timer)
+{
+    return timer && sys_dnode_is_linked(&timer->node);
+}
+
+uint32_t timer_wheel_remaining_ms(const struct timer_wheel_timer *timer)
+{
+    uint32_t remaining = 0;
+
+    if (!timer) {
+        return 0;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&wheel_lock);
+    if (sys_dnode_is_linked(&timer->node)) {
+        remaining = (timer->expires - wheel_now) * CONFIG_TIMER_WHEEL_TICK_MS;
+    }
+    k_spin_unlock(&wheel_lock, key);
+    return remaining;
+}
+
+// Called with wheel_lock held.
+static uint32_t wheel_next_event(void)
+{
+    uint32_t next = UINT32_MAX;
+    uint32_t offset = wheel_first_occupied(0, wheel_now + 1);
+
+    // Level 0 slots are single ticks.
+    if (offset < WHEEL_SLOTS) {
+        next = offset + 1;
+    }
+    // On the coarser levels a slot is only touched when it cascades, at
+    // the start of its span.
+    for (int level = 1; level < WHEEL_LEVELS; level++) {
+        const uint32_t index = wheel_now >> (level * WHEEL_SLOT_BITS);
+
+        offset = wheel_first_occupied(level, index + 1);
+        if (offset < WHEEL_SLOTS) {
+            const uint32_t tick = (index + 1 + offset) << (level * WHEEL_SLOT_BITS);
+
+            next = MIN(next, tick - wheel_now);
+        }
+    }
+    return next;
+}
+
+void timer_wheel_advance(uint32_t ticks)
+{
+    k_spinlock_key_t key = k_spin_lock(&wheel_lock);
+
+    while (ticks > 0) {
+        if (stats.armed == 0) {
+            // Nothing to cascade or expire: skip ahead.
+            wheel_now += ticks;
+            break;
+        }
+        if (ticks > 1) {
+            // Skip the ticks on which nothing happens.
+            uint32_t idle = MIN(wheel_next_event() - 1, ticks);
+
+            wheel_now += idle;
+            ticks -= idle;
+            if (ticks == 0) {
+                break;
+            }
+        }
+        ticks--;
+        wheel_tick();
+
+        sys_dlist_t *slot = &wheel[0][wheel_now & WHEEL_SLOT_MASK];
+        sys_dnode_t *node;
+
+        while ((node = sys_dlist_get(slot)) != NULL) {
+            struct timer_wheel_timer *timer = CONTAINER_OF(node, struct timer_wheel_timer, node);
+            const app_event_t event = {
+                .id = timer->event,
+                .payload.u32 = timer->machine,
+            };
+
+            stats.armed--;
+            stats.expired++;
+            // The timer is unlinked, so its owner may re-arm it from a
+            // subscriber while the event is being posted.
+            k_spin_unlock(&wheel_lock, key);
+            if (event_bus_post(&event) != 0) {
+                LOG_WRN("Failed to post expiry of timer for machine %u", event.payload.u32);
+            }
+            key = k_spin_lock(&wheel_lock);
+        }
+        occupied[0] &= ~BIT64(wheel_now & WHEEL_SLOT_MASK);
+    }
+    k_spin_unlock(&wheel_lock, key);
+}
+
+uint32_t timer_wheel_next_event(void)
+{
+    uint32_t next = UINT32_MAX;
+    k_spinlock_key_t key = k_spin_lock(&wheel_lock);
+
+    if (stats.armed > 0) {
+        next = wheel_next_event();
+    }
+    k_spin_unlock(&wheel_lock, key);
+    return next;
+}
+
+uint32_t timer_wheel_now(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&wheel_lock);
+    uint32_t now = wheel_now;
+
+    k_spin_unlock(&wheel_lock, key);
+    return now;
+}
+
+void timer_wheel_get_stats(timer_wheel_stats_t *out)
+{
+    if (!out) {
+        return;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&wheel_lock);
+    *out = stats;
+    k_spin_unlock(&wheel_lock, key);
+}
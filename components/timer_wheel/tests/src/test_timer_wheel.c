@@ -0,0 +1,197 @@
+#include <zephyr/ztest.h>
+#include <zephyr/kernel.h>
+#include "event_bus.h"
+#include "timer_wheel.h"
+
+#define TICK_MS CONFIG_TIMER_WHEEL_TICK_MS
+#define MANY_TIMERS 5000
+
+K_MSGQ_DEFINE(expiry_q, sizeof(app_event_t), 64, 4);
+
+static const event_id_t expiry_events[] = {
+	EVENT_TIMER_EXPIRED,
+};
+
+static struct timer_wheel_timer timers[MANY_TIMERS];
+
+static void *timer_wheel_suite_setup(void)
+{
+	zassert_ok(event_bus_init(), "event_bus_init() failed");
+	zassert_not_null(event_bus_subscribe(&expiry_q, expiry_events, ARRAY_SIZE(expiry_events)),
+			 "Subscription failed");
+	return NULL;
+}
+
+static void timer_wheel_before(void *data)
+{
+	ARG_UNUSED(data);
+	zassert_ok(timer_wheel_init(), "timer_wheel_init() failed");
+	k_msgq_purge(&expiry_q);
+	for (int i = 0; i < MANY_TIMERS; i++) {
+		timer_wheel_timer_init(&timers[i], EVENT_TIMER_EXPIRED, i);
+	}
+}
+
+// Advances one tick and returns the number of expiries it posted, checking
+// that each belongs to a timer due on exactly this tick.
+static int advance_one(const uint32_t *due)
+{
+	app_event_t event;
+	int expired = 0;
+
+	timer_wheel_advance(1);
+	while (k_msgq_get(&expiry_q, &event, K_NO_WAIT) == 0) {
+		zassert_equal(event.id, EVENT_TIMER_EXPIRED, "Unexpected event");
+		if (due) {
+			zassert_equal(due[event.payload.u32], timer_wheel_now(),
+				      "Timer %u expired on tick %u, due %u", event.payload.u32,
+				      timer_wheel_now(), due[event.payload.u32]);
+		}
+		expired++;
+	}
+	return expired;
+}
+
+ZTEST(timer_wheel_suite, test_expires_on_time)
+{
+	app_event_t event;
+
+	zassert_ok(timer_wheel_arm(&timers[7], 5 * TICK_MS));
+	zassert_true(timer_wheel_is_armed(&timers[7]));
+	zassert_equal(timer_wheel_remaining_ms(&timers[7]), 5 * TICK_MS);
+
+	timer_wheel_advance(4);
+	zassert_equal(k_msgq_num_used_get(&expiry_q), 0, "Expired early");
+	zassert_equal(timer_wheel_remaining_ms(&timers[7]), TICK_MS);
+
+	timer_wheel_advance(1);
+	zassert_ok(k_msgq_get(&expiry_q, &event, K_NO_WAIT), "Did not expire");
+	zassert_equal(event.payload.u32, 7, "Wrong machine in the expiry event");
+	zassert_false(timer_wheel_is_armed(&timers[7]));
+	zassert_equal(timer_wheel_remaining_ms(&timers[7]), 0);
+}
+
+ZTEST(timer_wheel_suite, test_cancel_and_rearm)
+{
+	timer_wheel_stats_t stats;
+
+	zassert_ok(timer_wheel_arm(&timers[0], 3 * TICK_MS));
+	zassert_ok(timer_wheel_cancel(&timers[0]));
+	zassert_equal(timer_wheel_cancel(&timers[0]), -EALREADY);
+	timer_wheel_advance(10);
+	zassert_equal(k_msgq_num_used_get(&expiry_q), 0, "Cancelled timer expired");
+
+	// Re-arming replaces the previous timeout.
+	zassert_ok(timer_wheel_arm(&timers[1], 2 * TICK_MS));
+	zassert_ok(timer_wheel_arm(&timers[1], 6 * TICK_MS));
+	timer_wheel_advance(5);
+	zassert_equal(k_msgq_num_used_get(&expiry_q), 0, "Re-armed timer kept its old timeout");
+	timer_wheel_advance(1);
+	zassert_equal(k_msgq_num_used_get(&expiry_q), 1, "Re-armed timer did not expire");
+
+	timer_wheel_get_stats(&stats);
+	zassert_equal(stats.armed, 0);
+	zassert_equal(stats.expired, 1);
+	zassert_equal(stats.cancelled, 1);
+}
+
+ZTEST(timer_wheel_suite, test_bad_arguments)
+{
+	zassert_equal(timer_wheel_arm(NULL, 10), -EINVAL);
+	zassert_equal(timer_wheel_cancel(NULL), -EINVAL);
+	zassert_equal(timer_wheel_arm(&timers[0], UINT32_MAX), -ERANGE);
+	zassert_false(timer_wheel_is_armed(&timers[0]));
+}
+
+/**
+ * @brief Timeouts on every level of the wheel, including across the
+ * cascade boundaries, expire on their exact tick.
+ */
+ZTEST(timer_wheel_suite, test_every_level_expires_on_time)
+{
+	static const uint32_t ticks[] = {
+		1, 63, 64, 65, 100, 4095, 4096, 4097, 70000, 262143, 262144, 300001,
+	};
+	static uint32_t due[ARRAY_SIZE(ticks)];
+	int expired = 0;
+
+	// Start off a level boundary, so the cascades are not aligned with 0.
+	timer_wheel_advance(37);
+	for (int i = 0; i < ARRAY_SIZE(ticks); i++) {
+		due[i] = timer_wheel_now() + ticks[i];
+		zassert_ok(timer_wheel_arm(&timers[i], ticks[i] * TICK_MS));
+	}
+	for (uint32_t t = 0; t < ticks[ARRAY_SIZE(ticks) - 1]; t++) {
+		expired += advance_one(due);
+	}
+	zassert_equal(expired, ARRAY_SIZE(ticks), "Some timers never expired");
+}
+
+/**
+ * @brief Thousands of timers, some cancelled, each fire once and on time.
+ */
+ZTEST(timer_wheel_suite, test_many_timers)
+{
+	static uint32_t due[MANY_TIMERS];
+	timer_wheel_stats_t stats;
+	uint32_t seed = 1;
+	int expired = 0;
+
+	for (int i = 0; i < MANY_TIMERS; i++) {
+		seed = seed * 1664525u + 1013904223u;
+		uint32_t ticks = 1 + (seed >> 8) % 20000;
+
+		due[i] = timer_wheel_now() + ticks;
+		zassert_ok(timer_wheel_arm(&timers[i], ticks * TICK_MS));
+	}
+	for (int i = 0; i < MANY_TIMERS; i += 10) {
+		zassert_ok(timer_wheel_cancel(&timers[i]));
+	}
+
+	for (uint32_t t = 0; t < 20000; t++) {
+		expired += advance_one(due);
+	}
+
+	timer_wheel_get_stats(&stats);
+	zassert_equal(expired, MANY_TIMERS - MANY_TIMERS / 10);
+	zassert_equal(stats.expired, expired);
+	zassert_equal(stats.armed, 0);
+}
+
+/**
+ * @brief Jumping from one timer_wheel_next_event() to the next expires
+ * every timer on the same tick as stepping one tick at a time.
+ */
+ZTEST(timer_wheel_suite, test_next_event_jumps)
+{
+	static uint32_t due[MANY_TIMERS];
+	uint32_t seed = 7;
+	int expired = 0;
+	int jumps = 0;
+
+	zassert_equal(timer_wheel_next_event(), UINT32_MAX, "Empty wheel has work to do");
+
+	for (int i = 0; i < MANY_TIMERS; i++) {
+		seed = seed * 1664525u + 1013904223u;
+		uint32_t ticks = 1 + (seed >> 8) % 300000;
+
+		due[i] = timer_wheel_now() + ticks;
+		zassert_ok(timer_wheel_arm(&timers[i], ticks * TICK_MS));
+	}
+
+	uint32_t next;
+
+	while ((next = timer_wheel_next_event()) != UINT32_MAX) {
+		zassert_true(next > 0, "Next event is now");
+		if (next > 1) {
+			timer_wheel_advance(next - 1);
+			zassert_equal(k_msgq_num_used_get(&expiry_q), 0, "Jumped over an expiry");
+		}
+		expired += advance_one(due);
+		jumps++;
+	}
+	zassert_equal(expired, MANY_TIMERS);
+	TC_PRINT("%d timers over %u ticks in %d jumps\n", MANY_TIMERS, timer_wheel_now(), jumps);
+}
+
+ZTEST_SUITE(timer_wheel_suite, NULL, timer_wheel_suite_setup, timer_wheel_before, NULL, NULL);